@@ -0,0 +1,225 @@
+#include "AsyncLogger.h"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <iostream>
+#include <vector>
+
+namespace tools
+{
+    namespace
+    {
+        const char* levelName(LogLevel level)
+        {
+            switch( level )
+            {
+                case LogLevel::VERBOSE: return "VERBOSE";
+                case LogLevel::DEBUG: return "DEBUG";
+                case LogLevel::INFO: return "INFO";
+                case LogLevel::WARNING: return "WARNING";
+                case LogLevel::PROBLEM: return "ERROR";
+            }
+            return "";
+        }
+
+        const char* levelColor(LogLevel level)
+        {
+            switch( level )
+            {
+                case LogLevel::VERBOSE: return "\033[38;5;219m"; // Light Purple
+                case LogLevel::DEBUG: return "\033[36m";         // Cyan
+                case LogLevel::INFO: return "\033[32m";          // Green
+                case LogLevel::WARNING: return "\033[33m";       // Yellow
+                case LogLevel::PROBLEM: return "\033[31m";       // Red
+            }
+            return "";
+        }
+
+        // std::localtime shares one buffer between threads, these do not.
+        bool toLocalTime(std::time_t time, std::tm& result)
+        {
+#ifdef _WIN32
+            return localtime_s(&result, &time) == 0;
+#else
+            return localtime_r(&time, &result) != nullptr;
+#endif
+        }
+    }
+
+    AsyncLogger::AsyncLogger() : AsyncLogger(Options(), std::cout)
+    {
+    }
+
+    AsyncLogger::AsyncLogger(const Options& options, std::ostream& output) : AsyncLogger(options, output, nullptr)
+    {
+    }
+
+    AsyncLogger::AsyncLogger(const Options& options, std::ostream& output, std::ostream& file) : AsyncLogger(options, output, &file)
+    {
+    }
+
+    AsyncLogger::AsyncLogger(const Options& options, std::ostream& output, std::ostream* file)
+        : Logger(options.verbosity), m_options(options), m_output(output), m_file(file), m_records(std::max<size_t>(options.capacity, 2))
+    {
+        m_options.batchSize = std::max<size_t>(m_options.batchSize, 1);
+        m_writer = std::thread(&AsyncLogger::run, this);
+    }
+
+    AsyncLogger::~AsyncLogger()
+    {
+        stop();
+    }
+
+    void AsyncLogger::log(const std::string& message, LogLevel level)
+    {
+        if( level < m_verbosity )
+            return;
+
+        const int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const size_t length = std::min(message.size(), RECORD_TEXT_SIZE);
+        auto fill = [&message, level, time, length](Record& record)
+            {
+                record.time = time;
+                record.level = level;
+                record.length = static_cast<uint16_t>(length);
+                std::memcpy(record.text, message.data(), length);
+                if( message.size() > RECORD_TEXT_SIZE )
+                    std::memcpy(record.text + RECORD_TEXT_SIZE - 3, "...", 3);
+            };
+
+        // Counted until the record is queued, so stop() waits for the producers that did not see it stopping.
+        m_producers.fetch_add(1);
+        if( m_stopped.load() )
+        {
+            m_producers.fetch_sub(1);
+            Record record;
+            fill(record);
+            write(&record, 1);
+            return;
+        }
+
+        // The record is written straight into the ring buffer, only the bytes of the message are copied.
+        if( !m_records.tryEmplace(fill) )
+        {
+            const bool wait = m_options.overflow == OverflowPolicy::Block
+                || (m_options.overflow == OverflowPolicy::DropBelowWarning && level >= LogLevel::WARNING);
+            if( wait )
+            {
+                while( !m_records.tryEmplace(fill) )
+                    std::this_thread::yield();
+            }
+            else
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        m_producers.fetch_sub(1);
+    }
+
+    void AsyncLogger::stop()
+    {
+        if( !m_writer.joinable() )
+            return;
+
+        m_records.close();
+        m_writer.join();
+        m_stopped.store(true);
+
+        // Messages pushed while the writer was finishing or by producers still queueing, and drops not reported yet.
+        // Once no producer is counted after m_stopped was set, every later message is written by log() itself.
+        Record record;
+        for( bool producing = true; producing; )
+        {
+            producing = m_producers.load() != 0;
+            while( m_records.tryPop(record) )
+                write(&record, 1);
+            if( producing )
+                std::this_thread::yield();
+        }
+        write(nullptr, 0);
+    }
+
+    uint64_t AsyncLogger::droppedCount() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    void AsyncLogger::run()
+    {
+        std::vector<Record> batch(m_options.batchSize);
+        while( m_records.waitPop(batch[0]) )
+        {
+            size_t count = 1;
+            while( count < batch.size() && m_records.tryPop(batch[count]) )
+                ++count;
+            write(batch.data(), count);
+        }
+    }
+
+    void AsyncLogger::write(const Record* records, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+
+        Record note;
+        const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        const bool reportDrops = dropped != m_reportedDropped;
+        if( reportDrops )
+        {
+            note.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            note.level = LogLevel::WARNING;
+            const auto result = std::format_to_n(note.text, RECORD_TEXT_SIZE, "AsyncLogger: {} messages were dropped, the buffer was full.", dropped - m_reportedDropped);
+            note.length = static_cast<uint16_t>(std::min<size_t>(result.size, RECORD_TEXT_SIZE));
+            m_reportedDropped = dropped;
+        }
+
+        // The file gets the lines without colors, so they are formatted once per output.
+        if( m_file != nullptr )
+            writeTo(*m_file, reportDrops ? &note : nullptr, records, count, false);
+        writeTo(m_output, reportDrops ? &note : nullptr, records, count, m_options.colors);
+    }
+
+    void AsyncLogger::writeTo(std::ostream& output, const Record* note, const Record* records, size_t count, bool colors)
+    {
+        m_buffer.clear();
+        if( note != nullptr )
+            append(*note, colors);
+        for( size_t i = 0; i < count; ++i )
+            append(records[i], colors);
+
+        if( !m_buffer.empty() )
+        {
+            output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            output.flush();
+        }
+    }
+
+    void AsyncLogger::append(const Record& record, bool colors)
+    {
+        // The date is formatted once per second, most lines only add their milliseconds.
+        const int64_t second = record.time / 1000000;
+        if( second != m_cachedSecond )
+        {
+            std::tm local{};
+            if( !toLocalTime(static_cast<std::time_t>(second), local) || std::strftime(m_cachedTime, sizeof(m_cachedTime), "%Y-%m-%d %H:%M:%S", &local) == 0 )
+                m_cachedTime[0] = '\0';
+            m_cachedSecond = second;
+        }
+
+        // Appended piece by piece, which is several times faster than formatting the whole line.
+        const int64_t milliseconds = record.time / 1000 % 1000;
+        const char fraction[4] = { '.', static_cast<char>('0' + milliseconds / 100), static_cast<char>('0' + milliseconds / 10 % 10), static_cast<char>('0' + milliseconds % 10) };
+        if( colors )
+            m_buffer.append(levelColor(record.level));
+        m_buffer.push_back('[');
+        m_buffer.append(m_cachedTime);
+        m_buffer.append(fraction, sizeof(fraction));
+        m_buffer.append("][");
+        m_buffer.append(levelName(record.level));
+        m_buffer.append("]: ");
+        m_buffer.append(record.text, record.length);
+        if( colors )
+            m_buffer.append("\033[0m");
+        m_buffer.push_back('\n');
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * @file AsyncLogger.h
+ * @brief Defines the AsyncLogger class, a logger writing its messages on a background thread.
+ */
+
+#pragma once
+
+#include "Logger.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace tools
+{
+    /**
+     * @class AsyncLogger
+     * @brief Logger that only copies a message into a ring buffer; a background thread formats and writes it.
+     *
+     * A call to log() fills one fixed-size record and pushes it into a lock-free MpscQueue, so logging threads never
+     * wait for each other nor for the output. The writer thread takes the records in batches, formats them into one
+     * buffer and writes and flushes it once per batch. Messages longer than a record are cut, ending with "...".
+     *
+     * When the buffer is full, the overflow policy decides whether the caller waits or the message is dropped;
+     * dropped messages are counted and reported by the writer. stop() or the destructor writes every queued
+     * message before returning.
+     */
+    class AsyncLogger : public Logger
+    {
+    public:
+        static constexpr size_t RECORD_TEXT_SIZE = 480; ///< The bytes of a message a record keeps.
+
+        /**
+         * @brief What log() does when the ring buffer is full.
+         */
+        enum class OverflowPolicy
+        {
+            Block,           ///< Wait until the writer makes room; nothing is lost.
+            Drop,            ///< Drop the message.
+            DropBelowWarning ///< Drop messages below WARNING, wait with warnings and problems.
+        };
+
+        /**
+         * @brief Settings of the logger.
+         */
+        struct Options
+        {
+            LogLevel verbosity = LogLevel::DEBUG;            ///< Messages below this level are ignored.
+            size_t capacity = 8192;                          ///< The records the ring buffer holds.
+            size_t batchSize = 256;                          ///< The most records written with one flush.
+            OverflowPolicy overflow = OverflowPolicy::Block; ///< What to do when the buffer is full.
+            bool colors = true;                              ///< Whether lines are colored with ANSI escape codes.
+        };
+
+        /**
+         * @brief Starts a logger writing to the console with default options.
+         */
+        AsyncLogger();
+
+        /**
+         * @brief Starts a logger.
+         * @param options The settings of the logger.
+         * @param output The stream to write to, it must outlive the logger.
+         */
+        AsyncLogger(const Options& options, std::ostream& output);
+
+        /**
+         * @brief Starts a logger writing every message to a file as well, e.g. through a RotatingFileSink.
+         * @param options The settings of the logger; the file never gets colors.
+         * @param output The stream to write to, it must outlive the logger.
+         * @param file The file stream to write to, it must outlive the logger.
+         */
+        AsyncLogger(const Options& options, std::ostream& output, std::ostream& file);
+
+        /**
+         * @brief Writes the queued messages and stops the writer thread.
+         */
+        ~AsyncLogger() override;
+
+        AsyncLogger(const AsyncLogger&) = delete;
+        AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+        /**
+         * @brief Queues a message. Safe to call from any thread.
+         *
+         * @param message The message to log.
+         * @param level The log level of the message.
+         */
+        void log(const std::string& message, LogLevel level) override;
+
+        /**
+         * @brief Writes the queued messages and stops the writer thread.
+         *
+         * Messages logged afterwards are written by the calling thread. Calling it again does nothing.
+         */
+        void stop();
+
+        /**
+         * @brief Returns the number of messages dropped because the buffer was full.
+         */
+        uint64_t droppedCount() const;
+
+    private:
+        /**
+         * @brief Starts a logger; the public constructors delegate here.
+         * @param file The file stream to write to as well, or null.
+         */
+        AsyncLogger(const Options& options, std::ostream& output, std::ostream* file);
+
+        struct Record
+        {
+            int64_t time = 0; ///< Microseconds since the epoch of the system clock.
+            LogLevel level = LogLevel::INFO;
+            uint16_t length = 0;
+            char text[RECORD_TEXT_SIZE];
+        };
+
+        void run();
+        void write(const Record* records, size_t count);
+        void writeTo(std::ostream& output, const Record* note, const Record* records, size_t count, bool colors);
+        void append(const Record& record, bool colors);
+
+        Options m_options;
+        std::ostream& m_output;
+        std::ostream* m_file = nullptr;
+        std::mutex m_outputMutex;       ///< Guards the output and the members below it, the writer takes it once per batch.
+        std::string m_buffer;           ///< The formatted batch, reused so it keeps its capacity.
+        uint64_t m_reportedDropped = 0; ///< The drops already reported.
+        int64_t m_cachedSecond = -1;    ///< The second formatted into m_cachedTime.
+        char m_cachedTime[32] = {};
+        MpscQueue<Record> m_records;
+        std::atomic<uint64_t> m_dropped{ 0 };
+        std::atomic<bool> m_stopped{ false }; ///< Set once the writer is gone, log() then writes by itself.
+        std::atomic<size_t> m_producers{ 0 }; ///< Calls of log() between checking m_stopped and queueing their record.
+        std::thread m_writer;
+    };
+}
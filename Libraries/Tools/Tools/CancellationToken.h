@@ -0,0 +1,102 @@
+/**
+ * @file CancellationToken.h
+ * @brief Defines the CancellationToken class, which lets one caller cancel the operations it started.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+
+namespace tools
+{
+    /**
+     * @class CancellationToken
+     * @brief Cancellation flag shared between the owner of some background work and the code doing it.
+     *
+     * The owner (e.g. a widget) keeps one token per kind of work and passes it to every operation it starts.
+     * Long-running operations subscribe a callback that aborts them (kills a process, fails a request), so
+     * cancel() stops exactly the work of this owner and leaves the operations of other owners running.
+     */
+    class CancellationToken
+    {
+    public:
+
+        using Callback = std::function<void()>;
+
+        CancellationToken() = default;
+
+        CancellationToken(const CancellationToken&) = delete;
+        CancellationToken& operator=(const CancellationToken&) = delete;
+
+        /**
+         * @brief Marks the token as cancelled and invokes the subscribed callbacks.
+         */
+        void cancel()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled = true;
+            for( auto& callback : m_callbacks )
+            {
+                callback.second();
+            }
+        }
+
+        /**
+         * @brief Checks whether cancel() was called since the last reset().
+         */
+        bool isCancelled() const
+        {
+            return m_cancelled;
+        }
+
+        /**
+         * @brief Clears the cancelled flag, so the token can be used for the next operation.
+         */
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled = false;
+        }
+
+        /**
+         * @brief Registers a callback that aborts a running operation.
+         *
+         * Callbacks run while the token is locked, so once unsubscribe() returns the callback is not running
+         * and will not run again.
+         *
+         * @param callback Invoked by cancel(), or right away if the token is cancelled already.
+         * @return The id for unsubscribe().
+         */
+        uint64_t subscribe(Callback callback)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if( m_cancelled )
+                callback();
+
+            const uint64_t id = m_nextId++;
+            m_callbacks.emplace(id, std::move(callback));
+            return id;
+        }
+
+        /**
+         * @brief Removes a callback registered by subscribe().
+         * @param id The id returned by subscribe().
+         */
+        void unsubscribe(uint64_t id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_callbacks.erase(id);
+        }
+
+    private:
+
+        mutable std::mutex m_mutex;
+        std::atomic<bool> m_cancelled{ false };
+        uint64_t m_nextId = 1;
+        std::map<uint64_t, Callback> m_callbacks;
+    };
+}
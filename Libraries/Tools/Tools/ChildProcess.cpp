@@ -0,0 +1,495 @@
+#include "ChildProcess.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace tools
+{
+#ifdef _WIN32
+    namespace
+    {
+        std::wstring toWide(const std::string& str)
+        {
+            if( str.empty() )
+                return std::wstring();
+            int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
+            std::wstring wstr(len, L'\0');
+            MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), &wstr[0], len);
+            return wstr;
+        }
+
+        // Quotes one argument following the rules of CommandLineToArgvW.
+        std::string quoteArgument(const std::string& argument)
+        {
+            if( !argument.empty() && argument.find_first_of(" \t\"") == std::string::npos )
+                return argument;
+
+            std::string quoted = "\"";
+            size_t backslashes = 0;
+            for( char c : argument )
+            {
+                if( c == '\\' )
+                {
+                    ++backslashes;
+                    continue;
+                }
+                if( c == '"' )
+                    quoted.append(backslashes * 2 + 1, '\\');
+                else
+                    quoted.append(backslashes, '\\');
+                backslashes = 0;
+                quoted += c;
+            }
+            quoted.append(backslashes * 2, '\\');
+            quoted += '"';
+            return quoted;
+        }
+    }
+
+    ChildProcess::~ChildProcess()
+    {
+        terminate();
+        closeHandles();
+    }
+
+    bool ChildProcess::start(const std::vector<std::string>& arguments)
+    {
+        if( arguments.empty() || m_process )
+            return false;
+
+        SECURITY_ATTRIBUTES saAttr;
+        saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
+        saAttr.bInheritHandle = TRUE;
+        saAttr.lpSecurityDescriptor = NULL;
+
+        HANDLE stdinRead = NULL, stdinWrite = NULL, stdoutRead = NULL, stdoutWrite = NULL;
+        if( !CreatePipe(&stdinRead, &stdinWrite, &saAttr, 0) )
+            return false;
+        if( !CreatePipe(&stdoutRead, &stdoutWrite, &saAttr, 0) )
+        {
+            CloseHandle(stdinRead);
+            CloseHandle(stdinWrite);
+            return false;
+        }
+
+        // Our ends of the pipes must not leak into the child.
+        SetHandleInformation(stdinWrite, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(stdoutRead, HANDLE_FLAG_INHERIT, 0);
+
+        std::string commandLine;
+        for( const auto& argument : arguments )
+        {
+            if( !commandLine.empty() )
+                commandLine += ' ';
+            commandLine += quoteArgument(argument);
+        }
+        std::wstring wcommand = toWide(commandLine);
+
+        PROCESS_INFORMATION piProcInfo;
+        ZeroMemory(&piProcInfo, sizeof(PROCESS_INFORMATION));
+        STARTUPINFOW siStartInfo;
+        ZeroMemory(&siStartInfo, sizeof(STARTUPINFOW));
+        siStartInfo.cb = sizeof(STARTUPINFOW);
+        siStartInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+        siStartInfo.hStdOutput = stdoutWrite;
+        siStartInfo.hStdInput = stdinRead;
+        siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
+
+        // Started suspended so it is in the job before it can start processes of its own.
+        BOOL success = CreateProcessW(NULL, &wcommand[0], NULL, NULL, TRUE, CREATE_NO_WINDOW | CREATE_SUSPENDED, NULL, NULL, &siStartInfo, &piProcInfo);
+
+        // The child owns its ends now.
+        CloseHandle(stdinRead);
+        CloseHandle(stdoutWrite);
+
+        if( !success )
+        {
+            CloseHandle(stdinWrite);
+            CloseHandle(stdoutRead);
+            return false;
+        }
+
+        // Closing the job kills the whole tree, also when the application itself exits.
+        HANDLE job = CreateJobObjectW(NULL, NULL);
+        if( job )
+        {
+            JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+            ZeroMemory(&limits, sizeof(limits));
+            limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+            SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+            if( !AssignProcessToJobObject(job, piProcInfo.hProcess) )
+            {
+                CloseHandle(job);
+                job = NULL;
+            }
+        }
+
+        ResumeThread(piProcInfo.hThread);
+        CloseHandle(piProcInfo.hThread);
+        m_job = job;
+        m_process = piProcInfo.hProcess;
+        m_stdinWrite = stdinWrite;
+        m_stdoutRead = stdoutRead;
+        return true;
+    }
+
+    bool ChildProcess::write(const std::string& data)
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if( !m_stdinWrite )
+            return false;
+
+        size_t offset = 0;
+        while( offset < data.size() )
+        {
+            DWORD written = 0;
+            if( !WriteFile(m_stdinWrite, data.data() + offset, (DWORD)(data.size() - offset), &written, NULL) )
+                return false;
+            offset += written;
+        }
+        return true;
+    }
+
+    int ChildProcess::read(char* buffer, size_t size)
+    {
+        if( !m_stdoutRead )
+            return -1;
+
+        DWORD read = 0;
+        if( !ReadFile(m_stdoutRead, buffer, (DWORD)size, &read, NULL) )
+        {
+            return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+        }
+        return (int)read;
+    }
+
+    int ChildProcess::read(char* buffer, size_t size, std::chrono::milliseconds timeout)
+    {
+        if( !m_stdoutRead )
+            return -1;
+
+        // Anonymous pipes cannot be waited on, so poll them until data arrives or the time is up.
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while( true )
+        {
+            DWORD available = 0;
+            if( !PeekNamedPipe(m_stdoutRead, NULL, 0, NULL, &available, NULL) )
+                return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+            if( available > 0 )
+                return read(buffer, size < available ? size : (size_t)available);
+            if( std::chrono::steady_clock::now() >= deadline )
+                return TIMED_OUT;
+            Sleep(5);
+        }
+    }
+
+    void ChildProcess::closeInput()
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if( m_stdinWrite )
+        {
+            CloseHandle(m_stdinWrite);
+            m_stdinWrite = nullptr;
+        }
+    }
+
+    bool ChildProcess::isRunning()
+    {
+        return m_process && WaitForSingleObject(m_process, 0) == WAIT_TIMEOUT;
+    }
+
+    void ChildProcess::terminate()
+    {
+        if( m_job )
+            TerminateJobObject(m_job, 1);
+
+        if( isRunning() )
+        {
+            TerminateProcess(m_process, 1);
+            WaitForSingleObject(m_process, INFINITE);
+        }
+    }
+
+    int ChildProcess::wait()
+    {
+        if( !m_process )
+            return -1;
+
+        WaitForSingleObject(m_process, INFINITE);
+        DWORD exitCode = 0;
+        GetExitCodeProcess(m_process, &exitCode);
+        return (int)exitCode;
+    }
+
+    void ChildProcess::closeHandles()
+    {
+        closeInput();
+        if( m_stdoutRead )
+        {
+            CloseHandle(m_stdoutRead);
+            m_stdoutRead = nullptr;
+        }
+        if( m_process )
+        {
+            CloseHandle(m_process);
+            m_process = nullptr;
+        }
+        if( m_job )
+        {
+            CloseHandle(m_job);
+            m_job = nullptr;
+        }
+    }
+#else
+    namespace
+    {
+        /**
+         * @brief Blocks SIGPIPE on the calling thread for its lifetime.
+         *
+         * A worker that dies while we write must surface as a failed write, not kill the application. Only the
+         * writing thread is touched, the process-wide disposition of SIGPIPE stays as the application set it.
+         */
+        class SigpipeBlocker
+        {
+        public:
+            SigpipeBlocker()
+            {
+                sigemptyset(&m_sigpipe);
+                sigaddset(&m_sigpipe, SIGPIPE);
+
+                sigset_t pending;
+                sigpending(&pending);
+                m_wasPending = sigismember(&pending, SIGPIPE) == 1;
+                pthread_sigmask(SIG_BLOCK, &m_sigpipe, &m_previousMask);
+            }
+
+            ~SigpipeBlocker()
+            {
+                pthread_sigmask(SIG_SETMASK, &m_previousMask, nullptr);
+            }
+
+            SigpipeBlocker(const SigpipeBlocker&) = delete;
+            SigpipeBlocker& operator=(const SigpipeBlocker&) = delete;
+
+            /**
+             * @brief Takes the SIGPIPE a failed write raised, so it is not delivered once the mask is restored.
+             */
+            void discardRaised()
+            {
+                if( m_wasPending )
+                    return;
+
+                const int error = errno;
+                const timespec noWait{ 0, 0 };
+                while( sigtimedwait(&m_sigpipe, nullptr, &noWait) < 0 && errno == EINTR )
+                {
+                }
+                errno = error;
+            }
+
+        private:
+            sigset_t m_sigpipe;
+            sigset_t m_previousMask;
+            bool m_wasPending = false;
+        };
+    }
+
+    ChildProcess::~ChildProcess()
+    {
+        terminate();
+        closeHandles();
+    }
+
+    bool ChildProcess::start(const std::vector<std::string>& arguments)
+    {
+        if( arguments.empty() || m_pid > 0 )
+            return false;
+
+        int stdinPipe[2];
+        int stdoutPipe[2];
+        if( pipe(stdinPipe) != 0 )
+            return false;
+        if( pipe(stdoutPipe) != 0 )
+        {
+            ::close(stdinPipe[0]);
+            ::close(stdinPipe[1]);
+            return false;
+        }
+        fcntl(stdinPipe[1], F_SETFD, FD_CLOEXEC);
+        fcntl(stdoutPipe[0], F_SETFD, FD_CLOEXEC);
+
+        // Build argv before forking, only async-signal-safe calls are allowed in the child.
+        std::vector<char*> argv;
+        for( const auto& argument : arguments )
+        {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if( pid < 0 )
+        {
+            ::close(stdinPipe[0]);
+            ::close(stdinPipe[1]);
+            ::close(stdoutPipe[0]);
+            ::close(stdoutPipe[1]);
+            return false;
+        }
+
+        if( pid == 0 )
+        {
+            // Own process group, so the whole tree can be signalled at once.
+            setpgid(0, 0);
+            dup2(stdinPipe[0], STDIN_FILENO);
+            dup2(stdoutPipe[1], STDOUT_FILENO);
+            ::close(stdinPipe[0]);
+            ::close(stdoutPipe[1]);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+
+        ::close(stdinPipe[0]);
+        ::close(stdoutPipe[1]);
+        m_pid = pid;
+        m_reaped = false;
+        m_exitCode = -1;
+        m_stdinWrite = stdinPipe[1];
+        m_stdoutRead = stdoutPipe[0];
+        return true;
+    }
+
+    bool ChildProcess::write(const std::string& data)
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if( m_stdinWrite < 0 )
+            return false;
+
+        SigpipeBlocker sigpipeBlocker;
+        size_t offset = 0;
+        while( offset < data.size() )
+        {
+            ssize_t written = ::write(m_stdinWrite, data.data() + offset, data.size() - offset);
+            if( written < 0 )
+            {
+                if( errno == EINTR )
+                    continue;
+                if( errno == EPIPE )
+                    sigpipeBlocker.discardRaised();
+                return false;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    int ChildProcess::read(char* buffer, size_t size)
+    {
+        if( m_stdoutRead < 0 )
+            return -1;
+
+        while( true )
+        {
+            ssize_t count = ::read(m_stdoutRead, buffer, size);
+            if( count < 0 && errno == EINTR )
+                continue;
+            return static_cast<int>(count);
+        }
+    }
+
+    int ChildProcess::read(char* buffer, size_t size, std::chrono::milliseconds timeout)
+    {
+        if( m_stdoutRead < 0 )
+            return -1;
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while( true )
+        {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            pollfd descriptor{ m_stdoutRead, POLLIN, 0 };
+            const int ready = poll(&descriptor, 1, remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0);
+            if( ready < 0 )
+            {
+                if( errno == EINTR )
+                    continue;
+                return -1;
+            }
+            if( ready == 0 )
+                return TIMED_OUT;
+
+            // Readable or hung up, either way read() does not block now.
+            return read(buffer, size);
+        }
+    }
+
+    void ChildProcess::closeInput()
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if( m_stdinWrite >= 0 )
+        {
+            ::close(m_stdinWrite);
+            m_stdinWrite = -1;
+        }
+    }
+
+    bool ChildProcess::isRunning()
+    {
+        if( m_pid <= 0 || m_reaped )
+            return false;
+
+        int status = 0;
+        if( waitpid(m_pid, &status, WNOHANG) == m_pid )
+        {
+            m_reaped = true;
+            m_exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            return false;
+        }
+        return true;
+    }
+
+    void ChildProcess::terminate()
+    {
+        if( isRunning() )
+        {
+            kill(-m_pid, SIGKILL);
+            kill(m_pid, SIGKILL);
+            wait();
+        }
+    }
+
+    int ChildProcess::wait()
+    {
+        if( m_pid <= 0 )
+            return -1;
+
+        if( !m_reaped )
+        {
+            int status = 0;
+            while( waitpid(m_pid, &status, 0) < 0 && errno == EINTR )
+            {
+            }
+            m_reaped = true;
+            m_exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        }
+        return m_exitCode;
+    }
+
+    void ChildProcess::closeHandles()
+    {
+        closeInput();
+        if( m_stdoutRead >= 0 )
+        {
+            ::close(m_stdoutRead);
+            m_stdoutRead = -1;
+        }
+    }
+#endif
+}
@@ -0,0 +1,121 @@
+/**
+ * @file ChildProcess.h
+ * @brief Defines the ChildProcess class for running a program with piped standard input and output.
+ *
+ * Unlike ScriptRunner, ChildProcess does not own any threads and does not interpret the output.
+ * It is a thin, portable wrapper around the process and its two pipes, meant to be driven by a
+ * caller that implements its own protocol on top of it (e.g. a long-lived dictionary worker).
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+
+namespace tools
+{
+    /**
+     * @class ChildProcess
+     * @brief Starts a program and exposes its stdin and stdout as byte streams.
+     *
+     * The child's stderr is inherited from the parent. Reads block until data is available or the
+     * child closes its stdout. Writing and reading may happen from different threads.
+     */
+    class ChildProcess
+    {
+    public:
+
+        /**
+         * @brief Returned by the timed read() when no bytes arrived in time.
+         */
+        static constexpr int TIMED_OUT = -2;
+
+        /**
+         * @brief Constructs an idle ChildProcess.
+         */
+        ChildProcess() = default;
+
+        /**
+         * @brief Terminates the child process if it is still running and releases the pipes.
+         */
+        ~ChildProcess();
+
+        ChildProcess(const ChildProcess&) = delete;
+        ChildProcess& operator=(const ChildProcess&) = delete;
+
+        /**
+         * @brief Starts a program.
+         * @param arguments The program (looked up in PATH) followed by its arguments.
+         * @return True if the process was started.
+         */
+        bool start(const std::vector<std::string>& arguments);
+
+        /**
+         * @brief Writes all bytes to the child's stdin.
+         * @param data The bytes to write.
+         * @return True if everything was written, false if the pipe is closed.
+         */
+        bool write(const std::string& data);
+
+        /**
+         * @brief Reads available bytes from the child's stdout, blocking until at least one byte arrives.
+         * @param buffer Destination buffer.
+         * @param size Size of the destination buffer.
+         * @return The number of bytes read, 0 when the child closed its stdout, -1 on error.
+         */
+        int read(char* buffer, size_t size);
+
+        /**
+         * @brief Reads available bytes from the child's stdout, waiting at most the given time.
+         * @param buffer Destination buffer.
+         * @param size Size of the destination buffer.
+         * @param timeout How long to wait for the first byte.
+         * @return The number of bytes read, 0 when the child closed its stdout, -1 on error, TIMED_OUT if nothing arrived.
+         */
+        int read(char* buffer, size_t size, std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Closes the child's stdin so it sees end of input.
+         */
+        void closeInput();
+
+        /**
+         * @brief Checks whether the child process is still alive.
+         * @return True if the process is running.
+         */
+        bool isRunning();
+
+        /**
+         * @brief Kills the child process and everything it started. Pending reads return 0 afterwards.
+         */
+        void terminate();
+
+        /**
+         * @brief Waits for the child process to exit.
+         * @return The exit code of the child, or -1 if it was not started.
+         */
+        int wait();
+
+    private:
+
+        void closeHandles();
+
+        std::mutex m_writeMutex; ///< Serializes writers of the child's stdin.
+
+#ifdef _WIN32
+        void* m_process = nullptr;  ///< HANDLE of the child process.
+        void* m_job = nullptr;  ///< HANDLE of the job object holding the child and its descendants.
+        void* m_stdinWrite = nullptr;  ///< HANDLE of the write end of the child's stdin.
+        void* m_stdoutRead = nullptr;  ///< HANDLE of the read end of the child's stdout.
+#else
+        int m_pid = -1;  ///< Process id of the child.
+        int m_stdinWrite = -1;  ///< Write end of the child's stdin.
+        int m_stdoutRead = -1;  ///< Read end of the child's stdout.
+        int m_exitCode = -1;  ///< Exit code once the child was reaped.
+        bool m_reaped = false;  ///< True once waitpid collected the child.
+#endif
+    };
+}
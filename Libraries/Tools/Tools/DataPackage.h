@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <stdexcept>
 
@@ -18,6 +22,8 @@ namespace tools
     public:
         using Identifier = uint32_t; ///< Alias for the identifier.
 
+        static constexpr Identifier NO_TYPE = 0; ///< The identifier of packages without a type of their own; never a PACKAGE_ID.
+
         /**
         * @brief Constructor.
         *
@@ -67,7 +73,7 @@ namespace tools
         *
         * @param id The identifier for the ComplexDataPackage.
         */
-        ComplexDataPackage(Identifier id = 0) : DataPackage(id) {}
+        ComplexDataPackage(Identifier id = NO_TYPE) : DataPackage(id) {}
 
         /**
         * @brief Sets a value in the package.
@@ -115,4 +121,98 @@ namespace tools
     protected:
         std::unordered_map<Key, std::variant<Types...>> values; ///< Map to store values of various types.
     };
+
+    /**
+    * @brief Describes one value of a KeyedDataPackage: its key and its type.
+    *
+    * @tparam KeyValue The key, an enumerator of the key type of the package.
+    * @tparam T The type of the value.
+    */
+    template<auto KeyValue, typename T>
+    struct PackageField
+    {
+        static constexpr auto key = KeyValue;
+        using Type = T;
+    };
+
+    /**
+    * @brief KeyedDataPackage stores a fixed set of values, one per key, with the type of each key known at compile time.
+    *
+    * Unlike ComplexDataPackage, every value has its own member at a fixed place in the package, chosen by the key
+    * at compile time, so setting or getting one neither hashes nor allocates, and using a key with the wrong type
+    * or a key that is not in the schema does not compile. A value that was never set is value-initialized.
+    *
+    * @tparam Key The enum of the keys.
+    * @tparam Fields One PackageField per key, each key at most once.
+    */
+    template<typename Key, typename... Fields>
+    class KeyedDataPackage : public DataPackage
+    {
+        template<Key K, typename T>
+        struct Slot
+        {
+            T value{};
+        };
+
+        template<Key K, typename T>
+        static T typeOf(const Slot<K, T>&);
+
+    public:
+        using KeyType = Key;
+
+        /**
+        * @brief The stored values, one member per field; trivially copyable if all their types are.
+        */
+        struct Values : Slot<Fields::key, typename Fields::Type>... {};
+
+        /**
+        * @brief The type of the value stored under a key.
+        */
+        template<Key K>
+        using ValueType = decltype(typeOf<K>(std::declval<const Values&>()));
+
+        /**
+        * @brief Constructor.
+        *
+        * Initializes the KeyedDataPackage with the provided identifier.
+        *
+        * @param id The identifier for the KeyedDataPackage.
+        */
+        KeyedDataPackage(Identifier id = NO_TYPE) : DataPackage(id)
+        {
+            static_assert((std::is_same_v<std::remove_cv_t<decltype(Fields::key)>, Key> && ...), "Every field must use the key type of the package");
+        }
+
+        /**
+        * @brief Sets a value in the package.
+        *
+        * @tparam K The key under which the value will be stored.
+        * @param value The value to store.
+        */
+        template<Key K>
+        void set(ValueType<K> value)
+        {
+            static_cast<Slot<K, ValueType<K>>&>(m_values).value = std::move(value);
+        }
+
+        /**
+        * @brief Gets a value from the package.
+        *
+        * @tparam K The key of the value to retrieve.
+        * @return The value stored under the key, or a value-initialized one if it was not set.
+        */
+        template<Key K>
+        const ValueType<K>& get() const
+        {
+            return static_cast<const Slot<K, ValueType<K>>&>(m_values).value;
+        }
+
+        /**
+        * @brief Gets all values of the package, e.g. to copy them at once.
+        */
+        const Values& values() const { return m_values; }
+
+    private:
+        Values m_values{}; ///< The values of all keys.
+    };
 }
@@ -0,0 +1,80 @@
+/**
+ * @file Delegate.h
+ * @brief Defines the Delegate class template, a callable wrapper that never allocates.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tools
+{
+    template<typename Signature, size_t Capacity = 3 * sizeof(void*)>
+    class Delegate;
+
+    /**
+     * @class Delegate
+     * @brief Holds a small callable, like std::function, but always inside the object itself.
+     *
+     * Only callables that fit the buffer and are trivially copyable are accepted, e.g. lambdas capturing a few
+     * pointers or references; anything else does not compile. So creating, copying or destroying a Delegate never
+     * allocates nor runs any code, and a call costs one indirect jump.
+     *
+     * @tparam R The return type.
+     * @tparam Args The parameter types.
+     * @tparam Capacity The size of the buffer in bytes.
+     */
+    template<typename R, typename... Args, size_t Capacity>
+    class Delegate<R(Args...), Capacity>
+    {
+    public:
+
+        /**
+         * @brief Creates an empty delegate.
+         */
+        Delegate() = default;
+
+        /**
+         * @brief Creates a delegate calling a copy of a function.
+         * @param function The callable, invocable as const with Args.
+         */
+        template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate>>>
+        Delegate(F function)
+        {
+            static_assert(sizeof(F) <= Capacity, "The callable does not fit the delegate, capture less or raise its capacity");
+            static_assert(alignof(F) <= alignof(std::max_align_t), "The callable is over-aligned");
+            static_assert(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>, "The callable must be trivially copyable, capture pointers instead of objects");
+            static_assert(std::is_invocable_r_v<R, const F&, Args...>, "The callable does not match the signature of the delegate");
+
+            ::new (static_cast<void*>(m_storage)) F(function);
+            m_invoke = [](const void* storage, Args... args) -> R
+                {
+                    return (*std::launder(static_cast<const F*>(storage)))(std::forward<Args>(args)...);
+                };
+        }
+
+        /**
+         * @brief Calls the function.
+         * @warning The delegate must not be empty.
+         */
+        R operator()(Args... args) const
+        {
+            return m_invoke(m_storage, std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Checks whether the delegate holds a function.
+         */
+        explicit operator bool() const
+        {
+            return m_invoke != nullptr;
+        }
+
+    private:
+        alignas(std::max_align_t) unsigned char m_storage[Capacity] = {};
+        R(*m_invoke)(const void*, Args...) = nullptr;
+    };
+}
@@ -12,10 +12,10 @@ namespace tools
 {
     void ConsoleLogger::log(const std::string& message, LogLevel level)
     {
-        static std::mutex logMutex; // Mutex for thread safety
-        std::lock_guard<std::mutex> lock(logMutex); // Lock the mutex
-        if( level >= verbosityLevel )
+        if( level >= m_verbosity )
         {
+            static std::mutex logMutex; // Mutex for thread safety
+            std::lock_guard<std::mutex> lock(logMutex); // Lock the mutex
             std::string timestamp = getCurrentTime();
             switch( level )
             {
@@ -1,6 +1,23 @@
 #pragma once
 
+#include <concepts>
+#include <format>
 #include <string>
+#include <utility>
+
+/**
+ * @brief The lowest log level compiled in, as the index of a LogLevel.
+ *
+ * Calls of the level functions of Logger (verbose(), debug(), ...) below it compile to nothing, arguments aside.
+ * Release builds drop VERBOSE and DEBUG messages unless the project defines it.
+ */
+#ifndef TOOLS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define TOOLS_LOG_MIN_LEVEL 2
+#else
+#define TOOLS_LOG_MIN_LEVEL 0
+#endif
+#endif
 
 namespace tools
 {
@@ -16,12 +33,83 @@ namespace tools
         PROBLEM
     };
 
+    constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(TOOLS_LOG_MIN_LEVEL); ///< The lowest level compiled in.
+
     /**
      * @brief Abstract base class for a logger.
+     *
+     * Besides log(), which takes a finished message, it offers one function per level taking a format string
+     * checked at compile time and its arguments, or a callable returning the message. Both check the level first
+     * and only build the message when it is written, so a filtered-out call costs a comparison.
      */
     class Logger
     {
     public:
+        /**
+         * @brief Constructor to set the verbosity level.
+         *
+         * @param verbosity Messages below this level are not built nor logged by the level functions.
+         */
+        explicit Logger(LogLevel verbosity = LogLevel::VERBOSE) : m_verbosity(verbosity) {}
+
+        /**
+         * @brief Checks whether messages of a level are logged.
+         *
+         * @param level The log level.
+         * @return true if the level is compiled in and not below the verbosity of the logger.
+         */
+        bool isEnabled(LogLevel level) const
+        {
+            return level >= COMPILED_LOG_LEVEL && level >= m_verbosity;
+        }
+
+        /**
+         * @brief Logs a message built from a format string, e.g. verbose("Word {} added", id).
+         *
+         * The arguments are only formatted when the level is enabled; pass a callable instead when computing an
+         * argument costs as well.
+         */
+        template<typename... Args>
+        void verbose(std::format_string<Args...> format, Args&&... args) { write<LogLevel::VERBOSE>(format, std::forward<Args>(args)...); }
+
+        /**
+         * @brief Logs the message returned by a callable, which is only called when the level is enabled.
+         */
+        template<std::invocable F>
+        void verbose(F&& message) { writeLazy<LogLevel::VERBOSE>(std::forward<F>(message)); }
+
+        /** @brief Logs a message built from a format string, see verbose(). */
+        template<typename... Args>
+        void debug(std::format_string<Args...> format, Args&&... args) { write<LogLevel::DEBUG>(format, std::forward<Args>(args)...); }
+
+        /** @brief Logs the message returned by a callable, see verbose(). */
+        template<std::invocable F>
+        void debug(F&& message) { writeLazy<LogLevel::DEBUG>(std::forward<F>(message)); }
+
+        /** @brief Logs a message built from a format string, see verbose(). */
+        template<typename... Args>
+        void info(std::format_string<Args...> format, Args&&... args) { write<LogLevel::INFO>(format, std::forward<Args>(args)...); }
+
+        /** @brief Logs the message returned by a callable, see verbose(). */
+        template<std::invocable F>
+        void info(F&& message) { writeLazy<LogLevel::INFO>(std::forward<F>(message)); }
+
+        /** @brief Logs a message built from a format string, see verbose(). */
+        template<typename... Args>
+        void warning(std::format_string<Args...> format, Args&&... args) { write<LogLevel::WARNING>(format, std::forward<Args>(args)...); }
+
+        /** @brief Logs the message returned by a callable, see verbose(). */
+        template<std::invocable F>
+        void warning(F&& message) { writeLazy<LogLevel::WARNING>(std::forward<F>(message)); }
+
+        /** @brief Logs a message built from a format string, see verbose(). */
+        template<typename... Args>
+        void problem(std::format_string<Args...> format, Args&&... args) { write<LogLevel::PROBLEM>(format, std::forward<Args>(args)...); }
+
+        /** @brief Logs the message returned by a callable, see verbose(). */
+        template<std::invocable F>
+        void problem(F&& message) { writeLazy<LogLevel::PROBLEM>(std::forward<F>(message)); }
+
         /**
          * @brief Logs a message with a specific log level.
          *
@@ -34,6 +122,30 @@ namespace tools
          * @brief Virtual destructor.
          */
         virtual ~Logger() = default;
+
+    protected:
+        LogLevel m_verbosity; /**< Messages below this level are ignored */
+
+    private:
+        template<LogLevel Level, typename... Args>
+        void write(std::format_string<Args...> format, Args&&... args)
+        {
+            if constexpr( Level >= COMPILED_LOG_LEVEL )
+            {
+                if( Level >= m_verbosity )
+                    log(std::format(format, std::forward<Args>(args)...), Level);
+            }
+        }
+
+        template<LogLevel Level, typename F>
+        void writeLazy(F&& message)
+        {
+            if constexpr( Level >= COMPILED_LOG_LEVEL )
+            {
+                if( Level >= m_verbosity )
+                    log(std::string(std::forward<F>(message)()), Level);
+            }
+        }
     };
 
     /**
@@ -47,7 +159,7 @@ namespace tools
          *
          * @param verbosity The verbosity level of the logger.
          */
-        ConsoleLogger(LogLevel verbosity = LogLevel::DEBUG) : verbosityLevel(verbosity) {}
+        ConsoleLogger(LogLevel verbosity = LogLevel::DEBUG) : Logger(verbosity) {}
 
         /**
          * @brief Logs a message to the console with a specific log level.
@@ -58,8 +170,6 @@ namespace tools
         void log(const std::string& message, LogLevel level) override;
 
     private:
-        LogLevel verbosityLevel; /**< The verbosity level of the logger */
-
         /**
          * @brief Gets the current time formatted as a string.
          *
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tools
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    const uint8_t* MappedFile::data() const
+    {
+        return m_data;
+    }
+
+    size_t MappedFile::size() const
+    {
+        return m_size;
+    }
+
+#ifdef _WIN32
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring widePath(length > 0 ? length : 1, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+
+        HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if( file == INVALID_HANDLE_VALUE )
+            return false;
+        m_file = file;
+
+        LARGE_INTEGER size;
+        if( !GetFileSizeEx(file, &size) || size.QuadPart == 0 )
+        {
+            close();
+            return false;
+        }
+
+        m_mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if( !m_mapping )
+        {
+            close();
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if( !m_data )
+        {
+            close();
+            return false;
+        }
+
+        m_size = static_cast<size_t>(size.QuadPart);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if( m_data )
+            UnmapViewOfFile(m_data);
+        if( m_mapping )
+            CloseHandle(m_mapping);
+        if( m_file )
+            CloseHandle(m_file);
+
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+        m_file = nullptr;
+    }
+
+#else
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if( file < 0 )
+            return false;
+
+        struct stat status;
+        if( fstat(file, &status) != 0 || status.st_size <= 0 )
+        {
+            ::close(file);
+            return false;
+        }
+
+        // The mapping keeps its own reference to the file.
+        void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if( data == MAP_FAILED )
+            return false;
+
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = static_cast<size_t>(status.st_size);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if( m_data )
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+#endif
+}
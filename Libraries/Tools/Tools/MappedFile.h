@@ -0,0 +1,72 @@
+/**
+ * @file MappedFile.h
+ * @brief Defines the MappedFile class, a read-only memory mapping of a whole file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tools
+{
+    /**
+     * @class MappedFile
+     * @brief Maps a file into memory for reading, so its contents are paged in on first access.
+     *
+     * Opening costs the same for any file size; nothing is read until the bytes are touched.
+     * The mapping stays valid until close() or destruction. Empty files cannot be mapped.
+     */
+    class MappedFile
+    {
+    public:
+
+        MappedFile() = default;
+
+        /**
+         * @brief Unmaps the file.
+         */
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * @brief Maps a file, closing the previous one.
+         * @param path The file to map, UTF-8 encoded.
+         * @return True if the file was mapped.
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Unmaps the file.
+         */
+        void close();
+
+        /**
+         * @brief Checks whether a file is mapped.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Returns the first byte of the mapping, nullptr if no file is mapped.
+         */
+        const uint8_t* data() const;
+
+        /**
+         * @brief Returns the size of the mapped file in bytes.
+         */
+        size_t size() const;
+
+    private:
+
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+
+#ifdef _WIN32
+        void* m_file = nullptr;     ///< HANDLE of the file.
+        void* m_mapping = nullptr;  ///< HANDLE of the file mapping object.
+#endif
+    };
+}
@@ -0,0 +1,227 @@
+/**
+ * @file MpscQueue.h
+ * @brief Defines the MpscQueue class template, a bounded lock-free queue with many producers and one consumer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace tools
+{
+    /**
+     * @class MpscQueue
+     * @brief A bounded first-in first-out queue for handing items from any number of threads to one consumer.
+     *
+     * Each slot of a ring buffer carries a sequence number telling whether it is free for the producer of a given
+     * position or filled for the consumer, so producers only contend on one atomic index and never take a lock.
+     * Items of one producer are popped in the order they were pushed.
+     *
+     * Nothing is dropped: push() waits for free space when the queue is full. The consumer sleeps in waitPop()
+     * until an item is pushed or the queue is closed, instead of polling.
+     *
+     * @tparam T The item type, default constructible and movable.
+     */
+    template<typename T>
+    class MpscQueue
+    {
+    public:
+
+        /**
+         * @brief Creates an empty queue.
+         * @param capacity The number of items the queue holds, rounded up to a power of two.
+         */
+        explicit MpscQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while( size < capacity )
+                size *= 2;
+
+            m_mask = size - 1;
+            m_cells = std::make_unique<Cell[]>(size);
+            for( size_t i = 0; i < size; ++i )
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /**
+         * @brief Adds an item unless the queue is full. Safe to call from any thread.
+         * @param value The item, only moved from if it was added.
+         * @return False if the queue is full.
+         */
+        bool tryPush(T& value)
+        {
+            return tryEmplace([&value](T& slot) { slot = std::move(value); });
+        }
+
+        /**
+         * @brief Adds an item written in place unless the queue is full. Safe to call from any thread.
+         *
+         * Saves a copy of large items: the caller fills the slot directly.
+         *
+         * @param fill Called with the slot of the new item, only if there is room.
+         * @return False if the queue is full.
+         */
+        template<typename Fill>
+        bool tryEmplace(Fill&& fill)
+        {
+            size_t position = m_tail.load(std::memory_order_relaxed);
+            while( true )
+            {
+                Cell& cell = m_cells[position & m_mask];
+                const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if( difference == 0 )
+                {
+                    // The slot is free for this position, claim it.
+                    if( m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) )
+                    {
+                        fill(cell.value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        wake();
+                        return true;
+                    }
+                }
+                else if( difference < 0 )
+                {
+                    // The consumer has not freed the slot of the previous round yet.
+                    return false;
+                }
+                else
+                {
+                    // Another producer claimed the position first.
+                    position = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Adds an item, waiting for the consumer to make room if the queue is full. Safe to call from any thread.
+         * @param value The item.
+         */
+        void push(T value)
+        {
+            while( !tryPush(value) )
+                std::this_thread::yield();
+        }
+
+        /**
+         * @brief Takes the oldest item if there is one. Only the consumer thread may call it.
+         * @param value Receives the item.
+         * @return False if the queue is empty.
+         */
+        bool tryPop(T& value)
+        {
+            Cell& cell = m_cells[m_head & m_mask];
+            if( cell.sequence.load(std::memory_order_acquire) != m_head + 1 )
+                return false;
+
+            value = std::move(cell.value);
+            if constexpr( !std::is_trivially_copyable_v<T> )
+                cell.value = T(); // Releases what the moved-from item still holds.
+            cell.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+            ++m_head;
+            return true;
+        }
+
+        /**
+         * @brief Takes the oldest item, sleeping until one is pushed. Only the consumer thread may call it.
+         * @param value Receives the item.
+         * @return False once the queue is closed and empty.
+         */
+        bool waitPop(T& value)
+        {
+            while( true )
+            {
+                // Read the signal before checking, so a push in between changes it and the wait returns at once.
+                const uint32_t signal = m_signal.load(std::memory_order_acquire);
+                if( tryPop(value) )
+                    return true;
+                if( m_closed.load(std::memory_order_acquire) )
+                    return drainPop(value);
+
+                // Producers only notify a sleeping consumer. Either they see the flag, or the signal has changed here.
+                m_sleeping.store(true, std::memory_order_seq_cst);
+                if( m_signal.load(std::memory_order_seq_cst) == signal )
+                    m_signal.wait(signal, std::memory_order_acquire);
+                m_sleeping.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Wakes the consumer for good: waitPop() returns the remaining items and then false.
+         *
+         * The remaining items include those of pushes still running when close() is called.
+         */
+        void close()
+        {
+            m_closed.store(true, std::memory_order_release);
+            wake();
+        }
+
+        /**
+         * @brief Checks whether close() was called.
+         */
+        bool isClosed() const
+        {
+            return m_closed.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Returns the number of items the queue holds.
+         */
+        size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence{ 0 }; ///< position for a free slot, position + 1 for a filled one.
+            T value{};
+        };
+
+        /**
+         * @brief Takes the oldest item of a closed queue, waiting for the pushes that claimed a slot to fill it.
+         * @return False once every claimed slot was taken.
+         */
+        bool drainPop(T& value)
+        {
+            // A producer that has claimed a position but not published it yet must not read as an empty queue.
+            while( m_tail.load(std::memory_order_acquire) != m_head )
+            {
+                if( tryPop(value) )
+                    return true;
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        void wake()
+        {
+            m_signal.fetch_add(1, std::memory_order_seq_cst);
+            if( m_sleeping.load(std::memory_order_seq_cst) )
+                m_signal.notify_one();
+        }
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask = 0;
+
+        // Producers and the consumer write different cache lines.
+        alignas(64) std::atomic<size_t> m_tail{ 0 };
+        alignas(64) size_t m_head = 0;
+        alignas(64) std::atomic<uint32_t> m_signal{ 0 };
+        std::atomic<bool> m_sleeping{ false }; ///< True while the consumer waits in waitPop().
+        std::atomic<bool> m_closed{ false };
+    };
+}
@@ -0,0 +1,183 @@
+#include "ProcessExecutor.h"
+#include "ChildProcess.h"
+#include <algorithm>
+#include <iterator>
+
+namespace tools
+{
+    namespace
+    {
+        // Longest time the executor thread waits for output before it checks for cancellation again.
+        constexpr std::chrono::milliseconds POLL_INTERVAL(20);
+    }
+
+    void ProcessExecutor::Task::cancel()
+    {
+        m_cancelled = true;
+    }
+
+    bool ProcessExecutor::Task::isFinished() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_result.status != Status::Running;
+    }
+
+    ProcessExecutor::Result ProcessExecutor::Task::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished.wait(lock, [this] { return m_result.status != Status::Running; });
+        return m_result;
+    }
+
+    bool ProcessExecutor::Task::waitFor(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_finished.wait_for(lock, timeout, [this] { return m_result.status != Status::Running; });
+    }
+
+    ProcessExecutor::Result ProcessExecutor::Task::getResult() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_result;
+    }
+
+    void ProcessExecutor::Task::finish(Result result)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_result = std::move(result);
+        m_finished.notify_all();
+    }
+
+    ProcessExecutor::~ProcessExecutor()
+    {
+        cancelAll();
+
+        std::vector<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            jobs.swap(m_jobs);
+        }
+        for( auto& job : jobs )
+        {
+            if( job.thread.joinable() )
+                job.thread.join();
+        }
+    }
+
+    std::shared_ptr<ProcessExecutor::Task> ProcessExecutor::run(const std::vector<std::string>& arguments, std::chrono::milliseconds timeout,
+        CompletionCallback onComplete, const std::string& input)
+    {
+        joinFinished();
+
+        auto task = std::make_shared<Task>();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back({ task, std::thread(&ProcessExecutor::execute, task, arguments, timeout, std::move(onComplete), input) });
+        return task;
+    }
+
+    void ProcessExecutor::cancelAll()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for( auto& job : m_jobs )
+        {
+            job.task->cancel();
+        }
+    }
+
+    size_t ProcessExecutor::getRunningCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<size_t>(std::count_if(m_jobs.begin(), m_jobs.end(), [](const Job& job) { return !job.task->isFinished(); }));
+    }
+
+    void ProcessExecutor::joinFinished()
+    {
+        std::vector<Job> finished;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto running = std::stable_partition(m_jobs.begin(), m_jobs.end(), [](const Job& job) { return !job.task->isFinished(); });
+            std::move(running, m_jobs.end(), std::back_inserter(finished));
+            m_jobs.erase(running, m_jobs.end());
+        }
+
+        // A finished thread may still be running its callback, join outside the lock.
+        for( auto& job : finished )
+        {
+            if( job.thread.joinable() )
+                job.thread.join();
+        }
+    }
+
+    void ProcessExecutor::execute(const std::shared_ptr<Task>& task, std::vector<std::string> arguments, std::chrono::milliseconds timeout,
+        CompletionCallback onComplete, std::string input)
+    {
+        Result result;
+        ChildProcess process;
+
+        if( arguments.empty() || !process.start(arguments) )
+        {
+            result.status = Status::Failed;
+            result.error = "Cannot start " + (arguments.empty() ? std::string("an empty command") : arguments.front()) + ".";
+        }
+        else
+        {
+            if( !input.empty() )
+                process.write(input);
+            process.closeInput();
+
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            char buffer[4096];
+            while( true )
+            {
+                if( task->m_cancelled )
+                {
+                    process.terminate();
+                    result.status = Status::Cancelled;
+                    result.error = "The command was cancelled.";
+                    break;
+                }
+
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if( remaining.count() <= 0 )
+                {
+                    process.terminate();
+                    result.status = Status::TimedOut;
+                    result.error = "The command timed out.";
+                    break;
+                }
+
+                const int count = process.read(buffer, sizeof(buffer), std::min(remaining, POLL_INTERVAL));
+                if( count == ChildProcess::TIMED_OUT )
+                    continue;
+                if( count > 0 )
+                {
+                    result.output.append(buffer, static_cast<size_t>(count));
+                    continue;
+                }
+
+                // The output is closed, the program is about to exit (or hangs without output).
+                if( process.isRunning() )
+                {
+                    std::this_thread::sleep_for(std::min(remaining, std::chrono::milliseconds(5)));
+                    continue;
+                }
+
+                result.exitCode = process.wait();
+                if( result.exitCode == 0 )
+                {
+                    result.status = Status::Completed;
+                }
+                else
+                {
+                    result.status = Status::Failed;
+                    result.error = "Command failed with code " + std::to_string(result.exitCode);
+                }
+                break;
+            }
+        }
+
+        task->finish(result);
+        if( onComplete )
+            onComplete(result);
+    }
+}
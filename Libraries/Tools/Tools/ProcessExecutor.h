@@ -0,0 +1,150 @@
+/**
+ * @file ProcessExecutor.h
+ * @brief Defines the ProcessExecutor class, which runs programs in the background with hard timeouts and cancellation.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * @class ProcessExecutor
+     * @brief Runs short-lived programs (e.g. dictionary scripts) without blocking the caller.
+     *
+     * Every program runs on its own thread, which reads its output with timed reads (see
+     * ChildProcess::read) so it notices a timeout or a cancellation within a few milliseconds.
+     * A program that times out or is cancelled is killed together with everything it started.
+     */
+    class ProcessExecutor
+    {
+    public:
+
+        /**
+         * @brief How a program ended.
+         */
+        enum class Status
+        {
+            Running,    ///< Not finished yet.
+            Completed,  ///< Exited with code 0.
+            Failed,     ///< Could not be started or exited with a non-zero code.
+            TimedOut,   ///< Killed because it ran longer than its timeout.
+            Cancelled   ///< Killed because Task::cancel() was called.
+        };
+
+        /**
+         * @brief Outcome of a program.
+         */
+        struct Result
+        {
+            Status status = Status::Running;
+            int exitCode = -1;    ///< The exit code, -1 if the program was killed or not started.
+            std::string output;   ///< Everything the program wrote to stdout.
+            std::string error;    ///< Why the program failed, empty on success.
+        };
+
+        using CompletionCallback = std::function<void(const Result&)>;
+
+        /**
+         * @class Task
+         * @brief Handle of a running program, shared between the caller and the executor.
+         */
+        class Task
+        {
+        public:
+
+            /**
+             * @brief Kills the program. The result status becomes Cancelled unless it finished already.
+             */
+            void cancel();
+
+            /**
+             * @brief Checks whether the program has finished.
+             */
+            bool isFinished() const;
+
+            /**
+             * @brief Waits for the program to finish.
+             * @return The result.
+             */
+            Result wait();
+
+            /**
+             * @brief Waits for the program to finish, at most the given time.
+             * @return True if it finished.
+             */
+            bool waitFor(std::chrono::milliseconds timeout);
+
+            /**
+             * @brief Returns the result, with Status::Running while the program runs.
+             */
+            Result getResult() const;
+
+        private:
+
+            friend class ProcessExecutor;
+
+            void finish(Result result);
+
+            std::atomic<bool> m_cancelled{ false };
+            mutable std::mutex m_mutex;
+            std::condition_variable m_finished;
+            Result m_result;
+        };
+
+        ProcessExecutor() = default;
+
+        /**
+         * @brief Cancels all programs and waits for their threads.
+         */
+        ~ProcessExecutor();
+
+        ProcessExecutor(const ProcessExecutor&) = delete;
+        ProcessExecutor& operator=(const ProcessExecutor&) = delete;
+
+        /**
+         * @brief Starts a program in the background.
+         * @param arguments The program (looked up in PATH) followed by its arguments, passed without a shell.
+         * @param timeout The program is killed when it runs longer.
+         * @param onComplete Optional callback, invoked on the executor thread once the result is available.
+         * @param input Bytes written to the program's stdin before it is closed.
+         * @return The handle of the program.
+         */
+        std::shared_ptr<Task> run(const std::vector<std::string>& arguments, std::chrono::milliseconds timeout,
+            CompletionCallback onComplete = nullptr, const std::string& input = "");
+
+        /**
+         * @brief Cancels all running programs.
+         */
+        void cancelAll();
+
+        /**
+         * @brief Returns the number of programs that have not finished yet.
+         */
+        size_t getRunningCount() const;
+
+    private:
+
+        struct Job
+        {
+            std::shared_ptr<Task> task;
+            std::thread thread;
+        };
+
+        static void execute(const std::shared_ptr<Task>& task, std::vector<std::string> arguments, std::chrono::milliseconds timeout,
+            CompletionCallback onComplete, std::string input);
+        void joinFinished();
+
+        mutable std::mutex m_mutex;
+        std::vector<Job> m_jobs;
+    };
+}
@@ -0,0 +1,208 @@
+#include "RotatingFileSink.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace tools
+{
+    RotatingFileSink::RotatingFileSink(const std::filesystem::path& path) : RotatingFileSink(path, Options())
+    {
+    }
+
+    RotatingFileSink::RotatingFileSink(const std::filesystem::path& path, const Options& options)
+        : m_path(path), m_options(options)
+    {
+        m_options.fileSize = std::max<size_t>(m_options.fileSize, 4096);
+
+        std::error_code error;
+        if( !m_path.parent_path().empty() )
+            std::filesystem::create_directories(m_path.parent_path(), error);
+        if( std::filesystem::exists(m_path, error) )
+            shiftFiles();
+        openFile();
+    }
+
+    RotatingFileSink::~RotatingFileSink()
+    {
+        closeFile();
+    }
+
+    bool RotatingFileSink::isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    size_t RotatingFileSink::writtenBytes() const
+    {
+        return static_cast<size_t>(pptr() - pbase());
+    }
+
+    std::filesystem::path RotatingFileSink::filePath(size_t index) const
+    {
+        if( index == 0 )
+            return m_path;
+
+        std::filesystem::path path = m_path;
+        path.replace_filename(m_path.stem().string() + "." + std::to_string(index) + m_path.extension().string());
+        return path;
+    }
+
+    void RotatingFileSink::rotate()
+    {
+        closeFile();
+        shiftFiles();
+        openFile();
+    }
+
+    std::streamsize RotatingFileSink::xsputn(const char* data, std::streamsize size)
+    {
+        if( m_data == nullptr )
+            return 0;
+
+        const bool expired = m_options.maxAge.count() > 0 && std::chrono::steady_clock::now() - m_openedAt >= m_options.maxAge;
+        if( expired || (pptr() != pbase() && size > epptr() - pptr()) )
+            rotate();
+
+        std::streamsize written = 0;
+        while( written < size && m_data != nullptr )
+        {
+            if( pptr() == epptr() )
+            {
+                rotate();
+                continue;
+            }
+
+            const std::streamsize count = std::min<std::streamsize>({ size - written, epptr() - pptr(), INT_MAX });
+            std::memcpy(pptr(), data + written, static_cast<size_t>(count));
+            pbump(static_cast<int>(count));
+            written += count;
+        }
+        return written;
+    }
+
+    int RotatingFileSink::overflow(int character)
+    {
+        if( character == traits_type::eof() )
+            return traits_type::not_eof(character);
+
+        const char value = traits_type::to_char_type(character);
+        return xsputn(&value, 1) == 1 ? character : traits_type::eof();
+    }
+
+    void RotatingFileSink::shiftFiles()
+    {
+        std::error_code error;
+        if( m_options.keptFiles == 0 )
+        {
+            std::filesystem::remove(m_path, error);
+            return;
+        }
+
+        std::filesystem::remove(filePath(m_options.keptFiles), error);
+        for( size_t index = m_options.keptFiles; index > 0; --index )
+            std::filesystem::rename(filePath(index - 1), filePath(index), error);
+    }
+
+#ifdef _WIN32
+
+    bool RotatingFileSink::openFile()
+    {
+        HANDLE file = CreateFileW(m_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if( file == INVALID_HANDLE_VALUE )
+            return false;
+        m_file = file;
+
+        // Creating the mapping grows the file to its full size.
+        const unsigned long long size = m_options.fileSize;
+        m_mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), NULL);
+        if( m_mapping )
+            m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, m_options.fileSize));
+        if( !m_data )
+        {
+            closeFile();
+            return false;
+        }
+
+        setp(m_data, m_data + m_options.fileSize);
+        m_openedAt = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void RotatingFileSink::closeFile()
+    {
+        const size_t written = writtenBytes();
+        if( m_data )
+            UnmapViewOfFile(m_data);
+        if( m_mapping )
+            CloseHandle(m_mapping);
+        if( m_file )
+        {
+            // The file was preallocated, drop the bytes never written.
+            LARGE_INTEGER end;
+            end.QuadPart = static_cast<LONGLONG>(written);
+            if( SetFilePointerEx(m_file, end, NULL, FILE_BEGIN) )
+                SetEndOfFile(m_file);
+            CloseHandle(m_file);
+        }
+
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+        setp(nullptr, nullptr);
+    }
+
+#else
+
+    bool RotatingFileSink::openFile()
+    {
+        m_file = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if( m_file < 0 )
+            return false;
+
+        void* data = MAP_FAILED;
+        if( ftruncate(m_file, static_cast<off_t>(m_options.fileSize)) == 0 )
+            data = mmap(nullptr, m_options.fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+        if( data == MAP_FAILED )
+        {
+            closeFile();
+            return false;
+        }
+
+        m_data = static_cast<char*>(data);
+        setp(m_data, m_data + m_options.fileSize);
+        m_openedAt = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void RotatingFileSink::closeFile()
+    {
+        const size_t written = writtenBytes();
+        if( m_data )
+            munmap(m_data, m_options.fileSize);
+        if( m_file >= 0 )
+        {
+            // The file was preallocated, drop the bytes never written.
+            if( ftruncate(m_file, static_cast<off_t>(written)) != 0 )
+            {
+                // Nothing to do about it, the rest of the file stays zeroed.
+            }
+            ::close(m_file);
+        }
+
+        m_data = nullptr;
+        m_file = -1;
+        setp(nullptr, nullptr);
+    }
+
+#endif
+}
@@ -0,0 +1,103 @@
+/**
+ * @file RotatingFileSink.h
+ * @brief Defines the RotatingFileSink class, a stream buffer writing log files through memory mappings.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <streambuf>
+
+namespace tools
+{
+    /**
+     * @class RotatingFileSink
+     * @brief Writes a log into preallocated, memory-mapped files and rotates them by size and age.
+     *
+     * Each file is created at its full size and mapped, so writing is a copy into memory; the system writes the
+     * pages back on its own, even when the process crashes. A file is rotated when the next write does not fit
+     * or when it is older than the maximum age: it is cut to the written bytes and renamed to "name.1.ext", older
+     * files move one number up and the oldest beyond the kept count is removed. A write never spans two files
+     * unless it is larger than a whole file, so the lines of a batch stay together.
+     *
+     * Use it through a std::ostream, e.g. as the output of an AsyncLogger, whose writer thread serializes the
+     * writes. The sink itself is not thread-safe.
+     */
+    class RotatingFileSink : public std::streambuf
+    {
+    public:
+        /**
+         * @brief Settings of the sink.
+         */
+        struct Options
+        {
+            size_t fileSize = 4 * 1024 * 1024;          ///< The bytes preallocated per file.
+            std::chrono::seconds maxAge{ 24 * 3600 };   ///< Files older than this are rotated, zero disables it.
+            size_t keptFiles = 5;                       ///< The rotated files kept besides the current one.
+        };
+
+        /**
+         * @brief Opens the log with default options.
+         * @param path The current log file; a file left there by a previous run is rotated first.
+         */
+        explicit RotatingFileSink(const std::filesystem::path& path);
+
+        /**
+         * @brief Opens the log.
+         * @param path The current log file; a file left there by a previous run is rotated first.
+         * @param options The settings of the sink.
+         */
+        RotatingFileSink(const std::filesystem::path& path, const Options& options);
+
+        /**
+         * @brief Cuts the current file to the written bytes and closes it.
+         */
+        ~RotatingFileSink() override;
+
+        RotatingFileSink(const RotatingFileSink&) = delete;
+        RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+        /**
+         * @brief Checks whether a file is open; writes fail when none could be created.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Returns the bytes written into the current file.
+         */
+        size_t writtenBytes() const;
+
+        /**
+         * @brief Returns the path of a file of the log, 0 being the current one and 1 the last rotated one.
+         */
+        std::filesystem::path filePath(size_t index) const;
+
+        /**
+         * @brief Closes the current file and starts a new one.
+         */
+        void rotate();
+
+    protected:
+        std::streamsize xsputn(const char* data, std::streamsize size) override;
+        int overflow(int character) override;
+
+    private:
+        bool openFile();
+        void closeFile();
+        void shiftFiles();
+
+        std::filesystem::path m_path;
+        Options m_options;
+        char* m_data = nullptr;
+        std::chrono::steady_clock::time_point m_openedAt;
+
+#ifdef _WIN32
+        void* m_file = nullptr;     ///< HANDLE of the file.
+        void* m_mapping = nullptr;  ///< HANDLE of the file mapping object.
+#else
+        int m_file = -1;
+#endif
+    };
+}
@@ -0,0 +1,198 @@
+#include "Tracer.h"
+#include <format>
+#include <fstream>
+#include <iterator>
+
+namespace tools
+{
+    namespace
+    {
+        void appendEscaped(std::string& json, const char* text)
+        {
+            for( ; *text != '\0'; ++text )
+            {
+                const char character = *text;
+                if( character == '"' || character == '\\' )
+                {
+                    json.push_back('\\');
+                    json.push_back(character);
+                }
+                else if( static_cast<unsigned char>(character) < 0x20 )
+                {
+                    std::format_to(std::back_inserter(json), "\\u{:04x}", static_cast<int>(character));
+                }
+                else
+                {
+                    json.push_back(character);
+                }
+            }
+        }
+
+        // Chrome traces count in microseconds, the fraction keeps the nanoseconds.
+        void appendMicroseconds(std::string& json, int64_t nanoseconds)
+        {
+            std::format_to(std::back_inserter(json), "{}.{:03}", nanoseconds / 1000, nanoseconds % 1000);
+        }
+    }
+
+    Tracer& Tracer::instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void Tracer::start()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            removeExitedThreads(false);
+            for( const std::shared_ptr<ThreadBuffer>& buffer : m_threads )
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                buffer->events.clear();
+                buffer->dropped = 0;
+            }
+        }
+        s_enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void Tracer::stop()
+    {
+        s_enabled.store(false, std::memory_order_relaxed);
+    }
+
+    void Tracer::setThreadName(const std::string& name)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.name = name;
+    }
+
+    size_t Tracer::eventCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        size_t count = 0;
+        for( const std::shared_ptr<ThreadBuffer>& buffer : m_threads )
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            count += buffer->events.size();
+        }
+        return count;
+    }
+
+    size_t Tracer::droppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        size_t count = 0;
+        for( const std::shared_ptr<ThreadBuffer>& buffer : m_threads )
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            count += buffer->dropped;
+        }
+        return count;
+    }
+
+    std::string Tracer::toJson() const
+    {
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto separate = [&json, &first]()
+            {
+                json += first ? "\n" : ",\n";
+                first = false;
+            };
+
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        for( const std::shared_ptr<ThreadBuffer>& buffer : m_threads )
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            if( !buffer->name.empty() )
+            {
+                separate();
+                std::format_to(std::back_inserter(json), "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"", buffer->id);
+                appendEscaped(json, buffer->name.c_str());
+                json += "\"}}";
+            }
+
+            for( const Event& event : buffer->events )
+            {
+                separate();
+                json += "{\"name\":\"";
+                appendEscaped(json, event.name);
+                json += "\",\"cat\":\"";
+                appendEscaped(json, event.category);
+                std::format_to(std::back_inserter(json), "\",\"ph\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":", event.phase, buffer->id);
+                appendMicroseconds(json, event.start);
+                if( event.phase == 'X' )
+                {
+                    json += ",\"dur\":";
+                    appendMicroseconds(json, event.value);
+                    json += "}";
+                }
+                else
+                {
+                    std::format_to(std::back_inserter(json), ",\"args\":{{\"value\":{}}}}}", event.value);
+                }
+            }
+        }
+        json += "\n]}\n";
+        return json;
+    }
+
+    bool Tracer::writeJson(const std::filesystem::path& path) const
+    {
+        const std::string json = toJson();
+        std::ofstream file(path, std::ios::binary);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        return static_cast<bool>(file);
+    }
+
+    void Tracer::record(const char* name, const char* category, char phase, int64_t start, int64_t value)
+    {
+        ThreadBuffer& buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if( buffer.events.size() < MAX_EVENTS_PER_THREAD )
+            buffer.events.push_back(Event{ name, category, start, value, phase });
+        else
+            ++buffer.dropped;
+    }
+
+    Tracer::ThreadBuffer& Tracer::threadBuffer()
+    {
+        // The tracer keeps a reference too, so the events outlive the thread; the registration marks the end of the thread.
+        struct Registration
+        {
+            std::shared_ptr<ThreadBuffer> buffer;
+
+            ~Registration()
+            {
+                if( buffer )
+                {
+                    std::lock_guard<std::mutex> lock(buffer->mutex);
+                    buffer->exited = true;
+                }
+            }
+        };
+        thread_local Registration registration;
+
+        if( !registration.buffer )
+        {
+            registration.buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(m_threadsMutex);
+            // Short-lived threads register all the time, the ones without events are not needed any more.
+            removeExitedThreads(true);
+            registration.buffer->id = m_nextThreadId++;
+            m_threads.push_back(registration.buffer);
+        }
+        return *registration.buffer;
+    }
+
+    void Tracer::removeExitedThreads(bool keepEvents)
+    {
+        std::erase_if(m_threads, [keepEvents](const std::shared_ptr<ThreadBuffer>& buffer)
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                return buffer->exited && !(keepEvents && !buffer->events.empty());
+            });
+    }
+}
@@ -0,0 +1,199 @@
+/**
+ * @file Tracer.h
+ * @brief Defines the Tracer class and the TraceScope timer, which record where time goes into a Chrome trace.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * @class Tracer
+     * @brief Records timed scopes and counters of every thread and exports them as Chrome trace JSON.
+     *
+     * Tracing is off until start() is called. While it is off, a TraceScope or a counter costs one relaxed atomic
+     * load. While it is on, each thread appends to its own buffer, so threads never wait for each other; the
+     * buffers survive their threads until the next start(), which drops the buffers of exited threads. The JSON
+     * opens in chrome://tracing and ui.perfetto.dev.
+     *
+     * Names and categories are not copied, they must be string literals or live as long as the trace.
+     */
+    class Tracer
+    {
+    public:
+        static constexpr size_t MAX_EVENTS_PER_THREAD = 1 << 20; ///< Later events of a thread are dropped.
+
+        /**
+         * @brief Returns the tracer of the process.
+         */
+        static Tracer& instance();
+
+        /**
+         * @brief Checks whether events are recorded; cheap enough for any hot path.
+         */
+        static bool isEnabled()
+        {
+            return s_enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records the value of a counter, shown as a graph in the trace.
+         *
+         * @param name The name of the counter.
+         * @param value The current value.
+         */
+        static void count(const char* name, int64_t value)
+        {
+            if( isEnabled() )
+                instance().record(name, "counter", 'C', instance().now(), value);
+        }
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        /**
+         * @brief Drops the recorded events and starts recording.
+         */
+        void start();
+
+        /**
+         * @brief Stops recording, the events are kept for export.
+         */
+        void stop();
+
+        /**
+         * @brief Names the calling thread in the trace.
+         * @param name The name of the thread.
+         */
+        void setThreadName(const std::string& name);
+
+        /**
+         * @brief Returns the number of events recorded since start().
+         */
+        size_t eventCount() const;
+
+        /**
+         * @brief Returns the number of events dropped since start() because a thread buffer was full.
+         */
+        size_t droppedCount() const;
+
+        /**
+         * @brief Returns the recorded events as Chrome trace JSON.
+         */
+        std::string toJson() const;
+
+        /**
+         * @brief Writes the recorded events as Chrome trace JSON.
+         * @param path The file to write.
+         * @return True if the file was written.
+         */
+        bool writeJson(const std::filesystem::path& path) const;
+
+        /**
+         * @brief Returns the nanoseconds since the tracer was created.
+         */
+        int64_t now() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        /**
+         * @brief Appends an event to the buffer of the calling thread.
+         *
+         * @param name The name of the event.
+         * @param category The category of the event.
+         * @param phase 'X' for a scope, 'C' for a counter.
+         * @param start The time of the event, from now().
+         * @param value The duration of a scope in nanoseconds or the value of a counter.
+         */
+        void record(const char* name, const char* category, char phase, int64_t start, int64_t value);
+
+    private:
+        struct Event
+        {
+            const char* name;
+            const char* category;
+            int64_t start;
+            int64_t value;
+            char phase;
+        };
+
+        struct ThreadBuffer
+        {
+            std::mutex mutex; ///< Only contended while the events are exported or cleared.
+            std::vector<Event> events;
+            size_t dropped = 0;
+            uint32_t id = 0;
+            std::string name;
+            bool exited = false; ///< Set when the thread ends; the buffer is kept only for its events.
+        };
+
+        Tracer() = default;
+
+        ThreadBuffer& threadBuffer();
+
+        /**
+         * @brief Forgets the buffers of exited threads; m_threadsMutex must be locked.
+         * @param keepEvents Whether buffers with events are kept for the next export.
+         */
+        void removeExitedThreads(bool keepEvents);
+
+        inline static std::atomic<bool> s_enabled{ false };
+
+        const std::chrono::steady_clock::time_point m_epoch = std::chrono::steady_clock::now();
+        mutable std::mutex m_threadsMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_threads;
+        uint32_t m_nextThreadId = 1;
+    };
+
+    /**
+     * @class TraceScope
+     * @brief Records the time from its construction to its destruction while tracing is on.
+     */
+    class TraceScope
+    {
+    public:
+        /**
+         * @brief Starts timing a scope.
+         *
+         * @param name The name of the scope, a string literal.
+         * @param category The category of the scope, a string literal.
+         */
+        explicit TraceScope(const char* name, const char* category = "app")
+        {
+            if( Tracer::isEnabled() )
+            {
+                m_name = name;
+                m_category = category;
+                m_start = Tracer::instance().now();
+            }
+        }
+
+        ~TraceScope()
+        {
+            if( m_name != nullptr )
+            {
+                Tracer& tracer = Tracer::instance();
+                tracer.record(m_name, m_category, 'X', m_start, tracer.now() - m_start);
+            }
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* m_name = nullptr; ///< Null when tracing was off at the start.
+        const char* m_category = nullptr;
+        int64_t m_start = 0;
+    };
+}
@@ -0,0 +1,299 @@
+/**
+ * @file TypedEventDispatcher.h
+ * @brief Defines the TypedEventDispatcher class template, which calls handlers registered per entity and event.
+ */
+
+#pragma once
+
+#include "Delegate.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * @class TypedEventDispatcher
+     * @brief Calls the handlers of an event of an entity with the payload of the event.
+     *
+     * Handlers live in a table with one row per (entity, event) pair, so an event goes straight to its own
+     * handlers. They are Delegate objects, so dispatching neither allocates nor copies the payload: each handler
+     * gets a reference to it. A handler may ask for a payload type P derived from Payload; it is then only called
+     * when the payload carries P::PACKAGE_ID, which replaces a dynamic_cast.
+     *
+     * Every subscription returns a Subscription that removes the handler when it is destroyed; the dispatcher
+     * and its subscriptions may be destroyed in any order. Handlers may subscribe or unsubscribe while an event
+     * is dispatched; a handler added then is called from the next event on. The dispatcher is not thread-safe.
+     *
+     * @tparam Entity The type of the entities, convertible to an index below EntityCount.
+     * @tparam Event The type of the events, convertible to an index below EventCount.
+     * @tparam Payload The base type of the payloads, providing isId() and NO_TYPE.
+     * @tparam EntityCount The number of entities.
+     * @tparam EventCount The number of events per entity.
+     */
+    template<typename Entity, typename Event, typename Payload, size_t EntityCount, size_t EventCount>
+    class TypedEventDispatcher
+    {
+    public:
+        using Handler = Delegate<void(const Payload*)>; ///< A handler as stored, taking the payload or nullptr.
+
+        /**
+         * @class Subscription
+         * @brief Keeps a handler registered for as long as it lives.
+         */
+        class Subscription
+        {
+        public:
+            Subscription() = default;
+
+            Subscription(Subscription&& other) noexcept
+                : m_dispatcher(std::exchange(other.m_dispatcher, nullptr)), m_row(other.m_row), m_token(other.m_token)
+            {
+                if( m_dispatcher != nullptr )
+                    m_dispatcher->attach(m_row, m_token, this);
+            }
+
+            Subscription& operator=(Subscription&& other) noexcept
+            {
+                if( this != &other )
+                {
+                    reset();
+                    m_dispatcher = std::exchange(other.m_dispatcher, nullptr);
+                    m_row = other.m_row;
+                    m_token = other.m_token;
+                    if( m_dispatcher != nullptr )
+                        m_dispatcher->attach(m_row, m_token, this);
+                }
+                return *this;
+            }
+
+            Subscription(const Subscription&) = delete;
+            Subscription& operator=(const Subscription&) = delete;
+
+            ~Subscription()
+            {
+                reset();
+            }
+
+            /**
+             * @brief Removes the handler now.
+             */
+            void reset()
+            {
+                if( m_dispatcher != nullptr )
+                {
+                    m_dispatcher->unsubscribe(m_row, m_token);
+                    m_dispatcher = nullptr;
+                }
+            }
+
+            /**
+             * @brief Checks whether the handler is still registered.
+             */
+            bool isActive() const
+            {
+                return m_dispatcher != nullptr;
+            }
+
+        private:
+            friend class TypedEventDispatcher;
+
+            Subscription(TypedEventDispatcher* dispatcher, size_t row, uint32_t token)
+                : m_dispatcher(dispatcher), m_row(row), m_token(token)
+            {
+                m_dispatcher->attach(m_row, m_token, this);
+            }
+
+            TypedEventDispatcher* m_dispatcher = nullptr;
+            size_t m_row = 0;
+            uint32_t m_token = 0;
+        };
+
+        TypedEventDispatcher() = default;
+        TypedEventDispatcher(const TypedEventDispatcher&) = delete;
+        TypedEventDispatcher& operator=(const TypedEventDispatcher&) = delete;
+
+        /**
+         * @brief Detaches the remaining subscriptions, so they may outlive the dispatcher.
+         */
+        ~TypedEventDispatcher()
+        {
+            for( std::vector<Entry>& handlers : m_table )
+            {
+                for( Entry& entry : handlers )
+                {
+                    if( entry.owner != nullptr )
+                        entry.owner->m_dispatcher = nullptr;
+                }
+            }
+        }
+
+        /**
+         * @brief Registers a handler of an event with a payload of type P.
+         *
+         * @tparam P The payload type, derived from Payload and defining a PACKAGE_ID other than Payload::NO_TYPE.
+         * @param entity The entity emitting the event.
+         * @param event The event.
+         * @param handler The handler, called with a const P&; it must fit a Delegate.
+         * @return The subscription, the handler is removed when it is destroyed.
+         * @throws std::out_of_range if the entity or the event is outside the table.
+         */
+        template<typename P, typename F>
+        [[nodiscard]] Subscription subscribe(Entity entity, Event event, F handler)
+        {
+            // Packages built with the default identifier carry NO_TYPE, they must not pass for a P.
+            static_assert(P::PACKAGE_ID != Payload::NO_TYPE, "The payload type needs an identifier of its own");
+            return add(entity, event, Handler([handler](const Payload* payload)
+                {
+                    if( payload != nullptr && payload->isId(P::PACKAGE_ID) )
+                        handler(static_cast<const P&>(*payload));
+                }));
+        }
+
+        /**
+         * @brief Registers a handler of an event, called without its payload.
+         *
+         * @param entity The entity emitting the event.
+         * @param event The event.
+         * @param handler The handler, called without arguments; it must fit a Delegate.
+         * @return The subscription, the handler is removed when it is destroyed.
+         * @throws std::out_of_range if the entity or the event is outside the table.
+         */
+        template<typename F>
+        [[nodiscard]] Subscription subscribe(Entity entity, Event event, F handler)
+        {
+            return add(entity, event, Handler([handler](const Payload*)
+                {
+                    handler();
+                }));
+        }
+
+        /**
+         * @brief Calls the handlers of an event.
+         *
+         * @param entity The entity emitting the event.
+         * @param event The event.
+         * @param payload The payload of the event, may be nullptr.
+         * @return The number of handlers registered for the event, zero for an event outside the table.
+         */
+        size_t emit(Entity entity, Event event, const Payload* payload)
+        {
+            const size_t entityIndex = static_cast<size_t>(entity);
+            const size_t eventIndex = static_cast<size_t>(event);
+            if( entityIndex >= EntityCount || eventIndex >= EventCount )
+                return 0;
+
+            std::vector<Entry>& handlers = m_table[entityIndex * EventCount + eventIndex];
+            const size_t count = handlers.size();
+
+            // Removals during the dispatch only clear their entry; the row is compacted once it is over.
+            DispatchGuard guard(*this);
+            size_t called = 0;
+            for( size_t i = 0; i < count; ++i )
+            {
+                // A copy, the row may grow and move while the handler runs.
+                const Handler handler = handlers[i].handler;
+                if( handler )
+                {
+                    handler(payload);
+                    ++called;
+                }
+            }
+            return called;
+        }
+
+        /**
+         * @brief Returns the number of handlers registered for an event.
+         */
+        size_t listenerCount(Entity entity, Event event) const
+        {
+            const size_t entityIndex = static_cast<size_t>(entity);
+            const size_t eventIndex = static_cast<size_t>(event);
+            if( entityIndex >= EntityCount || eventIndex >= EventCount )
+                return 0;
+
+            const std::vector<Entry>& handlers = m_table[entityIndex * EventCount + eventIndex];
+            return std::count_if(handlers.begin(), handlers.end(), [](const Entry& entry) { return static_cast<bool>(entry.handler); });
+        }
+
+    private:
+        struct Entry
+        {
+            Handler handler;
+            uint32_t token = 0;
+            Subscription* owner = nullptr; ///< The subscription keeping the handler, told when the dispatcher goes away.
+        };
+
+        struct DispatchGuard
+        {
+            explicit DispatchGuard(TypedEventDispatcher& dispatcher) : m_dispatcher(dispatcher)
+            {
+                ++m_dispatcher.m_dispatching;
+            }
+
+            ~DispatchGuard()
+            {
+                if( --m_dispatcher.m_dispatching == 0 && m_dispatcher.m_removedDuringDispatch )
+                    m_dispatcher.compact();
+            }
+
+            TypedEventDispatcher& m_dispatcher;
+        };
+
+        Subscription add(Entity entity, Event event, Handler handler)
+        {
+            const size_t entityIndex = static_cast<size_t>(entity);
+            const size_t eventIndex = static_cast<size_t>(event);
+            if( entityIndex >= EntityCount || eventIndex >= EventCount )
+                throw std::out_of_range("TypedEventDispatcher: The entity or the event is outside the table.");
+
+            const size_t row = entityIndex * EventCount + eventIndex;
+            const uint32_t token = ++m_lastToken;
+            m_table[row].push_back(Entry{ handler, token, nullptr });
+            return Subscription(this, row, token);
+        }
+
+        void attach(size_t row, uint32_t token, Subscription* owner)
+        {
+            std::vector<Entry>& handlers = m_table[row];
+            auto it = std::find_if(handlers.begin(), handlers.end(), [token](const Entry& entry) { return entry.token == token; });
+            if( it != handlers.end() )
+                it->owner = owner;
+        }
+
+        void unsubscribe(size_t row, uint32_t token)
+        {
+            std::vector<Entry>& handlers = m_table[row];
+            auto it = std::find_if(handlers.begin(), handlers.end(), [token](const Entry& entry) { return entry.token == token; });
+            if( it == handlers.end() )
+                return;
+
+            if( m_dispatching > 0 )
+            {
+                it->handler = Handler();
+                it->owner = nullptr;
+                m_removedDuringDispatch = true;
+            }
+            else
+            {
+                handlers.erase(it);
+            }
+        }
+
+        void compact()
+        {
+            for( std::vector<Entry>& handlers : m_table )
+                std::erase_if(handlers, [](const Entry& entry) { return !entry.handler; });
+            m_removedDuringDispatch = false;
+        }
+
+        std::array<std::vector<Entry>, EntityCount * EventCount> m_table; ///< The handlers, row entity * EventCount + event.
+        uint32_t m_lastToken = 0;
+        int m_dispatching = 0; ///< The depth of nested emit() calls.
+        bool m_removedDuringDispatch = false;
+    };
+}
@@ -0,0 +1,639 @@
+#include "XmlPullParser.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace tools
+{
+    namespace
+    {
+        bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        bool isBlank(const std::string& text)
+        {
+            for( char c : text )
+            {
+                if( !isSpace(c) )
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    XmlPullParser::XmlPullParser(std::istream& input, size_t chunkSize)
+        : m_input(input), m_chunkSize(chunkSize > 0 ? chunkSize : DEFAULT_CHUNK_SIZE)
+    {
+    }
+
+    XmlPullParser::Event XmlPullParser::next()
+    {
+        if( m_finished )
+            return m_event;
+
+        if( m_pendingEnd )
+        {
+            // The end of a self-closing tag, the name is still the one of the start tag.
+            m_pendingEnd = false;
+            m_openElements.pop_back();
+            m_attributes.clear();
+            m_event = Event::EndElement;
+            return m_event;
+        }
+
+        m_attributes.clear();
+        m_text.clear();
+
+        while( true )
+        {
+            if( !ensure(1) )
+            {
+                if( !m_openElements.empty() )
+                    return fail("Unexpected end of document inside <" + m_openElements.back() + ">.");
+                if( !m_seenRoot )
+                    return fail("The document has no root element.");
+                m_finished = true;
+                m_event = Event::EndDocument;
+                return m_event;
+            }
+
+            if( m_buffer[m_position] == '<' )
+            {
+                ++m_position;
+                if( parseMarkup() )
+                    return m_event;
+                continue;
+            }
+
+            std::string raw;
+            if( !readUntil("<", raw) )
+            {
+                // Trailing text at the end of the input.
+                raw = m_buffer.substr(m_position);
+                m_position = m_buffer.size();
+            }
+            else
+            {
+                --m_position; // Leave the '<' for the next round.
+            }
+
+            if( m_openElements.empty() )
+            {
+                if( !isBlank(raw) )
+                    return fail("Text outside of the root element.");
+                continue;
+            }
+
+            m_text = decode(raw);
+            m_event = Event::Text;
+            return m_event;
+        }
+    }
+
+    const std::string& XmlPullParser::getName() const
+    {
+        return m_name;
+    }
+
+    const std::string& XmlPullParser::getText() const
+    {
+        return m_text;
+    }
+
+    const std::string* XmlPullParser::findAttribute(const std::string& name) const
+    {
+        for( const auto& attribute : m_attributes )
+        {
+            if( attribute.first == name )
+                return &attribute.second;
+        }
+        return nullptr;
+    }
+
+    std::string XmlPullParser::getAttribute(const std::string& name, const std::string& fallback) const
+    {
+        const std::string* value = findAttribute(name);
+        return value ? *value : fallback;
+    }
+
+    int XmlPullParser::getDepth() const
+    {
+        return static_cast<int>(m_openElements.size());
+    }
+
+    uint64_t XmlPullParser::getBytesRead() const
+    {
+        return m_bytesDiscarded + m_position;
+    }
+
+    const std::string& XmlPullParser::getError() const
+    {
+        return m_error;
+    }
+
+    std::string XmlPullParser::readElementText()
+    {
+        if( m_event != Event::StartElement )
+            return "";
+
+        const int depth = getDepth();
+        std::string text;
+        while( true )
+        {
+            switch( next() )
+            {
+                case Event::Text:
+                    text += m_text;
+                    break;
+                case Event::EndElement:
+                    if( getDepth() < depth )
+                        return text;
+                    break;
+                case Event::StartElement:
+                    break;
+                default:
+                    return "";
+            }
+        }
+    }
+
+    void XmlPullParser::skipElement()
+    {
+        if( m_event != Event::StartElement )
+            return;
+
+        const int depth = getDepth();
+        while( true )
+        {
+            Event event = next();
+            if( event == Event::EndDocument || event == Event::Error )
+                return;
+            if( event == Event::EndElement && getDepth() < depth )
+                return;
+        }
+    }
+
+    bool XmlPullParser::fill()
+    {
+        if( m_endOfInput )
+            return false;
+
+        // Drop what was consumed once it is at least half of the buffer, so the buffer stays near the chunk size.
+        if( m_position > 0 && m_position >= m_buffer.size() / 2 )
+        {
+            m_buffer.erase(0, m_position);
+            m_bytesDiscarded += m_position;
+            m_position = 0;
+        }
+
+        const size_t oldSize = m_buffer.size();
+        m_buffer.resize(oldSize + m_chunkSize);
+        m_input.read(&m_buffer[oldSize], static_cast<std::streamsize>(m_chunkSize));
+        const size_t count = static_cast<size_t>(m_input.gcount());
+        m_buffer.resize(oldSize + count);
+
+        if( count == 0 )
+        {
+            m_endOfInput = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool XmlPullParser::ensure(size_t count)
+    {
+        while( m_buffer.size() - m_position < count )
+        {
+            if( !fill() )
+                return false;
+        }
+        return true;
+    }
+
+    bool XmlPullParser::startsWith(const char* literal)
+    {
+        const size_t length = std::strlen(literal);
+        return ensure(length) && m_buffer.compare(m_position, length, literal) == 0;
+    }
+
+    bool XmlPullParser::readUntil(const std::string& delimiter, std::string& content)
+    {
+        size_t searched = 0; // Bytes after m_position known not to start the delimiter.
+        while( true )
+        {
+            const size_t found = m_buffer.find(delimiter, m_position + searched);
+            if( found != std::string::npos )
+            {
+                content.assign(m_buffer, m_position, found - m_position);
+                m_position = found + delimiter.size();
+                return true;
+            }
+
+            const size_t available = m_buffer.size() - m_position;
+            searched = available >= delimiter.size() ? available - delimiter.size() + 1 : 0;
+            if( !fill() )
+                return false;
+        }
+    }
+
+    bool XmlPullParser::readTag(std::string& tag)
+    {
+        // Like readUntil(">"), but a '>' inside a quoted attribute value does not end the tag.
+        size_t offset = 0;
+        char quote = 0;
+        while( true )
+        {
+            if( m_position + offset >= m_buffer.size() && !fill() )
+                return false;
+
+            const size_t end = m_buffer.size() - m_position;
+            for( ; offset < end; ++offset )
+            {
+                const char c = m_buffer[m_position + offset];
+                if( quote )
+                {
+                    if( c == quote )
+                        quote = 0;
+                }
+                else if( c == '"' || c == '\'' )
+                {
+                    quote = c;
+                }
+                else if( c == '>' )
+                {
+                    tag.assign(m_buffer, m_position, offset);
+                    m_position += offset + 1;
+                    return true;
+                }
+            }
+        }
+    }
+
+    bool XmlPullParser::parseMarkup()
+    {
+        if( !ensure(1) )
+        {
+            fail("Unexpected end of document after '<'.");
+            return true;
+        }
+
+        std::string skipped;
+        const char c = m_buffer[m_position];
+        if( c == '/' )
+        {
+            parseEndTag();
+            return true;
+        }
+        if( c == '?' )
+        {
+            if( !readUntil("?>", skipped) )
+                fail("Unterminated processing instruction.");
+            return m_finished;
+        }
+        if( c == '!' )
+        {
+            if( startsWith("!--") )
+            {
+                if( !readUntil("-->", skipped) )
+                    fail("Unterminated comment.");
+                return m_finished;
+            }
+            if( startsWith("![CDATA[") )
+            {
+                m_position += std::strlen("![CDATA[");
+                if( !readUntil("]]>", m_text) )
+                    fail("Unterminated CDATA section.");
+                else if( m_openElements.empty() )
+                    fail("CDATA outside of the root element.");
+                else
+                    m_event = Event::Text;
+                return true;
+            }
+            if( startsWith("!DOCTYPE") )
+            {
+                if( !parseDoctype() )
+                    fail("Malformed DOCTYPE declaration.");
+                return m_finished;
+            }
+            fail("Unknown markup declaration.");
+            return true;
+        }
+
+        parseStartTag();
+        return true;
+    }
+
+    void XmlPullParser::parseStartTag()
+    {
+        std::string tag;
+        if( !readTag(tag) )
+        {
+            fail("Unterminated start tag.");
+            return;
+        }
+
+        bool selfClosing = false;
+        if( !tag.empty() && tag.back() == '/' )
+        {
+            selfClosing = true;
+            tag.pop_back();
+        }
+
+        size_t position = 0;
+        while( position < tag.size() && !isSpace(tag[position]) )
+        {
+            ++position;
+        }
+        m_name = tag.substr(0, position);
+        if( m_name.empty() )
+        {
+            fail("Start tag without a name.");
+            return;
+        }
+
+        while( true )
+        {
+            while( position < tag.size() && isSpace(tag[position]) )
+            {
+                ++position;
+            }
+            if( position >= tag.size() )
+                break;
+
+            const size_t nameStart = position;
+            while( position < tag.size() && tag[position] != '=' && !isSpace(tag[position]) )
+            {
+                ++position;
+            }
+            std::string name = tag.substr(nameStart, position - nameStart);
+
+            while( position < tag.size() && isSpace(tag[position]) )
+            {
+                ++position;
+            }
+            if( position >= tag.size() || tag[position] != '=' )
+            {
+                fail("Attribute '" + name + "' of <" + m_name + "> has no value.");
+                return;
+            }
+            ++position;
+            while( position < tag.size() && isSpace(tag[position]) )
+            {
+                ++position;
+            }
+            if( position >= tag.size() || (tag[position] != '"' && tag[position] != '\'') )
+            {
+                fail("Attribute '" + name + "' of <" + m_name + "> is not quoted.");
+                return;
+            }
+
+            const char quote = tag[position++];
+            const size_t valueEnd = tag.find(quote, position);
+            if( valueEnd == std::string::npos )
+            {
+                fail("Unterminated value of attribute '" + name + "'.");
+                return;
+            }
+            m_attributes.emplace_back(std::move(name), decode(tag.substr(position, valueEnd - position)));
+            position = valueEnd + 1;
+        }
+
+        if( m_seenRoot && m_openElements.empty() )
+        {
+            fail("More than one root element.");
+            return;
+        }
+
+        m_seenRoot = true;
+        m_openElements.push_back(m_name);
+        m_pendingEnd = selfClosing;
+        m_event = Event::StartElement;
+    }
+
+    void XmlPullParser::parseEndTag()
+    {
+        std::string tag;
+        if( !readTag(tag) )
+        {
+            fail("Unterminated end tag.");
+            return;
+        }
+
+        size_t end = tag.size();
+        while( end > 1 && isSpace(tag[end - 1]) )
+        {
+            --end;
+        }
+        m_name = tag.substr(1, end - 1);
+
+        if( m_openElements.empty() || m_openElements.back() != m_name )
+        {
+            fail("Unexpected end tag </" + m_name + ">.");
+            return;
+        }
+
+        m_openElements.pop_back();
+        m_event = Event::EndElement;
+    }
+
+    bool XmlPullParser::parseDoctype()
+    {
+        m_position += std::strlen("!DOCTYPE");
+        std::string skipped;
+
+        // The header (root name, optional external id) up to the internal subset or the end.
+        while( true )
+        {
+            if( !ensure(1) )
+                return false;
+
+            const char c = m_buffer[m_position++];
+            if( c == '>' )
+                return true;
+            if( c == '"' || c == '\'' )
+            {
+                if( !readUntil(std::string(1, c), skipped) )
+                    return false;
+            }
+            else if( c == '[' )
+            {
+                break;
+            }
+        }
+
+        // The internal subset: only general entity declarations are kept.
+        while( true )
+        {
+            if( !ensure(1) )
+                return false;
+
+            const char c = m_buffer[m_position];
+            if( isSpace(c) )
+            {
+                ++m_position;
+            }
+            else if( c == ']' )
+            {
+                ++m_position;
+                return readUntil(">", skipped);
+            }
+            else if( startsWith("<!--") )
+            {
+                m_position += std::strlen("<!--");
+                if( !readUntil("-->", skipped) )
+                    return false;
+            }
+            else if( c == '<' )
+            {
+                ++m_position;
+                std::string declaration;
+                if( !readTag(declaration) )
+                    return false;
+                if( declaration.compare(0, std::strlen("!ENTITY"), "!ENTITY") == 0 )
+                    parseEntityDeclaration(declaration.substr(std::strlen("!ENTITY")));
+            }
+            else if( c == '%' )
+            {
+                // Parameter entity reference, external declarations are not loaded.
+                if( !readUntil(";", skipped) )
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+
+    void XmlPullParser::parseEntityDeclaration(const std::string& declaration)
+    {
+        size_t position = 0;
+        while( position < declaration.size() && isSpace(declaration[position]) )
+        {
+            ++position;
+        }
+        if( position >= declaration.size() || declaration[position] == '%' )
+            return; // Parameter entities only matter for the DTD itself.
+
+        const size_t nameStart = position;
+        while( position < declaration.size() && !isSpace(declaration[position]) )
+        {
+            ++position;
+        }
+        std::string name = declaration.substr(nameStart, position - nameStart);
+
+        while( position < declaration.size() && isSpace(declaration[position]) )
+        {
+            ++position;
+        }
+        if( position >= declaration.size() || (declaration[position] != '"' && declaration[position] != '\'') )
+            return; // External entity (SYSTEM / PUBLIC), not supported.
+
+        const char quote = declaration[position++];
+        const size_t valueEnd = declaration.find(quote, position);
+        if( valueEnd == std::string::npos )
+            return;
+
+        m_entities[name] = decode(declaration.substr(position, valueEnd - position));
+    }
+
+    XmlPullParser::Event XmlPullParser::fail(const std::string& message)
+    {
+        m_error = message + " (at byte " + std::to_string(getBytesRead()) + ")";
+        m_finished = true;
+        m_pendingEnd = false;
+        m_event = Event::Error;
+        return m_event;
+    }
+
+    std::string XmlPullParser::decode(const std::string& raw) const
+    {
+        size_t ampersand = raw.find('&');
+        if( ampersand == std::string::npos )
+            return raw;
+
+        std::string out;
+        out.reserve(raw.size());
+        size_t position = 0;
+        while( ampersand != std::string::npos )
+        {
+            out.append(raw, position, ampersand - position);
+
+            const size_t semicolon = raw.find(';', ampersand + 1);
+            if( semicolon == std::string::npos )
+            {
+                position = ampersand;
+                break;
+            }
+
+            const std::string reference = raw.substr(ampersand + 1, semicolon - ampersand - 1);
+            bool known = true;
+            if( reference.size() > 1 && reference[0] == '#' )
+            {
+                try
+                {
+                    const bool hex = reference[1] == 'x' || reference[1] == 'X';
+                    appendUtf8(out, static_cast<uint32_t>(std::stoul(reference.substr(hex ? 2 : 1), nullptr, hex ? 16 : 10)));
+                }
+                catch( const std::exception& )
+                {
+                    known = false;
+                }
+            }
+            else if( reference == "lt" )
+                out += '<';
+            else if( reference == "gt" )
+                out += '>';
+            else if( reference == "amp" )
+                out += '&';
+            else if( reference == "quot" )
+                out += '"';
+            else if( reference == "apos" )
+                out += '\'';
+            else
+            {
+                auto entity = m_entities.find(reference);
+                if( entity != m_entities.end() )
+                    out += entity->second;
+                else
+                    known = false;
+            }
+
+            // Unknown references are kept as they are.
+            if( !known )
+                out.append(raw, ampersand, semicolon - ampersand + 1);
+
+            position = semicolon + 1;
+            ampersand = raw.find('&', position);
+        }
+        out.append(raw, position, std::string::npos);
+        return out;
+    }
+
+    void XmlPullParser::appendUtf8(std::string& out, uint32_t codePoint)
+    {
+        if( codePoint < 0x80 )
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if( codePoint < 0x800 )
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if( codePoint < 0x10000 )
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
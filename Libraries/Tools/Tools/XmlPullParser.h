@@ -0,0 +1,148 @@
+/**
+ * @file XmlPullParser.h
+ * @brief Defines the XmlPullParser class, a streaming XML reader for documents too large to load as a DOM.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * @class XmlPullParser
+     * @brief Reads an XML document from a stream one event at a time.
+     *
+     * The input is read in fixed-size chunks, so memory use does not depend on the document size.
+     * Supported: elements and attributes, character data, CDATA sections, comments and processing
+     * instructions (skipped), the predefined and numeric character references and general entities
+     * declared in the internal DOCTYPE subset (JMdict declares its part-of-speech codes this way).
+     * Namespaces and external DTDs are not interpreted; a malformed document ends with Event::Error.
+     */
+    class XmlPullParser
+    {
+    public:
+
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+        /**
+         * @brief Kind of the current parser position.
+         */
+        enum class Event
+        {
+            StartElement,   ///< An opening tag, getName() and the attributes are valid.
+            EndElement,     ///< A closing tag (also reported after a self-closing tag).
+            Text,           ///< Character data, getText() holds the decoded text.
+            EndDocument,    ///< The input ended after the root element was closed.
+            Error           ///< The input is not well-formed, see getError().
+        };
+
+        /**
+         * @brief Constructs a parser reading from a stream.
+         * @param input The stream to read, it must outlive the parser.
+         * @param chunkSize Number of bytes read from the stream at a time.
+         */
+        explicit XmlPullParser(std::istream& input, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+        /**
+         * @brief Advances to the next event.
+         * @return The new event. After EndDocument or Error the same event is returned again.
+         */
+        Event next();
+
+        /**
+         * @brief Returns the element name of a StartElement or EndElement event.
+         */
+        const std::string& getName() const;
+
+        /**
+         * @brief Returns the decoded text of a Text event.
+         */
+        const std::string& getText() const;
+
+        /**
+         * @brief Returns the value of an attribute of the current start element.
+         * @param name The attribute name, including any prefix (e.g. "xml:lang").
+         * @return The decoded value, or nullptr if the element has no such attribute.
+         */
+        const std::string* findAttribute(const std::string& name) const;
+
+        /**
+         * @brief Returns the value of an attribute of the current start element.
+         * @param name The attribute name.
+         * @param fallback Returned when the attribute is missing.
+         */
+        std::string getAttribute(const std::string& name, const std::string& fallback = "") const;
+
+        /**
+         * @brief Returns the number of open elements. A start element counts itself, an end element does not.
+         */
+        int getDepth() const;
+
+        /**
+         * @brief Returns the number of input bytes consumed so far, for progress reporting.
+         */
+        uint64_t getBytesRead() const;
+
+        /**
+         * @brief Returns the description of the last error.
+         */
+        const std::string& getError() const;
+
+        /**
+         * @brief Reads the text content of the current start element up to its end element.
+         *
+         * Text of nested elements is included, their tags are skipped. Afterwards the parser is
+         * positioned at the matching EndElement.
+         * @return The concatenated text, empty if the document ended or is malformed.
+         */
+        std::string readElementText();
+
+        /**
+         * @brief Skips the current start element including all of its children.
+         */
+        void skipElement();
+
+    private:
+
+        bool fill();
+        bool ensure(size_t count);
+        bool startsWith(const char* literal);
+        bool readUntil(const std::string& delimiter, std::string& content);
+        bool readTag(std::string& tag);
+
+        bool parseMarkup();
+        void parseStartTag();
+        void parseEndTag();
+        bool parseDoctype();
+        void parseEntityDeclaration(const std::string& declaration);
+        Event fail(const std::string& message);
+
+        std::string decode(const std::string& raw) const;
+        static void appendUtf8(std::string& out, uint32_t codePoint);
+
+        std::istream& m_input;
+        const size_t m_chunkSize;
+        std::string m_buffer;
+        size_t m_position = 0;
+        uint64_t m_bytesDiscarded = 0;
+        bool m_endOfInput = false;
+
+        Event m_event = Event::Text;
+        bool m_finished = false;
+        bool m_pendingEnd = false;
+        bool m_seenRoot = false;
+        std::string m_name;
+        std::string m_text;
+        std::string m_error;
+        std::vector<std::pair<std::string, std::string>> m_attributes;
+        std::vector<std::string> m_openElements;
+        std::unordered_map<std::string, std::string> m_entities;
+    };
+}
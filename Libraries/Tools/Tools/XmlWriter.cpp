@@ -0,0 +1,144 @@
+#include "XmlWriter.h"
+
+namespace tools
+{
+    namespace
+    {
+        // The pending output is handed to the stream in pieces of about this size.
+        constexpr size_t FLUSH_SIZE = 16 * 1024;
+    }
+
+    XmlWriter::XmlWriter(std::ostream& output, bool indent)
+        : m_output(output), m_indent(indent)
+    {
+        m_buffer = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    }
+
+    XmlWriter::~XmlWriter()
+    {
+        finish();
+    }
+
+    void XmlWriter::startElement(const std::string& name)
+    {
+        closeStartTag();
+        if( !m_hasText && (!m_openElements.empty() || !m_buffer.empty()) )
+            newLine(m_openElements.size());
+
+        m_buffer += '<';
+        m_buffer += name;
+        m_openElements.push_back(name);
+        m_startTagOpen = true;
+        m_hasChildren = false;
+        m_hasText = false;
+    }
+
+    void XmlWriter::attribute(const std::string& name, const std::string& value)
+    {
+        if( !m_startTagOpen )
+            return;
+
+        m_buffer += ' ';
+        m_buffer += name;
+        m_buffer += "=\"";
+        escape(m_buffer, value);
+        m_buffer += '"';
+    }
+
+    void XmlWriter::text(const std::string& value)
+    {
+        if( m_openElements.empty() )
+            return;
+
+        closeStartTag();
+        escape(m_buffer, value, false);
+        m_hasText = true;
+    }
+
+    void XmlWriter::endElement()
+    {
+        if( m_openElements.empty() )
+            return;
+
+        if( m_startTagOpen )
+        {
+            m_buffer += "/>";
+            m_startTagOpen = false;
+        }
+        else
+        {
+            if( m_hasChildren && !m_hasText )
+                newLine(m_openElements.size() - 1);
+            m_buffer += "</";
+            m_buffer += m_openElements.back();
+            m_buffer += '>';
+        }
+
+        m_openElements.pop_back();
+        m_hasChildren = true;
+        m_hasText = false;
+
+        if( m_buffer.size() >= FLUSH_SIZE )
+        {
+            m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+    }
+
+    bool XmlWriter::finish()
+    {
+        while( !m_openElements.empty() )
+        {
+            endElement();
+        }
+
+        if( !m_buffer.empty() )
+        {
+            if( m_indent )
+                m_buffer += '\n';
+            m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+        m_output.flush();
+        return static_cast<bool>(m_output);
+    }
+
+    void XmlWriter::escape(std::string& out, const std::string& value, bool attribute)
+    {
+        for( char c : value )
+        {
+            switch( c )
+            {
+                case '&': out += "&amp;"; break;
+                case '<': out += "&lt;"; break;
+                case '>': out += "&gt;"; break;
+                case '"': out += attribute ? "&quot;" : "\""; break;
+                case '\n': out += attribute ? "&#10;" : "\n"; break;
+                case '\r': out += "&#13;"; break;
+                case '\t': out += attribute ? "&#9;" : "\t"; break;
+                default:
+                    if( static_cast<unsigned char>(c) >= 0x20 )
+                        out += c;
+                    break;
+            }
+        }
+    }
+
+    void XmlWriter::closeStartTag()
+    {
+        if( m_startTagOpen )
+        {
+            m_buffer += '>';
+            m_startTagOpen = false;
+        }
+    }
+
+    void XmlWriter::newLine(size_t depth)
+    {
+        if( !m_indent )
+            return;
+
+        m_buffer += '\n';
+        m_buffer.append(depth * 2, ' ');
+    }
+}
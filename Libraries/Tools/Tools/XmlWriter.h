@@ -0,0 +1,87 @@
+/**
+ * @file XmlWriter.h
+ * @brief Defines the XmlWriter class, which writes an XML document to a stream as it is produced.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tools
+{
+    /**
+     * @class XmlWriter
+     * @brief Writes XML elements, attributes and text straight to a stream, without building a DOM.
+     *
+     * Only the names of the open elements are kept, so memory use does not depend on the document size.
+     * Attribute values and text are escaped; line breaks and tabs in attribute values are written as
+     * character references so they survive the attribute value normalization of XML parsers. Control
+     * characters that XML 1.0 does not allow are dropped. The writer does not validate names.
+     */
+    class XmlWriter
+    {
+    public:
+
+        /**
+         * @brief Constructs a writer and writes the XML declaration.
+         * @param output The stream to write, it must outlive the writer.
+         * @param indent Whether to put each element on its own, indented line (meant for documents without mixed content).
+         */
+        explicit XmlWriter(std::ostream& output, bool indent = true);
+
+        /**
+         * @brief Closes all open elements.
+         */
+        ~XmlWriter();
+
+        XmlWriter(const XmlWriter&) = delete;
+        XmlWriter& operator=(const XmlWriter&) = delete;
+
+        /**
+         * @brief Opens an element; attributes can be added until its first child or text.
+         */
+        void startElement(const std::string& name);
+
+        /**
+         * @brief Adds an attribute to the element opened last.
+         */
+        void attribute(const std::string& name, const std::string& value);
+
+        /**
+         * @brief Writes character data into the current element.
+         */
+        void text(const std::string& value);
+
+        /**
+         * @brief Closes the element opened last, as a self-closing tag if it is empty.
+         */
+        void endElement();
+
+        /**
+         * @brief Closes all open elements and flushes the stream.
+         * @return False if the stream failed.
+         */
+        bool finish();
+
+        /**
+         * @brief Appends a value to a string, escaped for use in an attribute (or in text if @p attribute is false).
+         */
+        static void escape(std::string& out, const std::string& value, bool attribute = true);
+
+    private:
+
+        void closeStartTag();
+        void newLine(size_t depth);
+
+        std::ostream& m_output;
+        bool m_indent;
+        bool m_startTagOpen = false;
+        bool m_hasChildren = false;
+        bool m_hasText = false;
+        std::vector<std::string> m_openElements;
+        std::string m_buffer;
+    };
+}
@@ -4,6 +4,8 @@ import json
 import requests
 from bs4 import BeautifulSoup
 import jaconv
+from DictionaryWorker import is_worker_mode, run_worker
+from HttpSession import get_session
 
 sys.stdout.reconfigure(encoding='utf-8')
 
@@ -159,7 +161,7 @@ def fetch_verb_conjugations(word_romaji, debug=False):
         )
     }
     try:
-        response = requests.get(url, headers=headers)
+        response = get_session().get(url, headers=headers)
         response.raise_for_status()
         soup = BeautifulSoup(response.text, 'html.parser')
 
@@ -234,54 +236,65 @@ def output_json(word, conj_dict):
 
 # --- MAIN ---
 
-def main():
-    if len(sys.argv) < 2:
-        print("Usage: conj.py <word_in_kana_or_romaji> [--json] [--debug]")
-        sys.exit(1)
-
-    word = sys.argv[1].strip()
-    word = to_kana_if_romaji(word)
-    output_json_mode = '--json' in sys.argv
-    debug_mode = '--debug' in sys.argv
-
+def conjugate(word, debug_mode=False):
+    """
+    Conjugates an adjective or a verb given in kana.
+    Returns dict {key: hiragana}, or None when the word is neither.
+    """
     # Try adjective logic first
     adj_type = detect_adjective_type(word)
     if adj_type:
         if debug_mode:
             print(f"DEBUG: recognized as adjective type {adj_type}", file=sys.stderr)
         if adj_type == "ii_special":
-            conj = conjugate_ii_special()
+            return conjugate_ii_special()
         elif adj_type == "double_ii":
-            conj = conjugate_double_ii(word)
+            return conjugate_double_ii(word)
         elif adj_type == "i":
-            conj = conjugate_i_adjective(word)
+            return conjugate_i_adjective(word)
         elif adj_type == "na":
-            conj = conjugate_na_adjective(word)
-        else:
-            print("ERROR: Unexpected adjective type", file=sys.stderr)
-            sys.exit(1)
-        if output_json_mode:
-            print(output_json(word, conj))
-        else:
-            print(output_xml(word, conj))
-        sys.exit(0)
+            return conjugate_na_adjective(word)
+        print("ERROR: Unexpected adjective type", file=sys.stderr)
+        return None
     elif is_verb_candidate(word):
         # Always fetch from Reverso using romaji
         word_romaji = to_romaji_if_kana(word)
         if debug_mode:
             print(f"DEBUG: recognized as verb candidate, using '{word_romaji}' for Reverso", file=sys.stderr)
-        conj = fetch_verb_conjugations(word_romaji, debug=debug_mode)
-        if not conj:
+        return fetch_verb_conjugations(word_romaji, debug=debug_mode)
+    return None
+
+def worker_handler(text):
+    word = to_kana_if_romaji(text)
+    conj = conjugate(word)
+    return output_xml(word, conj) if conj else None
+
+def main():
+    if is_worker_mode():
+        run_worker(worker_handler)
+        sys.exit(0)
+
+    if len(sys.argv) < 2:
+        print("Usage: conj.py <word_in_kana_or_romaji> [--json] [--debug] | --worker")
+        sys.exit(1)
+
+    word = sys.argv[1].strip()
+    word = to_kana_if_romaji(word)
+    output_json_mode = '--json' in sys.argv
+    debug_mode = '--debug' in sys.argv
+
+    conj = conjugate(word, debug_mode)
+    if not conj:
+        if detect_adjective_type(word) or is_verb_candidate(word):
             print("この単語は動詞として認識できません (Not recognized as a verb)")
-            sys.exit(1)
-        if output_json_mode:
-            print(output_json(word, conj))
         else:
-            print(output_xml(word, conj))
-        sys.exit(0)
-    else:
-        print("この単語は形容詞や動詞として認識できません (Not recognized as adjective or verb)", file=sys.stderr)
+            print("この単語は形容詞や動詞として認識できません (Not recognized as adjective or verb)", file=sys.stderr)
         sys.exit(1)
+    if output_json_mode:
+        print(output_json(word, conj))
+    else:
+        print(output_xml(word, conj))
+    sys.exit(0)
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,67 @@
+"""
+Resident worker mode shared by the dictionary scripts.
+
+A script started with --worker stays alive and answers many lookups, so the
+interpreter start-up, the imports and the HTTP sessions (one per pool thread,
+see HttpSession.py) are paid only once.
+
+Protocol (UTF-8):
+  start-up: the worker writes the banner line "TADAIMA-WORKER 1"
+  request:  "<id>\t<input>\n"
+  reply:    "<id> <OK|ERR> <byte length>\n" followed by exactly <byte length> bytes
+
+Requests are handled on a small thread pool, so replies may arrive out of order.
+"""
+
+import sys
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+PROTOCOL_BANNER = "TADAIMA-WORKER 1"
+
+
+def is_worker_mode():
+    return '--worker' in sys.argv[1:]
+
+
+def run_worker(handler, max_workers=4):
+    """
+    Serves requests from stdin until it is closed.
+    handler(input) returns the XML reply, or None / raises when there is no result.
+    """
+    out = sys.stdout.buffer
+    # Anything the handlers print goes to stderr, so it cannot corrupt the framing.
+    sys.stderr.reconfigure(encoding='utf-8', errors='replace')
+    sys.stdout = sys.stderr
+    write_lock = threading.Lock()
+
+    def reply(request_id, status, payload):
+        data = payload.encode('utf-8')
+        with write_lock:
+            out.write(f"{request_id} {status} {len(data)}\n".encode('utf-8'))
+            out.write(data)
+            out.flush()
+
+    def handle(request_id, text):
+        try:
+            result = handler(text)
+            if result:
+                reply(request_id, "OK", result)
+            else:
+                reply(request_id, "ERR", f"No result for {text}")
+        except SystemExit:
+            reply(request_id, "ERR", f"No result for {text}")
+        except Exception as e:
+            reply(request_id, "ERR", str(e))
+
+    with write_lock:
+        out.write((PROTOCOL_BANNER + "\n").encode('utf-8'))
+        out.flush()
+
+    with ThreadPoolExecutor(max_workers=max_workers) as pool:
+        for raw in sys.stdin.buffer:
+            line = raw.decode('utf-8', errors='replace').rstrip('\r\n')
+            if not line:
+                continue
+            request_id, _, text = line.partition('\t')
+            pool.submit(handle, request_id, text.strip())
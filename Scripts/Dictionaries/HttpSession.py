@@ -0,0 +1,21 @@
+"""
+HTTP session helper shared by the dictionary scripts.
+
+requests.Session is not thread-safe (cookie jar and connection pool), and a
+resident worker handles lookups on a thread pool, so every thread gets its
+own session. Each session is reused for all lookups of its thread.
+"""
+
+import threading
+
+import requests
+
+_local = threading.local()
+
+
+def get_session():
+    session = getattr(_local, 'session', None)
+    if session is None:
+        session = requests.Session()
+        _local.session = session
+    return session
@@ -6,6 +6,8 @@ import pykakasi
 import re
 from googletrans import Translator
 import time
+from DictionaryWorker import is_worker_mode, run_worker
+from HttpSession import get_session
 
 # Ensure UTF-8 output
 sys.stdout.reconfigure(encoding='utf-8')
@@ -24,7 +26,7 @@ def get_translation(word):
     url = f"https://takoboto.jp/?q={word}"
     
     # Make a request to the website
-    response = requests.get(url)
+    response = get_session().get(url)
     response.encoding = 'utf-8'  # Ensure response is interpreted as UTF-8
     if response.status_code != 200:
         print("Error: Could not fetch data from Takoboto")
@@ -216,6 +218,10 @@ def format_output(english_word, hiragana, kanji, romaji, example_sentence, examp
     return xml_str.encode('utf-8').decode('utf-8')
 
 if __name__ == "__main__":
+    if is_worker_mode():
+        run_worker(get_translation)
+        sys.exit(0)
+
     # Check if sufficient arguments are provided
     if len(sys.argv) < 2:
         print("Usage: script.py <word> [-debug]")
@@ -0,0 +1,244 @@
+#include "gtest/gtest.h"
+#include "Application/DatabaseMerger.h"
+#include "Application/ApplicationDatabase.h"
+#include "Tools/Logger.h"
+#include "../Mocks/TempFiles.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+using namespace tadaima;
+using namespace tadaima::application;
+using Kind = DatabaseMerger::Conflict::Kind;
+
+namespace
+{
+    // Runs SQL on a database file without ApplicationDatabase, e.g. to set modification times.
+    void execute(const std::string& path, const std::string& sql)
+    {
+        sqlite3* db = nullptr;
+        ASSERT_EQ(sqlite3_open(path.c_str(), &db), SQLITE_OK);
+        char* errMsg = nullptr;
+        EXPECT_EQ(sqlite3_exec(db, sql.c_str(), 0, 0, &errMsg), SQLITE_OK) << (errMsg ? errMsg : "");
+        sqlite3_free(errMsg);
+        sqlite3_close(db);
+    }
+
+    Word makeWord(const std::string& kana, const std::string& translation, const std::string& romaji)
+    {
+        return Word(0, kana, "", translation, romaji, "", {});
+    }
+
+    // Both databases start from the same lessons, as after copying the file to a second computer.
+    void addCommonLessons(Database& database)
+    {
+        const int animals = database.addLesson("Animals", "1", "N5");
+        database.addWord(animals, makeWord("neko", "cat", "neko"));
+        database.addWord(animals, makeWord("inu", "dog", "inu"));
+        database.addWord(animals, makeWord("tori", "bird", "tori"));
+        const int food = database.addLesson("Food", "1", "N5");
+        database.addWord(food, makeWord("sushi", "sushi", "sushi"));
+    }
+
+    const Lesson* findLesson(const std::vector<Lesson>& lessons, const std::string& mainName)
+    {
+        auto it = std::find_if(lessons.begin(), lessons.end(), [&mainName](const Lesson& lesson) { return lesson.mainName == mainName; });
+        return it == lessons.end() ? nullptr : &*it;
+    }
+
+    const Word* findWord(const Lesson& lesson, const std::string& kana)
+    {
+        auto it = std::find_if(lesson.words.begin(), lesson.words.end(), [&kana](const Word& word) { return word.kana == kana; });
+        return it == lesson.words.end() ? nullptr : &*it;
+    }
+}
+
+TEST(DatabaseMergerTest, SyncTakesNewerWordsAndAddsMissingOnes)
+{
+    tools::Logger logger;
+    const std::string desktop = uniqueTempPath("tadaima_merge_desktop.db").string();
+    const std::string laptop = uniqueTempPath("tadaima_merge_laptop.db").string();
+    {
+        ApplicationDatabase database(desktop, logger);
+        addCommonLessons(database);
+        const int animals = database.findLesson("N5", "Animals", "1");
+        database.addWord(animals, makeWord("kuma", "bear", "kuma"));
+    }
+    {
+        ApplicationDatabase database(laptop, logger);
+        addCommonLessons(database);
+        const int verbs = database.addLesson("Verbs", "1", "N5");
+        database.addTag(database.addWord(verbs, makeWord("taberu", "to eat", "taberu")), "verb");
+    }
+    // The cat was edited on both computers, last on the laptop; the dog only on the desktop, after that.
+    execute(desktop, "UPDATE words SET romaji = 'NEKO' WHERE kana = 'neko'; UPDATE words SET romaji = 'INU' WHERE kana = 'inu';"
+        "UPDATE words SET modified_at = 100; UPDATE words SET modified_at = 300 WHERE kana = 'inu';");
+    execute(laptop, "UPDATE words SET romaji = 'Neko' WHERE kana = 'neko'; INSERT INTO tags (word_id, tag) SELECT id, 'pet' FROM words WHERE kana = 'neko';"
+        "UPDATE words SET modified_at = 100; UPDATE words SET modified_at = 200 WHERE kana = 'neko';");
+
+    DatabaseMerger merger(logger);
+    const auto [desktopReport, laptopReport] = merger.sync(desktop, laptop);
+
+    EXPECT_EQ(desktopReport.lessonsAdded, 1);
+    EXPECT_EQ(desktopReport.wordsAdded, 1);
+    EXPECT_EQ(desktopReport.wordsUpdated, 1);
+    ASSERT_EQ(desktopReport.conflicts.size(), 2u);
+    EXPECT_EQ(desktopReport.conflicts[0].kind, Kind::Edited);
+    EXPECT_EQ(laptopReport.wordsAdded, 1);
+    EXPECT_EQ(laptopReport.wordsUpdated, 1);
+
+    for( const std::string& path : { desktop, laptop } )
+    {
+        ApplicationDatabase database(path, logger);
+        const std::vector<Lesson> lessons = database.getAllLessons();
+        ASSERT_EQ(lessons.size(), 3u) << path;
+        const Lesson* animals = findLesson(lessons, "Animals");
+        ASSERT_NE(animals, nullptr);
+        ASSERT_EQ(animals->words.size(), 4u) << path;
+        EXPECT_EQ(findWord(*animals, "neko")->romaji, "Neko");
+        EXPECT_EQ(findWord(*animals, "neko")->tags, (std::vector<std::string>{ "pet" }));
+        EXPECT_EQ(findWord(*animals, "inu")->romaji, "INU");
+        const Lesson* verbs = findLesson(lessons, "Verbs");
+        ASSERT_NE(verbs, nullptr);
+        EXPECT_EQ(verbs->words[0].tags, (std::vector<std::string>{ "verb" }));
+    }
+
+    // Once in sync, merging again changes nothing.
+    const DatabaseMerger::Report again = merger.merge(desktop, laptop);
+    EXPECT_EQ(again.wordsAdded + again.wordsUpdated + again.wordsDeleted + again.lessonsAdded, 0);
+    EXPECT_TRUE(again.conflicts.empty());
+
+    std::filesystem::remove(desktop);
+    std::filesystem::remove(laptop);
+}
+
+TEST(DatabaseMergerTest, DeletionsWinUnlessChangedLater)
+{
+    tools::Logger logger;
+    const std::string desktop = uniqueTempPath("tadaima_merge_desktop.db").string();
+    const std::string laptop = uniqueTempPath("tadaima_merge_laptop.db").string();
+    {
+        ApplicationDatabase database(desktop, logger);
+        addCommonLessons(database);
+    }
+    {
+        ApplicationDatabase database(laptop, logger);
+        addCommonLessons(database);
+        const int animals = database.findLesson("N5", "Animals", "1");
+        for( const Word& word : database.getWordsInLesson(animals) )
+        {
+            if( word.kana == "tori" )
+                database.deleteWord(word.id);
+        }
+        const int food = database.findLesson("N5", "Food", "1");
+        for( const Word& word : database.getWordsInLesson(food) )
+            database.deleteWord(word.id);
+        database.deleteLesson(food);
+    }
+    // The laptop deleted the bird and the food lesson at 300; the desktop changed the sushi later.
+    execute(desktop, "UPDATE words SET romaji = 'SUSHI' WHERE kana = 'sushi'; UPDATE lessons SET modified_at = 100;"
+        "UPDATE words SET modified_at = 100; UPDATE words SET modified_at = 500 WHERE kana = 'sushi';");
+    execute(laptop, "UPDATE lessons SET modified_at = 100; UPDATE words SET modified_at = 100; UPDATE tombstones SET modified_at = 300;");
+
+    DatabaseMerger merger(logger);
+    const auto [desktopReport, laptopReport] = merger.sync(desktop, laptop);
+
+    EXPECT_EQ(desktopReport.wordsDeleted, 1);
+    EXPECT_EQ(desktopReport.lessonsDeleted, 0);
+    ASSERT_EQ(desktopReport.conflicts.size(), 1u);
+    EXPECT_EQ(desktopReport.conflicts[0].kind, Kind::DeletedThere);
+    EXPECT_FALSE(desktopReport.conflicts[0].theirsWon);
+    EXPECT_EQ(laptopReport.lessonsAdded, 1);
+    ASSERT_EQ(laptopReport.conflicts.size(), 1u);
+    EXPECT_EQ(laptopReport.conflicts[0].kind, Kind::DeletedHere);
+
+    for( const std::string& path : { desktop, laptop } )
+    {
+        ApplicationDatabase database(path, logger);
+        const std::vector<Lesson> lessons = database.getAllLessons();
+        ASSERT_EQ(lessons.size(), 2u) << path;
+        const Lesson* animals = findLesson(lessons, "Animals");
+        ASSERT_NE(animals, nullptr);
+        EXPECT_EQ(animals->words.size(), 2u) << path;
+        EXPECT_EQ(findWord(*animals, "tori"), nullptr);
+        const Lesson* food = findLesson(lessons, "Food");
+        ASSERT_NE(food, nullptr);
+        ASSERT_EQ(food->words.size(), 1u);
+        EXPECT_EQ(food->words[0].romaji, "SUSHI");
+
+        // The lesson is back, its old deletion must not travel any further.
+        const LessonChanges changes = database.getChangesSince(-1);
+        EXPECT_TRUE(std::none_of(changes.tombstones.begin(), changes.tombstones.end(),
+            [](const LessonTombstone& tombstone) { return tombstone.wholeLesson; })) << path;
+    }
+
+    std::filesystem::remove(desktop);
+    std::filesystem::remove(laptop);
+}
+
+TEST(DatabaseMergerTest, RejectsMissingAndIdenticalFiles)
+{
+    tools::Logger logger;
+    const std::string desktop = uniqueTempPath("tadaima_merge_desktop.db").string();
+    {
+        ApplicationDatabase database(desktop, logger);
+    }
+
+    DatabaseMerger merger(logger);
+    const std::string missing = uniqueTempPath("tadaima_merge_missing.db").string();
+    EXPECT_THROW(merger.merge(desktop, missing), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(missing));
+    EXPECT_THROW(merger.merge(desktop, desktop), std::runtime_error);
+
+    std::filesystem::remove(desktop);
+}
+
+TEST(DatabaseMergerTest, DISABLED_Throughput)
+{
+    tools::Logger logger;
+    const std::string desktop = uniqueTempPath("tadaima_merge_large_desktop.db").string();
+    const std::string laptop = uniqueTempPath("tadaima_merge_large_laptop.db").string();
+    const int lessons = 100;
+    const int wordsPerLesson = 1000;
+    {
+        ApplicationDatabase database(desktop, logger);
+        database.beginTransaction();
+        for( int l = 0; l < lessons; ++l )
+        {
+            const int lessonId = database.addLesson("Lesson " + std::to_string(l), "1", "Large");
+            for( int w = 0; w < wordsPerLesson; ++w )
+            {
+                const int wordId = database.addWord(lessonId, makeWord("kana" + std::to_string(w), "word " + std::to_string(l) + "/" + std::to_string(w), "romaji"));
+                database.addTag(wordId, "n5");
+            }
+        }
+        database.commitTransaction();
+    }
+    std::filesystem::copy_file(desktop, laptop);
+
+    // The laptop changes every tenth word and adds a new lesson of 10000 words.
+    execute(laptop, "UPDATE words SET romaji = 'changed' WHERE id % 10 = 0;");
+    {
+        ApplicationDatabase database(laptop, logger);
+        database.beginTransaction();
+        const int lessonId = database.addLesson("New", "1", "Large");
+        for( int w = 0; w < 10000; ++w )
+            database.addWord(lessonId, makeWord("new" + std::to_string(w), "new word", "romaji"));
+        database.commitTransaction();
+    }
+
+    DatabaseMerger merger(logger);
+    const auto begin = std::chrono::steady_clock::now();
+    const DatabaseMerger::Report report = merger.merge(desktop, laptop);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    EXPECT_EQ(report.lessonsAdded, 1);
+    EXPECT_EQ(report.wordsAdded, 10000);
+    EXPECT_EQ(report.wordsUpdated, lessons * wordsPerLesson / 10);
+    std::cout << "[ THROUGHPUT ] merged " << lessons * wordsPerLesson << " words in " << seconds << " s" << std::endl;
+
+    std::filesystem::remove(desktop);
+    std::filesystem::remove(laptop);
+}
@@ -2,7 +2,9 @@
 #include "../Mocks/MockGui.h"
 #include "Application/ApplicationSettings.h"
 #include "gui/widgets/packages/LessonDataPackage.h"
+#include "gui/widgets/packages/SettingsDataPackage.h"
 #include "Gui/Widgets/LessonTreeViewWidget.h"
+#include "Gui/Widgets/ApplicationSettingsWidget.h"
 #include "Tools/Logger.h"
 
 class EventBridgeTest : public ::testing::Test
@@ -33,7 +35,7 @@ protected:
     Gui::config config;
     LoggerMock loggerMock;
     EventBridgeMock eventBridge;
-    Application mockApp;
+    MockApplication mockApp;
     MockGui mockGui;
 
     void SetUp() override
@@ -44,10 +46,12 @@ protected:
 
 TEST_F(EventBridgeTest, Initialize)
 {
-    EXPECT_CALL(mockGui, addListener(widget::Type::LessonTreeView, _)).Times(1);
-    EXPECT_CALL(mockGui, addListener(widget::Type::ApplicationSettings, _)).Times(1);
-
     eventBridge.initialize(mockApp, mockGui);
+
+    WidgetEventDispatcher& dispatcher = mockGui.getDispatcher();
+    EXPECT_EQ(dispatcher.listenerCount(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonCreated), 1u);
+    EXPECT_EQ(dispatcher.listenerCount(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonsImported), 1u);
+    EXPECT_EQ(dispatcher.listenerCount(widget::Type::ApplicationSettings, ApplicationSettingsWidget::OnSettingsChanged), 1u);
 }
 
 TEST_F(EventBridgeTest, InitializeGui)
@@ -60,6 +64,7 @@ TEST_F(EventBridgeTest, InitializeGui)
     EXPECT_CALL(mockGui, initializeWidget(_)).Times(1);
 
     eventBridge.initializeGui(lessons);
+    mockGui.applyPostedUpdates();
 }
 
 TEST_F(EventBridgeTest, InitializeSettings)
@@ -77,11 +82,28 @@ TEST_F(EventBridgeTest, InitializeSettings)
     EXPECT_CALL(mockGui, initializeWidget(_)).Times(1);
 
     eventBridge.initializeSettings(settings);
+    mockGui.applyPostedUpdates();
+}
+
+TEST_F(EventBridgeTest, ForwardsLessonEventsToTheApplication)
+{
+    const LessonDataPackage package(Lesson{ 1, "Group1", "Main1", "Sub1", {} });
+
+    EXPECT_CALL(mockApp, setEvent(ApplicationEvent::OnLessonCreated, _)).Times(1);
+    EXPECT_CALL(mockApp, setEvent(ApplicationEvent::OnLessonsImported, _)).Times(1);
+
+    EXPECT_EQ(mockGui.getDispatcher().emit(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonCreated, &package), 1u);
+    EXPECT_EQ(mockGui.getDispatcher().emit(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonsImported, nullptr), 1u);
 }
 
-TEST_F(EventBridgeTest, HandleEvent_NullData)
+TEST_F(EventBridgeTest, IgnoresEventsWithoutTheirPackage)
 {
-    EXPECT_THROW(eventBridge.handleEvent(nullptr), std::invalid_argument);
+    // A lesson event needs a LessonDataPackage; it is dropped without one or with a package of another type.
+    EXPECT_CALL(mockApp, setEvent(_, _)).Times(0);
+
+    const SettingsDataPackage settings;
+    EXPECT_EQ(mockGui.getDispatcher().emit(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonCreated, nullptr), 1u);
+    EXPECT_EQ(mockGui.getDispatcher().emit(widget::Type::LessonTreeView, LessonTreeViewWidget::OnLessonCreated, &settings), 1u);
 }
 
 TEST_F(EventBridgeTest, StringToWordType_ValidString)
@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+#include "dictionary/BatchTranslator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace tadaima;
+using namespace std::chrono_literals;
+
+namespace
+{
+    Word fakeTranslation(const std::string& input)
+    {
+        if( input == "broken" )
+            throw std::runtime_error("Command failed with code 1");
+        Word word;
+        word.translation = input;
+        word.kana = input == "unknown" ? "" : "かな";
+        if( input == "empty" )
+            word.translation.clear();
+        return word;
+    }
+}
+
+TEST(BatchTranslatorTest, TranslatesEveryDistinctInputOnce)
+{
+    std::atomic<int> calls = 0;
+    BatchTranslator translator([&calls](const std::string& input)
+        {
+            ++calls;
+            return fakeTranslation(input);
+        });
+
+    ASSERT_TRUE(translator.start({ "cat", "dog", "Cat ", "bird", "dog", "" }));
+    translator.wait();
+
+    auto results = translator.takeResults();
+    EXPECT_EQ(calls.load(), 3);
+    ASSERT_EQ(results.size(), 3u);
+
+    std::vector<std::string> inputs;
+    for( const auto& item : results )
+    {
+        EXPECT_TRUE(item.succeeded());
+        EXPECT_EQ(item.word.translation, item.input);
+        inputs.push_back(item.input);
+    }
+    std::sort(inputs.begin(), inputs.end());
+    EXPECT_EQ(inputs, (std::vector<std::string>{ "bird", "cat", "dog" }));
+
+    auto progress = translator.getProgress();
+    EXPECT_EQ(progress.total, 3u);
+    EXPECT_EQ(progress.completed, 3u);
+    EXPECT_EQ(progress.failed, 0u);
+    EXPECT_EQ(progress.duplicates, 2u);
+    EXPECT_FALSE(translator.isRunning());
+}
+
+TEST(BatchTranslatorTest, ReportsErrorsPerItem)
+{
+    BatchTranslator translator(fakeTranslation);
+
+    translator.start({ "cat", "broken", "empty" });
+    translator.wait();
+
+    int failed = 0;
+    for( const auto& item : translator.takeResults() )
+    {
+        if( item.input == "cat" )
+        {
+            EXPECT_TRUE(item.succeeded());
+        }
+        else
+        {
+            EXPECT_FALSE(item.succeeded());
+            ++failed;
+        }
+        if( item.input == "broken" )
+        {
+            EXPECT_EQ(item.error, "Command failed with code 1");
+        }
+    }
+    EXPECT_EQ(failed, 2);
+    EXPECT_EQ(translator.getProgress().failed, 2u);
+}
+
+TEST(BatchTranslatorTest, NeverExceedsParallelismLimit)
+{
+    std::atomic<int> running = 0;
+    std::atomic<int> peak = 0;
+    BatchTranslator translator([&](const std::string& input)
+        {
+            int now = ++running;
+            int expected = peak.load();
+            while( now > expected && !peak.compare_exchange_weak(expected, now) )
+            {
+            }
+            std::this_thread::sleep_for(5ms);
+            --running;
+            return fakeTranslation(input);
+        }, 3);
+
+    std::vector<std::string> inputs;
+    for( int index = 0; index < 30; ++index )
+    {
+        inputs.push_back("word" + std::to_string(index));
+    }
+
+    translator.start(inputs);
+    translator.wait();
+
+    EXPECT_EQ(translator.takeResults().size(), 30u);
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_GT(peak.load(), 1);
+}
+
+TEST(BatchTranslatorTest, StreamsResultsBeforeTheBatchEnds)
+{
+    std::atomic<int> callbacks = 0;
+    BatchTranslator translator([](const std::string& input)
+        {
+            if( input == "slow" )
+                std::this_thread::sleep_for(200ms);
+            return fakeTranslation(input);
+        }, 2);
+
+    translator.start({ "slow", "a", "b", "c" }, [&callbacks](const BatchTranslator::Item&) { ++callbacks; });
+
+    // The fast words come back while the slow one is still running.
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    size_t streamed = 0;
+    while( streamed < 3 && std::chrono::steady_clock::now() < deadline )
+    {
+        streamed += translator.takeResults().size();
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(streamed, 3u);
+    EXPECT_TRUE(translator.isRunning());
+
+    translator.wait();
+    EXPECT_EQ(translator.takeResults().size(), 1u);
+    EXPECT_EQ(callbacks.load(), 4);
+}
+
+TEST(BatchTranslatorTest, CancelStopsHandingOutInputs)
+{
+    BatchTranslator translator([](const std::string& input)
+        {
+            std::this_thread::sleep_for(20ms);
+            return fakeTranslation(input);
+        }, 1);
+
+    std::vector<std::string> inputs;
+    for( int index = 0; index < 50; ++index )
+    {
+        inputs.push_back("word" + std::to_string(index));
+    }
+
+    translator.start(inputs);
+    std::this_thread::sleep_for(30ms);
+    translator.cancel();
+    translator.wait();
+
+    EXPECT_LT(translator.getProgress().completed, 50u);
+    EXPECT_FALSE(translator.isRunning());
+    EXPECT_TRUE(translator.start({ "again" }));
+}
+
+TEST(BatchTranslatorTest, SplitsPastedList)
+{
+    auto words = BatchTranslator::splitList(" cat \r\ndog, bird;fish\t\n\n猫、犬 ");
+    EXPECT_EQ(words, (std::vector<std::string>{ "cat", "dog", "bird", "fish", "猫", "犬" }));
+    EXPECT_TRUE(BatchTranslator::splitList(" \n , ").empty());
+}
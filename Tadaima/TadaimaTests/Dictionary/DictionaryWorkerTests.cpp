@@ -0,0 +1,232 @@
+#include "gtest/gtest.h"
+#include "StandInWorker.h"
+#include "Tools/CancellationToken.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+using namespace tadaima;
+using namespace std::chrono_literals;
+
+namespace
+{
+    DictionaryWorker::ChannelFactory standInFactory(std::atomic<int>* spawnCount = nullptr, std::chrono::microseconds latency = 0us)
+    {
+        return [spawnCount, latency]()
+            {
+                if( spawnCount )
+                    ++(*spawnCount);
+                return std::make_unique<StandInWorkerChannel>(latency);
+            };
+    }
+}
+
+TEST(DictionaryWorkerTest, AnswersRequestOverFramedProtocol)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_EQ(worker.request("neko", 1s), "<xml>neko</xml>");
+    EXPECT_EQ(worker.request("猫 と 犬", 1s), "<xml>猫 と 犬</xml>");
+    EXPECT_EQ(worker.getState(), DictionaryWorker::State::Ready);
+}
+
+TEST(DictionaryWorkerTest, InputIsKeptOnOneLine)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_EQ(worker.request("a\nb\tc", 1s), "<xml>a b c</xml>");
+}
+
+TEST(DictionaryWorkerTest, MultiplexesConcurrentRequests)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    // Slower requests are sent first, so the replies arrive in reverse order.
+    std::vector<std::future<std::string>> futures;
+    for( int delay = 50; delay >= 0; delay -= 5 )
+    {
+        futures.push_back(worker.submit("slow:" + std::to_string(delay)));
+    }
+
+    int delay = 50;
+    for( auto& future : futures )
+    {
+        ASSERT_EQ(future.wait_for(2s), std::future_status::ready);
+        EXPECT_EQ(future.get(), "<xml>slow:" + std::to_string(delay) + "</xml>");
+        delay -= 5;
+    }
+}
+
+TEST(DictionaryWorkerTest, ErrorReplyBecomesException)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_THROW(worker.request("error", 1s), std::runtime_error);
+    EXPECT_EQ(worker.request("neko", 1s), "<xml>neko</xml>");
+}
+
+TEST(DictionaryWorkerTest, TimedOutRequestRestartsTheWorker)
+{
+    std::atomic<int> spawnCount = 0;
+    DictionaryWorker worker(standInFactory(&spawnCount));
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_THROW(worker.request("hang", 50ms), std::runtime_error);
+    EXPECT_EQ(worker.request("neko", 1s), "<xml>neko</xml>");
+    EXPECT_EQ(worker.getRestartCount(), 1);
+    EXPECT_EQ(spawnCount.load(), 2);
+}
+
+TEST(DictionaryWorkerTest, CancellingATokenFailsOnlyItsOwnRequests)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    tools::CancellationToken cancelled;
+    tools::CancellationToken other;
+    auto hung = std::async(std::launch::async, [&]() { return worker.request("hang", 5s, &cancelled); });
+    auto slow = std::async(std::launch::async, [&]() { return worker.request("slow:200", 5s, &other); });
+
+    std::this_thread::sleep_for(50ms);
+    cancelled.cancel();
+
+    ASSERT_EQ(hung.wait_for(1s), std::future_status::ready);
+    EXPECT_THROW(hung.get(), std::runtime_error);
+    EXPECT_EQ(slow.get(), "<xml>slow:200</xml>");
+
+    // A cancelled token fails new requests right away until it is reset.
+    EXPECT_THROW(worker.request("neko", 1s, &cancelled), std::runtime_error);
+    cancelled.reset();
+    EXPECT_EQ(worker.request("neko", 1s, &cancelled), "<xml>neko</xml>");
+}
+
+TEST(DictionaryWorkerTest, RestartsAfterCrashAndResendsPendingRequests)
+{
+    std::atomic<int> spawnCount = 0;
+    DictionaryWorker worker([&spawnCount]()
+        {
+            // The first worker dies as soon as it has received two requests.
+            return std::make_unique<StandInWorkerChannel>(0us, true, ++spawnCount == 1 ? 2 : 0);
+        });
+    ASSERT_TRUE(worker.start(1s));
+
+    auto first = worker.submit("inu");
+    auto second = worker.submit("neko");
+
+    ASSERT_EQ(first.wait_for(2s), std::future_status::ready);
+    ASSERT_EQ(second.wait_for(2s), std::future_status::ready);
+    EXPECT_EQ(first.get(), "<xml>inu</xml>");
+    EXPECT_EQ(second.get(), "<xml>neko</xml>");
+    EXPECT_EQ(worker.getRestartCount(), 1);
+    EXPECT_EQ(spawnCount.load(), 2);
+}
+
+TEST(DictionaryWorkerTest, RequestsAroundTheStartAreSentOnce)
+{
+    for( int round = 0; round < 200; ++round )
+    {
+        // The worker dies on a third request, so a request sent twice shows as a restart.
+        std::atomic<int> spawnCount = 0;
+        DictionaryWorker worker([&spawnCount]() { return std::make_unique<StandInWorkerChannel>(0us, true, ++spawnCount == 1 ? 3 : 0); });
+
+        // One request waits for the worker, the other one races with the reader sending the waiting ones.
+        auto waiting = worker.submit("inu");
+        ASSERT_TRUE(worker.start(1s));
+        auto racing = worker.submit("neko");
+
+        ASSERT_EQ(waiting.wait_for(2s), std::future_status::ready);
+        ASSERT_EQ(racing.wait_for(2s), std::future_status::ready);
+        EXPECT_EQ(waiting.get(), "<xml>inu</xml>");
+        EXPECT_EQ(racing.get(), "<xml>neko</xml>");
+        ASSERT_EQ(worker.getRestartCount(), 0) << "round " << round;
+    }
+}
+
+TEST(DictionaryWorkerTest, InputThatCrashesTheWorkerFailsAfterOneRetry)
+{
+    std::atomic<int> spawnCount = 0;
+    DictionaryWorker worker(standInFactory(&spawnCount));
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_THROW(worker.request("crash", 2s), std::runtime_error);
+
+    EXPECT_EQ(worker.request("neko", 1s), "<xml>neko</xml>");
+    EXPECT_EQ(worker.getRestartCount(), 2);
+    EXPECT_EQ(spawnCount.load(), 3);
+}
+
+TEST(DictionaryWorkerTest, GivesUpAfterTooManyCrashes)
+{
+    DictionaryWorker worker(standInFactory(), 1);
+    ASSERT_TRUE(worker.start(1s));
+
+    EXPECT_THROW(worker.request("crash", 2s), std::runtime_error);
+    EXPECT_THROW(worker.request("crash", 2s), std::runtime_error);
+    EXPECT_EQ(worker.getState(), DictionaryWorker::State::Failed);
+    EXPECT_THROW(worker.request("neko", 1s), std::runtime_error);
+}
+
+TEST(DictionaryWorkerTest, ScriptWithoutWorkerSupportIsNotUsed)
+{
+    DictionaryWorker worker([]() { return std::make_unique<StandInWorkerChannel>(0us, false); });
+
+    EXPECT_FALSE(worker.start(1s));
+    EXPECT_EQ(worker.getState(), DictionaryWorker::State::Failed);
+}
+
+TEST(DictionaryWorkerTest, FailedSpawnIsNotUsed)
+{
+    DictionaryWorker worker([]() { return std::unique_ptr<WorkerChannel>(); });
+
+    EXPECT_FALSE(worker.start(1s));
+    EXPECT_THROW(worker.request("neko", 1s), std::runtime_error);
+}
+
+TEST(DictionaryWorkerTest, StopFailsOutstandingRequests)
+{
+    DictionaryWorker worker(standInFactory());
+    ASSERT_TRUE(worker.start(1s));
+
+    auto pending = worker.submit("hang");
+    worker.stop();
+
+    ASSERT_EQ(pending.wait_for(1s), std::future_status::ready);
+    EXPECT_THROW(pending.get(), std::runtime_error);
+}
+
+TEST(DictionaryWorkerTest, LatencyAgainstStandInWorker)
+{
+    constexpr int requests = 500;
+    std::atomic<int> spawnCount = 0;
+    DictionaryWorker worker(standInFactory(&spawnCount));
+    ASSERT_TRUE(worker.start(1s));
+
+    std::vector<double> latencies;
+    latencies.reserve(requests);
+    for( int index = 0; index < requests; ++index )
+    {
+        auto begin = std::chrono::steady_clock::now();
+        worker.request("word" + std::to_string(index), 1s);
+        latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double mean = 0;
+    for( double latency : latencies )
+    {
+        mean += latency;
+    }
+    mean /= requests;
+    const double p99 = latencies[requests * 99 / 100];
+
+    std::cout << "[ LATENCY  ] " << requests << " requests, mean " << mean << " us, median "
+              << latencies[requests / 2] << " us, p99 " << p99 << " us" << std::endl;
+
+    // One process serves every request, and the round trip itself is far below a process start.
+    EXPECT_EQ(spawnCount.load(), 1);
+    EXPECT_LT(mean, 5000.0);
+}
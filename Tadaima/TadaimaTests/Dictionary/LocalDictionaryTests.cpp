@@ -0,0 +1,154 @@
+#include "gtest/gtest.h"
+#include "dictionary/LocalDictionary.h"
+#include "dictionary/JMdictImporter.h"
+#include "dictionary/Transliterator.h"
+#include <sstream>
+#include <stdexcept>
+
+using namespace tadaima;
+
+namespace
+{
+    const char* const JMDICT_SAMPLE =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE JMdict [\n"
+        "<!ENTITY n \"noun (common) (futsuumeishi)\">\n"
+        "<!ENTITY v1 \"Ichidan verb\">\n"
+        "]>\n"
+        "<JMdict>\n"
+        "<entry><ent_seq>1467640</ent_seq>\n"
+        "<k_ele><keb>猫</keb><ke_pri>ichi1</ke_pri></k_ele>\n"
+        "<k_ele><keb>ネコ</keb></k_ele>\n"
+        "<r_ele><reb>ねこ</reb><re_pri>ichi1</re_pri></r_ele>\n"
+        "<sense><pos>&n;</pos><gloss>cat (esp. the domestic cat)</gloss><gloss xml:lang=\"ger\">Katze</gloss></sense>\n"
+        "<sense><gloss>shamisen</gloss></sense>\n"
+        "</entry>\n"
+        "<entry><ent_seq>2000001</ent_seq>\n"
+        "<r_ele><reb>ねこ</reb></r_ele>\n"
+        "<sense><pos>&n;</pos><gloss>wheelbarrow</gloss></sense>\n"
+        "</entry>\n"
+        "<entry><ent_seq>1358280</ent_seq>\n"
+        "<k_ele><keb>食べる</keb><ke_pri>news1</ke_pri></k_ele>\n"
+        "<r_ele><reb>たべる</reb></r_ele>\n"
+        "<sense><pos>&v1;</pos><gloss>to eat</gloss></sense>\n"
+        "</entry>\n"
+        "<entry><ent_seq>9999999</ent_seq>\n"
+        "<r_ele><reb>だめ</reb></r_ele>\n"
+        "<sense><gloss xml:lang=\"fre\">mauvais</gloss></sense>\n"
+        "</entry>\n"
+        "</JMdict>\n";
+
+    const char* const KANJIDIC_SAMPLE =
+        "<kanjidic2>\n"
+        "<header><file_version>4</file_version></header>\n"
+        "<character><literal>犬</literal><misc><grade>1</grade><jlpt>4</jlpt></misc>\n"
+        "<reading_meaning><rmgroup>\n"
+        "<reading r_type=\"pinyin\">quan3</reading><reading r_type=\"ja_on\">ケン</reading><reading r_type=\"ja_kun\">いぬ</reading>\n"
+        "<meaning>dog</meaning><meaning m_lang=\"fr\">chien</meaning>\n"
+        "</rmgroup></reading_meaning></character>\n"
+        "</kanjidic2>\n";
+
+    JMdictImporter::Result importText(LocalDictionary& dictionary, const std::string& text)
+    {
+        std::istringstream input(text);
+        return JMdictImporter::importStream(input, dictionary);
+    }
+}
+
+TEST(TransliteratorTest, ConvertsKanaToHepburn)
+{
+    EXPECT_EQ(Transliterator::toRomaji("ねこ"), "neko");
+    EXPECT_EQ(Transliterator::toRomaji("きょう"), "kyou");
+    EXPECT_EQ(Transliterator::toRomaji("しゃしん"), "shashin");
+    EXPECT_EQ(Transliterator::toRomaji("がっこう"), "gakkou");
+    EXPECT_EQ(Transliterator::toRomaji("まっちゃ"), "matcha");
+    EXPECT_EQ(Transliterator::toRomaji("きんえん"), "kin'en");
+    EXPECT_EQ(Transliterator::toRomaji("ほんや"), "hon'ya");
+    EXPECT_EQ(Transliterator::toRomaji("ラーメン"), "raamen");
+    EXPECT_EQ(Transliterator::toRomaji("パーティー"), "paatii");
+    EXPECT_EQ(Transliterator::toRomaji("ファイル"), "fairu");
+    EXPECT_EQ(Transliterator::toRomaji("ジェット"), "jetto");
+    EXPECT_EQ(Transliterator::toRomaji("ウィキ"), "wiki");
+    EXPECT_EQ(Transliterator::toRomaji("CDを"), "CDo");
+}
+
+TEST(LocalDictionaryTest, ImportsJMdictAndLooksUpEveryForm)
+{
+    LocalDictionary dictionary(":memory:");
+    ASSERT_TRUE(dictionary.isOpen());
+
+    auto result = importText(dictionary, JMDICT_SAMPLE);
+    EXPECT_EQ(result.entries, 3);
+    EXPECT_EQ(dictionary.getEntryCount(), 3);
+
+    for( const char* query : { "猫", "ネコ", "ねこ", "neko", "cat", "Cat (esp. the domestic cat)", "  CAT " } )
+    {
+        auto word = dictionary.lookup(query);
+        ASSERT_TRUE(word.has_value()) << query;
+        EXPECT_EQ(word->kanji, "猫") << query;
+        EXPECT_EQ(word->kana, "ねこ");
+        EXPECT_EQ(word->romaji, "neko");
+        EXPECT_EQ(word->translation, "cat (esp. the domestic cat)");
+    }
+
+    auto eat = dictionary.lookup("eat");
+    ASSERT_TRUE(eat.has_value());
+    EXPECT_EQ(eat->kanji, "食べる");
+    EXPECT_EQ(eat->romaji, "taberu");
+
+    EXPECT_FALSE(dictionary.lookup("dog").has_value());
+    EXPECT_FALSE(dictionary.lookup("だめ").has_value());
+}
+
+TEST(LocalDictionaryTest, CommonWordsComeFirstAndSensesKeepTheirPartOfSpeech)
+{
+    LocalDictionary dictionary(":memory:");
+    importText(dictionary, JMDICT_SAMPLE);
+
+    auto entries = dictionary.findEntries("ねこ");
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_TRUE(entries[0].common);
+    EXPECT_EQ(entries[0].senses, "cat (esp. the domestic cat) / shamisen");
+    EXPECT_EQ(entries[0].partOfSpeech, "noun (common) (futsuumeishi)");
+    EXPECT_FALSE(entries[1].common);
+    EXPECT_EQ(entries[1].gloss, "wheelbarrow");
+}
+
+TEST(LocalDictionaryTest, ImportsKanjidicAndAnswersSingleKanji)
+{
+    LocalDictionary dictionary(":memory:");
+    importText(dictionary, JMDICT_SAMPLE);
+
+    auto result = importText(dictionary, KANJIDIC_SAMPLE);
+    EXPECT_EQ(result.kanji, 1);
+    EXPECT_EQ(dictionary.getEntryCount(), 3); // The word entries are kept.
+
+    auto kanji = dictionary.findKanji("犬");
+    ASSERT_TRUE(kanji.has_value());
+    EXPECT_EQ(kanji->onyomi, "ケン");
+    EXPECT_EQ(kanji->kunyomi, "いぬ");
+    EXPECT_EQ(kanji->meanings, "dog");
+    EXPECT_EQ(kanji->grade, 1);
+    EXPECT_EQ(kanji->jlpt, 4);
+
+    auto word = dictionary.lookup("犬");
+    ASSERT_TRUE(word.has_value());
+    EXPECT_EQ(word->kana, "いぬ");
+    EXPECT_EQ(word->romaji, "inu");
+    EXPECT_EQ(word->translation, "dog");
+}
+
+TEST(LocalDictionaryTest, FailedOrCancelledImportKeepsThePreviousDictionary)
+{
+    LocalDictionary dictionary(":memory:");
+    importText(dictionary, JMDICT_SAMPLE);
+
+    EXPECT_THROW(importText(dictionary, "<JMdict><entry><reb>いぬ</reb></JMdict>"), std::runtime_error);
+    EXPECT_THROW(importText(dictionary, "<lessons></lessons>"), std::runtime_error);
+
+    std::istringstream input(JMDICT_SAMPLE);
+    EXPECT_THROW(JMdictImporter::importStream(input, dictionary, [](uint64_t) { return false; }), std::runtime_error);
+
+    EXPECT_EQ(dictionary.getEntryCount(), 3);
+    EXPECT_TRUE(dictionary.lookup("cat").has_value());
+}
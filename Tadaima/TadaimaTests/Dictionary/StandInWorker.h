@@ -0,0 +1,183 @@
+#pragma once
+
+#include "dictionary/DictionaryWorker.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class StandInWorkerChannel
+ * @brief In-process stand-in for a dictionary script running with `--worker`.
+ *
+ * Speaks the worker protocol over in-memory pipes. The reply to an input is `<xml>input</xml>`,
+ * except for a few magic inputs:
+ * - `crash` closes the stream like a dying process,
+ * - `error` answers with an ERR reply,
+ * - `hang` never answers,
+ * - `slow:<ms>` answers after the given delay on its own thread, so replies come out of order.
+ */
+class StandInWorkerChannel : public tadaima::WorkerChannel
+{
+public:
+    /**
+     * @param latency Delay added to every ordinary reply.
+     * @param sendBanner When false the stand-in behaves like a script without worker support.
+     * @param crashAfterRequests When positive, the stand-in dies without answering once it received that many requests.
+     */
+    explicit StandInWorkerChannel(std::chrono::microseconds latency = std::chrono::microseconds(0), bool sendBanner = true, int crashAfterRequests = 0)
+        : m_latency(latency), m_crashAfterRequests(crashAfterRequests)
+    {
+        if( sendBanner )
+            m_toParent.push(std::string(tadaima::DictionaryWorker::PROTOCOL_BANNER) + "\n");
+        else
+            m_toParent.push("<translation><trs>--worker</trs></translation>\n");
+
+        if( !sendBanner )
+            m_toParent.close();
+        else
+            m_thread = std::thread(&StandInWorkerChannel::serve, this);
+    }
+
+    ~StandInWorkerChannel() override
+    {
+        close();
+    }
+
+    bool write(const std::string& data) override
+    {
+        return m_toWorker.push(data);
+    }
+
+    int read(char* buffer, size_t size) override
+    {
+        return m_toParent.pop(buffer, size);
+    }
+
+    void close() override
+    {
+        std::lock_guard<std::mutex> closeLock(m_closeMutex);
+        m_toWorker.close();
+        m_toParent.close();
+        if( m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id() )
+            m_thread.join();
+        std::lock_guard<std::mutex> lock(m_slowMutex);
+        for( auto& thread : m_slowReplies )
+        {
+            if( thread.joinable() )
+                thread.join();
+        }
+        m_slowReplies.clear();
+    }
+
+private:
+
+    class Pipe
+    {
+    public:
+        bool push(const std::string& data)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if( m_closed )
+                return false;
+            m_data += data;
+            m_ready.notify_all();
+            return true;
+        }
+
+        int pop(char* buffer, size_t size)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this] { return !m_data.empty() || m_closed; });
+            if( m_data.empty() )
+                return 0;
+            size_t count = std::min(size, m_data.size());
+            m_data.copy(buffer, count);
+            m_data.erase(0, count);
+            return static_cast<int>(count);
+        }
+
+        bool popLine(std::string& line)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_ready.wait(lock, [this] { return m_data.find('\n') != std::string::npos || m_closed; });
+            size_t end = m_data.find('\n');
+            if( end == std::string::npos )
+                return false;
+            line = m_data.substr(0, end);
+            m_data.erase(0, end + 1);
+            return true;
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_ready.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_ready;
+        std::string m_data;
+        bool m_closed = false;
+    };
+
+    void reply(const std::string& id, const std::string& status, const std::string& payload)
+    {
+        m_toParent.push(id + " " + status + " " + std::to_string(payload.size()) + "\n" + payload);
+    }
+
+    void serve()
+    {
+        std::string line;
+        while( m_toWorker.popLine(line) )
+        {
+            size_t tab = line.find('\t');
+            std::string id = line.substr(0, tab);
+            std::string input = line.substr(tab + 1);
+
+            if( input == "crash" || ++m_received == m_crashAfterRequests )
+            {
+                m_toParent.close();
+                return;
+            }
+            if( input == "hang" )
+                continue;
+            if( input == "error" )
+            {
+                reply(id, "ERR", "No result for error");
+                continue;
+            }
+            if( input.rfind("slow:", 0) == 0 )
+            {
+                auto delay = std::chrono::milliseconds(std::stoi(input.substr(5)));
+                std::lock_guard<std::mutex> lock(m_slowMutex);
+                m_slowReplies.emplace_back([this, id, input, delay]()
+                    {
+                        std::this_thread::sleep_for(delay);
+                        reply(id, "OK", "<xml>" + input + "</xml>");
+                    });
+                continue;
+            }
+
+            if( m_latency.count() > 0 )
+                std::this_thread::sleep_for(m_latency);
+            reply(id, "OK", "<xml>" + input + "</xml>");
+        }
+    }
+
+    std::chrono::microseconds m_latency;
+    int m_crashAfterRequests;
+    int m_received = 0;
+    Pipe m_toWorker;
+    Pipe m_toParent;
+    std::thread m_thread;
+    std::mutex m_closeMutex;
+    std::mutex m_slowMutex;
+    std::vector<std::thread> m_slowReplies;
+};
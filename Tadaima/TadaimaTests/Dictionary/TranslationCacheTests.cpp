@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "dictionary/TranslationCache.h"
+#include "../Mocks/TempFiles.h"
+#include <filesystem>
+
+using namespace tadaima;
+
+namespace
+{
+    Word makeWord()
+    {
+        Word word;
+        word.kana = "ねこ";
+        word.kanji = "猫";
+        word.translation = "cat";
+        word.romaji = "neko";
+        word.exampleSentence = "猫が好きです。";
+        return word;
+    }
+}
+
+TEST(TranslationCacheTest, MissThenHitAfterStore)
+{
+    TranslationCache cache(":memory:");
+    ASSERT_TRUE(cache.isOpen());
+
+    EXPECT_FALSE(cache.findTranslation("Tangorin.py", "cat").has_value());
+
+    cache.storeTranslation("Tangorin.py", "cat", makeWord());
+    auto cached = cache.findTranslation("Tangorin.py", "cat");
+
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->kana, "ねこ");
+    EXPECT_EQ(cached->kanji, "猫");
+    EXPECT_EQ(cached->translation, "cat");
+    EXPECT_EQ(cached->romaji, "neko");
+    EXPECT_EQ(cached->exampleSentence, "猫が好きです。");
+
+    auto statistics = cache.getStatistics();
+    EXPECT_EQ(statistics.hits, 1u);
+    EXPECT_EQ(statistics.misses, 1u);
+    EXPECT_EQ(statistics.stores, 1u);
+    EXPECT_DOUBLE_EQ(statistics.hitRatio(), 0.5);
+}
+
+TEST(TranslationCacheTest, KeyIsNormalizedAndScriptSpecific)
+{
+    TranslationCache cache(":memory:");
+    cache.storeTranslation("Tangorin.py", "  Black   Cat ", makeWord());
+
+    EXPECT_TRUE(cache.findTranslation("Tangorin.py", "black cat").has_value());
+    EXPECT_FALSE(cache.findTranslation("takoboto.py", "black cat").has_value());
+    EXPECT_EQ(TranslationCache::normalizeInput("\tNEKO\n"), "neko");
+    EXPECT_EQ(TranslationCache::normalizeInput("ネコ"), "ネコ");
+}
+
+TEST(TranslationCacheTest, ConjugationsRoundTrip)
+{
+    TranslationCache cache(":memory:");
+    std::array<std::string, CONJUGATION_COUNT> conjugations;
+    for( int index = 0; index < CONJUGATION_COUNT; ++index )
+    {
+        conjugations[index] = "form" + std::to_string(index);
+    }
+    conjugations[3] = "";
+
+    cache.storeConjugations("Conjugation.py", "taberu", conjugations);
+    auto cached = cache.findConjugations("Conjugation.py", "taberu");
+
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(*cached, conjugations);
+    EXPECT_FALSE(cache.findTranslation("Conjugation.py", "taberu").has_value());
+}
+
+TEST(TranslationCacheTest, ExpiredEntriesAreMissesAndPurged)
+{
+    TranslationCache cache(":memory:");
+    cache.storeTranslation("Tangorin.py", "cat", makeWord());
+
+    cache.setTimeToLive(std::chrono::seconds(-1));
+    EXPECT_FALSE(cache.findTranslation("Tangorin.py", "cat").has_value());
+    EXPECT_EQ(cache.getStatistics().expired, 1u);
+    EXPECT_EQ(cache.purgeExpired(), 1);
+
+    cache.setTimeToLive(TranslationCache::DEFAULT_TIME_TO_LIVE);
+    EXPECT_FALSE(cache.findTranslation("Tangorin.py", "cat").has_value());
+}
+
+TEST(TranslationCacheTest, EntriesPersistAcrossInstances)
+{
+    const auto path = uniqueTempPath("tadaima_translation_cache_test.db").string();
+
+    {
+        TranslationCache cache(path);
+        cache.storeTranslation("Tangorin.py", "cat", makeWord());
+    }
+    {
+        TranslationCache cache(path);
+        auto cached = cache.findTranslation("Tangorin.py", "cat");
+        ASSERT_TRUE(cached.has_value());
+        EXPECT_EQ(cached->romaji, "neko");
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,190 @@
+#include "gtest/gtest.h"
+#include "Gui/FontAtlasCache.h"
+#include "Gui/GlyphSet.h"
+#include "imgui.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using tadaima::gui::FontAtlasCache;
+using tadaima::gui::GlyphSet;
+
+namespace
+{
+    // The settings Gui uses for its fonts.
+    ImFontConfig makeConfig()
+    {
+        ImFontConfig config;
+        config.OversampleH = 3;
+        config.OversampleV = 3;
+        config.PixelSnapH = true;
+        config.SizePixels = 17.0f;
+        return config;
+    }
+
+    std::unique_ptr<ImFontAtlas> makeAtlas(GlyphSet& glyphs, float size = 17.0f)
+    {
+        auto atlas = std::make_unique<ImFontAtlas>();
+        ImFontConfig config = makeConfig();
+        config.SizePixels = size;
+        config.GlyphRanges = glyphs.ranges();
+        atlas->AddFontDefault(&config);
+        return atlas;
+    }
+
+    // The Japanese font is copied next to the executable by the build; the benchmark needs it.
+    std::string findJapaneseFont()
+    {
+        for( const char* directory : { "fonts", "../resources", "../../resources", "resources" } )
+        {
+            const std::filesystem::path path = std::filesystem::path(directory) / "NotoSansJP-Regular.ttf";
+            if( std::filesystem::exists(path) )
+                return path.string();
+        }
+        return {};
+    }
+
+    class FontAtlasCacheTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            m_directory = std::filesystem::temp_directory_path() / ("tadaima_atlas_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        }
+
+        void TearDown() override
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_directory, error);
+        }
+
+        size_t fileCount() const
+        {
+            size_t count = 0;
+            for( [[maybe_unused]] const auto& entry : std::filesystem::directory_iterator(m_directory) )
+                ++count;
+            return count;
+        }
+
+        std::filesystem::path m_directory;
+    };
+}
+
+TEST_F(FontAtlasCacheTest, LoadsTheAtlasItBuilt)
+{
+    FontAtlasCache cache(m_directory.string());
+    GlyphSet glyphs;
+    glyphs.addText("Tadaima! Lessons 0123456789");
+
+    const auto built = makeAtlas(glyphs);
+    const FontAtlasCache::Stats builtStats = cache.build(*built);
+    EXPECT_FALSE(builtStats.fromCache);
+    EXPECT_TRUE(std::filesystem::exists(cache.filePath(FontAtlasCache::key(*makeAtlas(glyphs)))));
+
+    const auto loaded = makeAtlas(glyphs);
+    const FontAtlasCache::Stats loadedStats = cache.build(*loaded);
+    EXPECT_TRUE(loadedStats.fromCache);
+    EXPECT_TRUE(loaded->IsBuilt());
+    EXPECT_EQ(loadedStats.glyphs, builtStats.glyphs);
+    EXPECT_EQ(loadedStats.textureBytes, builtStats.textureBytes);
+
+    ASSERT_EQ(loaded->TexWidth, built->TexWidth);
+    ASSERT_EQ(loaded->TexHeight, built->TexHeight);
+    EXPECT_EQ(std::memcmp(loaded->TexPixelsAlpha8, built->TexPixelsAlpha8, static_cast<size_t>(built->TexWidth) * built->TexHeight), 0);
+    EXPECT_EQ(loaded->TexUvWhitePixel.x, built->TexUvWhitePixel.x);
+    EXPECT_EQ(loaded->TexUvWhitePixel.y, built->TexUvWhitePixel.y);
+    EXPECT_EQ(std::memcmp(loaded->TexUvLines, built->TexUvLines, sizeof(built->TexUvLines)), 0);
+
+    const ImFont* builtFont = built->Fonts[0];
+    const ImFont* loadedFont = loaded->Fonts[0];
+    EXPECT_EQ(loadedFont->FontSize, builtFont->FontSize);
+    EXPECT_EQ(loadedFont->Ascent, builtFont->Ascent);
+    EXPECT_EQ(loadedFont->Descent, builtFont->Descent);
+    ASSERT_EQ(loadedFont->Glyphs.Size, builtFont->Glyphs.Size);
+    EXPECT_EQ(std::memcmp(loadedFont->Glyphs.Data, builtFont->Glyphs.Data, sizeof(ImFontGlyph) * builtFont->Glyphs.Size), 0);
+    EXPECT_EQ(loadedFont->FindGlyph('T')->AdvanceX, builtFont->FindGlyph('T')->AdvanceX);
+    EXPECT_EQ(loadedFont->FallbackGlyph->Codepoint, builtFont->FallbackGlyph->Codepoint);
+    EXPECT_EQ(loadedFont->CalcTextSizeA(17.0f, FLT_MAX, 0.0f, "Lessons").x, builtFont->CalcTextSizeA(17.0f, FLT_MAX, 0.0f, "Lessons").x);
+}
+
+TEST_F(FontAtlasCacheTest, KeyDependsOnGlyphsAndSize)
+{
+    GlyphSet glyphs;
+    glyphs.addText("abc");
+    const std::string key = FontAtlasCache::key(*makeAtlas(glyphs));
+
+    EXPECT_EQ(FontAtlasCache::key(*makeAtlas(glyphs)), key);
+    EXPECT_NE(FontAtlasCache::key(*makeAtlas(glyphs, 18.0f)), key);
+    glyphs.addText("d");
+    EXPECT_NE(FontAtlasCache::key(*makeAtlas(glyphs)), key);
+}
+
+TEST_F(FontAtlasCacheTest, RebuildsOverADamagedFile)
+{
+    FontAtlasCache cache(m_directory.string());
+    GlyphSet glyphs;
+    glyphs.addText("abc");
+    cache.build(*makeAtlas(glyphs));
+
+    const std::string path = cache.filePath(FontAtlasCache::key(*makeAtlas(glyphs)));
+    const auto size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size / 2);
+
+    const auto atlas = makeAtlas(glyphs);
+    EXPECT_FALSE(cache.build(*atlas).fromCache);
+    EXPECT_TRUE(atlas->IsBuilt());
+    EXPECT_EQ(std::filesystem::file_size(path), size);
+    EXPECT_TRUE(cache.build(*makeAtlas(glyphs)).fromCache);
+}
+
+TEST_F(FontAtlasCacheTest, KeepsOnlyTheRecentAtlases)
+{
+    FontAtlasCache cache(m_directory.string());
+    GlyphSet glyphs;
+    for( char c = 'a'; c < 'a' + 6; ++c )
+    {
+        glyphs.addText(std::string(1, c));
+        cache.build(*makeAtlas(glyphs));
+    }
+    EXPECT_EQ(fileCount(), FontAtlasCache::KEPT_FILES);
+    EXPECT_TRUE(cache.build(*makeAtlas(glyphs)).fromCache);
+}
+
+TEST_F(FontAtlasCacheTest, StartupWithTheGlyphsOfADeck)
+{
+    const std::string fontPath = findJapaneseFont();
+    if( fontPath.empty() )
+        GTEST_SKIP() << "NotoSansJP-Regular.ttf not found";
+
+    FontAtlasCache cache(m_directory.string());
+    const auto measure = [&cache, &fontPath](const ImWchar* ranges)
+        {
+            ImFontAtlas atlas;
+            ImFontConfig config = makeConfig();
+            atlas.AddFontFromFileTTF(fontPath.c_str(), config.SizePixels, &config, ranges);
+            return cache.build(atlas);
+        };
+
+    // Before: kana and the whole block of common kanji, as Gui baked them.
+    static const ImWchar allKanji[] = { 0x0020, 0x007F, 0x3000, 0x30FF, 0x4E00, 0x9FAF, 0 };
+    const FontAtlasCache::Stats before = measure(allKanji);
+
+    // After: kana and the 2000 kanji of a large deck.
+    GlyphSet glyphs;
+    glyphs.addRange(0x0020, 0x007F);
+    glyphs.addRange(0x3000, 0x30FF);
+    for( ImWchar kanji = 0x4E00; glyphs.size() < 0x60 + 0x100 + 2000; kanji += 7 )
+        glyphs.addRange(kanji, kanji);
+    const FontAtlasCache::Stats built = measure(glyphs.ranges());
+    const FontAtlasCache::Stats loaded = measure(glyphs.ranges());
+
+    EXPECT_TRUE(loaded.fromCache);
+    EXPECT_LT(built.textureBytes, before.textureBytes);
+    std::cout << "[ LATENCY ] Font atlas of all kanji: " << before.toString() << std::endl;
+    std::cout << "[ LATENCY ] Font atlas of a deck: " << built.toString() << std::endl;
+    std::cout << "[ LATENCY ] Font atlas of a deck: " << loaded.toString() << std::endl;
+}
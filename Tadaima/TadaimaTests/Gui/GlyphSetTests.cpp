@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "Gui/GlyphSet.h"
+#include <vector>
+
+using tadaima::Lesson;
+using tadaima::Word;
+using tadaima::gui::GlyphSet;
+using tadaima::gui::GlyphRequests;
+
+namespace
+{
+    std::vector<ImWchar> toVector(const ImWchar* ranges)
+    {
+        std::vector<ImWchar> values;
+        for( ; *ranges; ++ranges )
+            values.push_back(*ranges);
+        return values;
+    }
+}
+
+TEST(GlyphSetTest, ReportsOnlyNewCharacters)
+{
+    GlyphSet glyphs;
+    EXPECT_TRUE(glyphs.addText("ねこ 猫"));
+    EXPECT_EQ(glyphs.size(), 4u);
+    EXPECT_TRUE(glyphs.contains(0x732B));
+    EXPECT_TRUE(glyphs.contains(' '));
+
+    EXPECT_FALSE(glyphs.addText("猫ね"));
+    EXPECT_TRUE(glyphs.addText("犬"));
+    EXPECT_EQ(glyphs.size(), 5u);
+}
+
+TEST(GlyphSetTest, MergesNeighbouringCharactersIntoRanges)
+{
+    GlyphSet glyphs;
+    glyphs.addRange('a', 'c');
+    glyphs.addText("dx");
+    EXPECT_EQ(toVector(glyphs.ranges()), (std::vector<ImWchar>{ 'a', 'd', 'x', 'x' }));
+
+    glyphs.addText("y");
+    EXPECT_EQ(toVector(glyphs.ranges()), (std::vector<ImWchar>{ 'a', 'd', 'x', 'y' }));
+}
+
+TEST(GlyphSetTest, SkipsControlCharactersAndCharactersOutsideTheBmp)
+{
+    GlyphSet glyphs;
+    EXPECT_FALSE(glyphs.addText("\n\t"));
+    EXPECT_FALSE(glyphs.addText("\xF0\x9F\x98\x80"));
+    EXPECT_EQ(glyphs.size(), 0u);
+    EXPECT_EQ(toVector(glyphs.ranges()), std::vector<ImWchar>());
+}
+
+TEST(GlyphSetTest, CollectsTheTextOfLessons)
+{
+    Lesson lesson;
+    lesson.groupName = "Genki";
+    lesson.mainName = "1";
+    lesson.subName = "1";
+    Word word;
+    word.kana = "たべる";
+    word.kanji = "食べる";
+    word.translation = "eat";
+    word.conjugations[0] = "食べます";
+    lesson.words.push_back(word);
+
+    GlyphSet glyphs;
+    EXPECT_TRUE(glyphs.addLessons({ lesson }));
+    EXPECT_TRUE(glyphs.contains(0x98DF));
+    EXPECT_TRUE(glyphs.contains(0x307E));
+    EXPECT_TRUE(glyphs.contains('G'));
+    EXPECT_FALSE(glyphs.addLessons({ lesson }));
+}
+
+TEST(GlyphSetTest, AddsTheCharactersOfAnEditBuffer)
+{
+    GlyphSet glyphs;
+    const ImWchar typed[] = { 0x732B, 'a', 0x732B };
+    EXPECT_TRUE(glyphs.addCharacters(typed, 3));
+    EXPECT_EQ(glyphs.size(), 2u);
+    EXPECT_FALSE(glyphs.addCharacters(typed, 1));
+}
+
+TEST(GlyphSetTest, RequestsKeepOnlyTextBeyondAscii)
+{
+    GlyphRequests::take();
+    Word word;
+    word.kana = "ねこ";
+    word.kanji = "猫";
+    word.translation = "cat";
+    GlyphRequests::add(word);
+    GlyphRequests::add("plain ascii");
+
+    GlyphSet glyphs;
+    EXPECT_TRUE(glyphs.addText(GlyphRequests::take()));
+    EXPECT_EQ(glyphs.size(), 3u);
+    EXPECT_TRUE(glyphs.contains(0x732B));
+    EXPECT_TRUE(GlyphRequests::take().empty());
+}
@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+#include "Gui/GuiUpdateQueue.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using tadaima::gui::GuiUpdateQueue;
+
+TEST(GuiUpdateQueueTest, AppliesUpdatesInOrderOnlyWhenAsked)
+{
+    GuiUpdateQueue queue;
+    std::vector<int> applied;
+    for( int i = 0; i < 5; ++i )
+        queue.post([&applied, i]() { applied.push_back(i); });
+
+    EXPECT_TRUE(applied.empty());
+    EXPECT_EQ(queue.pending(), 5u);
+    EXPECT_EQ(queue.apply(), 5u);
+    EXPECT_EQ(applied, (std::vector<int>{ 0, 1, 2, 3, 4 }));
+    EXPECT_EQ(queue.apply(), 0u);
+}
+
+TEST(GuiUpdateQueueTest, BudgetLeavesTheRestForTheNextFrame)
+{
+    GuiUpdateQueue queue;
+    std::vector<int> applied;
+    for( int i = 0; i < 3; ++i )
+    {
+        queue.post([&applied, i]()
+            {
+                applied.push_back(i);
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            });
+    }
+
+    // Each update takes longer than the budget, so one runs per frame; newer updates wait behind the old ones.
+    EXPECT_EQ(queue.apply(std::chrono::microseconds(1000)), 1u);
+    queue.post([&applied]() { applied.push_back(3); });
+    EXPECT_EQ(queue.pending(), 3u);
+    EXPECT_EQ(queue.apply(std::chrono::microseconds(1000)), 1u);
+    EXPECT_EQ(queue.apply(std::chrono::microseconds(1000)), 1u);
+    EXPECT_EQ(queue.apply(), 1u);
+    EXPECT_EQ(applied, (std::vector<int>{ 0, 1, 2, 3 }));
+}
+
+TEST(GuiUpdateQueueTest, ThrowingUpdateIsDroppedAndTheOthersStay)
+{
+    GuiUpdateQueue queue;
+    int applied = 0;
+    queue.post([]() { throw std::runtime_error("broken package"); });
+    queue.post([&applied]() { ++applied; });
+
+    EXPECT_THROW(queue.apply(), std::runtime_error);
+    EXPECT_EQ(queue.pending(), 1u);
+    EXPECT_EQ(queue.apply(), 1u);
+    EXPECT_EQ(applied, 1);
+}
+
+TEST(GuiUpdateQueueTest, FramesSeeWholeUpdatesWhileAWorkerPosts)
+{
+    // The "tree" is only changed by updates, so a frame must never see it half rebuilt or going back.
+    GuiUpdateQueue queue;
+    std::vector<int> tree;
+    const int updates = 2000;
+    std::atomic<bool> done = false;
+
+    std::thread worker([&queue, &tree, &done, updates]()
+        {
+            for( int i = 1; i <= updates; ++i )
+                queue.post([&tree, i]() { tree.assign(i % 50 + 1, i); });
+            done = true;
+        });
+
+    bool consistent = true;
+    int last = 0;
+    while( !done || queue.pending() )
+    {
+        queue.apply(std::chrono::microseconds(200));
+        if( tree.empty() )
+            continue;
+        for( int value : tree )
+            consistent = consistent && value == tree.front();
+        consistent = consistent && tree.front() >= last && static_cast<int>(tree.size()) == tree.front() % 50 + 1;
+        last = tree.front();
+    }
+    worker.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(last, updates);
+}
@@ -0,0 +1,151 @@
+#include "HeadlessFrameDriver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <new>
+
+namespace
+{
+    // Counter of the frame that runs on this thread; null outside HeadlessFrameDriver::run, so nothing is counted.
+    thread_local size_t* t_allocations = nullptr;
+
+    void countAllocation()
+    {
+        if( t_allocations )
+            ++*t_allocations;
+    }
+
+    /**
+     * @brief Counts the allocations of the calling thread for as long as it lives.
+     */
+    class AllocationCounter
+    {
+    public:
+        AllocationCounter() { t_allocations = &m_count; }
+        ~AllocationCounter() { t_allocations = nullptr; }
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        size_t count() const { return m_count; }
+
+    private:
+        size_t m_count = 0;
+    };
+
+    void* countedAlloc(size_t size, void*)
+    {
+        countAllocation();
+        return std::malloc(size);
+    }
+
+    void countedFree(void* ptr, void*)
+    {
+        std::free(ptr);
+    }
+}
+
+// Forwards to malloc like the default, and counts only the frames of HeadlessFrameDriver::run; array and nothrow forms end up here as well.
+void* operator new(std::size_t size)
+{
+    countAllocation();
+    if( void* ptr = std::malloc(size ? size : 1) )
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace tadaima::gui
+{
+    std::string HeadlessFrameDriver::FrameStats::toString(const std::string& name) const
+    {
+        return std::format("[ LATENCY ] {}: {:.1f} us per frame (max {:.1f} us), {:.0f} vertices, {:.0f} indices, {:.1f} allocations per frame over {} frames",
+            name, averageMicroseconds, maxMicroseconds, averageVertices, averageIndices, averageAllocations, frames);
+    }
+
+    HeadlessFrameDriver::HeadlessFrameDriver(ImVec2 displaySize)
+    {
+        ImGui::GetAllocatorFunctions(&m_previousAlloc, &m_previousFree, &m_previousUserData);
+        ImGui::SetAllocatorFunctions(countedAlloc, countedFree);
+
+        IMGUI_CHECKVERSION();
+        m_context = ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.LogFilename = nullptr;
+        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+        io.DisplaySize = displaySize;
+        io.DeltaTime = 1.0f / 60.0f;
+
+        // The atlas is built as a renderer backend would do it; the pixels are not uploaded anywhere.
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->AddFontDefault();
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1)));
+    }
+
+    HeadlessFrameDriver::~HeadlessFrameDriver()
+    {
+        ImGui::DestroyContext(m_context);
+        ImGui::SetAllocatorFunctions(m_previousAlloc, m_previousFree, m_previousUserData);
+    }
+
+    HeadlessFrameDriver::FrameStats HeadlessFrameDriver::run(int frames, const DrawFunction& draw, const InputScript& input)
+    {
+        ImGui::SetCurrentContext(m_context);
+        ImGuiIO& io = ImGui::GetIO();
+
+        FrameStats stats;
+        double totalMicroseconds = 0;
+        double totalVertices = 0;
+        double totalIndices = 0;
+        size_t totalAllocations = 0;
+        const AllocationCounter allocations;
+
+        for( int frame = 0; frame < frames; ++frame )
+        {
+            if( input )
+                input(io, frame);
+
+            const size_t allocationsBefore = allocations.count();
+            const auto begin = std::chrono::steady_clock::now();
+
+            ImGui::NewFrame();
+            draw();
+            ImGui::Render();
+
+            const auto end = std::chrono::steady_clock::now();
+            totalAllocations += allocations.count() - allocationsBefore;
+
+            const double microseconds = std::chrono::duration<double, std::micro>(end - begin).count();
+            totalMicroseconds += microseconds;
+            stats.maxMicroseconds = std::max(stats.maxMicroseconds, microseconds);
+
+            const ImDrawData* drawData = ImGui::GetDrawData();
+            totalVertices += drawData->TotalVtxCount;
+            totalIndices += drawData->TotalIdxCount;
+        }
+
+        stats.frames = frames;
+        if( frames > 0 )
+        {
+            stats.averageMicroseconds = totalMicroseconds / frames;
+            stats.averageVertices = totalVertices / frames;
+            stats.averageIndices = totalIndices / frames;
+            stats.averageAllocations = static_cast<double>(totalAllocations) / frames;
+        }
+        return stats;
+    }
+}
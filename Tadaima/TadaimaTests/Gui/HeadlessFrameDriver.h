@@ -0,0 +1,80 @@
+/**
+ * @file HeadlessFrameDriver.h
+ * @brief Runs ImGui frames without the Win32 and DirectX 11 backends, so widgets can be profiled on any machine.
+ */
+
+#pragma once
+
+#include "imgui.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace tadaima::gui
+{
+    /**
+     * @class HeadlessFrameDriver
+     * @brief Owns an ImGui context with a built font atlas and no backends and runs frames of widgets in it.
+     *
+     * A frame is NewFrame, the widget code and Render, exactly as in Gui::run; only the draw lists are never
+     * handed to a GPU, so the measured time is the CPU cost of the widgets and of ImGui.
+     */
+    class HeadlessFrameDriver
+    {
+    public:
+        /**
+         * @struct FrameStats
+         * @brief What a run of frames cost.
+         */
+        struct FrameStats
+        {
+            int frames = 0;                 /**< Number of measured frames. */
+            double averageMicroseconds = 0; /**< Average CPU time of a frame. */
+            double maxMicroseconds = 0;     /**< CPU time of the slowest frame. */
+            double averageVertices = 0;     /**< Average vertex count of the draw lists. */
+            double averageIndices = 0;      /**< Average index count of the draw lists. */
+            double averageAllocations = 0;  /**< Average number of heap allocations of the frame thread, by operator new and by ImGui. */
+
+            /**
+             * @brief Formats the statistics as a benchmark line.
+             * @param name The name of the benchmark.
+             */
+            std::string toString(const std::string& name) const;
+        };
+
+        /** @brief Submits the widgets of one frame. */
+        using DrawFunction = std::function<void()>;
+
+        /** @brief Queues the input events of a frame; they are processed by its NewFrame. */
+        using InputScript = std::function<void(ImGuiIO& io, int frame)>;
+
+        /**
+         * @brief Creates the ImGui context and builds its font atlas.
+         * @param displaySize The size of the simulated screen.
+         */
+        explicit HeadlessFrameDriver(ImVec2 displaySize = ImVec2(1280, 720));
+
+        /**
+         * @brief Destroys the ImGui context.
+         */
+        ~HeadlessFrameDriver();
+
+        HeadlessFrameDriver(const HeadlessFrameDriver&) = delete;
+        HeadlessFrameDriver& operator=(const HeadlessFrameDriver&) = delete;
+
+        /**
+         * @brief Runs frames and measures each of them from NewFrame to Render.
+         * @param frames Number of frames to run.
+         * @param draw Submits the widgets of a frame.
+         * @param input Queues the input of a frame, optional.
+         * @return The statistics of the frames.
+         */
+        FrameStats run(int frames, const DrawFunction& draw, const InputScript& input = nullptr);
+
+    private:
+        ImGuiContext* m_context = nullptr;              /**< The context all frames run in. */
+        ImGuiMemAllocFunc m_previousAlloc = nullptr;    /**< ImGui allocator to restore on destruction. */
+        ImGuiMemFreeFunc m_previousFree = nullptr;      /**< ImGui deallocator to restore on destruction. */
+        void* m_previousUserData = nullptr;             /**< User data of the previous ImGui allocator. */
+    };
+}
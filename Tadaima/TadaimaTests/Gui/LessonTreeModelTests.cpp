@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+#include "Gui/Widgets/LessonTreeViewWidget/LessonTreeModel.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using tadaima::Lesson;
+using tadaima::Word;
+using tadaima::gui::widget::LessonTreeModel;
+
+namespace
+{
+    Lesson makeLesson(int id, const std::string& groupName, const std::string& mainName, const std::string& subName, std::vector<int> wordIds = {})
+    {
+        Lesson lesson;
+        lesson.id = id;
+        lesson.groupName = groupName;
+        lesson.mainName = mainName;
+        lesson.subName = subName;
+        for( int wordId : wordIds )
+        {
+            Word word;
+            word.id = wordId;
+            word.translation = "word " + std::to_string(wordId);
+            lesson.words.push_back(word);
+        }
+        return lesson;
+    }
+
+    std::vector<std::string> childNames(const LessonTreeModel& model, LessonTreeModel::NodeId node)
+    {
+        std::vector<std::string> names;
+        for( const auto& [key, child] : model.find(node)->children )
+            names.push_back(model.find(child)->name);
+        return names;
+    }
+}
+
+TEST(LessonTreeModelTest, SortsGroupsChaptersAndLessons)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(3, "Minna", "1", "b"), makeLesson(1, "Genki", "2", "a"), makeLesson(2, "Genki", "1", "b"), makeLesson(4, "Genki", "1", "a") });
+
+    EXPECT_EQ(childNames(model, LessonTreeModel::ROOT), (std::vector<std::string>{ "Genki", "Minna" }));
+    const LessonTreeModel::NodeId genki = model.findChild(LessonTreeModel::ROOT, "Genki");
+    EXPECT_EQ(childNames(model, genki), (std::vector<std::string>{ "1", "2" }));
+    EXPECT_EQ(childNames(model, model.findChild(genki, "1")), (std::vector<std::string>{ "a", "b" }));
+    EXPECT_EQ(model.lessonCount(), 4u);
+
+    const Lesson lesson = model.lesson(model.findLesson(2));
+    EXPECT_EQ(lesson.groupName, "Genki");
+    EXPECT_EQ(lesson.mainName, "1");
+    EXPECT_EQ(lesson.subName, "b");
+    EXPECT_EQ(model.findLesson("Genki", "1", "b"), model.findLesson(2));
+}
+
+TEST(LessonTreeModelTest, KeepsNodesAndTheirStateAcrossReloads)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(1, "Genki", "1", "a", { 10, 11 }), makeLesson(2, "Genki", "1", "b", { 12 }) });
+    const LessonTreeModel::NodeId genki = model.findChild(LessonTreeModel::ROOT, "Genki");
+    const LessonTreeModel::NodeId a = model.findLesson(1);
+    model.setOpen(genki, true);
+    model.setOpen(a, true);
+    model.clearDirty();
+
+    // The application sends all lessons again after a change to one of them.
+    model.assign({ makeLesson(1, "Genki", "1", "a", { 10, 11 }), makeLesson(2, "Genki", "1", "b", { 12, 13 }) });
+    EXPECT_EQ(model.findChild(LessonTreeModel::ROOT, "Genki"), genki);
+    EXPECT_EQ(model.findLesson(1), a);
+    EXPECT_TRUE(model.isOpen(genki));
+    EXPECT_TRUE(model.isOpen(a));
+    EXPECT_FALSE(model.isDirty(a));
+    EXPECT_TRUE(model.isDirty(model.findLesson(2)));
+    EXPECT_TRUE(model.isDirty(LessonTreeModel::ROOT));
+    EXPECT_EQ(model.findWord(13), model.findLesson(2));
+
+    model.assign({ makeLesson(2, "Genki", "1", "b", { 12, 13 }) });
+    EXPECT_EQ(model.findLesson(1), LessonTreeModel::INVALID_NODE);
+    EXPECT_EQ(model.findWord(10), LessonTreeModel::INVALID_NODE);
+    EXPECT_TRUE(model.isOpen(genki));
+}
+
+TEST(LessonTreeModelTest, MovesARenamedLessonWithItsNode)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(1, "Genki", "1", "a", { 10 }), makeLesson(2, "Genki", "1", "b") });
+    const LessonTreeModel::NodeId node = model.findLesson(1);
+    model.setOpen(node, true);
+
+    EXPECT_EQ(model.insert(makeLesson(1, "Minna", "5", "z", { 10 })), node);
+    EXPECT_TRUE(model.isOpen(node));
+    EXPECT_EQ(model.findLesson("Minna", "5", "z"), node);
+    EXPECT_EQ(model.findWord(10), node);
+    EXPECT_EQ(childNames(model, model.findChild(model.findChild(LessonTreeModel::ROOT, "Genki"), "1")), std::vector<std::string>{ "b" });
+
+    // Moving the last lesson out of a chapter removes the chapter and its group.
+    EXPECT_TRUE(model.move(node, model.findChild(model.findChild(LessonTreeModel::ROOT, "Genki"), "1")));
+    EXPECT_EQ(model.findChild(LessonTreeModel::ROOT, "Minna"), LessonTreeModel::INVALID_NODE);
+    EXPECT_EQ(model.lesson(node).groupName, "Genki");
+    EXPECT_FALSE(model.move(node, LessonTreeModel::ROOT));
+}
+
+TEST(LessonTreeModelTest, RenamesGroupsForTheLessonsBelow)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(1, "Genki", "1", "a"), makeLesson(2, "Minna", "1", "a") });
+    const LessonTreeModel::NodeId genki = model.findChild(LessonTreeModel::ROOT, "Genki");
+
+    EXPECT_FALSE(model.rename(genki, "Minna"));
+    EXPECT_TRUE(model.rename(genki, "Tobira"));
+    EXPECT_EQ(model.findChild(LessonTreeModel::ROOT, "Tobira"), genki);
+    EXPECT_EQ(childNames(model, LessonTreeModel::ROOT), (std::vector<std::string>{ "Minna", "Tobira" }));
+    EXPECT_EQ(model.lesson(model.findLesson(1)).groupName, "Tobira");
+}
+
+TEST(LessonTreeModelTest, RemovesNodesWithEverythingBelow)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(1, "Genki", "1", "a", { 10 }), makeLesson(2, "Genki", "2", "a", { 11 }), makeLesson(3, "Minna", "1", "a") });
+
+    EXPECT_TRUE(model.remove(model.findLesson(1)));
+    EXPECT_EQ(childNames(model, model.findChild(LessonTreeModel::ROOT, "Genki")), std::vector<std::string>{ "2" });
+    EXPECT_TRUE(model.remove(model.findChild(LessonTreeModel::ROOT, "Genki")));
+    EXPECT_EQ(model.findLesson(2), LessonTreeModel::INVALID_NODE);
+    EXPECT_EQ(model.findWord(11), LessonTreeModel::INVALID_NODE);
+    EXPECT_EQ(model.lessons(LessonTreeModel::ROOT).size(), 1u);
+    EXPECT_FALSE(model.remove(LessonTreeModel::ROOT));
+    EXPECT_FALSE(model.remove(LessonTreeModel::INVALID_NODE));
+}
+
+TEST(LessonTreeModelTest, FindsWordsByTheirIds)
+{
+    LessonTreeModel model;
+    model.assign({ makeLesson(1, "Genki", "1", "a", { 12, 10 }), makeLesson(2, "Genki", "1", "b", { 11 }) });
+
+    const std::vector<Word> words = model.findWords({ 11, 12, 99 });
+    ASSERT_EQ(words.size(), 2u);
+    EXPECT_EQ(words[0].id, 11);
+    EXPECT_EQ(words[1].id, 12);
+}
+
+TEST(LessonTreeModelTest, ChangesCostLittleInALargeTree)
+{
+    // 10 groups x 50 chapters x 40 lessons.
+    std::vector<Lesson> lessons;
+    int nextId = 1;
+    for( int g = 0; g < 10; ++g )
+        for( int c = 0; c < 50; ++c )
+            for( int l = 0; l < 40; ++l )
+                lessons.push_back(makeLesson(nextId++, "Group " + std::to_string(g), "Chapter " + std::to_string(c), "Lesson " + std::to_string(l)));
+
+    LessonTreeModel model;
+    const auto begin = std::chrono::steady_clock::now();
+    model.assign(lessons);
+    const auto built = std::chrono::steady_clock::now();
+    model.clearDirty();
+    model.assign(lessons);
+    const auto reloaded = std::chrono::steady_clock::now();
+    EXPECT_FALSE(model.isDirty(LessonTreeModel::ROOT));
+
+    const int changes = 10000;
+    for( int i = 0; i < changes; ++i )
+    {
+        const int id = 1 + (i * 7919) % static_cast<int>(lessons.size());
+        const LessonTreeModel::NodeId node = model.findLesson(id);
+        model.rename(node, "Renamed " + std::to_string(i));
+        model.move(node, model.findChild(model.findChild(LessonTreeModel::ROOT, "Group " + std::to_string(i % 10)), "Chapter " + std::to_string(i % 50)));
+    }
+    const auto changed = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(model.lessonCount(), lessons.size());
+    const auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::cout << "[ LATENCY ] LessonTreeModel of " << lessons.size() << " lessons: built " << ms(begin, built) << " ms, reloaded unchanged " << ms(built, reloaded)
+        << " ms, rename and move " << ms(reloaded, changed) * 1000.0 / changes << " us" << std::endl;
+}
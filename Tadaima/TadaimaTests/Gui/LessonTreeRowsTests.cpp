@@ -0,0 +1,141 @@
+#include "gtest/gtest.h"
+#include "Gui/Widgets/LessonTreeViewWidget/LessonTreeRows.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using tadaima::Lesson;
+using tadaima::Word;
+using tadaima::gui::widget::LessonTreeModel;
+using tadaima::gui::widget::LessonTreeRow;
+using tadaima::gui::widget::LessonTreeRows;
+
+namespace
+{
+    std::vector<Lesson> makeLessons(int lessonsPerChapter, int wordsPerLesson)
+    {
+        std::vector<Lesson> lessons;
+        int nextId = 1;
+        for( const char* groupName : { "Genki", "Minna" } )
+        {
+            for( const char* mainName : { "Chapter 1", "Chapter 2" } )
+            {
+                for( int l = 0; l < lessonsPerChapter; ++l )
+                {
+                    Lesson lesson;
+                    lesson.id = nextId++;
+                    lesson.groupName = groupName;
+                    lesson.mainName = mainName;
+                    lesson.subName = "Lesson " + std::to_string(l);
+                    for( int w = 0; w < wordsPerLesson; ++w )
+                    {
+                        Word word;
+                        word.id = nextId++;
+                        word.translation = "word " + std::to_string(w);
+                        word.kana = "kana";
+                        lesson.words.push_back(word);
+                    }
+                    lessons.push_back(lesson);
+                }
+            }
+        }
+        return lessons;
+    }
+
+    void openAll(LessonTreeModel& model)
+    {
+        for( const Lesson& lesson : model.lessons(LessonTreeModel::ROOT) )
+        {
+            const LessonTreeModel::NodeId node = model.findLesson(lesson.id);
+            const LessonTreeModel::NodeId chapter = model.find(node)->parent;
+            model.setOpen(node, true);
+            model.setOpen(chapter, true);
+            model.setOpen(model.find(chapter)->parent, true);
+        }
+    }
+}
+
+TEST(LessonTreeRowsTest, ListsOnlyTheRowsOfExpandedNodes)
+{
+    LessonTreeModel model;
+    model.assign(makeLessons(2, 3));
+    LessonTreeRows rows;
+
+    ASSERT_EQ(rows.update(model).size(), 2u);
+    EXPECT_EQ(rows.update(model)[1].label, "Minna");
+
+    const LessonTreeModel::NodeId genki = rows.update(model)[0].node;
+    model.setOpen(genki, true);
+    model.setOpen(model.findChild(genki, "Chapter 2"), true);
+    model.setOpen(model.findLesson("Genki", "Chapter 2", "Lesson 1"), true);
+
+    const std::vector<LessonTreeRow>& visible = rows.update(model);
+    std::vector<std::string> labels;
+    for( const LessonTreeRow& row : visible )
+        labels.push_back(row.label.substr(0, row.label.find("##")));
+    EXPECT_EQ(labels, (std::vector<std::string>{ "Genki", "Chapter 1", "Chapter 2", "Lesson 0", "Lesson 1", "word 0 - kana", "word 1 - kana", "word 2 - kana", "Minna" }));
+
+    const LessonTreeRow& word = visible[6];
+    EXPECT_EQ(word.kind, LessonTreeRow::Kind::Word);
+    EXPECT_EQ(word.depth, 3);
+    EXPECT_EQ(word.treeNode->name, "Lesson 1");
+    EXPECT_EQ(model.find(word.treeNode->parent)->name, "Chapter 2");
+    EXPECT_EQ(word.word->translation, "word 1");
+    EXPECT_TRUE(visible[4].open);
+    EXPECT_FALSE(visible[3].open);
+}
+
+TEST(LessonTreeRowsTest, RebuildsOnlyAfterAChange)
+{
+    std::vector<Lesson> lessons = makeLessons(1, 1);
+    LessonTreeModel model;
+    model.assign(lessons);
+    LessonTreeRows rows;
+    const LessonTreeRow* first = rows.update(model).data();
+
+    // Setting the state a node already has changes nothing, neither does the same lessons again.
+    model.setOpen(model.findChild(LessonTreeModel::ROOT, "Minna"), false);
+    model.assign(lessons);
+    EXPECT_FALSE(model.isDirty(LessonTreeModel::ROOT));
+    EXPECT_EQ(rows.update(model).data(), first);
+
+    Lesson tobira;
+    tobira.id = 100;
+    tobira.groupName = "Tobira";
+    tobira.mainName = "Chapter 1";
+    lessons.push_back(tobira);
+    model.assign(lessons);
+    EXPECT_EQ(rows.update(model).size(), 3u);
+}
+
+TEST(LessonTreeRowsTest, FrameCostDoesNotDependOnDeckSize)
+{
+    // 2 groups x 2 chapters x 50 lessons x 200 words, everything expanded.
+    LessonTreeModel model;
+    model.assign(makeLessons(50, 200));
+    openAll(model);
+    LessonTreeRows rows;
+
+    const auto begin = std::chrono::steady_clock::now();
+    const size_t total = rows.update(model).size();
+    const auto built = std::chrono::steady_clock::now();
+
+    // A frame reads one screenful of rows, about what ImGuiListClipper hands out.
+    const int frames = 10000;
+    const size_t visibleRows = 40;
+    size_t characters = 0;
+    for( int frame = 0; frame < frames; ++frame )
+    {
+        const std::vector<LessonTreeRow>& visible = rows.update(model);
+        const size_t first = (frame * 97) % (visible.size() - visibleRows);
+        for( size_t i = first; i < first + visibleRows; ++i )
+            characters += visible[i].label.size();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(total, 2u + 4u + 200u + 40000u);
+    EXPECT_GT(characters, 0u);
+    std::cout << "[ LATENCY ] LessonTreeRows rebuild of " << total << " rows " << std::chrono::duration<double, std::milli>(built - begin).count()
+        << " ms, per frame " << std::chrono::duration<double, std::micro>(end - built).count() / frames << " us" << std::endl;
+}
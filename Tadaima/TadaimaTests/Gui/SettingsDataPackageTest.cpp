@@ -22,28 +22,28 @@ namespace tadaima
 
             TEST_F(SettingsDataPackageTest, SetAndGetSettings)
             {
-                package.set(SettingsPackageKey::Username, std::string("testuser"));
-                package.set(SettingsPackageKey::DictionaryPath, std::string("/path/to/dictionary"));
-                package.set(SettingsPackageKey::AnswerWordType, std::string("hello"));
-                package.set(SettingsPackageKey::AskedWordType, std::string("latin"));
-
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::Username), "testuser");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::DictionaryPath), "/path/to/dictionary");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::AnswerWordType), "hello");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::AskedWordType), "latin");
+                package.set<SettingsPackageKey::Username>("testuser");
+                package.set<SettingsPackageKey::DictionaryPath>("/path/to/dictionary");
+                package.set<SettingsPackageKey::AnswerWordType>(quiz::WordType::Romaji);
+                package.set<SettingsPackageKey::AskedWordType>(quiz::WordType::Kana);
+                package.set<SettingsPackageKey::ConjugationMask>(uint16_t(0x0F));
+
+                EXPECT_EQ(package.get<SettingsPackageKey::Username>(), "testuser");
+                EXPECT_EQ(package.get<SettingsPackageKey::DictionaryPath>(), "/path/to/dictionary");
+                EXPECT_EQ(package.get<SettingsPackageKey::AnswerWordType>(), quiz::WordType::Romaji);
+                EXPECT_EQ(package.get<SettingsPackageKey::AskedWordType>(), quiz::WordType::Kana);
+                EXPECT_EQ(package.get<SettingsPackageKey::ConjugationMask>(), 0x0F);
             }
 
             TEST_F(SettingsDataPackageTest, HandleEmptyValues)
             {
-                package.set(SettingsPackageKey::Username, std::string(""));
-                package.set(SettingsPackageKey::DictionaryPath, std::string(""));
-                package.set(SettingsPackageKey::AnswerWordType, std::string(""));
-                package.set(SettingsPackageKey::AskedWordType, std::string(""));
-
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::Username), "");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::DictionaryPath), "");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::AnswerWordType), "");
-                EXPECT_EQ(package.get<std::string>(SettingsPackageKey::AskedWordType), "");
+                package.set<SettingsPackageKey::Username>("");
+                package.set<SettingsPackageKey::DictionaryPath>("");
+
+                EXPECT_EQ(package.get<SettingsPackageKey::Username>(), "");
+                EXPECT_EQ(package.get<SettingsPackageKey::DictionaryPath>(), "");
+                EXPECT_FALSE(package.get<SettingsPackageKey::ShowLogs>());
+                EXPECT_EQ(package.get<SettingsPackageKey::ConjugationMask>(), 0);
             }
 
         } // namespace widget
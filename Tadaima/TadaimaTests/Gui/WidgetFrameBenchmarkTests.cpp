@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+#include "HeadlessFrameDriver.h"
+#include "imgui_internal.h"
+#include "quiz/Quiz.h"
+#include "Gui/Widgets/LessonTreeViewWidget.h"
+#include "Gui/Widgets/MainDashboardWidget.h"
+#include "Gui/Widgets/Quiz/ConjugationQuizWidget.h"
+#include "Gui/Widgets/Quiz/VocabularyQuizWidget.h"
+#include "Gui/Widgets/packages/LessonDataPackage.h"
+#include "Gui/Widgets/packages/SettingsDataPackage.h"
+#include "Tools/Logger.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using tadaima::Lesson;
+using tadaima::Word;
+using tadaima::gui::HeadlessFrameDriver;
+using namespace tadaima::gui::widget;
+
+namespace
+{
+    const int WARMUP_FRAMES = 10;
+    const int MEASURED_FRAMES = 300;
+
+    std::vector<Lesson> makeLessons(int chaptersPerGroup, int lessonsPerChapter, int wordsPerLesson)
+    {
+        std::vector<Lesson> lessons;
+        int nextId = 1;
+        for( const char* groupName : { "Genki", "Minna" } )
+        {
+            for( int c = 0; c < chaptersPerGroup; ++c )
+            {
+                for( int l = 0; l < lessonsPerChapter; ++l )
+                {
+                    Lesson lesson;
+                    lesson.id = nextId++;
+                    lesson.groupName = groupName;
+                    lesson.mainName = "Chapter " + std::to_string(c);
+                    lesson.subName = "Lesson " + std::to_string(l);
+                    for( int w = 0; w < wordsPerLesson; ++w )
+                    {
+                        Word word;
+                        word.id = nextId++;
+                        word.translation = "to eat " + std::to_string(w);
+                        word.romaji = "taberu" + std::to_string(w);
+                        word.kana = "taberu";
+                        word.kanji = "taberu";
+                        for( std::string& conjugation : word.conjugations )
+                            conjugation = "tabemasu" + std::to_string(w);
+                        lesson.words.push_back(word);
+                    }
+                    lessons.push_back(lesson);
+                }
+            }
+        }
+        return lessons;
+    }
+
+    void click(ImGuiIO& io, float x, float y)
+    {
+        io.AddMousePosEvent(x, y);
+        io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+        io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+    }
+
+    void press(ImGuiIO& io, ImGuiKey key)
+    {
+        io.AddKeyEvent(key, true);
+        io.AddKeyEvent(key, false);
+    }
+
+    // Types a wrong answer, submits it and confirms it, like a learner going through the cards.
+    void answerQuiz(ImGuiIO& io, int frame)
+    {
+        switch( frame % 6 )
+        {
+            case 0: io.AddInputCharactersUTF8("tabe"); break;
+            case 1: io.AddInputCharactersUTF8("nai"); break;
+            case 2: press(io, ImGuiKey_Enter); break;
+            case 4: press(io, ImGuiKey_Enter); break;
+            default: io.AddMousePosEvent(300.0f + frame % 50, 200.0f); break;
+        }
+    }
+}
+
+TEST(WidgetFrameBenchmarkTest, CountsTheWorkOfAFrame)
+{
+    HeadlessFrameDriver driver;
+    std::string text;
+    const HeadlessFrameDriver::FrameStats stats = driver.run(3, [&text]()
+        {
+            text = std::string(64, 'x');
+            ImGui::Begin("Counted");
+            ImGui::TextUnformatted(text.c_str());
+            ImGui::End();
+        });
+
+    EXPECT_EQ(stats.frames, 3);
+    EXPECT_GT(stats.averageVertices, 0.0);
+    EXPECT_GE(stats.averageIndices, stats.averageVertices);
+    EXPECT_GE(stats.averageAllocations, 1.0);
+    EXPECT_GT(stats.averageMicroseconds, 0.0);
+    EXPECT_GE(stats.maxMicroseconds, stats.averageMicroseconds);
+}
+
+TEST(WidgetFrameBenchmarkTest, LessonTreeView)
+{
+    HeadlessFrameDriver driver;
+    tools::Logger logger;
+    LessonTreeViewWidget widget(logger);
+
+    // 2 groups x 5 chapters x 20 lessons x 50 words, everything expanded.
+    widget.initialize(LessonDataPackage(makeLessons(5, 20, 50)));
+    for( const Lesson& lesson : widget.m_lessons.lessons(LessonTreeModel::ROOT) )
+    {
+        const LessonTreeModel::NodeId node = widget.m_lessons.findLesson(lesson.id);
+        const LessonTreeModel::NodeId chapter = widget.m_lessons.find(node)->parent;
+        widget.m_lessons.setOpen(node, true);
+        widget.m_lessons.setOpen(chapter, true);
+        widget.m_lessons.setOpen(widget.m_lessons.find(chapter)->parent, true);
+    }
+
+    bool open = true;
+    const auto draw = [&widget, &open]()
+        {
+            ImGui::SetNextWindowPos(ImVec2(0, 29), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(250, 700), ImGuiCond_Always);
+            widget.draw(&open);
+        };
+    // Hovers down the rows while scrolling, with a click on a row now and then.
+    const auto input = [](ImGuiIO& io, int frame)
+        {
+            const float y = 120.0f + (frame * 37) % 560;
+            io.AddMousePosEvent(80.0f, y);
+            io.AddMouseWheelEvent(0.0f, -1.0f);
+            if( frame % 15 == 0 )
+                click(io, 80.0f, y);
+        };
+
+    driver.run(WARMUP_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats idle = driver.run(MEASURED_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats scripted = driver.run(MEASURED_FRAMES, draw, input);
+
+    EXPECT_GT(idle.averageVertices, 0.0);
+    EXPECT_GT(scripted.averageVertices, 0.0);
+    std::cout << idle.toString("LessonTreeViewWidget idle") << std::endl;
+    std::cout << scripted.toString("LessonTreeViewWidget scrolling") << std::endl;
+}
+
+TEST(WidgetFrameBenchmarkTest, VocabularyQuiz)
+{
+    HeadlessFrameDriver driver;
+    tools::Logger logger;
+    VocabularyQuizWidget widget(tadaima::quiz::WordType::BaseWord, tadaima::quiz::WordType::Romaji, 3, makeLessons(1, 2, 50), logger);
+
+    bool open = true;
+    const auto draw = [&widget, &open]()
+        {
+            ImGui::SetNextWindowPos(ImVec2(250, 29), ImGuiCond_Always);
+            widget.draw(&open);
+        };
+
+    driver.run(WARMUP_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats stats = driver.run(MEASURED_FRAMES, draw, answerQuiz);
+
+    EXPECT_TRUE(open);
+    EXPECT_GT(stats.averageVertices, 0.0);
+    std::cout << stats.toString("VocabularyQuizWidget answering") << std::endl;
+}
+
+TEST(WidgetFrameBenchmarkTest, ConjugationQuiz)
+{
+    HeadlessFrameDriver driver;
+    tools::Logger logger;
+    ConjugationQuizWidget widget(0x0F, 3, makeLessons(1, 2, 50), logger);
+
+    bool open = true;
+    const ImVec2 position(250, 29);
+    const auto draw = [&widget, &open, &position]()
+        {
+            ImGui::SetNextWindowPos(position, ImGuiCond_Always);
+            widget.draw(&open);
+        };
+
+    driver.run(WARMUP_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats selection = driver.run(MEASURED_FRAMES, draw, [&position](ImGuiIO& io, int frame)
+        {
+            io.AddMousePosEvent(position.x + 30.0f + (frame * 13) % 540, position.y + 120.0f);
+        });
+
+    // "Start Quiz" is the 150 x 40 button in the bottom left corner of the 600 x 400 selection window; the
+    // press and the release of a click are processed in separate frames.
+    driver.run(3, draw, [&position](ImGuiIO& io, int frame)
+        {
+            if( frame == 0 )
+                click(io, position.x + 15.0f + 75.0f, position.y + 400.0f - 15.0f - 20.0f);
+        });
+    ASSERT_NE(ImGui::FindWindowByName("Conjugation Quiz"), nullptr);
+
+    driver.run(WARMUP_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats quiz = driver.run(MEASURED_FRAMES, draw, answerQuiz);
+
+    EXPECT_GT(selection.averageVertices, 0.0);
+    EXPECT_GT(quiz.averageVertices, 0.0);
+    std::cout << selection.toString("ConjugationQuizWidget selection") << std::endl;
+    std::cout << quiz.toString("ConjugationQuizWidget answering") << std::endl;
+}
+
+TEST(WidgetFrameBenchmarkTest, MainDashboard)
+{
+    HeadlessFrameDriver driver;
+    MainDashboardWidget widget;
+    SettingsDataPackage settings;
+    settings.set<SettingsPackageKey::Username>("Gakusei");
+    widget.initialize(settings);
+
+    bool open = true;
+    const auto draw = [&widget, &open]()
+        {
+            ImGui::SetNextWindowPos(ImVec2(250, 29), ImGuiCond_Always);
+            ImGui::SetNextWindowSize(ImVec2(640, 700), ImGuiCond_Always);
+            widget.draw(&open);
+        };
+
+    driver.run(WARMUP_FRAMES, draw);
+    const HeadlessFrameDriver::FrameStats stats = driver.run(MEASURED_FRAMES, draw, [](ImGuiIO& io, int frame)
+        {
+            io.AddMousePosEvent(260.0f + (frame * 23) % 620, 40.0f + (frame * 41) % 680);
+        });
+
+    EXPECT_GT(stats.averageVertices, 0.0);
+    std::cout << stats.toString("MainDashboardWidget") << std::endl;
+}
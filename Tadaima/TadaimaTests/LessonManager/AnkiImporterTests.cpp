@@ -0,0 +1,160 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "lessons/AnkiImporter.h"
+#include "MockDatabase.h"
+#include "../Mocks/TempFiles.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <filesystem>
+#include <fstream>
+
+using namespace tadaima;
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::Field;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace
+{
+    // Creates the notes table of an Anki collection (only the columns the importer reads).
+    class AnkiImporterTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            std::filesystem::create_directories(m_directory);
+            std::filesystem::remove(m_path);
+            ASSERT_EQ(sqlite3_open(m_path.c_str(), &m_db), SQLITE_OK);
+            execute("CREATE TABLE notes (id INTEGER PRIMARY KEY, mid INTEGER, flds TEXT NOT NULL, tags TEXT NOT NULL);");
+        }
+
+        void TearDown() override
+        {
+            sqlite3_close(m_db);
+            std::filesystem::remove_all(m_root);
+        }
+
+        void execute(const std::string& sql)
+        {
+            ASSERT_EQ(sqlite3_exec(m_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK) << sqlite3_errmsg(m_db);
+        }
+
+        void addNote(int id, const std::string& fields, const std::string& tags = "")
+        {
+            sqlite3_stmt* stmt = nullptr;
+            ASSERT_EQ(sqlite3_prepare_v2(m_db, "INSERT INTO notes (id, mid, flds, tags) VALUES (?, 1, ?, ?);", -1, &stmt, nullptr), SQLITE_OK);
+            sqlite3_bind_int(stmt, 1, id);
+            sqlite3_bind_text(stmt, 2, fields.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmt, 3, tags.c_str(), -1, SQLITE_TRANSIENT);
+            EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+            sqlite3_finalize(stmt);
+        }
+
+        const std::filesystem::path m_root = uniqueTempPath("tadaima_anki");
+        const std::filesystem::path m_directory = m_root / "N5 Vocabulary"; // A collection.anki2 is named after its directory.
+        const std::string m_path = (m_directory / "collection.anki2").string();
+        sqlite3* m_db = nullptr;
+    };
+}
+
+TEST_F(AnkiImporterTest, ImportsNotesAsOneLessonInOneTransaction)
+{
+    addNote(2, "\xEF\xBD\x9E\xE3\x81\x95\xE3\x82\x93\x1fMr., Mrs.;", " suffix ");
+    addNote(1, "\xE3\x81\x9F\xE3\x81\xB9\xE3\x82\x8B; \xE3\x81\x8F\xE3\x81\x86\x1f<b>to eat</b>&nbsp;.\x1f\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B", "verb n5");
+    addNote(3, "\x1f\x1f");
+
+    NiceMock<MockDatabase> database;
+    EXPECT_CALL(database, beginTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(database, commitTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(database, rollbackTransaction()).Times(0);
+    EXPECT_CALL(database, addLesson("N5 Vocabulary", "vocabulary", "Anki")).WillOnce(Return(4));
+    {
+        ::testing::InSequence order;
+        EXPECT_CALL(database, addWord(4, AllOf(
+            Field(&Word::kana, "\xE3\x81\x9F\xE3\x81\xB9\xE3\x82\x8B"),
+            Field(&Word::translation, "to eat"),
+            Field(&Word::romaji, "taberu"),
+            Field(&Word::kanji, "")))).WillOnce(Return(20));
+        EXPECT_CALL(database, addWord(4, AllOf(
+            Field(&Word::kana, "\xE3\x81\x95\xE3\x82\x93"),
+            Field(&Word::translation, "Mr., Mrs"),
+            Field(&Word::romaji, "san")))).WillOnce(Return(21));
+    }
+    EXPECT_CALL(database, addTag(20, "verb"));
+    EXPECT_CALL(database, addTag(20, "n5"));
+    EXPECT_CALL(database, addTag(21, "suffix"));
+
+    int reports = 0;
+    const AnkiImporter::Result result = AnkiImporter::importCollection(m_path, database, {}, [&](int64_t notesRead, int64_t totalNotes)
+        {
+            ++reports;
+            EXPECT_EQ(notesRead, 3);
+            EXPECT_EQ(totalNotes, 3);
+            return true;
+        });
+
+    EXPECT_EQ(result.words, 2);
+    EXPECT_EQ(result.skipped, 1);
+    EXPECT_EQ(reports, 1);
+}
+
+TEST_F(AnkiImporterTest, UsesTheConfiguredFieldMapping)
+{
+    addNote(1, "to eat\x1f\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B\x1f\xE3\x81\x9F\xE3\x81\xB9\xE3\x82\x8B\x1ftabemasu\x1f\xE3\x83\x91\xE3\x83\xB3\xE3\x82\x92\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B", "verb");
+
+    AnkiImporter::Options options;
+    options.fields.translation = 0;
+    options.fields.kanji = 1;
+    options.fields.kana = 2;
+    options.fields.romaji = 3;
+    options.fields.exampleSentence = 4;
+    options.fields.importTags = false;
+    options.mainName = "Verbs";
+
+    NiceMock<MockDatabase> database;
+    ON_CALL(database, beginTransaction()).WillByDefault(Return(true));
+    ON_CALL(database, commitTransaction()).WillByDefault(Return(true));
+    EXPECT_CALL(database, addLesson("Verbs", "vocabulary", "Anki")).WillOnce(Return(1));
+    EXPECT_CALL(database, addWord(1, AllOf(
+        Field(&Word::translation, "to eat"),
+        Field(&Word::kanji, "\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B"),
+        Field(&Word::kana, "\xE3\x81\x9F\xE3\x81\xB9\xE3\x82\x8B"),
+        Field(&Word::romaji, "tabemasu"),
+        Field(&Word::exampleSentence, "\xE3\x83\x91\xE3\x83\xB3\xE3\x82\x92\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B")))).WillOnce(Return(2));
+    EXPECT_CALL(database, addTag(_, _)).Times(0);
+
+    EXPECT_EQ(AnkiImporter::importCollection(m_path, database, options).words, 1);
+}
+
+TEST_F(AnkiImporterTest, RollsBackWhenTheImportFails)
+{
+    for( int i = 0; i < 600; ++i )
+        addNote(i, "kana\x1ftranslation");
+
+    NiceMock<MockDatabase> database;
+    ON_CALL(database, beginTransaction()).WillByDefault(Return(true));
+    ON_CALL(database, addLesson(_, _, _)).WillByDefault(Return(1));
+    EXPECT_CALL(database, commitTransaction()).Times(0);
+    EXPECT_CALL(database, rollbackTransaction()).Times(1);
+
+    EXPECT_THROW(AnkiImporter::importCollection(m_path, database, {}, [](int64_t, int64_t) { return false; }), std::runtime_error);
+
+    // A file that is not a collection is rejected before anything is written.
+    const std::string foreign = (m_directory / "foreign.anki2").string();
+    std::ofstream(foreign) << "not a database";
+    EXPECT_CALL(database, beginTransaction()).Times(0);
+    EXPECT_THROW(AnkiImporter::importCollection(foreign, database, {}), std::runtime_error);
+}
+
+TEST(AnkiImporterFieldTest, ConvertsFieldHtmlToText)
+{
+    EXPECT_EQ(AnkiImporter::fieldText(" <div>cat</div><div>dog</div> "), "cat  dog");
+    EXPECT_EQ(AnkiImporter::fieldText("a<br/>b &amp; c&nbsp;&lt;d&gt;"), "a b & c <d>");
+    EXPECT_EQ(AnkiImporter::fieldText("<span style=\"color: red\">red</span>"), "red");
+    EXPECT_EQ(AnkiImporter::fieldText("AT&T"), "AT&T");
+
+    EXPECT_EQ(AnkiImporter::lessonNameFor("decks/N4/collection.anki2"), "N4");
+    EXPECT_EQ(AnkiImporter::lessonNameFor("Kanji.anki2"), "Kanji");
+    EXPECT_TRUE(AnkiImporter::isCollectionPath("C:\\Anki\\COLLECTION.ANKI2"));
+    EXPECT_FALSE(AnkiImporter::isCollectionPath("deck.apkg"));
+}
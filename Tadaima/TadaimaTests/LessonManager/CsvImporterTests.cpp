@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+#include "lessons/CsvImporter.h"
+#include "../Mocks/TempFiles.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace tadaima;
+using Column = CsvImporter::Column;
+
+namespace
+{
+    std::vector<Lesson> importAll(const std::string& path, const CsvImporter::Options& options, size_t batchSize = 512)
+    {
+        std::vector<Lesson> lessons;
+        CsvImporter::importFile(path, options, [&lessons](const LessonImporter::Batch& batch)
+            {
+                auto lesson = batch.lessons.begin();
+                if( batch.continuesLesson )
+                {
+                    lessons.back().words.insert(lessons.back().words.end(), lesson->words.begin(), lesson->words.end());
+                    ++lesson;
+                }
+                lessons.insert(lessons.end(), lesson, batch.lessons.end());
+            }, nullptr, batchSize);
+        return lessons;
+    }
+}
+
+TEST(CsvImporterTest, ReadsQuotedFieldsAsInRfc4180)
+{
+    std::string_view text = "a,\"b,c\",\"say \"\"hi\"\"\"\r\n\"two\nlines\",,x\nlast";
+    std::vector<std::string> fields;
+
+    ASSERT_TRUE(CsvImporter::readRecord(text, ',', fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{ "a", "b,c", "say \"hi\"" }));
+    ASSERT_TRUE(CsvImporter::readRecord(text, ',', fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{ "two\nlines", "", "x" }));
+    ASSERT_TRUE(CsvImporter::readRecord(text, ',', fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{ "last" }));
+    EXPECT_FALSE(CsvImporter::readRecord(text, ',', fields));
+
+    std::string_view tabs = "\xE3\x81\x82\tA\t\n";
+    ASSERT_TRUE(CsvImporter::readRecord(tabs, '\t', fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{ "\xE3\x81\x82", "A", "" }));
+    EXPECT_TRUE(tabs.empty());
+}
+
+TEST(CsvImporterTest, MapsColumnsFromTheHeaderOrASpec)
+{
+    EXPECT_EQ(CsvImporter::parseMapping("kana, Translation ,-,tags,unknown"),
+        (std::vector<Column>{ Column::Kana, Column::Translation, Column::Ignore, Column::Tags, Column::Ignore }));
+    EXPECT_EQ(CsvImporter::columnFromName("Example Sentence"), Column::Example);
+    EXPECT_EQ(CsvImporter::columnFromName("mainName"), Column::Lesson);
+    EXPECT_TRUE(CsvImporter::isCsvPath("list.TSV"));
+    EXPECT_FALSE(CsvImporter::isCsvPath("list.xml"));
+    EXPECT_EQ(CsvImporter::optionsFor("list.tsv").delimiter, '\t');
+
+    // A byte order mark, a header in any order and a quoted example with a line break. The lesson is named
+    // after the file, so it keeps its plain name inside a unique directory.
+    const std::filesystem::path directory = uniqueTempPath("tadaima_csv");
+    std::filesystem::create_directories(directory);
+    const std::string path = (directory / "tadaima_vocabulary.csv").string();
+    std::ofstream(path, std::ios::binary) <<
+        "\xEF\xBB\xBF" "Translation,Kana,Notes,Tags,Example\r\n"
+        "cat,\xE3\x81\xAD\xE3\x81\x93,ignored,animal;n5,\"line one\nline two\"\r\n"
+        "\r\n"
+        ",,,,\r\n"
+        "dog,\xE3\x81\x84\xE3\x81\xAC,,animal,\r\n";
+
+    const std::vector<Lesson> lessons = importAll(path, CsvImporter::optionsFor(path));
+
+    ASSERT_EQ(lessons.size(), 1u);
+    EXPECT_EQ(lessons[0].groupName, "Imported");
+    EXPECT_EQ(lessons[0].mainName, "tadaima_vocabulary");
+    ASSERT_EQ(lessons[0].words.size(), 2u);
+    const Word& cat = lessons[0].words[0];
+    EXPECT_EQ(cat.translation, "cat");
+    EXPECT_EQ(cat.kana, "\xE3\x81\xAD\xE3\x81\x93");
+    EXPECT_EQ(cat.romaji, "neko");
+    EXPECT_EQ(cat.tags, (std::vector<std::string>{ "animal", "n5" }));
+    EXPECT_EQ(cat.exampleSentence, "line one\nline two");
+    EXPECT_EQ(lessons[0].words[1].romaji, "inu");
+
+    CsvImporter::Options unmapped = CsvImporter::optionsFor(path);
+    unmapped.columns = CsvImporter::parseMapping("-,-,tags");
+    EXPECT_THROW(importAll(path, unmapped), std::runtime_error);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(CsvImporterTest, ParallelChunksKeepRowOrderAndLessons)
+{
+    // Tiny chunks put quoted line breaks and lesson changes on chunk boundaries.
+    std::ostringstream csv;
+    csv << "lesson\tkana\ttranslation\n";
+    for( int i = 0; i < 3000; ++i )
+        csv << "L" << i / 700 << "\tk" << i << "\t\"word\n" << i << "\"\n";
+    const std::string path = writeTempFile("tadaima_vocabulary.tsv", csv.str());
+
+    CsvImporter::Options options = CsvImporter::optionsFor(path);
+    options.chunkSize = 64;
+    const std::vector<Lesson> lessons = importAll(path, options, 100);
+
+    ASSERT_EQ(lessons.size(), 5u);
+    int index = 0;
+    for( size_t l = 0; l < lessons.size(); ++l )
+    {
+        EXPECT_EQ(lessons[l].mainName, "L" + std::to_string(l));
+        for( const auto& word : lessons[l].words )
+        {
+            ASSERT_EQ(word.kana, "k" + std::to_string(index));
+            ASSERT_EQ(word.translation, "word\n" + std::to_string(index));
+            ++index;
+        }
+    }
+    EXPECT_EQ(index, 3000);
+
+    std::filesystem::remove(path);
+}
+
+TEST(CsvImporterTest, DISABLED_Throughput)
+{
+    // A multi-million-row list, about 200 MB; every row is different so nothing is shared between the words.
+    std::string csv = "kana,kanji,translation,romaji,tags\n";
+    const int rows = 3000000;
+    csv.reserve(static_cast<size_t>(rows) * 72);
+    for( int i = 0; i < rows; ++i )
+        csv += "\xE3\x81\x9F\xE3\x81\xB9\xE3\x82\x8B,\xE9\xA3\x9F\xE3\x81\xB9\xE3\x82\x8B,\"to eat, to consume " + std::to_string(i) + "\",taberu,verb n5\n";
+    const std::string path = writeTempFile("tadaima_vocabulary_large.csv", csv);
+
+    CsvImporter::Options options = CsvImporter::optionsFor(path);
+    options.chunkSize = 1024 * 1024;
+    int64_t words = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    const LessonImporter::Result result = CsvImporter::importFile(path, options, [&words](const LessonImporter::Batch& batch)
+        {
+            for( const auto& lesson : batch.lessons )
+                words += static_cast<int64_t>(lesson.words.size());
+        });
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    EXPECT_EQ(result.words, rows);
+    EXPECT_EQ(words, rows);
+    std::cout << "[ THROUGHPUT ] " << rows << " rows, " << static_cast<int64_t>(rows / seconds) << " rows/s" << std::endl;
+
+    std::filesystem::remove(path);
+}
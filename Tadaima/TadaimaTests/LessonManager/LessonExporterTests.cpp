@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+#include "lessons/LessonExporter.h"
+#include "lessons/LessonImporter.h"
+#include "../Mocks/TempFiles.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace tadaima;
+
+namespace
+{
+    // Random text with markup characters, whitespace that attribute normalization would eat and multi-byte UTF-8.
+    std::string randomText(std::mt19937& random, size_t maxLength)
+    {
+        static const std::vector<std::string> pieces = {
+            "a", "Z", "7", " ", "  ", "&", "<", ">", "\"", "'", "\n", "\t", "\r\n", ";", "&amp;", "]]>",
+            "\xE3\x81\x82", "\xE7\x8C\xAB", "\xE3\x83\xBC", "\xF0\x9F\x8D\xA3"
+        };
+        std::uniform_int_distribution<size_t> length(0, maxLength);
+        std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+
+        std::string text;
+        for( size_t i = length(random); i > 0; --i )
+            text += pieces[piece(random)];
+        return text;
+    }
+
+    std::vector<Lesson> randomLessons(std::mt19937& random, int lessonCount)
+    {
+        std::uniform_int_distribution<int> wordCount(0, 60);
+        std::uniform_int_distribution<int> tagCount(0, 3);
+        std::bernoulli_distribution hasConjugation(0.3);
+
+        std::vector<Lesson> lessons(lessonCount);
+        for( auto& lesson : lessons )
+        {
+            lesson.groupName = randomText(random, 4);
+            lesson.mainName = randomText(random, 6);
+            lesson.subName = randomText(random, 6);
+            lesson.words.resize(wordCount(random));
+            for( auto& word : lesson.words )
+            {
+                word.kana = randomText(random, 8);
+                word.kanji = randomText(random, 4);
+                word.translation = randomText(random, 10);
+                word.romaji = randomText(random, 8);
+                word.exampleSentence = randomText(random, 30);
+                for( int t = tagCount(random); t > 0; --t )
+                    word.tags.push_back(randomText(random, 5));
+                for( auto& conjugation : word.conjugations )
+                {
+                    if( hasConjugation(random) )
+                        conjugation = randomText(random, 8);
+                }
+            }
+        }
+        return lessons;
+    }
+
+    std::vector<Lesson> importAll(std::istream& input)
+    {
+        std::vector<Lesson> lessons;
+        LessonImporter::importStream(input, [&lessons](const LessonImporter::Batch& batch)
+            {
+                auto lesson = batch.lessons.begin();
+                if( batch.continuesLesson )
+                {
+                    lessons.back().words.insert(lessons.back().words.end(), lesson->words.begin(), lesson->words.end());
+                    ++lesson;
+                }
+                lessons.insert(lessons.end(), lesson, batch.lessons.end());
+            }, nullptr, 97);
+        return lessons;
+    }
+}
+
+TEST(LessonExporterTest, RandomizedExportImportRoundTripIsLossless)
+{
+    std::mt19937 random(20240611);
+    const std::vector<Lesson> lessons = randomLessons(random, 400);
+
+    std::stringstream stream;
+    LessonExporter::exportStream(stream, lessons);
+    const std::vector<Lesson> imported = importAll(stream);
+
+    ASSERT_EQ(imported.size(), lessons.size());
+    for( size_t i = 0; i < lessons.size(); ++i )
+    {
+        ASSERT_EQ(imported[i], lessons[i]) << "lesson " << i;
+    }
+}
+
+TEST(LessonExporterTest, ReadsConjugationsOfOlderExports)
+{
+    // Older exports stored the conjugation as element text next to its index.
+    std::istringstream input(
+        "<lessons><lesson mainName=\"m\"><word kana=\"k\">"
+        "<conjugation index=\"2\">tabeta</conjugation><conjugation index=\"5\">tabenai</conjugation>"
+        "</word></lesson></lessons>");
+
+    const std::vector<Lesson> lessons = importAll(input);
+
+    ASSERT_EQ(lessons.size(), 1u);
+    ASSERT_EQ(lessons[0].words.size(), 1u);
+    const Word& word = lessons[0].words[0];
+    EXPECT_TRUE(word.conjugations[0].empty());
+    EXPECT_EQ(word.conjugations[2], "tabeta");
+    EXPECT_EQ(word.conjugations[5], "tabenai");
+}
+
+TEST(LessonExporterTest, DeltaCarriesDeletionsBeforeTheChangedLessons)
+{
+    LessonChanges changes;
+    changes.sinceVersion = 12;
+    changes.version = 40;
+    changes.tombstones.push_back({ "Group", "Old", "Sub", true, 0, 20 });
+    changes.tombstones.push_back({ "Group", "Main", "Sub", false, 18446744073709551557ull, 31 });
+    Lesson lesson;
+    lesson.groupName = "Group";
+    lesson.mainName = "Main";
+    lesson.subName = "Sub";
+    lesson.words.push_back(Word(0, "\xE3\x81\xAD\xE3\x81\x93", "", "cat", "neko", "", { "n5" }));
+    changes.lessons.push_back(lesson);
+
+    std::stringstream stream;
+    LessonExporter::exportChanges(stream, changes);
+
+    std::vector<LessonImporter::Batch> batches;
+    LessonImporter::importStream(stream, [&batches](const LessonImporter::Batch& batch) { batches.push_back(batch); }, nullptr, 2);
+
+    // Two deletions fill the first batch, the lesson follows in the second.
+    ASSERT_EQ(batches.size(), 2u);
+    EXPECT_TRUE(batches[0].delta);
+    EXPECT_EQ(batches[0].tombstones, changes.tombstones);
+    EXPECT_TRUE(batches[0].lessons.empty());
+    EXPECT_TRUE(batches[1].delta);
+    ASSERT_EQ(batches[1].lessons.size(), 1u);
+    EXPECT_EQ(batches[1].lessons[0], lesson);
+
+    // A full export is not a delta, and older readers ignore the deletions.
+    std::stringstream full;
+    LessonExporter::exportStream(full, { lesson });
+    LessonImporter::importStream(full, [](const LessonImporter::Batch& batch) { EXPECT_FALSE(batch.delta); });
+}
+
+TEST(LessonExporterTest, BackgroundExportReplacesTheFileOnlyWhenComplete)
+{
+    std::mt19937 random(7);
+    std::vector<Lesson> lessons = randomLessons(random, 50);
+    const auto path = uniqueTempPath("tadaima_lesson_export.xml").string();
+    std::ofstream(path) << "previous";
+
+    LessonExporter exporter;
+    ASSERT_TRUE(exporter.start(path, lessons));
+    exporter.wait();
+
+    LessonExporter::Progress progress = exporter.getProgress();
+    EXPECT_TRUE(progress.finished);
+    EXPECT_TRUE(progress.error.empty()) << progress.error;
+    EXPECT_EQ(progress.wordsWritten, progress.totalWords);
+    EXPECT_FALSE(std::filesystem::exists(path + ".part"));
+
+    std::ifstream input(path, std::ios::binary);
+    EXPECT_EQ(importAll(input), lessons);
+    input.close();
+
+    // A cancelled export leaves the existing file alone.
+    const auto size = std::filesystem::file_size(path);
+    EXPECT_THROW(LessonExporter::exportFile(path, lessons, [](int64_t) { return false; }), std::runtime_error);
+    EXPECT_EQ(std::filesystem::file_size(path), size);
+    EXPECT_FALSE(std::filesystem::exists(path + ".part"));
+
+    std::filesystem::remove(path);
+}
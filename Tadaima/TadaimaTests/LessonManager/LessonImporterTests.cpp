@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "lessons/LessonImporter.h"
+#include "MockDatabase.h"
+#include "../Mocks/TempFiles.h"
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+using namespace tadaima;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace
+{
+    std::string makeLessonFile(int lessons, int wordsPerLesson)
+    {
+        std::ostringstream xml;
+        xml << "<?xml version=\"1.0\"?>\n<lessons>\n";
+        for( int l = 0; l < lessons; ++l )
+        {
+            xml << "  <lesson groupName=\"Group\" mainName=\"Main " << l << "\" subName=\"Sub\">\n";
+            for( int w = 0; w < wordsPerLesson; ++w )
+            {
+                xml << "    <word translation=\"word " << w << "\" romaji=\"r\" kana=\"&#12354;\" kanji=\"\" example=\"a &amp; b\">"
+                    << "<tag name=\"t" << w << "\"/><conjugation value=\"c\"/></word>\n";
+            }
+            xml << "  </lesson>\n";
+        }
+        xml << "</lessons>\n";
+        return xml.str();
+    }
+}
+
+TEST(LessonImporterTest, ParsesLessonsWordsTagsAndConjugations)
+{
+    std::istringstream input(makeLessonFile(2, 2));
+    std::vector<LessonImporter::Batch> batches;
+
+    auto result = LessonImporter::importStream(input, [&batches](const LessonImporter::Batch& batch) { batches.push_back(batch); });
+
+    EXPECT_EQ(result.lessons, 2);
+    EXPECT_EQ(result.words, 4);
+    ASSERT_EQ(batches.size(), 1u);
+    ASSERT_EQ(batches[0].lessons.size(), 2u);
+
+    const Lesson& lesson = batches[0].lessons[1];
+    EXPECT_EQ(lesson.groupName, "Group");
+    EXPECT_EQ(lesson.mainName, "Main 1");
+    EXPECT_EQ(lesson.subName, "Sub");
+    ASSERT_EQ(lesson.words.size(), 2u);
+    EXPECT_EQ(lesson.words[1].translation, "word 1");
+    EXPECT_EQ(lesson.words[1].kana, "\xE3\x81\x82");
+    EXPECT_EQ(lesson.words[1].exampleSentence, "a & b");
+    EXPECT_EQ(lesson.words[1].tags, std::vector<std::string>{ "t1" });
+    EXPECT_EQ(lesson.words[1].conjugations[0], "c");
+    EXPECT_TRUE(lesson.words[1].conjugations[1].empty());
+}
+
+TEST(LessonImporterTest, SplitsLargeLessonsIntoBoundedBatches)
+{
+    std::istringstream input(makeLessonFile(3, 25));
+    std::vector<LessonImporter::Batch> batches;
+
+    LessonImporter::importStream(input, [&batches](const LessonImporter::Batch& batch)
+        {
+            size_t items = batch.lessons.size() - (batch.continuesLesson ? 1 : 0);
+            for( const auto& lesson : batch.lessons )
+                items += lesson.words.size();
+            EXPECT_LE(items, 10u);
+            batches.push_back(batch);
+        }, nullptr, 10);
+
+    ASSERT_GT(batches.size(), 3u);
+    EXPECT_FALSE(batches.front().continuesLesson);
+
+    // Put the lessons back together: each one must come out with all its words, in order.
+    std::vector<Lesson> lessons;
+    for( const auto& batch : batches )
+    {
+        auto lesson = batch.lessons.begin();
+        if( batch.continuesLesson )
+        {
+            ASSERT_EQ(lesson->mainName, lessons.back().mainName);
+            lessons.back().words.insert(lessons.back().words.end(), lesson->words.begin(), lesson->words.end());
+            ++lesson;
+        }
+        lessons.insert(lessons.end(), lesson, batch.lessons.end());
+    }
+
+    ASSERT_EQ(lessons.size(), 3u);
+    for( const auto& lesson : lessons )
+    {
+        ASSERT_EQ(lesson.words.size(), 25u);
+        EXPECT_EQ(lesson.words[24].translation, "word 24");
+    }
+}
+
+TEST(LessonImporterTest, RejectsMalformedAndForeignFilesAndStopsWhenCancelled)
+{
+    const auto ignore = [](const LessonImporter::Batch&) {};
+
+    std::istringstream foreign("<JMdict><entry/></JMdict>");
+    EXPECT_THROW(LessonImporter::importStream(foreign, ignore), std::runtime_error);
+
+    std::istringstream truncated("<lessons><lesson mainName=\"a\"><word kana=\"b\">");
+    EXPECT_THROW(LessonImporter::importStream(truncated, ignore), std::runtime_error);
+
+    std::istringstream input(makeLessonFile(10, 10));
+    int delivered = 0;
+    EXPECT_THROW(LessonImporter::importStream(input, [&delivered](const LessonImporter::Batch&) { ++delivered; },
+        [](uint64_t) { return false; }, 10), std::runtime_error);
+    EXPECT_EQ(delivered, 1);
+}
+
+TEST(LessonImporterTest, BackgroundImportWritesEachBatchInATransaction)
+{
+    const std::string path = writeTempFile("tadaima_lesson_import.xml", makeLessonFile(2, 3));
+    auto database = std::make_shared<NiceMock<MockDatabase>>();
+
+    EXPECT_CALL(*database, beginTransaction()).Times(1).WillOnce(Return(true));
+    EXPECT_CALL(*database, commitTransaction()).Times(1).WillOnce(Return(true));
+    EXPECT_CALL(*database, addLesson("Main 0", "Sub", "Group")).WillOnce(Return(1));
+    EXPECT_CALL(*database, addLesson("Main 1", "Sub", "Group")).WillOnce(Return(2));
+    EXPECT_CALL(*database, addWord(1, _)).Times(3).WillRepeatedly(Return(10));
+    EXPECT_CALL(*database, addWord(2, _)).Times(3).WillRepeatedly(Return(11));
+    EXPECT_CALL(*database, deleteLesson(_)).Times(0);
+
+    LessonImporter importer;
+    ASSERT_TRUE(importer.start(path, database));
+    importer.wait();
+
+    auto progress = importer.getProgress();
+    EXPECT_TRUE(progress.finished);
+    EXPECT_TRUE(progress.error.empty()) << progress.error;
+    EXPECT_EQ(progress.imported.lessons, 2);
+    EXPECT_EQ(progress.imported.words, 6);
+    EXPECT_EQ(progress.bytesRead, progress.totalBytes);
+    EXPECT_FALSE(importer.isRunning());
+
+    std::filesystem::remove(path);
+}
+
+TEST(LessonImporterTest, OpensTheDatabaseOnTheImportThread)
+{
+    const std::string path = writeTempFile("tadaima_lesson_import_factory.xml", makeLessonFile(1, 2));
+    auto database = std::make_shared<NiceMock<MockDatabase>>();
+    ON_CALL(*database, beginTransaction()).WillByDefault(Return(true));
+    ON_CALL(*database, commitTransaction()).WillByDefault(Return(true));
+    ON_CALL(*database, addLesson(_, _, _)).WillByDefault(Return(1));
+    ON_CALL(*database, addWord(_, _)).WillByDefault(Return(10));
+
+    std::thread::id openedOn;
+    LessonImporter importer;
+    ASSERT_TRUE(importer.start(path, [&]() -> std::shared_ptr<Database>
+        {
+            openedOn = std::this_thread::get_id();
+            return database;
+        }));
+    importer.wait();
+
+    EXPECT_NE(openedOn, std::thread::id());
+    EXPECT_NE(openedOn, std::this_thread::get_id());
+    EXPECT_TRUE(importer.getProgress().error.empty()) << importer.getProgress().error;
+    EXPECT_EQ(importer.getProgress().imported.words, 2);
+
+    ASSERT_TRUE(importer.start(path, []() -> std::shared_ptr<Database> { return nullptr; }));
+    importer.wait();
+    EXPECT_TRUE(importer.getProgress().finished);
+    EXPECT_EQ(importer.getProgress().error, "Cannot open the lesson database.");
+
+    std::filesystem::remove(path);
+}
+
+TEST(LessonImporterTest, FailedImportRemovesTheLessonsItWrote)
+{
+    // The first batch (most of the first lesson) is committed, then the second lesson cannot be written.
+    const std::string path = writeTempFile("tadaima_lesson_import_failed.xml", makeLessonFile(2, 600));
+    auto database = std::make_shared<NiceMock<MockDatabase>>();
+
+    ON_CALL(*database, beginTransaction()).WillByDefault(Return(true));
+    ON_CALL(*database, commitTransaction()).WillByDefault(Return(true));
+    ON_CALL(*database, addWord(_, _)).WillByDefault(Return(10));
+    EXPECT_CALL(*database, addLesson("Main 0", "Sub", "Group")).WillOnce(Return(7));
+    EXPECT_CALL(*database, addLesson("Main 1", "Sub", "Group")).WillOnce(Return(-1));
+    EXPECT_CALL(*database, commitTransaction()).Times(2);
+    EXPECT_CALL(*database, rollbackTransaction()).Times(1);
+    EXPECT_CALL(*database, getWordsInLesson(7)).WillOnce(Return(std::vector<Word>{ Word(10, "k", "", "t", "", "", {}) }));
+    EXPECT_CALL(*database, deleteWord(10)).Times(1);
+    EXPECT_CALL(*database, deleteLesson(7)).Times(1);
+
+    LessonImporter importer;
+    ASSERT_TRUE(importer.start(path, database));
+    importer.wait();
+
+    auto progress = importer.getProgress();
+    EXPECT_TRUE(progress.finished);
+    EXPECT_FALSE(progress.error.empty());
+    EXPECT_EQ(progress.imported.lessons, 0);
+
+    std::filesystem::remove(path);
+}
+
+TEST(LessonImporterTest, DeltaImportDeletesAndReplacesWords)
+{
+    const std::string path = writeTempFile("tadaima_lesson_delta.xml",
+        "<lessons sinceVersion=\"3\" version=\"9\">"
+        "<deleted groupName=\"Group\" mainName=\"Gone\" subName=\"Sub\" version=\"4\"/>"
+        "<lesson groupName=\"Group\" mainName=\"Main\" subName=\"Sub\">"
+        "<word kana=\"k\" translation=\"t\" romaji=\"\" kanji=\"\" example=\"\"/>"
+        "</lesson></lessons>");
+    auto database = std::make_shared<NiceMock<MockDatabase>>();
+
+    ON_CALL(*database, beginTransaction()).WillByDefault(Return(true));
+    ON_CALL(*database, commitTransaction()).WillByDefault(Return(true));
+    EXPECT_CALL(*database, findLesson("Group", "Gone", "Sub")).WillOnce(Return(5));
+    EXPECT_CALL(*database, getWordsInLesson(5)).WillOnce(Return(std::vector<Word>{ Word(50, "x", "", "y", "", "", {}) }));
+    EXPECT_CALL(*database, deleteWord(50));
+    EXPECT_CALL(*database, deleteLesson(5));
+
+    // The delta clears the romaji the stored word still has, a merge would have kept it.
+    EXPECT_CALL(*database, findLesson("Group", "Main", "Sub")).WillOnce(Return(6));
+    EXPECT_CALL(*database, getWordsInLesson(6)).WillOnce(Return(std::vector<Word>{ Word(60, "k", "N/A", "t", "old", "", {}) }));
+    EXPECT_CALL(*database, updateWord(60, ::testing::Field(&Word::romaji, "")));
+    EXPECT_CALL(*database, addWord(_, _)).Times(0);
+
+    LessonImporter importer;
+    ASSERT_TRUE(importer.start(path, database));
+    importer.wait();
+
+    auto progress = importer.getProgress();
+    EXPECT_TRUE(progress.error.empty()) << progress.error;
+    EXPECT_EQ(progress.report.lessonsDeleted, 1);
+    EXPECT_EQ(progress.report.wordsUpdated, 1);
+
+    std::filesystem::remove(path);
+}
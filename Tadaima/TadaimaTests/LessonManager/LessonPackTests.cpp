@@ -0,0 +1,215 @@
+#include "gtest/gtest.h"
+#include "lessons/LessonImporter.h"
+#include "lessons/LessonPack.h"
+#include "../Mocks/TempFiles.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace tadaima;
+
+namespace
+{
+    std::string randomText(std::mt19937& random, size_t maxLength)
+    {
+        static const std::vector<std::string> pieces = {
+            "a", "Z", "7", " ", "&", "\n", "\xE3\x81\x82", "\xE7\x8C\xAB", "\xF0\x9F\x8D\xA3", std::string(1, '\0')
+        };
+        std::uniform_int_distribution<size_t> length(0, maxLength);
+        std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+
+        std::string text;
+        for( size_t i = length(random); i > 0; --i )
+            text += pieces[piece(random)];
+        return text;
+    }
+
+    std::vector<Lesson> randomLessons(std::mt19937& random, int lessonCount)
+    {
+        std::uniform_int_distribution<int> wordCount(0, 60);
+        std::uniform_int_distribution<int> tagCount(0, 3);
+        std::bernoulli_distribution hasConjugation(0.3);
+
+        std::vector<Lesson> lessons(lessonCount);
+        for( auto& lesson : lessons )
+        {
+            lesson.groupName = randomText(random, 2);
+            lesson.mainName = randomText(random, 6);
+            lesson.subName = randomText(random, 6);
+            lesson.words.resize(wordCount(random));
+            for( auto& word : lesson.words )
+            {
+                word.kana = randomText(random, 8);
+                word.kanji = randomText(random, 4);
+                word.translation = randomText(random, 10);
+                word.romaji = randomText(random, 8);
+                word.exampleSentence = randomText(random, 30);
+                for( int t = tagCount(random); t > 0; --t )
+                    word.tags.push_back(randomText(random, 2));
+                for( auto& conjugation : word.conjugations )
+                {
+                    if( hasConjugation(random) )
+                        conjugation = randomText(random, 8);
+                }
+            }
+        }
+        return lessons;
+    }
+
+    // Packs number lessons and words by their index, the written lessons have no ids.
+    Lesson withoutIds(Lesson lesson)
+    {
+        lesson.id = 0;
+        for( auto& word : lesson.words )
+            word.id = 0;
+        return lesson;
+    }
+
+    class LessonPackTest : public ::testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            std::filesystem::remove(m_path);
+        }
+
+        void writeBytes(const std::string& bytes)
+        {
+            std::ofstream(m_path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        std::string packBytes(const std::vector<Lesson>& lessons)
+        {
+            std::ostringstream output(std::ios::binary);
+            LessonPack::write(output, lessons);
+            return output.str();
+        }
+
+        const std::string m_path = uniqueTempPath("tadaima_lesson_pack.tdpack").string();
+    };
+}
+
+TEST_F(LessonPackTest, RandomizedWriteOpenRoundTripIsLossless)
+{
+    std::mt19937 random(20240612);
+    const std::vector<Lesson> lessons = randomLessons(random, 300);
+    LessonPack::writeFile(m_path, lessons);
+    EXPECT_FALSE(std::filesystem::exists(m_path + ".part"));
+
+    LessonPack pack;
+    ASSERT_TRUE(pack.open(m_path)) << pack.getError();
+    EXPECT_TRUE(pack.verifyChecksum());
+    ASSERT_EQ(pack.getLessonCount(), lessons.size());
+
+    size_t words = 0;
+    for( size_t i = 0; i < lessons.size(); ++i )
+    {
+        const Lesson lesson = pack.getLesson(i);
+        EXPECT_EQ(lesson.id, static_cast<int>(i));
+        ASSERT_EQ(withoutIds(lesson), lessons[i]) << "lesson " << i;
+        words += lessons[i].words.size();
+    }
+    EXPECT_EQ(pack.getWordCount(), words);
+}
+
+TEST_F(LessonPackTest, DetectsDamagedAndForeignFiles)
+{
+    std::mt19937 random(3);
+    const std::string bytes = packBytes(randomLessons(random, 10));
+    LessonPack pack;
+
+    // A flipped byte in the body is found by the checksum only.
+    std::string damaged = bytes;
+    damaged[damaged.size() / 2] ^= 0x20;
+    writeBytes(damaged);
+    ASSERT_TRUE(pack.open(m_path));
+    EXPECT_FALSE(pack.verifyChecksum());
+
+    std::string foreign = bytes;
+    foreign[0] = 'X';
+    writeBytes(foreign);
+    EXPECT_FALSE(pack.open(m_path));
+    EXPECT_FALSE(pack.isOpen());
+
+    std::string newer = bytes;
+    const uint32_t version = LessonPack::VERSION + 1;
+    std::memcpy(&newer[offsetof(LessonPack::Header, version)], &version, sizeof(version));
+    writeBytes(newer);
+    EXPECT_FALSE(pack.open(m_path));
+
+    // Tables must lie inside the file.
+    writeBytes(bytes.substr(0, bytes.size() - 1));
+    EXPECT_FALSE(pack.open(m_path));
+    EXPECT_FALSE(pack.getError().empty());
+
+    writeBytes(bytes.substr(0, sizeof(LessonPack::Header) - 1));
+    EXPECT_FALSE(pack.open(m_path));
+
+    writeBytes(bytes);
+    ASSERT_TRUE(pack.open(m_path));
+    EXPECT_TRUE(pack.verifyChecksum());
+}
+
+TEST_F(LessonPackTest, ImportPackSplitsLessonsIntoBatches)
+{
+    std::vector<Lesson> lessons(3);
+    lessons[0].mainName = "small";
+    lessons[0].words.resize(2);
+    lessons[1].mainName = "big";
+    lessons[1].words.resize(25);
+    for( size_t i = 0; i < lessons[1].words.size(); ++i )
+        lessons[1].words[i].kana = std::to_string(i);
+    lessons[2].mainName = "empty";
+    LessonPack::writeFile(m_path, lessons);
+
+    LessonPack pack;
+    ASSERT_TRUE(pack.open(m_path));
+
+    std::vector<Lesson> imported;
+    size_t batches = 0;
+    uint64_t lastProgress = 0;
+    const LessonImporter::Result result = LessonImporter::importPack(pack, [&](const LessonImporter::Batch& batch)
+        {
+            ++batches;
+            size_t items = 0;
+            auto lesson = batch.lessons.begin();
+            if( batch.continuesLesson )
+            {
+                imported.back().words.insert(imported.back().words.end(), lesson->words.begin(), lesson->words.end());
+                items += lesson->words.size() + 1;
+                ++lesson;
+            }
+            for( ; lesson != batch.lessons.end(); ++lesson )
+            {
+                imported.push_back(*lesson);
+                items += lesson->words.size() + 1;
+            }
+            EXPECT_LE(items, 10u + 1);
+        },
+        [&](uint64_t bytesRead)
+        {
+            EXPECT_GE(bytesRead, lastProgress);
+            lastProgress = bytesRead;
+            return true;
+        }, 10);
+
+    EXPECT_EQ(result.lessons, 3);
+    EXPECT_EQ(result.words, 27);
+    EXPECT_GT(batches, 2u);
+    EXPECT_EQ(lastProgress, pack.getFileSize());
+    ASSERT_EQ(imported.size(), lessons.size());
+    for( size_t i = 0; i < lessons.size(); ++i )
+        EXPECT_EQ(withoutIds(imported[i]), lessons[i]);
+
+    EXPECT_THROW(LessonImporter::importPack(pack, [](const LessonImporter::Batch&) {}, [](uint64_t) { return false; }), std::runtime_error);
+}
+
+TEST_F(LessonPackTest, RecognizesPackPaths)
+{
+    EXPECT_TRUE(LessonPack::isPackPath("lessons.tdpack"));
+    EXPECT_TRUE(LessonPack::isPackPath("C:\\Decks\\N5.TDPACK"));
+    EXPECT_FALSE(LessonPack::isPackPath("lessons.xml"));
+    EXPECT_FALSE(LessonPack::isPackPath("tdpack"));
+}
@@ -0,0 +1,148 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "lessons/LessonUpserter.h"
+#include "lessons/WordFingerprint.h"
+#include "MockDatabase.h"
+
+using namespace tadaima;
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::Field;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace
+{
+    Lesson makeLesson(const std::vector<Word>& words)
+    {
+        Lesson lesson;
+        lesson.groupName = "Group";
+        lesson.mainName = "Main";
+        lesson.subName = "Sub";
+        lesson.words = words;
+        return lesson;
+    }
+}
+
+TEST(WordFingerprintTest, IgnoresCaseSpacingAndMissingKanji)
+{
+    const Word word{ 1, "\xE3\x81\xAD\xE3\x81\x93", "", "cat, kitten", "neko", "", {} };
+    const Word same{ 2, "\xE3\x81\xAD\xE3\x81\x93 ", "N/A", "  Cat,\xE3\x80\x80 KITTEN", "neko", "example", { "n5" } };
+    const Word other{ 3, "\xE3\x81\xAD\xE3\x81\x93", "\xE7\x8C\xAB", "cat, kitten", "neko", "", {} };
+
+    EXPECT_EQ(WordFingerprint::of(word), WordFingerprint::of(same));
+    EXPECT_NE(WordFingerprint::of(word), WordFingerprint::of(other));
+    EXPECT_EQ(WordFingerprint::normalize("\tTo  eat\n"), "to eat");
+    EXPECT_EQ(WordFingerprint::normalize("N/A"), "");
+
+    // Text cannot move from one field to the next.
+    const Word shifted{ 4, "\xE3\x81\xAD\xE3\x81\x93 cat,", "", "kitten", "neko", "", {} };
+    EXPECT_NE(WordFingerprint::of(word), WordFingerprint::of(shifted));
+}
+
+TEST(LessonUpserterTest, SkipsIdenticalUpdatesChangedAndAddsNewWords)
+{
+    NiceMock<MockDatabase> database;
+    const Word stored{ 5, "\xE3\x81\x84\xE3\x81\xAC", "N/A", "dog", "inu", "", { "animal" } };
+    const Word unchanged{ 6, "\xE3\x81\xAD\xE3\x81\x93", "N/A", "cat", "neko", "", {} };
+    EXPECT_CALL(database, findLesson("Group", "Main", "Sub")).WillOnce(Return(3));
+    EXPECT_CALL(database, getWordsInLesson(3)).WillOnce(Return(std::vector<Word>{ stored, unchanged }));
+    EXPECT_CALL(database, addLesson(_, _, _)).Times(0);
+
+    Word changed{ 0, "\xE3\x81\x84\xE3\x81\xAC", "", "Dog", "", "", { "n5" } };
+    changed.exampleSentence = "A dog barks.";
+    const Word added{ 0, "\xE3\x81\xA8\xE3\x82\x8A", "", "bird", "tori", "", { "animal" } };
+    const Word sameCat{ 0, "\xE3\x81\xAD\xE3\x81\x93", "", "cat", "", "", {} };
+
+    EXPECT_CALL(database, updateWord(5, AllOf(Field(&Word::translation, "dog"), Field(&Word::romaji, "inu"),
+        Field(&Word::exampleSentence, "A dog barks."), Field(&Word::tags, std::vector<std::string>{ "animal", "n5" }))));
+    EXPECT_CALL(database, updateWord(6, _)).Times(0);
+    EXPECT_CALL(database, addWord(3, added)).WillOnce(Return(9));
+    EXPECT_CALL(database, addTag(9, "animal"));
+
+    LessonUpserter upserter(database);
+    EXPECT_EQ(upserter.upsert(makeLesson({ changed, added })), 3);
+    // A continued batch of the same lesson is matched against the cached words.
+    EXPECT_EQ(upserter.upsert(makeLesson({ sameCat, added })), 3);
+
+    const LessonUpserter::Report& report = upserter.getReport();
+    EXPECT_EQ(report.lessonsAdded, 0);
+    EXPECT_EQ(report.lessonsMatched, 1);
+    EXPECT_EQ(report.wordsAdded, 1);
+    EXPECT_EQ(report.wordsUpdated, 1);
+    EXPECT_EQ(report.wordsUnchanged, 2);
+    EXPECT_TRUE(upserter.getAddedLessonIds().empty());
+    EXPECT_EQ(upserter.getAddedWordIds(), std::vector<int>{ 9 });
+}
+
+TEST(LessonUpserterTest, DryRunOnlyCounts)
+{
+    NiceMock<MockDatabase> database;
+    EXPECT_CALL(database, addLesson(_, _, _)).Times(0);
+    EXPECT_CALL(database, addWord(_, _)).Times(0);
+    EXPECT_CALL(database, addTag(_, _)).Times(0);
+    EXPECT_CALL(database, updateWord(_, _)).Times(0);
+
+    const Word word{ 0, "\xE3\x81\xAD\xE3\x81\x93", "", "cat", "neko", "", { "n5" } };
+    LessonUpserter upserter(database, true);
+    EXPECT_EQ(upserter.upsert(makeLesson({ word, word })), -1);
+
+    EXPECT_EQ(upserter.getReport().lessonsAdded, 1);
+    EXPECT_EQ(upserter.getReport().wordsAdded, 1);
+    EXPECT_EQ(upserter.getReport().wordsUnchanged, 1);
+    EXPECT_EQ(upserter.getReport().toString(), "1 lessons added, 0 matched, 1 words added, 0 updated, 1 unchanged");
+}
+
+TEST(LessonUpserterTest, MergesDuplicateLessonsAndWordsInOneTransaction)
+{
+    NiceMock<MockDatabase> database;
+    EXPECT_CALL(database, beginTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(database, commitTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(database, rollbackTransaction()).Times(0);
+    EXPECT_CALL(database, findDuplicateLessons()).WillOnce(Return(std::vector<std::vector<int>>{ { 1, 4 } }));
+    EXPECT_CALL(database, moveWords(4, 1));
+    EXPECT_CALL(database, deleteLesson(4));
+
+    const Word kept{ 10, "\xE3\x81\xAD\xE3\x81\x93", "N/A", "cat", "neko", "", { "n5" } };
+    const Word duplicate{ 12, "\xE3\x81\xAD\xE3\x81\x93", "\xE7\x8C\xAB", "Cat", "", "A cat.", { "animal", "n5" } };
+    EXPECT_CALL(database, findDuplicateWords()).WillOnce(Return(MockDatabase::DuplicateWords{ { 1, { { 10, 12 } } } }));
+    EXPECT_CALL(database, getWordsInLesson(1)).WillOnce(Return(std::vector<Word>{ kept, duplicate }));
+    EXPECT_CALL(database, deleteWord(12));
+    EXPECT_CALL(database, updateWord(10, AllOf(Field(&Word::translation, "cat"), Field(&Word::kanji, "\xE7\x8C\xAB"),
+        Field(&Word::exampleSentence, "A cat."), Field(&Word::tags, std::vector<std::string>{ "n5", "animal" }))));
+
+    const LessonUpserter::Report report = LessonUpserter::mergeDuplicates(database);
+    EXPECT_EQ(report.lessonsMerged, 1);
+    EXPECT_EQ(report.wordsMerged, 1);
+}
+
+TEST(LessonUpserterTest, DryRunMergeRollsBack)
+{
+    NiceMock<MockDatabase> database;
+    EXPECT_CALL(database, beginTransaction()).WillOnce(Return(true));
+    EXPECT_CALL(database, commitTransaction()).Times(0);
+    EXPECT_CALL(database, rollbackTransaction()).Times(1);
+    ON_CALL(database, findDuplicateLessons()).WillByDefault(Return(std::vector<std::vector<int>>{ { 1, 2, 3 } }));
+
+    EXPECT_EQ(LessonUpserter::mergeDuplicates(database, true).lessonsMerged, 2);
+}
+
+TEST(LessonUpserterTest, RemovesWordsAndLessonsNamedByTombstones)
+{
+    NiceMock<MockDatabase> database;
+    const Word cat{ 7, "\xE3\x81\xAD\xE3\x81\x93", "N/A", "cat", "neko", "", {} };
+    const Word dog{ 8, "\xE3\x81\x84\xE3\x81\xAC", "N/A", "dog", "inu", "", {} };
+    ON_CALL(database, findLesson("Group", "Main", "Sub")).WillByDefault(Return(3));
+    ON_CALL(database, getWordsInLesson(3)).WillByDefault(Return(std::vector<Word>{ cat, dog }));
+    EXPECT_CALL(database, deleteWord(8));
+    EXPECT_CALL(database, deleteWord(7)).Times(0);
+    EXPECT_CALL(database, deleteLesson(_)).Times(0);
+
+    LessonUpserter upserter(database);
+    upserter.remove({ "Group", "Main", "Sub", false, WordFingerprint::of(dog), 5 });
+    // Unknown lessons are already gone.
+    upserter.remove({ "Group", "Other", "Sub", true, 0, 6 });
+
+    EXPECT_EQ(upserter.getReport().wordsDeleted, 1);
+    EXPECT_EQ(upserter.getReport().lessonsDeleted, 0);
+}
@@ -11,6 +11,14 @@
 class MockDatabase : public tadaima::Database
 {
 public:
+    /**
+     * @brief Makes findLesson() report that no lesson exists unless a test says otherwise.
+     */
+    MockDatabase()
+    {
+        ON_CALL(*this, findLesson).WillByDefault(::testing::Return(-1));
+    }
+
     /**
      * @brief Mock method to add a new lesson to the database.
      * @param mainName The main name of the lesson.
@@ -70,6 +78,57 @@ public:
      */
     MOCK_METHOD(void, deleteWord, (int wordId), (override));
 
+    /**
+     * @brief Mock method to find a lesson by its names.
+     * @return The ID of the lesson, or -1 if there is none.
+     */
+    MOCK_METHOD(int, findLesson, (const std::string& groupName, const std::string& mainName, const std::string& subName), (const, override));
+
+    /**
+     * @brief Mock method to find lessons that have the same names.
+     * @return The IDs of each set of duplicates.
+     */
+    MOCK_METHOD(std::vector<std::vector<int>>, findDuplicateLessons, (), (const, override));
+
+    /**
+     * @brief Mock method to find words of the same lesson with the same fingerprint.
+     * @return The IDs of each set of duplicates, by lesson ID.
+     */
+    using DuplicateWords = std::map<int, std::vector<std::vector<int>>>;
+    MOCK_METHOD(DuplicateWords, findDuplicateWords, (), (const, override));
+
+    /**
+     * @brief Mock method to move all words of a lesson to another lesson.
+     * @param fromLessonId The lesson that loses its words.
+     * @param toLessonId The lesson that receives them.
+     */
+    MOCK_METHOD(void, moveWords, (int fromLessonId, int toLessonId), (override));
+
+    /**
+     * @brief Mock method to return the version of the database.
+     * @return The version.
+     */
+    MOCK_METHOD(int64_t, getVersion, (), (const, override));
+
+    /**
+     * @brief Mock method to collect the changes made after a version.
+     * @param version The version of the last sync.
+     * @return The changes.
+     */
+    MOCK_METHOD(tadaima::LessonChanges, getChangesSince, (int64_t version), (const, override));
+
+    /**
+     * @brief Mock method to return the version of the last delta export.
+     * @return The version.
+     */
+    MOCK_METHOD(int64_t, getExportedVersion, (), (const, override));
+
+    /**
+     * @brief Mock method to record the version of a delta export.
+     * @param version The exported version.
+     */
+    MOCK_METHOD(void, setExportedVersion, (int64_t version), (override));
+
     /**
      * @brief Mock method to retrieve the names of all lessons in the database.
      * @return A vector of strings containing the names of all lessons.
@@ -100,4 +159,21 @@ public:
      * @return An ApplicationSettings object containing the loaded settings.
      */
     MOCK_METHOD(tadaima::application::ApplicationSettings, loadSettings, (), (override));
+
+    /**
+     * @brief Mock method to start a transaction.
+     * @return True if the transaction was started.
+     */
+    MOCK_METHOD(bool, beginTransaction, (), (override));
+
+    /**
+     * @brief Mock method to commit the current transaction.
+     * @return True if the changes were written.
+     */
+    MOCK_METHOD(bool, commitTransaction, (), (override));
+
+    /**
+     * @brief Mock method to roll back the current transaction.
+     */
+    MOCK_METHOD(void, rollbackTransaction, (), (override));
 };
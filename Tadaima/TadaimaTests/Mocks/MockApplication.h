@@ -12,5 +12,11 @@ using namespace ::testing;
 class MockApplication : public Application
 {
 public:
-   // MOCK_METHOD(void, setEvent, (ApplicationEvent event, const std::any& data), (override));
+    MockApplication(tools::Logger& logger, EventBridge& eventBridge) : Application(logger, eventBridge)
+    {
+
+    }
+
+    using Application::setEvent;
+    MOCK_METHOD(void, setEvent, (ApplicationEvent event, ApplicationCommand::Data data), (override));
 };
\ No newline at end of file
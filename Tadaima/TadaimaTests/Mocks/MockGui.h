@@ -19,6 +19,5 @@ public:
 
     }
 
-    MOCK_METHOD(void, addListener, (widget::Type type, std::function<void(const WidgetEvent*)> callback), (override));
     MOCK_METHOD(void, initializeWidget, (const tools::DataPackage& data), (override));
 };
\ No newline at end of file
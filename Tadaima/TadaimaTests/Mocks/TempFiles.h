@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Returns a path in the temp directory that no other test and no other test process uses.
+ *
+ * The process id and a counter are put between the stem and the extension of the name, e.g.
+ * `tadaima_lesson_import_4711_3.xml`, so test binaries running side by side never share a file.
+ * A leftover of a crashed run with the same process id is removed.
+ *
+ * @param name The file or directory name, e.g. "tadaima_lesson_import.xml".
+ */
+inline std::filesystem::path uniqueTempPath(const std::string& name)
+{
+    static std::atomic<unsigned> counter{ 0 };
+#ifdef _WIN32
+    const int processId = _getpid();
+#else
+    const int processId = static_cast<int>(getpid());
+#endif
+
+    const std::filesystem::path file(name);
+    const std::string unique = file.stem().string() + "_" + std::to_string(processId) + "_" + std::to_string(++counter) + file.extension().string();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / unique;
+    std::error_code error;
+    std::filesystem::remove_all(path, error);
+    return path;
+}
+
+/**
+ * @brief Writes a file with a unique name (see uniqueTempPath()) to the temp directory.
+ *
+ * @param name The file name the unique name is made from.
+ * @param content The bytes of the file.
+ * @return The path of the file.
+ */
+inline std::string writeTempFile(const std::string& name, const std::string& content)
+{
+    const std::filesystem::path path = uniqueTempPath(name);
+    std::ofstream(path, std::ios::binary) << content;
+    return path.string();
+}
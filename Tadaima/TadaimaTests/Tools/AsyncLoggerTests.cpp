@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include "Tools/AsyncLogger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using tools::AsyncLogger;
+using tools::LogLevel;
+
+namespace
+{
+    AsyncLogger::Options plainOptions()
+    {
+        AsyncLogger::Options options;
+        options.colors = false;
+        return options;
+    }
+
+    std::vector<std::string> lines(const std::string& text)
+    {
+        std::vector<std::string> result;
+        std::istringstream stream(text);
+        for( std::string line; std::getline(stream, line); )
+            result.push_back(line);
+        return result;
+    }
+
+    // Holds the writer inside its first write until opened, so the ring buffer fills up.
+    class GateBuffer : public std::streambuf
+    {
+    public:
+        void waitUntilEntered()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [this]() { return m_entered; });
+        }
+
+        void open()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_changed.notify_all();
+        }
+
+        std::string text()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_text;
+        }
+
+    protected:
+        std::streamsize xsputn(const char* data, std::streamsize size) override
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_entered = true;
+            m_changed.notify_all();
+            m_changed.wait(lock, [this]() { return m_open; });
+            m_text.append(data, static_cast<size_t>(size));
+            return size;
+        }
+
+        int overflow(int character) override
+        {
+            if( character != traits_type::eof() )
+            {
+                const char value = static_cast<char>(character);
+                xsputn(&value, 1);
+            }
+            return character;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_changed;
+        bool m_entered = false;
+        bool m_open = false;
+        std::string m_text;
+    };
+
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        std::streamsize xsputn(const char*, std::streamsize size) override { return size; }
+        int overflow(int character) override { return character; }
+    };
+}
+
+TEST(AsyncLoggerTest, WritesEveryMessageOfEveryThreadOnStop)
+{
+    std::ostringstream output;
+    const int threads = 4;
+    const int messagesPerThread = 5000;
+    {
+        AsyncLogger::Options options = plainOptions();
+        options.capacity = 64;
+        AsyncLogger logger(options, output);
+
+        std::vector<std::thread> producers;
+        for( int t = 0; t < threads; ++t )
+        {
+            producers.emplace_back([&logger, t, messagesPerThread]()
+                {
+                    for( int i = 0; i < messagesPerThread; ++i )
+                        logger.log(std::to_string(t) + ":" + std::to_string(i), LogLevel::INFO);
+                });
+        }
+        for( auto& producer : producers )
+            producer.join();
+    }
+
+    const std::vector<std::string> written = lines(output.str());
+    ASSERT_EQ(written.size(), static_cast<size_t>(threads * messagesPerThread));
+    EXPECT_TRUE(std::regex_match(written[0], std::regex(R"(\[\d{4}-\d\d-\d\d \d\d:\d\d:\d\d\.\d{3}\]\[INFO\]: \d:\d+)"))) << written[0];
+
+    // Each thread's messages keep their order.
+    std::vector<int> next(threads, 0);
+    bool ordered = true;
+    for( const std::string& line : written )
+    {
+        const size_t text = line.find("]: ") + 3;
+        const int thread = line[text] - '0';
+        ordered = ordered && std::stoi(line.substr(text + 2)) == next[thread]++;
+    }
+    EXPECT_TRUE(ordered);
+}
+
+TEST(AsyncLoggerTest, KeepsMessagesLoggedWhileStopping)
+{
+    std::ostringstream output;
+    const int threads = 4;
+    const int messagesPerThread = 20000;
+    AsyncLogger::Options options = plainOptions();
+    options.capacity = 64;
+    AsyncLogger logger(options, output);
+
+    std::atomic<int> started = 0;
+    std::vector<std::thread> producers;
+    for( int t = 0; t < threads; ++t )
+    {
+        producers.emplace_back([&logger, &started, messagesPerThread]()
+            {
+                ++started;
+                for( int i = 0; i < messagesPerThread; ++i )
+                    logger.log("message", LogLevel::INFO);
+            });
+    }
+    while( started < threads )
+        std::this_thread::yield();
+
+    // The producers race with stop(), the messages queued after its drain must not be lost.
+    logger.stop();
+    for( auto& producer : producers )
+        producer.join();
+
+    EXPECT_EQ(lines(output.str()).size(), static_cast<size_t>(threads * messagesPerThread));
+}
+
+TEST(AsyncLoggerTest, FiltersByVerbosityAndCutsLongMessages)
+{
+    std::ostringstream output;
+    AsyncLogger::Options options = plainOptions();
+    options.verbosity = LogLevel::INFO;
+    AsyncLogger logger(options, output);
+
+    logger.log("hidden", LogLevel::DEBUG);
+    logger.log(std::string(1000, 'x'), LogLevel::PROBLEM);
+    logger.stop();
+    logger.log("after stop", LogLevel::WARNING);
+
+    const std::vector<std::string> written = lines(output.str());
+    ASSERT_EQ(written.size(), 2u);
+    const std::string expected = "[ERROR]: " + std::string(AsyncLogger::RECORD_TEXT_SIZE - 3, 'x') + "...";
+    EXPECT_NE(written[0].find(expected), std::string::npos);
+    EXPECT_EQ(written[0].size(), written[0].find("[ERROR]") + expected.size());
+    EXPECT_NE(written[1].find("[WARNING]: after stop"), std::string::npos);
+}
+
+TEST(AsyncLoggerTest, DropPolicyCountsAndReportsLostMessages)
+{
+    GateBuffer gate;
+    std::ostream output(&gate);
+    AsyncLogger::Options options = plainOptions();
+    options.capacity = 4;
+    options.overflow = AsyncLogger::OverflowPolicy::Drop;
+    AsyncLogger logger(options, output);
+
+    logger.log("first", LogLevel::INFO);
+    gate.waitUntilEntered();
+    for( int i = 0; i < 7; ++i )
+        logger.log("queued " + std::to_string(i), LogLevel::INFO);
+    EXPECT_EQ(logger.droppedCount(), 3u);
+
+    gate.open();
+    logger.stop();
+    const std::string text = gate.text();
+    EXPECT_NE(text.find("queued 3"), std::string::npos);
+    EXPECT_EQ(text.find("queued 4"), std::string::npos);
+    EXPECT_NE(text.find("[WARNING]: AsyncLogger: 3 messages were dropped"), std::string::npos);
+}
+
+TEST(AsyncLoggerTest, DISABLED_ProducerCost)
+{
+    NullBuffer discard;
+    std::ostream output(&discard);
+    const int messages = 1000000;
+    const std::string message = "ApplicationDatabase::addWord: Added word with ID 123456 to lesson 42";
+
+    for( int threads : { 1, 4 } )
+    {
+        AsyncLogger logger(plainOptions(), output);
+        const auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> producers;
+        for( int t = 0; t < threads; ++t )
+        {
+            producers.emplace_back([&logger, &message, threads, messages]()
+                {
+                    for( int i = 0; i < messages / threads; ++i )
+                        logger.log(message, LogLevel::INFO);
+                });
+        }
+        for( auto& producer : producers )
+            producer.join();
+        const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / messages;
+        logger.stop();
+
+        EXPECT_EQ(logger.droppedCount(), 0u);
+        std::cout << "[ LATENCY ] AsyncLogger::log " << nanoseconds << " ns/call with " << threads << " threads" << std::endl;
+    }
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "Tools/DataPackage.h"
+#include <chrono>
+#include <iostream>
+#include <string>
 
 namespace tools
 {
@@ -62,4 +65,89 @@ namespace tools
         cdp.set<int>(1, 100);
         EXPECT_THROW(cdp.get<std::string>(1), std::runtime_error);
     }
+    enum class TestKey : uint32_t
+    {
+        Count,
+        Name,
+        Enabled
+    };
+
+    using TestKeyedPackage = KeyedDataPackage<TestKey,
+        PackageField<TestKey::Count, int>,
+        PackageField<TestKey::Name, std::string>,
+        PackageField<TestKey::Enabled, bool>>;
+
+    using PlainKeyedPackage = KeyedDataPackage<TestKey,
+        PackageField<TestKey::Count, int>,
+        PackageField<TestKey::Name, uint16_t>,
+        PackageField<TestKey::Enabled, bool>>;
+
+    static_assert(std::is_same_v<TestKeyedPackage::ValueType<TestKey::Name>, std::string>);
+    static_assert(std::is_trivially_copyable_v<PlainKeyedPackage::Values>);
+
+    TEST(KeyedDataPackageTest, SetAndGetValues)
+    {
+        TestKeyedPackage package(42);
+        EXPECT_EQ(package.id(), 42);
+
+        package.set<TestKey::Count>(100);
+        package.set<TestKey::Name>("test");
+        package.set<TestKey::Enabled>(true);
+
+        EXPECT_EQ(package.get<TestKey::Count>(), 100);
+        EXPECT_EQ(package.get<TestKey::Name>(), "test");
+        EXPECT_TRUE(package.get<TestKey::Enabled>());
+    }
+
+    TEST(KeyedDataPackageTest, GetReturnsDefaultForUnsetKey)
+    {
+        TestKeyedPackage package;
+        EXPECT_EQ(package.get<TestKey::Count>(), 0);
+        EXPECT_EQ(package.get<TestKey::Name>(), "");
+        EXPECT_FALSE(package.get<TestKey::Enabled>());
+    }
+
+    TEST(KeyedDataPackageTest, CopiesKeepTheirOwnValues)
+    {
+        PlainKeyedPackage package;
+        package.set<TestKey::Name>(7);
+        PlainKeyedPackage copy = package;
+        copy.set<TestKey::Name>(8);
+
+        EXPECT_EQ(package.get<TestKey::Name>(), 7);
+        EXPECT_EQ(copy.get<TestKey::Name>(), 8);
+    }
+
+    TEST(KeyedDataPackageTest, DISABLED_Throughput)
+    {
+        const int packages = 200000;
+        const std::string name = "user";
+        int64_t checksum = 0;
+
+        const auto complexBegin = std::chrono::steady_clock::now();
+        for( int i = 0; i < packages; ++i )
+        {
+            ComplexDataPackage<TestKey, int, std::string, bool> package;
+            package.set(TestKey::Count, i);
+            package.set(TestKey::Name, name);
+            package.set(TestKey::Enabled, true);
+            checksum += package.get<int>(TestKey::Count) + package.get<std::string>(TestKey::Name).size() + package.get<bool>(TestKey::Enabled);
+        }
+        const auto keyedBegin = std::chrono::steady_clock::now();
+        for( int i = 0; i < packages; ++i )
+        {
+            TestKeyedPackage package;
+            package.set<TestKey::Count>(i);
+            package.set<TestKey::Name>(name);
+            package.set<TestKey::Enabled>(true);
+            checksum -= package.get<TestKey::Count>() + package.get<TestKey::Name>().size() + package.get<TestKey::Enabled>();
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        EXPECT_EQ(checksum, 0);
+        const double complexSeconds = std::chrono::duration<double>(keyedBegin - complexBegin).count();
+        const double keyedSeconds = std::chrono::duration<double>(end - keyedBegin).count();
+        std::cout << "[ THROUGHPUT ] ComplexDataPackage " << static_cast<int64_t>(packages / complexSeconds) << " packages/s, KeyedDataPackage "
+            << static_cast<int64_t>(packages / keyedSeconds) << " packages/s" << std::endl;
+    }
 } // namespace tools
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "Tools/Logger.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using tools::LogLevel;
+
+namespace
+{
+    class RecordingLogger : public tools::Logger
+    {
+    public:
+        explicit RecordingLogger(LogLevel verbosity) : Logger(verbosity) {}
+
+        void log(const std::string& message, LogLevel level) override
+        {
+            if( level >= m_verbosity )
+                messages.emplace_back(level, message);
+        }
+
+        std::vector<std::pair<LogLevel, std::string>> messages;
+    };
+}
+
+TEST(LoggerTest, LevelFunctionsFormatOnlyEnabledMessages)
+{
+    RecordingLogger logger(LogLevel::INFO);
+    int built = 0;
+    auto expensive = [&built]() { ++built; return std::string("lessons"); };
+
+    logger.debug("Word {} added", 42);
+    logger.debug(expensive);
+    logger.info("Word {} added to lesson {}", 42, std::string("Animals"));
+    logger.warning(expensive);
+    logger.problem("Plain");
+
+    ASSERT_EQ(logger.messages.size(), 3u);
+    EXPECT_EQ(logger.messages[0], std::make_pair(LogLevel::INFO, std::string("Word 42 added to lesson Animals")));
+    EXPECT_EQ(logger.messages[1], std::make_pair(LogLevel::WARNING, std::string("lessons")));
+    EXPECT_EQ(logger.messages[2], std::make_pair(LogLevel::PROBLEM, std::string("Plain")));
+    EXPECT_EQ(built, 1);
+
+    EXPECT_FALSE(logger.isEnabled(LogLevel::DEBUG));
+    EXPECT_TRUE(logger.isEnabled(LogLevel::INFO));
+    EXPECT_FALSE(logger.isEnabled(LogLevel::VERBOSE));
+}
+
+TEST(LoggerTest, DISABLED_FilteredOutCallLatency)
+{
+    RecordingLogger logger(LogLevel::WARNING);
+    const int calls = 10000000;
+    const int wordId = 123456;
+    const int lessonId = 42;
+
+    const auto begin = std::chrono::steady_clock::now();
+    for( int i = 0; i < calls; ++i )
+        logger.log("Database: Added word with ID " + std::to_string(wordId + i) + " to lesson ID " + std::to_string(lessonId), LogLevel::INFO);
+    const auto middle = std::chrono::steady_clock::now();
+    for( int i = 0; i < calls; ++i )
+        logger.info("Database: Added word with ID {} to lesson ID {}", wordId + i, lessonId);
+    const auto end = std::chrono::steady_clock::now();
+
+    EXPECT_TRUE(logger.messages.empty());
+    const double eagerNs = std::chrono::duration<double, std::nano>(middle - begin).count() / calls;
+    const double lazyNs = std::chrono::duration<double, std::nano>(end - middle).count() / calls;
+    std::cout << "[ LATENCY ] Filtered-out log() " << eagerNs << " ns/call, info() " << lazyNs << " ns/call" << std::endl;
+}
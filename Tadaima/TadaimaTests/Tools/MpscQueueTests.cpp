@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include "Tools/MpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Item
+    {
+        int producer = 0;
+        int sequence = 0;
+        std::string payload;
+    };
+}
+
+TEST(MpscQueueTest, KeepsOrderAndReportsFull)
+{
+    tools::MpscQueue<Item> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+
+    for( int i = 0; i < 4; ++i )
+    {
+        Item item{ 0, i, "item " + std::to_string(i) };
+        EXPECT_TRUE(queue.tryPush(item));
+        EXPECT_TRUE(item.payload.empty());
+    }
+    Item overflow{ 0, 4, "kept" };
+    EXPECT_FALSE(queue.tryPush(overflow));
+    EXPECT_EQ(overflow.payload, "kept");
+
+    Item item;
+    for( int i = 0; i < 4; ++i )
+    {
+        ASSERT_TRUE(queue.tryPop(item));
+        EXPECT_EQ(item.sequence, i);
+        EXPECT_EQ(item.payload, "item " + std::to_string(i));
+    }
+    EXPECT_FALSE(queue.tryPop(item));
+    EXPECT_TRUE(queue.tryPush(overflow));
+}
+
+TEST(MpscQueueTest, LosesNoEventOfConcurrentProducers)
+{
+    // A small queue makes the producers wait for the consumer over and over.
+    tools::MpscQueue<Item> queue(16);
+    const int producers = 4;
+    const int itemsPerProducer = 50000;
+
+    std::vector<int> received(producers, 0);
+    bool ordered = true;
+    std::thread consumer([&]()
+        {
+            Item item;
+            while( queue.waitPop(item) )
+            {
+                ordered = ordered && item.sequence == received[item.producer];
+                ++received[item.producer];
+            }
+        });
+
+    std::vector<std::thread> threads;
+    for( int p = 0; p < producers; ++p )
+    {
+        threads.emplace_back([&queue, p, itemsPerProducer]()
+            {
+                for( int i = 0; i < itemsPerProducer; ++i )
+                    queue.push(Item{ p, i, {} });
+            });
+    }
+    for( auto& thread : threads )
+        thread.join();
+    queue.close();
+    consumer.join();
+
+    EXPECT_TRUE(ordered);
+    for( int p = 0; p < producers; ++p )
+        EXPECT_EQ(received[p], itemsPerProducer);
+}
+
+TEST(MpscQueueTest, WaitPopWakesOnPushAndClose)
+{
+    tools::MpscQueue<Item> queue(8);
+    Item item;
+    std::chrono::steady_clock::time_point pushed;
+    std::chrono::steady_clock::time_point popped;
+
+    std::thread consumer([&]()
+        {
+            if( queue.waitPop(item) )
+                popped = std::chrono::steady_clock::now();
+            EXPECT_FALSE(queue.waitPop(item));
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    pushed = std::chrono::steady_clock::now();
+    queue.push(Item{ 1, 2, "wake up" });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.close();
+    consumer.join();
+
+    EXPECT_EQ(item.payload, "wake up");
+    EXPECT_LT(popped - pushed, std::chrono::milliseconds(50));
+    EXPECT_TRUE(queue.isClosed());
+}
+
+TEST(MpscQueueTest, CloseKeepsItemsOfRunningPushes)
+{
+    tools::MpscQueue<Item> queue(4);
+    std::atomic<bool> claimed{ false };
+    std::atomic<bool> filled{ false };
+
+    // The producer holds its claimed slot while the queue is closed.
+    std::thread producer([&]()
+        {
+            queue.tryEmplace([&](Item& slot)
+                {
+                    claimed = true;
+                    while( !filled )
+                        std::this_thread::yield();
+                    slot = Item{ 1, 0, "late" };
+                });
+        });
+    while( !claimed )
+        std::this_thread::yield();
+    queue.close();
+
+    Item item;
+    std::atomic<bool> popped{ false };
+    std::thread consumer([&]()
+        {
+            EXPECT_TRUE(queue.waitPop(item));
+            popped = true;
+            Item none;
+            EXPECT_FALSE(queue.waitPop(none));
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(popped);
+    filled = true;
+    producer.join();
+    consumer.join();
+
+    EXPECT_EQ(item.payload, "late");
+}
+
+TEST(MpscQueueTest, DISABLED_Throughput)
+{
+    tools::MpscQueue<Item> queue(1024);
+    const int producers = 2;
+    const int itemsPerProducer = 1000000;
+
+    const auto begin = std::chrono::steady_clock::now();
+    int64_t received = 0;
+    std::thread consumer([&]()
+        {
+            Item item;
+            while( queue.waitPop(item) )
+                ++received;
+        });
+
+    std::vector<std::thread> threads;
+    for( int p = 0; p < producers; ++p )
+    {
+        threads.emplace_back([&queue, p, itemsPerProducer]()
+            {
+                for( int i = 0; i < itemsPerProducer; ++i )
+                    queue.push(Item{ p, i, {} });
+            });
+    }
+    for( auto& thread : threads )
+        thread.join();
+    queue.close();
+    consumer.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    EXPECT_EQ(received, producers * itemsPerProducer);
+    std::cout << "[ THROUGHPUT ] " << static_cast<int64_t>(received / seconds) << " events/s" << std::endl;
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "Tools/ProcessExecutor.h"
+#include <chrono>
+#include <future>
+
+using tools::ProcessExecutor;
+using Status = ProcessExecutor::Status;
+using namespace std::chrono_literals;
+
+namespace
+{
+    // Runs a line of the platform shell.
+    std::vector<std::string> shell(const std::string& command)
+    {
+#ifdef _WIN32
+        return { "cmd", "/c", command };
+#else
+        return { "sh", "-c", command };
+#endif
+    }
+
+    std::vector<std::string> sleepForever()
+    {
+#ifdef _WIN32
+        return shell("ping -n 60 127.0.0.1 >nul");
+#else
+        return shell("sleep 60");
+#endif
+    }
+
+    std::chrono::milliseconds elapsedSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    }
+}
+
+TEST(ProcessExecutorTest, CapturesOutputAndExitCode)
+{
+    ProcessExecutor executor;
+    auto result = executor.run(shell("echo hello"), 10s)->wait();
+
+    EXPECT_EQ(result.status, Status::Completed);
+    EXPECT_EQ(result.exitCode, 0);
+    EXPECT_EQ(result.output.rfind("hello", 0), 0u);
+    EXPECT_TRUE(result.error.empty());
+}
+
+TEST(ProcessExecutorTest, NonZeroExitAndMissingProgramFail)
+{
+    ProcessExecutor executor;
+
+    auto exited = executor.run(shell("exit 3"), 10s)->wait();
+    EXPECT_EQ(exited.status, Status::Failed);
+    EXPECT_EQ(exited.exitCode, 3);
+    EXPECT_FALSE(exited.error.empty());
+
+    auto missing = executor.run({ "tadaima-no-such-program" }, 10s)->wait();
+    EXPECT_EQ(missing.status, Status::Failed);
+}
+
+TEST(ProcessExecutorTest, InputIsWrittenToStdin)
+{
+    ProcessExecutor executor;
+#ifdef _WIN32
+    auto result = executor.run(shell("more"), 10s, nullptr, "ねこ\n")->wait();
+#else
+    auto result = executor.run(shell("cat"), 10s, nullptr, "ねこ\n")->wait();
+#endif
+
+    EXPECT_EQ(result.status, Status::Completed);
+    EXPECT_NE(result.output.find("ねこ"), std::string::npos);
+}
+
+TEST(ProcessExecutorTest, HardTimeoutKillsTheProcess)
+{
+    ProcessExecutor executor;
+    const auto start = std::chrono::steady_clock::now();
+    auto result = executor.run(sleepForever(), 200ms)->wait();
+
+    EXPECT_EQ(result.status, Status::TimedOut);
+    EXPECT_LT(elapsedSince(start), 5s);
+}
+
+TEST(ProcessExecutorTest, CancelStopsTheProcessRightAway)
+{
+    ProcessExecutor executor;
+    auto task = executor.run(sleepForever(), 60s);
+    EXPECT_FALSE(task->waitFor(100ms));
+    EXPECT_EQ(executor.getRunningCount(), 1u);
+
+    const auto start = std::chrono::steady_clock::now();
+    task->cancel();
+    auto result = task->wait();
+
+    EXPECT_EQ(result.status, Status::Cancelled);
+    EXPECT_LT(elapsedSince(start), 2s);
+    EXPECT_EQ(executor.getRunningCount(), 0u);
+}
+
+TEST(ProcessExecutorTest, CompletionCallbackReceivesTheResult)
+{
+    ProcessExecutor executor;
+    std::promise<ProcessExecutor::Result> completed;
+    auto future = completed.get_future();
+
+    executor.run(shell("echo done"), 10s, [&completed](const ProcessExecutor::Result& result) { completed.set_value(result); });
+
+    ASSERT_EQ(future.wait_for(10s), std::future_status::ready);
+    auto result = future.get();
+    EXPECT_EQ(result.status, Status::Completed);
+    EXPECT_EQ(result.output.rfind("done", 0), 0u);
+}
+
+TEST(ProcessExecutorTest, DestructorCancelsRunningPrograms)
+{
+    std::shared_ptr<ProcessExecutor::Task> task;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ProcessExecutor executor;
+        task = executor.run(sleepForever(), 60s);
+        task->waitFor(50ms);
+    }
+
+    EXPECT_LT(elapsedSince(start), 2s);
+    EXPECT_EQ(task->getResult().status, Status::Cancelled);
+}
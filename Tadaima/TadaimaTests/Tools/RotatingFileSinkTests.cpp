@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "Tools/RotatingFileSink.h"
+#include "Tools/AsyncLogger.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using tools::RotatingFileSink;
+
+namespace
+{
+    class RotatingFileSinkTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            m_directory = std::filesystem::temp_directory_path() / ("tadaima_sink_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+            std::filesystem::create_directories(m_directory);
+        }
+
+        void TearDown() override
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_directory, error);
+        }
+
+        std::filesystem::path m_directory;
+    };
+
+    std::string readFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+}
+
+TEST_F(RotatingFileSinkTest, RotatesFullFilesAndKeepsTheConfiguredNumber)
+{
+    RotatingFileSink::Options options;
+    options.fileSize = 4096;
+    options.keptFiles = 2;
+    const std::string line = std::string(1000, 'x') + "\n";
+    {
+        RotatingFileSink sink(m_directory / "test.log", options);
+        ASSERT_TRUE(sink.isOpen());
+        std::ostream stream(&sink);
+
+        // Four lines fill a file, the fifth one starts the next file instead of being split.
+        for( int i = 0; i < 13; ++i )
+            stream << line << std::flush;
+        EXPECT_EQ(sink.writtenBytes(), line.size());
+        EXPECT_EQ(sink.filePath(2), m_directory / "test.2.log");
+    }
+
+    // The files are cut to what was written; the first one was rotated away.
+    EXPECT_EQ(readFile(m_directory / "test.log"), line);
+    EXPECT_EQ(readFile(m_directory / "test.1.log").size(), 4 * line.size());
+    EXPECT_EQ(readFile(m_directory / "test.2.log").size(), 4 * line.size());
+    EXPECT_FALSE(std::filesystem::exists(m_directory / "test.3.log"));
+
+    // A new sink keeps the log of the previous run.
+    {
+        RotatingFileSink sink(m_directory / "test.log", options);
+        std::ostream stream(&sink);
+        stream << "second run\n";
+    }
+    EXPECT_EQ(readFile(m_directory / "test.log"), "second run\n");
+    EXPECT_EQ(readFile(m_directory / "test.1.log"), line);
+}
+
+TEST_F(RotatingFileSinkTest, RotatesOldFilesAndSplitsOversizedWrites)
+{
+    RotatingFileSink::Options options;
+    options.fileSize = 4096;
+    options.maxAge = std::chrono::seconds(1);
+    {
+        RotatingFileSink sink(m_directory / "test.log", options);
+        std::ostream stream(&sink);
+        stream << std::string(10000, 'y');
+        stream << "old\n";
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        stream << "new\n";
+    }
+
+    EXPECT_EQ(readFile(m_directory / "test.log"), "new\n");
+    EXPECT_EQ(readFile(m_directory / "test.1.log"), std::string(10000 - 2 * 4096, 'y') + "old\n");
+    EXPECT_EQ(readFile(m_directory / "test.2.log"), std::string(4096, 'y'));
+    EXPECT_EQ(readFile(m_directory / "test.3.log"), std::string(4096, 'y'));
+}
+
+TEST_F(RotatingFileSinkTest, AsyncLoggerWritesPlainLinesToTheFile)
+{
+    std::ostringstream console;
+    {
+        RotatingFileSink sink(m_directory / "test.log");
+        std::ostream file(&sink);
+        tools::AsyncLogger logger(tools::AsyncLogger::Options(), console, file);
+        logger.info("Word {} added", 42);
+        logger.log("Broken", tools::LogLevel::PROBLEM);
+    }
+
+    const std::string text = readFile(m_directory / "test.log");
+    EXPECT_NE(text.find("[INFO]: Word 42 added\n"), std::string::npos);
+    EXPECT_NE(text.find("[ERROR]: Broken\n"), std::string::npos);
+    EXPECT_EQ(text.find('\033'), std::string::npos);
+    EXPECT_NE(console.str().find("\033[31m"), std::string::npos);
+}
+
+TEST_F(RotatingFileSinkTest, DISABLED_WriteThroughput)
+{
+    const std::string batch = [] {
+        std::string lines;
+        for( int i = 0; i < 64; ++i )
+            lines += "[2024-01-01 12:00:00.000][DEBUG]: Database: Added word with ID 123456 to lesson ID 42\n";
+        return lines;
+    }();
+    const int batches = 20000;
+
+    RotatingFileSink::Options options;
+    options.fileSize = 16 * 1024 * 1024;
+    options.keptFiles = 1;
+    RotatingFileSink sink(m_directory / "mapped.log", options);
+    std::ostream mapped(&sink);
+    std::ofstream buffered(m_directory / "buffered.log", std::ios::binary);
+
+    const auto begin = std::chrono::steady_clock::now();
+    for( int i = 0; i < batches; ++i )
+        buffered.write(batch.data(), static_cast<std::streamsize>(batch.size())).flush();
+    const auto middle = std::chrono::steady_clock::now();
+    for( int i = 0; i < batches; ++i )
+        mapped.write(batch.data(), static_cast<std::streamsize>(batch.size())).flush();
+    const auto end = std::chrono::steady_clock::now();
+
+    const double megabytes = static_cast<double>(batch.size()) * batches / (1024 * 1024);
+    std::cout << "[ THROUGHPUT ] std::ofstream " << megabytes / std::chrono::duration<double>(middle - begin).count()
+        << " MB/s, RotatingFileSink " << megabytes / std::chrono::duration<double>(end - middle).count() << " MB/s" << std::endl;
+    EXPECT_TRUE(sink.isOpen());
+}
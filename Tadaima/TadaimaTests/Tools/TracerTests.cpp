@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "Tools/Tracer.h"
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <thread>
+
+using tools::Tracer;
+using tools::TraceScope;
+
+TEST(TracerTest, RecordsNothingWhileStopped)
+{
+    Tracer& tracer = Tracer::instance();
+    tracer.start();
+    tracer.stop();
+
+    {
+        TraceScope trace("Stopped", "test");
+        Tracer::count("Stopped", 1);
+    }
+    EXPECT_EQ(tracer.eventCount(), 0u);
+}
+
+TEST(TracerTest, ExportsScopesAndCountersOfEveryThread)
+{
+    Tracer& tracer = Tracer::instance();
+    tracer.start();
+    {
+        TraceScope outer("Outer", "test");
+        Tracer::count("Pending", 7);
+
+        std::thread worker([&tracer]()
+            {
+                tracer.setThreadName("Worker \"1\"");
+                TraceScope inner("Inner", "test");
+            });
+        worker.join();
+    }
+    tracer.stop();
+    EXPECT_EQ(tracer.eventCount(), 3u);
+
+    const std::string json = tracer.toJson();
+    EXPECT_TRUE(std::regex_search(json, std::regex(R"(\{"name":"Outer","cat":"test","ph":"X","pid":1,"tid":\d+,"ts":\d+\.\d{3},"dur":\d+\.\d{3}\})"))) << json;
+    EXPECT_TRUE(std::regex_search(json, std::regex(R"(\{"name":"Pending","cat":"counter","ph":"C","pid":1,"tid":\d+,"ts":\d+\.\d{3},"args":\{"value":7\}\})"))) << json;
+    EXPECT_NE(json.find(R"("name":"thread_name","ph":"M")"), std::string::npos);
+    EXPECT_NE(json.find(R"("args":{"name":"Worker \"1\""})"), std::string::npos);
+    EXPECT_NE(json.find(R"("name":"Inner")"), std::string::npos);
+
+    // The events are kept until the next start.
+    tracer.start();
+    tracer.stop();
+    EXPECT_EQ(tracer.eventCount(), 0u);
+}
+
+TEST(TracerTest, ForgetsExitedThreads)
+{
+    Tracer& tracer = Tracer::instance();
+    tracer.start();
+    std::thread([&tracer]()
+        {
+            tracer.setThreadName("Finished worker");
+            TraceScope trace("Work", "test");
+        }).join();
+    tracer.stop();
+    EXPECT_NE(tracer.toJson().find("Finished worker"), std::string::npos);
+
+    // The events of an exited thread are exported once, the next start drops its buffer.
+    tracer.start();
+    tracer.stop();
+    EXPECT_EQ(tracer.toJson().find("Finished worker"), std::string::npos);
+
+    // A buffer without events goes as soon as another thread registers.
+    std::thread([&tracer]() { tracer.setThreadName("Idle worker"); }).join();
+    EXPECT_NE(tracer.toJson().find("Idle worker"), std::string::npos);
+    std::thread([&tracer]() { tracer.setThreadName("Next worker"); }).join();
+    EXPECT_EQ(tracer.toJson().find("Idle worker"), std::string::npos);
+}
+
+TEST(TracerTest, DISABLED_ScopeLatency)
+{
+    Tracer& tracer = Tracer::instance();
+    const int scopes = 1000000;
+    const auto measure = [scopes]()
+        {
+            const auto begin = std::chrono::steady_clock::now();
+            for( int i = 0; i < scopes; ++i )
+                TraceScope trace("Scope", "test");
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / scopes;
+        };
+
+    tracer.stop();
+    const double offNs = measure();
+    tracer.start();
+    const double onNs = measure();
+    tracer.stop();
+
+    EXPECT_EQ(tracer.eventCount(), static_cast<size_t>(scopes));
+    tracer.start();
+    tracer.stop();
+    std::cout << "[ LATENCY ] TraceScope " << offNs << " ns/scope while off, " << onNs << " ns/scope while on" << std::endl;
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "Tools/TypedEventDispatcher.h"
+#include "Tools/EventDispatcher.h"
+#include "Tools/DataPackage.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    enum Entity : uint8_t { Tree, Settings, EntityCount };
+    enum Event : uint8_t { Created, Deleted, Imported, EventCount };
+
+    struct NamePackage : tools::DataPackage
+    {
+        static constexpr Identifier PACKAGE_ID = 1;
+        NamePackage(const std::string& name) : DataPackage(PACKAGE_ID), name(name) {}
+        std::string name;
+    };
+
+    struct CountPackage : tools::DataPackage
+    {
+        static constexpr Identifier PACKAGE_ID = 2;
+        CountPackage(int count) : DataPackage(PACKAGE_ID), count(count) {}
+        int count = 0;
+    };
+
+    using Dispatcher = tools::TypedEventDispatcher<Entity, Event, tools::DataPackage, EntityCount, EventCount>;
+}
+
+TEST(TypedEventDispatcherTest, CallsHandlersOfTheEventWithTheirPayloadType)
+{
+    Dispatcher dispatcher;
+    std::vector<std::string> names;
+    int counts = 0;
+    int imports = 0;
+
+    Dispatcher::Subscription created = dispatcher.subscribe<NamePackage>(Tree, Created, [&names](const NamePackage& package) { names.push_back(package.name); });
+    Dispatcher::Subscription counted = dispatcher.subscribe<CountPackage>(Tree, Created, [&counts](const CountPackage& package) { counts += package.count; });
+    Dispatcher::Subscription imported = dispatcher.subscribe(Tree, Imported, [&imports]() { ++imports; });
+
+    const NamePackage lesson("Animals");
+    EXPECT_EQ(dispatcher.emit(Tree, Created, &lesson), 2u);
+    EXPECT_EQ(dispatcher.emit(Tree, Created, nullptr), 2u);
+    EXPECT_EQ(dispatcher.emit(Tree, Imported, nullptr), 1u);
+    EXPECT_EQ(dispatcher.emit(Settings, Created, &lesson), 0u);
+    EXPECT_EQ(dispatcher.emit(Tree, static_cast<Event>(EventCount + 1), &lesson), 0u);
+
+    // Only the handler asking for a NamePackage got one; the other one did not see the wrong type.
+    EXPECT_EQ(names, (std::vector<std::string>{ "Animals" }));
+    EXPECT_EQ(counts, 0);
+    EXPECT_EQ(imports, 1);
+    EXPECT_THROW(auto unused = dispatcher.subscribe(Tree, static_cast<Event>(EventCount), []() {}), std::out_of_range);
+}
+
+TEST(TypedEventDispatcherTest, PackagesWithoutATypeReachNoTypedHandler)
+{
+    Dispatcher dispatcher;
+    int calls = 0;
+    Dispatcher::Subscription named = dispatcher.subscribe<NamePackage>(Tree, Created, [&calls](const NamePackage&) { ++calls; });
+    Dispatcher::Subscription counted = dispatcher.subscribe<CountPackage>(Tree, Created, [&calls](const CountPackage&) { ++calls; });
+
+    // Built with the default identifier, the package must not be cast to either payload type.
+    const tools::ComplexDataPackage<uint32_t, int> untyped;
+    EXPECT_TRUE(untyped.isId(tools::DataPackage::NO_TYPE));
+    EXPECT_EQ(dispatcher.emit(Tree, Created, &untyped), 2u);
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(TypedEventDispatcherTest, SubscriptionsRemoveTheirHandlers)
+{
+    Dispatcher dispatcher;
+    int calls = 0;
+    {
+        Dispatcher::Subscription first = dispatcher.subscribe(Tree, Deleted, [&calls]() { ++calls; });
+        std::vector<Dispatcher::Subscription> moved;
+        moved.push_back(dispatcher.subscribe(Tree, Deleted, [&calls]() { calls += 10; }));
+        moved.push_back(std::move(first));
+        EXPECT_FALSE(first.isActive());
+        EXPECT_EQ(dispatcher.listenerCount(Tree, Deleted), 2u);
+
+        dispatcher.emit(Tree, Deleted, nullptr);
+        moved[0].reset();
+        dispatcher.emit(Tree, Deleted, nullptr);
+    }
+    EXPECT_EQ(dispatcher.listenerCount(Tree, Deleted), 0u);
+    EXPECT_EQ(dispatcher.emit(Tree, Deleted, nullptr), 0u);
+    EXPECT_EQ(calls, 12);
+
+    // A subscription may outlive its dispatcher.
+    Dispatcher::Subscription survivor;
+    {
+        Dispatcher shortLived;
+        survivor = shortLived.subscribe(Tree, Deleted, []() {});
+    }
+    EXPECT_FALSE(survivor.isActive());
+}
+
+TEST(TypedEventDispatcherTest, HandlersMaySubscribeAndUnsubscribeWhileDispatched)
+{
+    Dispatcher dispatcher;
+    std::vector<Dispatcher::Subscription> subscriptions;
+    std::vector<int> calls;
+
+    // The first handler removes the second one and adds a third, which only sees the next event.
+    subscriptions.push_back(dispatcher.subscribe(Tree, Created, [&]()
+        {
+            calls.push_back(1);
+            subscriptions[1].reset();
+            subscriptions.push_back(dispatcher.subscribe(Tree, Created, [&calls]() { calls.push_back(3); }));
+        }));
+    subscriptions.push_back(dispatcher.subscribe(Tree, Created, [&calls]() { calls.push_back(2); }));
+
+    EXPECT_EQ(dispatcher.emit(Tree, Created, nullptr), 1u);
+    EXPECT_EQ(calls, (std::vector<int>{ 1 }));
+    EXPECT_EQ(dispatcher.listenerCount(Tree, Created), 2u);
+
+    subscriptions.erase(subscriptions.begin());
+    dispatcher.emit(Tree, Created, nullptr);
+    EXPECT_EQ(calls, (std::vector<int>{ 1, 3 }));
+}
+
+TEST(TypedEventDispatcherTest, DISABLED_DispatchLatency)
+{
+    const int events = 1000000;
+    const int handlers = 4;
+    const NamePackage package("Animals");
+    int64_t total = 0;
+
+    // The current dispatcher, as used by the GUI before: handlers per entity, checking the event and the payload type.
+    struct Emitted { Event event; const tools::DataPackage* payload; };
+    tools::EventDispatcher<Entity, Emitted> byEntity;
+    for( int h = 0; h < handlers; ++h )
+    {
+        byEntity.addListener(Tree, [&total](Emitted emitted)
+            {
+                if( emitted.event == Created )
+                {
+                    if( const NamePackage* name = dynamic_cast<const NamePackage*>(emitted.payload) )
+                        total += name->name.size();
+                }
+            });
+    }
+
+    Dispatcher typed;
+    std::vector<Dispatcher::Subscription> subscriptions;
+    for( int h = 0; h < handlers; ++h )
+        subscriptions.push_back(typed.subscribe<NamePackage>(Tree, Created, [&total](const NamePackage& name) { total -= name.name.size(); }));
+
+    const auto begin = std::chrono::steady_clock::now();
+    for( int i = 0; i < events; ++i )
+        byEntity.emit(Tree, Emitted{ Created, &package });
+    const auto middle = std::chrono::steady_clock::now();
+    for( int i = 0; i < events; ++i )
+        typed.emit(Tree, Created, &package);
+    const auto end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(total, 0);
+    const double byEntityNs = std::chrono::duration<double, std::nano>(middle - begin).count() / events;
+    const double typedNs = std::chrono::duration<double, std::nano>(end - middle).count() / events;
+    std::cout << "[ LATENCY ] EventDispatcher " << byEntityNs << " ns/event, TypedEventDispatcher " << typedNs << " ns/event" << std::endl;
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "Tools/XmlPullParser.h"
+#include <sstream>
+
+using tools::XmlPullParser;
+using Event = XmlPullParser::Event;
+
+namespace
+{
+    // Collects the events as a compact trace: "<a", "text", ">a".
+    std::vector<std::string> trace(const std::string& xml, size_t chunkSize = XmlPullParser::DEFAULT_CHUNK_SIZE)
+    {
+        std::istringstream input(xml);
+        XmlPullParser parser(input, chunkSize);
+        std::vector<std::string> events;
+        while( true )
+        {
+            switch( parser.next() )
+            {
+                case Event::StartElement: events.push_back("<" + parser.getName()); break;
+                case Event::EndElement: events.push_back(">" + parser.getName()); break;
+                case Event::Text: events.push_back(parser.getText()); break;
+                case Event::EndDocument: return events;
+                case Event::Error: events.push_back("error"); return events;
+            }
+        }
+    }
+}
+
+TEST(XmlPullParserTest, ReportsElementsTextAndSelfClosingTags)
+{
+    auto events = trace("<?xml version=\"1.0\"?><!-- header --><a><b>one</b><c/><![CDATA[<raw>]]></a>");
+
+    std::vector<std::string> expected = { "<a", "<b", "one", ">b", "<c", ">c", "<raw>", ">a" };
+    EXPECT_EQ(events, expected);
+}
+
+TEST(XmlPullParserTest, DecodesAttributesAndCharacterReferences)
+{
+    std::istringstream input("<a lang='eng' title=\"x &gt; y\">&lt;&#x732B;&#29356;&amp;</a>");
+    XmlPullParser parser(input);
+
+    ASSERT_EQ(parser.next(), Event::StartElement);
+    EXPECT_EQ(parser.getAttribute("lang"), "eng");
+    EXPECT_EQ(parser.getAttribute("title"), "x > y");
+    EXPECT_EQ(parser.findAttribute("missing"), nullptr);
+    EXPECT_EQ(parser.readElementText(), "<猫犬&");
+    EXPECT_EQ(parser.next(), Event::EndDocument);
+}
+
+TEST(XmlPullParserTest, ExpandsEntitiesDeclaredInTheDoctype)
+{
+    const std::string xml =
+        "<!DOCTYPE JMdict [\n"
+        "<!ELEMENT JMdict (entry*)>\n"
+        "<!-- <!ENTITY fake \"no\"> -->\n"
+        "<!ENTITY v5r \"Godan verb with 'ru' ending\">\n"
+        "<!ENTITY n \"noun (common) (futsuumeishi)\">\n"
+        "]>\n"
+        "<JMdict><pos>&v5r;</pos><pos>&n;</pos><pos>&fake;</pos></JMdict>";
+
+    auto events = trace(xml);
+
+    std::vector<std::string> expected = { "<JMdict", "<pos", "Godan verb with 'ru' ending", ">pos",
+        "<pos", "noun (common) (futsuumeishi)", ">pos", "<pos", "&fake;", ">pos", ">JMdict" };
+    EXPECT_EQ(events, expected);
+}
+
+TEST(XmlPullParserTest, TinyChunksGiveTheSameResult)
+{
+    const std::string xml = "<root><entry id=\"1\"><keb>猫</keb><!-- skip --><gloss xml:lang=\"eng\">cat</gloss></entry></root>";
+
+    EXPECT_EQ(trace(xml, 1), trace(xml));
+    EXPECT_EQ(trace(xml, 3), trace(xml));
+}
+
+TEST(XmlPullParserTest, ReportsMalformedDocuments)
+{
+    EXPECT_EQ(trace("<a><b></a>").back(), "error");
+    EXPECT_EQ(trace("<a>").back(), "error");
+    EXPECT_EQ(trace("<a></a><b></b>").back(), "error");
+    EXPECT_EQ(trace("").back(), "error");
+
+    std::istringstream input("<a><b></a>");
+    XmlPullParser parser(input);
+    while( parser.next() != Event::Error )
+    {
+    }
+    EXPECT_NE(parser.getError().find("</a>"), std::string::npos);
+    EXPECT_EQ(parser.next(), Event::Error);
+}
+
+TEST(XmlPullParserTest, SkipElementLeavesTheParserAfterTheSubtree)
+{
+    std::istringstream input("<a><skip><x>1</x><y/></skip><keep>2</keep></a>");
+    XmlPullParser parser(input);
+
+    ASSERT_EQ(parser.next(), Event::StartElement);
+    ASSERT_EQ(parser.next(), Event::StartElement);
+    ASSERT_EQ(parser.getName(), "skip");
+    parser.skipElement();
+
+    ASSERT_EQ(parser.next(), Event::StartElement);
+    EXPECT_EQ(parser.getName(), "keep");
+    EXPECT_EQ(parser.getDepth(), 2);
+    EXPECT_EQ(parser.readElementText(), "2");
+    EXPECT_GT(parser.getBytesRead(), 0u);
+}
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+#include "Tools/XmlWriter.h"
+#include "Tools/XmlPullParser.h"
+#include <sstream>
+
+using tools::XmlPullParser;
+using tools::XmlWriter;
+
+TEST(XmlWriterTest, WritesIndentedElementsAndSelfClosingTags)
+{
+    std::ostringstream output;
+    {
+        XmlWriter writer(output);
+        writer.startElement("a");
+        writer.startElement("b");
+        writer.attribute("x", "1");
+        writer.endElement();
+        writer.startElement("c");
+        writer.text("text");
+        writer.endElement();
+    }
+
+    EXPECT_EQ(output.str(), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<a>\n  <b x=\"1\"/>\n  <c>text</c>\n</a>\n");
+}
+
+TEST(XmlWriterTest, EscapedValuesReadBackUnchanged)
+{
+    const std::string value = "a & b < c > d \"quoted\" 'single'\nsecond line\ttab\r\xE7\x8C\xAB";
+
+    std::stringstream stream;
+    XmlWriter writer(stream, false);
+    writer.startElement("root");
+    writer.attribute("value", value);
+    writer.text(value);
+    ASSERT_TRUE(writer.finish());
+
+    XmlPullParser parser(stream);
+    ASSERT_EQ(parser.next(), XmlPullParser::Event::StartElement);
+    EXPECT_EQ(parser.getAttribute("value"), value);
+    EXPECT_EQ(parser.readElementText(), value);
+}
+
+TEST(XmlWriterTest, DropsControlCharactersAndClosesOpenElements)
+{
+    std::ostringstream output;
+    XmlWriter writer(output, false);
+    writer.startElement("a");
+    writer.startElement("b");
+    writer.attribute("v", std::string("x\x01y\x1Fz"));
+    EXPECT_TRUE(writer.finish());
+
+    EXPECT_EQ(output.str(), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><a><b v=\"xyz\"/></a>");
+}
@@ -6,9 +6,8 @@
 #include <chrono>
 #include <vector>
 #include <thread>
-#include <mutex>
-#include <condition_variable>
 #include "Tools/Logger.h"
+#include "Tools/Tracer.h"
 #include "ApplicationDatabase.h"
 #include "ApplicationSettings.h"
 
@@ -16,9 +15,10 @@ namespace tadaima
 {
     namespace application
     {
-        Application::Application(tools::Logger& logger, EventBridge& eventBridge)
+        Application::Application(tools::Logger& logger, EventBridge& eventBridge, std::string databasePath)
             : m_running(false),
-            m_database("lessons.db", logger),
+            m_databasePath(std::move(databasePath)),
+            m_database(m_databasePath, logger),
             m_lessonManager(m_database),
             m_eventBridge(eventBridge),
             m_logger(logger)
@@ -39,72 +39,83 @@ namespace tadaima
 
         void Application::runThread()
         {
-            std::unique_lock<std::mutex> lock(mtx);
+            tools::Tracer::instance().setThreadName("Application");
+            ApplicationCommand command;
+            while( m_commands.waitPop(command) )
+            {
+                try
+                {
+                    handleCommand(command);
+                }
+                catch( const std::exception& ex )
+                {
+                    m_logger.log(std::string("Exception caught during event handling: ") + ex.what(), tools::LogLevel::PROBLEM);
+                }
+                catch( ... )
+                {
+                    m_logger.log("Unexpected exception caught during event handling", tools::LogLevel::PROBLEM);
+                }
+            }
+        }
 
-            while( m_running )
+        void Application::handleCommand(ApplicationCommand& command)
+        {
+            tools::TraceScope trace("Application::handleCommand", "events");
+            switch( command.event )
             {
-                m_threadRaise.wait_for(lock, std::chrono::milliseconds(100));
+                case ApplicationEvent::OnLessonCreated:
+                {
+                    std::vector<Lesson>& lessons = std::get<std::vector<Lesson>>(command.data);
+                    m_logger.info([this, &lessons]() { return "OnLessonCreated event occurred. Lessons added: " + lessonsToString(lessons); });
+                    m_lessonManager.addLessons(lessons);
+                    m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
+                    break;
+                }
 
-                if( m_running && m_event.anyEventChanged() )
+                case ApplicationEvent::OnLessonUpdate:
                 {
-                    try
-                    {
-                        if( m_event.isEventOccurred(ApplicationEvent::OnLessonCreated) )
-                        {
-                            std::vector<Lesson> lessons = m_event.getEventData<std::vector<Lesson>>(ApplicationEvent::OnLessonCreated);
-                            m_logger.log("OnLessonCreated event occurred. Lessons added: " + lessonsToString(lessons), tools::LogLevel::INFO);
-                            m_lessonManager.addLessons(lessons);
-                            m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
-                            m_event.clearEvent(ApplicationEvent::OnLessonCreated);
-                        }
-
-                        if( m_event.isEventOccurred(ApplicationEvent::OnLessonUpdate) )
-                        {
-                            std::vector<Lesson> lessons = m_event.getEventData<std::vector<Lesson>>(ApplicationEvent::OnLessonUpdate);
-                            m_logger.log("OnLessonUpdate event occurred. Lessons updated: " + lessonsToString(lessons), tools::LogLevel::INFO);
-                            m_lessonManager.renameLessons(lessons);
-                            m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
-                            m_event.clearEvent(ApplicationEvent::OnLessonUpdate);
-
-                        }
-
-                        if( m_event.isEventOccurred(ApplicationEvent::OnLessonDelete) )
-                        {
-                            std::vector<Lesson> lessons = m_event.getEventData<std::vector<Lesson>>(ApplicationEvent::OnLessonDelete);
-                            m_logger.log("OnLessonDelete event occurred. Lessons deleted: " + lessonsToString(lessons), tools::LogLevel::INFO);
-                            m_lessonManager.removeLessons(lessons);
-                            m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
-                            m_event.clearEvent(ApplicationEvent::OnLessonDelete);
-                        }
-
-                        if( m_event.isEventOccurred(ApplicationEvent::OnLessonEdited) )
-                        {
-                            std::vector<Lesson> lessons = m_event.getEventData<std::vector<Lesson>>(ApplicationEvent::OnLessonEdited);
-                            m_logger.log("OnLessonEdited event occurred. Lessons deleted: " + lessonsToString(lessons), tools::LogLevel::INFO);
-                            m_lessonManager.editLessons(lessons);
-                            m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
-                            m_event.clearEvent(ApplicationEvent::OnLessonEdited);
-                        }
-
-                        if( m_event.isEventOccurred(ApplicationEvent::OnSettingsChanged) )
-                        {
-                            ApplicationSettings applicationSettings = m_event.getEventData<ApplicationSettings>(ApplicationEvent::OnSettingsChanged);
-                            m_logger.log("OnSettingsChanged event occurred", tools::LogLevel::INFO);
-                            m_logger.log(applicationSettings.toString(), tools::LogLevel::INFO);
-                            applySettings(applicationSettings);
-                            m_database.saveSettings(applicationSettings);
-                            m_eventBridge.initializeSettings(applicationSettings);
-                            m_event.clearEvent(ApplicationEvent::OnSettingsChanged);
-                        }
-                    }
-                    catch( const std::exception& ex )
-                    {
-                        m_logger.log(std::string("Exception caught during event handling: ") + ex.what(), tools::LogLevel::PROBLEM);
-                    }
-                    catch( ... )
-                    {
-                        m_logger.log("Unexpected exception caught during event handling", tools::LogLevel::PROBLEM);
-                    }
+                    std::vector<Lesson>& lessons = std::get<std::vector<Lesson>>(command.data);
+                    m_logger.info([this, &lessons]() { return "OnLessonUpdate event occurred. Lessons updated: " + lessonsToString(lessons); });
+                    m_lessonManager.renameLessons(lessons);
+                    m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
+                    break;
+                }
+
+                case ApplicationEvent::OnLessonDelete:
+                {
+                    std::vector<Lesson>& lessons = std::get<std::vector<Lesson>>(command.data);
+                    m_logger.info([this, &lessons]() { return "OnLessonDelete event occurred. Lessons deleted: " + lessonsToString(lessons); });
+                    m_lessonManager.removeLessons(lessons);
+                    m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
+                    break;
+                }
+
+                case ApplicationEvent::OnLessonEdited:
+                {
+                    std::vector<Lesson>& lessons = std::get<std::vector<Lesson>>(command.data);
+                    m_logger.info([this, &lessons]() { return "OnLessonEdited event occurred. Lessons deleted: " + lessonsToString(lessons); });
+                    m_lessonManager.editLessons(lessons);
+                    m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
+                    break;
+                }
+
+                case ApplicationEvent::OnSettingsChanged:
+                {
+                    ApplicationSettings& applicationSettings = std::get<ApplicationSettings>(command.data);
+                    m_logger.log("OnSettingsChanged event occurred", tools::LogLevel::INFO);
+                    m_logger.info([&applicationSettings]() { return applicationSettings.toString(); });
+                    applySettings(applicationSettings);
+                    m_database.saveSettings(applicationSettings);
+                    m_eventBridge.initializeSettings(applicationSettings);
+                    break;
+                }
+
+                case ApplicationEvent::OnLessonsImported:
+                {
+                    // The lessons were written by the importer's own connection, only the GUI needs refreshing.
+                    m_logger.log("OnLessonsImported event occurred.", tools::LogLevel::INFO);
+                    m_eventBridge.initializeGui(m_lessonManager.getAllLessons());
+                    break;
                 }
             }
         }
@@ -114,7 +125,7 @@ namespace tadaima
             if( m_running )
             {
                 m_running = false;
-                m_threadRaise.notify_one();
+                m_commands.close();
                 if( workerThread.joinable() )
                 {
                     workerThread.join();
@@ -133,6 +144,11 @@ namespace tadaima
             m_logger.log("Application initialized.", tools::LogLevel::INFO);
         }
 
+        const std::string& Application::getDatabasePath() const
+        {
+            return m_databasePath;
+        }
+
         void Application::applySettings(ApplicationSettings& settings)
         {
             auto hwnd = GetConsoleWindow();
@@ -163,6 +179,8 @@ namespace tadaima
                     return "OnLessonDelete";
                 case ApplicationEvent::OnSettingsChanged:
                     return "OnSettingschanged";
+                case ApplicationEvent::OnLessonsImported:
+                    return "OnLessonsImported";
                 default:
                     return "UnknownEvent";
             }
@@ -12,13 +12,13 @@
 #include <string>
 #include <thread>
 #include <atomic>
-#include <mutex>
 #include "ApplicationDatabase.h"
 #include "Lessons/LessonManager.h"
-#include "Tools/EventsData.h"
+#include "Tools/MpscQueue.h"
 #include "bridge/EventBridge.h"
 #include "Tools/Logger.h"
 #include "ApplicationEventList.h"
+#include "ApplicationCommand.h"
 
 namespace tools { class Logger; }
 namespace tadaima
@@ -45,15 +45,16 @@ namespace tadaima
              *
              * @param logger Reference to a Logger instance for logging.
              * @param eventBridge Reference to an EventBridge instance for event handling.
+             * @param databasePath The lesson database the application opens.
              */
-            Application(tools::Logger& logger, EventBridge& eventBridge);
+            Application(tools::Logger& logger, EventBridge& eventBridge, std::string databasePath = "lessons.db");
 
             /**
              * @brief Destructor.
              *
              * Cleans up resources and stops the worker thread.
              */
-            ~Application();
+            virtual ~Application();
 
             /**
              * @brief Runs the application.
@@ -69,24 +70,37 @@ namespace tadaima
              */
             void Initialize();
 
+            /**
+             * @brief Returns the path of the lesson database, for the parts of the GUI that open their own connection.
+             */
+            const std::string& getDatabasePath() const;
+
             /**
              * @brief Sets an event with the given data.
              *
-             * This template method sets an application event with the provided data and notifies
-             * the worker thread.
+             * This method queues an application event with the provided data for the worker
+             * thread, which wakes up right away. Events are handled in the order they were set and none
+             * is lost; safe to call from any thread.
              *
-             * @tparam DataType The type of the data associated with the event.
              * @param event The application event to set.
-             * @param data The data associated with the event.
+             * @param data The lessons or settings associated with the event.
              */
-            template<typename DataType>
-            void setEvent(ApplicationEvent event, const DataType& data)
+            virtual void setEvent(ApplicationEvent event, ApplicationCommand::Data data)
             {
-                m_event.setEvent(event, data);
-                m_threadRaise.notify_one();
+                m_commands.push(ApplicationCommand{ event, std::move(data) });
                 m_logger.log("Event set: " + eventToString(event), tools::LogLevel::DEBUG);
             }
 
+            /**
+             * @brief Sets an event without data and notifies the worker thread.
+             *
+             * @param event The application event to set.
+             */
+            void setEvent(ApplicationEvent event)
+            {
+                setEvent(event, ApplicationCommand::Data{});
+            }
+
         private:
 
             /**
@@ -116,10 +130,17 @@ namespace tadaima
              * @brief Worker thread function.
              *
              * This method is the entry point for the worker thread.
-             * It periodically performs tasks based on notifications.
+             * It sleeps until an event is queued and handles the events one by one.
              */
             void runThread();
 
+            /**
+             * @brief Handles one queued event on the worker thread.
+             *
+             * @param command The event and its data.
+             */
+            void handleCommand(ApplicationCommand& command);
+
             /**
              * @brief Stops the worker thread.
              *
@@ -127,19 +148,19 @@ namespace tadaima
              */
             void stopThread();
 
+            std::string m_databasePath; /**< Path of the lesson database. */
             ApplicationDatabase m_database; /**< Database for managing lessons. */
             LessonManager m_lessonManager; /**< Manager for handling lesson operations. */
             EventBridge& m_eventBridge; /**< Reference to the EventBridge for event handling. */
             tools::Logger& m_logger; /**< Reference to the Logger instance for logging. */
 
-            tools::EventsData<std::vector<Lesson>, ApplicationSettings> m_event; /**< Event data structure. */
+            static constexpr size_t COMMAND_QUEUE_CAPACITY = 1024; /**< Events queued before setEvent() waits for the worker. */
+            tools::MpscQueue<ApplicationCommand> m_commands{ COMMAND_QUEUE_CAPACITY }; /**< Events set by the GUI, handled by the worker thread. */
 
             gui::Gui* m_gui = nullptr; /**< Pointer to the GUI instance. */
             std::thread workerThread; /**< Worker thread for background tasks. */
             std::atomic<bool> m_running; /**< Atomic flag to control the worker thread's execution. */
             std::string m_newDirectory; /**< The path to the new directory. */
-            std::condition_variable m_threadRaise; /**< Condition variable for thread synchronization. */
-            std::mutex mtx; /**< Mutex for thread synchronization. */
         };
     }
 }
@@ -0,0 +1,29 @@
+/**
+ * @file ApplicationCommand.h
+ * @brief Defines the ApplicationCommand struct, an event sent from the GUI to the application worker.
+ */
+
+#pragma once
+
+#include "ApplicationEventList.h"
+#include "ApplicationSettings.h"
+#include "Lessons/Lesson.h"
+#include <variant>
+#include <vector>
+
+namespace tadaima
+{
+    namespace application
+    {
+        /**
+         * @brief An application event together with its data, queued for the worker thread.
+         */
+        struct ApplicationCommand
+        {
+            using Data = std::variant<std::monostate, std::vector<Lesson>, ApplicationSettings>; /**< No data, the lessons or the settings of an event. */
+
+            ApplicationEvent event = ApplicationEvent::OnLessonsImported; /**< What happened. */
+            Data data; /**< The lessons or settings of the event, if any. */
+        };
+    }
+}
@@ -2,12 +2,141 @@
 #include <iostream>
 #include <Libraries/SQLite3/sqlite3.h>
 #include "Tools/Logger.h"
+#include "Tools/Tracer.h"
 #include "ApplicationSettings.h"
+#include "Lessons/WordFingerprint.h"
 
 namespace tadaima
 {
     namespace application
     {
+        namespace
+        {
+            // The current time in milliseconds since the epoch, in SQL.
+#define NOW_MS "CAST((julianday('now') - 2440587.5) * 86400000 AS INTEGER)"
+
+            std::string columnText(sqlite3_stmt* stmt, int column)
+            {
+                const unsigned char* text = sqlite3_column_text(stmt, column);
+                return text ? reinterpret_cast<const char*>(text) : "";
+            }
+
+            // Every change raises sync_state.version by one and stamps the changed lesson or word with it and with
+            // the time in milliseconds since the epoch. Deleted lessons and words leave a tombstone; lessons are named
+            // by their names and words by their fingerprint, since IDs differ between databases. A word added again
+            // removes the tombstone of its old version.
+            const char* const CHANGE_TRACKING_TABLES_SQL =
+                "CREATE TABLE IF NOT EXISTS sync_state ("
+                "id INTEGER PRIMARY KEY CHECK (id = 0), "
+                "version INTEGER NOT NULL, "
+                "exported_version INTEGER NOT NULL);"
+                "INSERT OR IGNORE INTO sync_state (id, version, exported_version) VALUES (0, 0, -1);"
+
+                "CREATE TABLE IF NOT EXISTS tombstones ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "group_name TEXT NOT NULL, "
+                "main_name TEXT NOT NULL, "
+                "sub_name TEXT NOT NULL, "
+                "fingerprint INTEGER, "  // NULL for a deleted lesson
+                "version INTEGER NOT NULL, "
+                "modified_at INTEGER NOT NULL DEFAULT 0);"
+
+                "CREATE INDEX IF NOT EXISTS idx_tombstones_version ON tombstones(version);"
+                "CREATE INDEX IF NOT EXISTS idx_tombstones_names ON tombstones(main_name, sub_name, fingerprint);"
+                "CREATE INDEX IF NOT EXISTS idx_lessons_version ON lessons(version);"
+                "CREATE INDEX IF NOT EXISTS idx_words_version ON words(version);";
+
+            // Triggers are recreated on every start, so databases of older versions get the current ones.
+            const char* const CHANGE_TRACKING_TRIGGERS_SQL =
+                "DROP TRIGGER IF EXISTS track_lesson_insert;"
+                "CREATE TRIGGER track_lesson_insert AFTER INSERT ON lessons BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE lessons SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.id; "
+                "END;"
+
+                // A renamed lesson is deleted under its old names and sent again with all its words.
+                "DROP TRIGGER IF EXISTS track_lesson_rename;"
+                "CREATE TRIGGER track_lesson_rename AFTER UPDATE OF group_name, main_name, sub_name ON lessons "
+                "WHEN IFNULL(OLD.group_name, '') IS NOT IFNULL(NEW.group_name, '') OR OLD.main_name IS NOT NEW.main_name OR OLD.sub_name IS NOT NEW.sub_name BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "INSERT INTO tombstones (group_name, main_name, sub_name, fingerprint, version, modified_at) "
+                "SELECT IFNULL(OLD.group_name, ''), OLD.main_name, OLD.sub_name, NULL, version, " NOW_MS " FROM sync_state "
+                "WHERE NOT EXISTS (SELECT 1 FROM lessons WHERE main_name = OLD.main_name AND sub_name = OLD.sub_name AND IFNULL(group_name, '') = IFNULL(OLD.group_name, '')); "
+                "UPDATE lessons SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.id; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE lesson_id = NEW.id; "
+                "END;"
+
+                // Duplicates share their names, a lesson is only gone when the last of them is deleted.
+                "DROP TRIGGER IF EXISTS track_lesson_delete;"
+                "CREATE TRIGGER track_lesson_delete AFTER DELETE ON lessons "
+                "WHEN NOT EXISTS (SELECT 1 FROM lessons WHERE main_name = OLD.main_name AND sub_name = OLD.sub_name AND IFNULL(group_name, '') = IFNULL(OLD.group_name, '')) BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "DELETE FROM tombstones WHERE fingerprint IS NOT NULL AND main_name = OLD.main_name AND sub_name = OLD.sub_name AND group_name = IFNULL(OLD.group_name, ''); "
+                "INSERT INTO tombstones (group_name, main_name, sub_name, fingerprint, version, modified_at) "
+                "SELECT IFNULL(OLD.group_name, ''), OLD.main_name, OLD.sub_name, NULL, version, " NOW_MS " FROM sync_state; "
+                "END;"
+
+                "DROP TRIGGER IF EXISTS track_word_insert;"
+                "CREATE TRIGGER track_word_insert AFTER INSERT ON words BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.id; "
+                "DELETE FROM tombstones WHERE fingerprint = NEW.fingerprint AND (group_name, main_name, sub_name) IN "
+                "(SELECT IFNULL(group_name, ''), main_name, sub_name FROM lessons WHERE id = NEW.lesson_id); "
+                "END;"
+
+                // A word whose fingerprint or lesson changes is deleted under the old ones.
+                "DROP TRIGGER IF EXISTS track_word_update;"
+                "CREATE TRIGGER track_word_update AFTER UPDATE OF lesson_id, kana, kanji, translation, romaji, example_sentence, fingerprint ON words BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.id; "
+                "INSERT INTO tombstones (group_name, main_name, sub_name, fingerprint, version, modified_at) "
+                "SELECT IFNULL(l.group_name, ''), l.main_name, l.sub_name, OLD.fingerprint, s.version, " NOW_MS " FROM lessons l, sync_state s "
+                "WHERE l.id = OLD.lesson_id AND OLD.fingerprint IS NOT NULL "
+                "AND (OLD.fingerprint IS NOT NEW.fingerprint OR OLD.lesson_id IS NOT NEW.lesson_id) "
+                "AND NOT EXISTS (SELECT 1 FROM words WHERE lesson_id = OLD.lesson_id AND fingerprint = OLD.fingerprint); "
+                "DELETE FROM tombstones WHERE fingerprint = NEW.fingerprint AND (group_name, main_name, sub_name) IN "
+                "(SELECT IFNULL(group_name, ''), main_name, sub_name FROM lessons WHERE id = NEW.lesson_id); "
+                "END;"
+
+                "DROP TRIGGER IF EXISTS track_word_delete;"
+                "CREATE TRIGGER track_word_delete AFTER DELETE ON words "
+                "WHEN NOT EXISTS (SELECT 1 FROM words WHERE lesson_id = OLD.lesson_id AND fingerprint = OLD.fingerprint) BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "INSERT INTO tombstones (group_name, main_name, sub_name, fingerprint, version, modified_at) "
+                "SELECT IFNULL(l.group_name, ''), l.main_name, l.sub_name, OLD.fingerprint, s.version, " NOW_MS " FROM lessons l, sync_state s "
+                "WHERE l.id = OLD.lesson_id AND OLD.fingerprint IS NOT NULL; "
+                "END;"
+
+                // Tags and conjugations belong to their word.
+                "DROP TRIGGER IF EXISTS track_tag_insert;"
+                "CREATE TRIGGER track_tag_insert AFTER INSERT ON tags BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.word_id; "
+                "END;"
+                "DROP TRIGGER IF EXISTS track_tag_delete;"
+                "CREATE TRIGGER track_tag_delete AFTER DELETE ON tags BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = OLD.word_id; "
+                "END;"
+                "DROP TRIGGER IF EXISTS track_conjugation_insert;"
+                "CREATE TRIGGER track_conjugation_insert AFTER INSERT ON conjugations BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.word_id; "
+                "END;"
+                "DROP TRIGGER IF EXISTS track_conjugation_update;"
+                "CREATE TRIGGER track_conjugation_update AFTER UPDATE ON conjugations BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = NEW.word_id; "
+                "END;"
+                "DROP TRIGGER IF EXISTS track_conjugation_delete;"
+                "CREATE TRIGGER track_conjugation_delete AFTER DELETE ON conjugations BEGIN "
+                "UPDATE sync_state SET version = version + 1; "
+                "UPDATE words SET version = (SELECT version FROM sync_state), modified_at = " NOW_MS " WHERE id = OLD.word_id; "
+                "END;";
+
+#undef NOW_MS
+        }
+
         ApplicationDatabase::ApplicationDatabase(const std::string& dbPath, tools::Logger& logger)
             : db(nullptr), m_logger(logger)
         {
@@ -18,6 +147,10 @@ namespace tadaima
             else
             {
                 m_logger.log("Database: Opened database successfully at " + dbPath, tools::LogLevel::INFO);
+
+                // Lesson imports write through their own connection, wait for them instead of failing.
+                sqlite3_busy_timeout(db, 2000);
+
                 if( initDatabase() )
                 {
                     m_logger.log("Database: Initialized database successfully.", tools::LogLevel::INFO);
@@ -81,6 +214,14 @@ namespace tadaima
 
             const char* alterWordsTable = "ALTER TABLE words ADD COLUMN kanji TEXT;";
 
+            const char* addFingerprintColumn = "ALTER TABLE words ADD COLUMN fingerprint INTEGER;";
+
+            const char* createIndexes =
+                "CREATE INDEX IF NOT EXISTS idx_words_fingerprint ON words(lesson_id, fingerprint);"
+                "CREATE INDEX IF NOT EXISTS idx_lessons_names ON lessons(main_name, sub_name);"
+                "CREATE INDEX IF NOT EXISTS idx_tags_word ON tags(word_id);"
+                "CREATE INDEX IF NOT EXISTS idx_conjugations_word ON conjugations(word_id);";
+
             char* errMsg = nullptr;
 
             if( sqlite3_exec(db, createLessonsTable, 0, 0, &errMsg) != SQLITE_OK )
@@ -169,11 +310,107 @@ namespace tadaima
                 return false;
             }
 
+            if( sqlite3_exec(db, addFingerprintColumn, 0, 0, &errMsg) != SQLITE_OK )
+            {
+                std::string errorMsg = std::string(errMsg);
+                if( errorMsg.find("duplicate column name") == std::string::npos )
+                {
+                    m_logger.log("Database: SQL error while adding the fingerprint column: " + errorMsg, tools::LogLevel::PROBLEM);
+                    sqlite3_free(errMsg);
+                    return false;
+                }
+                sqlite3_free(errMsg);
+            }
+
+            if( sqlite3_exec(db, createIndexes, 0, 0, &errMsg) != SQLITE_OK )
+            {
+                m_logger.log("Database: SQL error while creating indexes: " + std::string(errMsg), tools::LogLevel::PROBLEM);
+                sqlite3_free(errMsg);
+                return false;
+            }
+
+            return backfillFingerprints() && initChangeTracking();
+        }
+
+        bool ApplicationDatabase::initChangeTracking()
+        {
+            // Rows written before change tracking keep version 0, they are part of every export since -1,
+            // and modification time 0, so any change made elsewhere wins over them.
+            const char* addColumns[] = {
+                "ALTER TABLE lessons ADD COLUMN version INTEGER NOT NULL DEFAULT 0;",
+                "ALTER TABLE words ADD COLUMN version INTEGER NOT NULL DEFAULT 0;",
+                "ALTER TABLE lessons ADD COLUMN modified_at INTEGER NOT NULL DEFAULT 0;",
+                "ALTER TABLE words ADD COLUMN modified_at INTEGER NOT NULL DEFAULT 0;",
+                CHANGE_TRACKING_TABLES_SQL,
+                "ALTER TABLE tombstones ADD COLUMN modified_at INTEGER NOT NULL DEFAULT 0;",
+                CHANGE_TRACKING_TRIGGERS_SQL
+            };
+
+            char* errMsg = nullptr;
+            for( const char* sql : addColumns )
+            {
+                if( sqlite3_exec(db, sql, 0, 0, &errMsg) != SQLITE_OK )
+                {
+                    std::string errorMsg = std::string(errMsg);
+                    sqlite3_free(errMsg);
+                    if( errorMsg.find("duplicate column name") == std::string::npos )
+                    {
+                        m_logger.log("Database: SQL error while setting up change tracking: " + errorMsg, tools::LogLevel::PROBLEM);
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool ApplicationDatabase::backfillFingerprints()
+        {
+            // Words written before the fingerprint column existed.
+            const char* selectSql = "SELECT id, kana, kanji, translation FROM words WHERE fingerprint IS NULL;";
+            const char* updateSql = "UPDATE words SET fingerprint = ? WHERE id = ?;";
+            sqlite3_stmt* selectStmt;
+            sqlite3_stmt* updateStmt;
+            if( sqlite3_prepare_v2(db, selectSql, -1, &selectStmt, 0) != SQLITE_OK )
+                return false;
+            if( sqlite3_prepare_v2(db, updateSql, -1, &updateStmt, 0) != SQLITE_OK )
+            {
+                sqlite3_finalize(selectStmt);
+                return false;
+            }
+
+            sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, 0);
+            int updated = 0;
+            while( sqlite3_step(selectStmt) == SQLITE_ROW )
+            {
+                Word word;
+                word.kana = columnText(selectStmt, 1);
+                word.kanji = columnText(selectStmt, 2);
+                word.translation = columnText(selectStmt, 3);
+
+                sqlite3_bind_int64(updateStmt, 1, static_cast<sqlite3_int64>(WordFingerprint::of(word)));
+                sqlite3_bind_int(updateStmt, 2, sqlite3_column_int(selectStmt, 0));
+                sqlite3_step(updateStmt);
+                sqlite3_reset(updateStmt);
+                ++updated;
+            }
+            sqlite3_finalize(selectStmt);
+            sqlite3_finalize(updateStmt);
+
+            if( sqlite3_exec(db, "COMMIT;", 0, 0, 0) != SQLITE_OK )
+            {
+                sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+                m_logger.log("Database: Cannot store word fingerprints: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+                return false;
+            }
+
+            if( updated > 0 )
+                m_logger.info("Database: Computed fingerprints of {} words.", updated);
             return true;
         }
 
         int ApplicationDatabase::addLesson(const std::string& mainName, const std::string& subName, const std::string& groupName)
         {
+            tools::TraceScope trace("ApplicationDatabase::addLesson", "database");
             const char* sql = "INSERT INTO lessons (main_name, sub_name, group_name) VALUES (?, ?, ?);";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
@@ -189,7 +426,7 @@ namespace tadaima
                 }
                 int lessonId = static_cast<int>(sqlite3_last_insert_rowid(db));
                 sqlite3_finalize(stmt);
-                m_logger.log("Database: Added lesson with ID " + std::to_string(lessonId) + ", mainName: " + mainName + ", subName: " + subName + ", groupName: " + groupName, tools::LogLevel::INFO);
+                m_logger.verbose("Database: Added lesson with ID {}, mainName: {}, subName: {}, groupName: {}", lessonId, mainName, subName, groupName);
                 return lessonId;
             }
             return -1;
@@ -197,9 +434,10 @@ namespace tadaima
 
         int ApplicationDatabase::addWord(int lessonId, const Word& word)
         {
+            tools::TraceScope trace("ApplicationDatabase::addWord", "database");
             const char* sql =
-                "INSERT INTO words (lesson_id, kana, kanji, translation, romaji, example_sentence) "
-                "VALUES (?, ?, ?, ?, ?, ?);";
+                "INSERT INTO words (lesson_id, kana, kanji, translation, romaji, example_sentence, fingerprint) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?);";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
             {
@@ -209,6 +447,7 @@ namespace tadaima
                 sqlite3_bind_text(stmt, 4, word.translation.c_str(), -1, SQLITE_STATIC);
                 sqlite3_bind_text(stmt, 5, word.romaji.c_str(), -1, SQLITE_STATIC);
                 sqlite3_bind_text(stmt, 6, word.exampleSentence.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_int64(stmt, 7, static_cast<sqlite3_int64>(WordFingerprint::of(word)));
 
                 if( sqlite3_step(stmt) != SQLITE_DONE )
                 {
@@ -229,7 +468,7 @@ namespace tadaima
                     }
                 }
 
-                m_logger.log("Database: Added word with ID " + std::to_string(wordId) + " to lesson ID " + std::to_string(lessonId), tools::LogLevel::INFO);
+                m_logger.verbose("Database: Added word with ID {} to lesson ID {}", wordId, lessonId);
                 return wordId;
             }
             m_logger.log("Database: Failed to prepare statement for adding word.", tools::LogLevel::PROBLEM);
@@ -249,12 +488,13 @@ namespace tadaima
                     m_logger.log("Database: SQL error while adding tag: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
                 }
                 sqlite3_finalize(stmt);
-                m_logger.log("Database: Added tag '" + tag + "' to word ID " + std::to_string(wordId), tools::LogLevel::INFO);
+                m_logger.verbose("Database: Added tag '{}' to word ID {}", tag, wordId);
             }
         }
 
         void ApplicationDatabase::updateLesson(int lessonId, const std::string& newGroupName, const std::string& newMainName, const std::string& newSubName)
         {
+            tools::TraceScope trace("ApplicationDatabase::updateLesson", "database");
             const char* sql = "UPDATE lessons SET group_name = ?, main_name = ?, sub_name = ? WHERE id = ?;";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
@@ -270,7 +510,7 @@ namespace tadaima
                 }
                 else
                 {
-                    m_logger.log("Database: Updated lesson ID " + std::to_string(lessonId) + " to groupName: " + newGroupName + ", mainName: " + newMainName + ", subName: " + newSubName, tools::LogLevel::INFO);
+                    m_logger.verbose("Database: Updated lesson ID {} to groupName: {}, mainName: {}, subName: {}", lessonId, newGroupName, newMainName, newSubName);
                 }
 
                 sqlite3_finalize(stmt);
@@ -283,6 +523,7 @@ namespace tadaima
 
         bool ApplicationDatabase::editLesson(const Lesson& lesson)
         {
+            tools::TraceScope trace("ApplicationDatabase::editLesson", "database");
             try
             {
                 int lessonId = lesson.id;
@@ -352,7 +593,7 @@ namespace tadaima
                 }
 
                 // Insert updated words
-                const char* insertWordSql = "INSERT INTO words (lesson_id, kana, kanji, translation, romaji, example_sentence) VALUES (?, ?, ?, ?, ?, ?);";
+                const char* insertWordSql = "INSERT INTO words (lesson_id, kana, kanji, translation, romaji, example_sentence, fingerprint) VALUES (?, ?, ?, ?, ?, ?, ?);";
                 sqlite3_stmt* insertWordStmt;
                 for( const auto& word : lesson.words )
                 {
@@ -364,6 +605,7 @@ namespace tadaima
                         sqlite3_bind_text(insertWordStmt, 4, word.translation.c_str(), -1, SQLITE_STATIC);
                         sqlite3_bind_text(insertWordStmt, 5, word.romaji.c_str(), -1, SQLITE_STATIC);
                         sqlite3_bind_text(insertWordStmt, 6, word.exampleSentence.c_str(), -1, SQLITE_STATIC);
+                        sqlite3_bind_int64(insertWordStmt, 7, static_cast<sqlite3_int64>(WordFingerprint::of(word)));
                         if( sqlite3_step(insertWordStmt) != SQLITE_DONE )
                         {
                             m_logger.log("Database: SQL error while inserting word: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
@@ -420,7 +662,8 @@ namespace tadaima
 
         void ApplicationDatabase::updateWord(int wordId, const Word& updatedWord)
         {
-            const char* sql = "UPDATE words SET kana = ?, kanji = ?, translation = ?, romaji = ?, example_sentence = ? WHERE id = ?;";  // Added kanji column
+            tools::TraceScope trace("ApplicationDatabase::updateWord", "database");
+            const char* sql = "UPDATE words SET kana = ?, kanji = ?, translation = ?, romaji = ?, example_sentence = ?, fingerprint = ? WHERE id = ?;";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
             {
@@ -429,17 +672,31 @@ namespace tadaima
                 sqlite3_bind_text(stmt, 3, updatedWord.translation.c_str(), -1, SQLITE_STATIC);
                 sqlite3_bind_text(stmt, 4, updatedWord.romaji.c_str(), -1, SQLITE_STATIC);
                 sqlite3_bind_text(stmt, 5, updatedWord.exampleSentence.c_str(), -1, SQLITE_STATIC);
-                sqlite3_bind_int(stmt, 6, wordId);
+                sqlite3_bind_int64(stmt, 6, static_cast<sqlite3_int64>(WordFingerprint::of(updatedWord)));
+                sqlite3_bind_int(stmt, 7, wordId);
 
                 if( sqlite3_step(stmt) != SQLITE_DONE )
                 {
                     m_logger.log("Database: SQL error while updating word: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+                    sqlite3_finalize(stmt);
+                    return;
                 }
-                else
+                sqlite3_finalize(stmt);
+
+                // Tags and conjugations are replaced as a whole.
+                deleteWordDetails(wordId);
+                for( const auto& tag : updatedWord.tags )
                 {
-                    m_logger.log("Database: Updated word ID " + std::to_string(wordId), tools::LogLevel::INFO);
+                    addTag(wordId, tag);
                 }
-                sqlite3_finalize(stmt);
+                for( int i = 0; i < CONJUGATION_COUNT; ++i )
+                {
+                    if( !updatedWord.conjugations[i].empty() )
+                    {
+                        addConjugation(wordId, static_cast<ConjugationType>(i), updatedWord.conjugations[i]);
+                    }
+                }
+                m_logger.verbose("Database: Updated word ID {}", wordId);
             }
             else
             {
@@ -449,6 +706,7 @@ namespace tadaima
 
         void ApplicationDatabase::deleteLesson(int lessonId)
         {
+            tools::TraceScope trace("ApplicationDatabase::deleteLesson", "database");
             const char* sql = "DELETE FROM lessons WHERE id = ?;";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
@@ -459,12 +717,15 @@ namespace tadaima
                     m_logger.log("Database: SQL error while deleting lesson: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
                 }
                 sqlite3_finalize(stmt);
-                m_logger.log("Database: Deleted lesson ID " + std::to_string(lessonId), tools::LogLevel::INFO);
+                m_logger.verbose("Database: Deleted lesson ID {}", lessonId);
             }
         }
 
         void ApplicationDatabase::deleteWord(int wordId)
         {
+            tools::TraceScope trace("ApplicationDatabase::deleteWord", "database");
+            deleteWordDetails(wordId);
+
             const char* sql = "DELETE FROM words WHERE id = ?;";
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
@@ -475,8 +736,230 @@ namespace tadaima
                     m_logger.log("Database: SQL error while deleting word: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
                 }
                 sqlite3_finalize(stmt);
-                m_logger.log("Database: Deleted word ID " + std::to_string(wordId), tools::LogLevel::INFO);
+                m_logger.verbose("Database: Deleted word ID {}", wordId);
+            }
+        }
+
+        void ApplicationDatabase::deleteWordDetails(int wordId)
+        {
+            const char* sqls[] = { "DELETE FROM tags WHERE word_id = ?;", "DELETE FROM conjugations WHERE word_id = ?;" };
+            for( const char* sql : sqls )
+            {
+                sqlite3_stmt* stmt;
+                if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
+                {
+                    sqlite3_bind_int(stmt, 1, wordId);
+                    if( sqlite3_step(stmt) != SQLITE_DONE )
+                    {
+                        m_logger.log("Database: SQL error while deleting word details: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+                    }
+                    sqlite3_finalize(stmt);
+                }
+            }
+        }
+
+        int ApplicationDatabase::findLesson(const std::string& groupName, const std::string& mainName, const std::string& subName) const
+        {
+            const char* sql = "SELECT id FROM lessons WHERE main_name = ? AND sub_name = ? AND IFNULL(group_name, '') = ? ORDER BY id LIMIT 1;";
+            sqlite3_stmt* stmt;
+            int lessonId = -1;
+            if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
+            {
+                sqlite3_bind_text(stmt, 1, mainName.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(stmt, 2, subName.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(stmt, 3, groupName.c_str(), -1, SQLITE_STATIC);
+                if( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    lessonId = sqlite3_column_int(stmt, 0);
+                }
+                sqlite3_finalize(stmt);
+            }
+            return lessonId;
+        }
+
+        std::vector<std::vector<int>> ApplicationDatabase::findDuplicateLessons() const
+        {
+            const char* sql =
+                "SELECT l.id, l.main_name, l.sub_name, IFNULL(l.group_name, '') AS g FROM lessons l "
+                "JOIN (SELECT main_name, sub_name, IFNULL(group_name, '') AS g FROM lessons "
+                "GROUP BY main_name, sub_name, g HAVING COUNT(*) > 1) d "
+                "ON l.main_name = d.main_name AND l.sub_name = d.sub_name AND IFNULL(l.group_name, '') = d.g "
+                "ORDER BY l.main_name, l.sub_name, g, l.id;";
+
+            std::vector<std::vector<int>> duplicates;
+            for( auto& group : selectGroups(sql, 3) )
+            {
+                duplicates.push_back(std::move(group.second));
+            }
+            return duplicates;
+        }
+
+        std::map<int, std::vector<std::vector<int>>> ApplicationDatabase::findDuplicateWords() const
+        {
+            const char* sql =
+                "SELECT w.id, w.lesson_id, w.fingerprint FROM words w "
+                "JOIN (SELECT lesson_id, fingerprint FROM words GROUP BY lesson_id, fingerprint HAVING COUNT(*) > 1) d "
+                "ON w.lesson_id = d.lesson_id AND w.fingerprint = d.fingerprint "
+                "ORDER BY w.lesson_id, w.fingerprint, w.id;";
+
+            std::map<int, std::vector<std::vector<int>>> duplicates;
+            for( auto& group : selectGroups(sql, 2) )
+            {
+                duplicates[std::stoi(group.first[0])].push_back(std::move(group.second));
+            }
+            return duplicates;
+        }
+
+        void ApplicationDatabase::moveWords(int fromLessonId, int toLessonId)
+        {
+            tools::TraceScope trace("ApplicationDatabase::moveWords", "database");
+            const char* sql = "UPDATE words SET lesson_id = ? WHERE lesson_id = ?;";
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
+            {
+                sqlite3_bind_int(stmt, 1, toLessonId);
+                sqlite3_bind_int(stmt, 2, fromLessonId);
+                if( sqlite3_step(stmt) != SQLITE_DONE )
+                {
+                    m_logger.log("Database: SQL error while moving words: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+                }
+                sqlite3_finalize(stmt);
+                m_logger.verbose("Database: Moved words of lesson ID {} to lesson ID {}", fromLessonId, toLessonId);
+            }
+        }
+
+        int64_t ApplicationDatabase::getVersion() const
+        {
+            int64_t version = 0;
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, "SELECT version FROM sync_state;", -1, &stmt, 0) == SQLITE_OK )
+            {
+                if( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    version = sqlite3_column_int64(stmt, 0);
+                }
+                sqlite3_finalize(stmt);
+            }
+            return version;
+        }
+
+        LessonChanges ApplicationDatabase::getChangesSince(int64_t version) const
+        {
+            tools::TraceScope trace("ApplicationDatabase::getChangesSince", "database");
+            // One read transaction, so the changes and their version match even while an import writes.
+            const bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+            if( ownTransaction )
+                sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, 0);
+
+            LessonChanges changes;
+            changes.sinceVersion = version;
+            changes.version = getVersion();
+
+            const char* tombstonesSql = "SELECT group_name, main_name, sub_name, fingerprint, version FROM tombstones WHERE version > ? ORDER BY version, id;";
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, tombstonesSql, -1, &stmt, 0) == SQLITE_OK )
+            {
+                sqlite3_bind_int64(stmt, 1, version);
+                while( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    LessonTombstone tombstone;
+                    tombstone.groupName = columnText(stmt, 0);
+                    tombstone.mainName = columnText(stmt, 1);
+                    tombstone.subName = columnText(stmt, 2);
+                    tombstone.wholeLesson = sqlite3_column_type(stmt, 3) == SQLITE_NULL;
+                    tombstone.fingerprint = static_cast<uint64_t>(sqlite3_column_int64(stmt, 3));
+                    tombstone.version = sqlite3_column_int64(stmt, 4);
+                    changes.tombstones.push_back(std::move(tombstone));
+                }
+                sqlite3_finalize(stmt);
+            }
+
+            const char* lessonsSql =
+                "SELECT id, IFNULL(group_name, ''), main_name, sub_name FROM lessons "
+                "WHERE version > ?1 OR id IN (SELECT lesson_id FROM words WHERE version > ?1) ORDER BY id;";
+            if( sqlite3_prepare_v2(db, lessonsSql, -1, &stmt, 0) == SQLITE_OK )
+            {
+                sqlite3_bind_int64(stmt, 1, version);
+                while( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    Lesson lesson;
+                    lesson.id = sqlite3_column_int(stmt, 0);
+                    lesson.groupName = columnText(stmt, 1);
+                    lesson.mainName = columnText(stmt, 2);
+                    lesson.subName = columnText(stmt, 3);
+                    lesson.words = selectWords(lesson.id, version);
+                    changes.lessons.push_back(std::move(lesson));
+                }
+                sqlite3_finalize(stmt);
+            }
+            else
+            {
+                m_logger.log("Database: Failed to prepare statement for collecting changes: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+            }
+
+            if( ownTransaction )
+                sqlite3_exec(db, "COMMIT;", 0, 0, 0);
+
+            m_logger.info("Database: Collected changes since version {}: {} lessons, {} deletions.", version, changes.lessons.size(), changes.tombstones.size());
+            return changes;
+        }
+
+        int64_t ApplicationDatabase::getExportedVersion() const
+        {
+            int64_t version = -1;
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, "SELECT exported_version FROM sync_state;", -1, &stmt, 0) == SQLITE_OK )
+            {
+                if( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    version = sqlite3_column_int64(stmt, 0);
+                }
+                sqlite3_finalize(stmt);
             }
+            return version;
+        }
+
+        void ApplicationDatabase::setExportedVersion(int64_t version)
+        {
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, "UPDATE sync_state SET exported_version = ?;", -1, &stmt, 0) == SQLITE_OK )
+            {
+                sqlite3_bind_int64(stmt, 1, version);
+                if( sqlite3_step(stmt) != SQLITE_DONE )
+                {
+                    m_logger.log("Database: SQL error while recording the exported version: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+                }
+                sqlite3_finalize(stmt);
+            }
+        }
+
+        std::vector<std::pair<std::vector<std::string>, std::vector<int>>> ApplicationDatabase::selectGroups(const char* sql, int keyColumns) const
+        {
+            // Rows are (id, key...) ordered by key, consecutive rows with the same key form a group.
+            std::vector<std::pair<std::vector<std::string>, std::vector<int>>> groups;
+            sqlite3_stmt* stmt;
+            if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
+            {
+                while( sqlite3_step(stmt) == SQLITE_ROW )
+                {
+                    std::vector<std::string> key;
+                    for( int column = 1; column <= keyColumns; ++column )
+                    {
+                        key.push_back(columnText(stmt, column));
+                    }
+                    if( groups.empty() || key != groups.back().first )
+                    {
+                        groups.emplace_back(std::move(key), std::vector<int>());
+                    }
+                    groups.back().second.push_back(sqlite3_column_int(stmt, 0));
+                }
+                sqlite3_finalize(stmt);
+            }
+            else
+            {
+                m_logger.log("Database: Failed to prepare statement for finding duplicates: " + std::string(sqlite3_errmsg(db)), tools::LogLevel::PROBLEM);
+            }
+            return groups;
         }
 
         std::vector<std::string> ApplicationDatabase::getLessonNames() const
@@ -497,13 +980,19 @@ namespace tadaima
         }
 
         std::vector<Word> ApplicationDatabase::getWordsInLesson(int lessonId) const
+        {
+            return selectWords(lessonId, -1);
+        }
+
+        std::vector<Word> ApplicationDatabase::selectWords(int lessonId, int64_t version) const
         {
             std::vector<Word> words;
-            const char* sql = "SELECT id, kana, kanji, translation, romaji, example_sentence FROM words WHERE lesson_id = ?;"; // Added kanji to the SELECT statement
+            const char* sql = "SELECT id, kana, kanji, translation, romaji, example_sentence FROM words WHERE lesson_id = ? AND version > ? ORDER BY id;"; // Added kanji to the SELECT statement
             sqlite3_stmt* stmt;
             if( sqlite3_prepare_v2(db, sql, -1, &stmt, 0) == SQLITE_OK )
             {
                 sqlite3_bind_int(stmt, 1, lessonId);
+                sqlite3_bind_int64(stmt, 2, version);
                 while( sqlite3_step(stmt) == SQLITE_ROW )
                 {
                     Word word;
@@ -541,6 +1030,7 @@ namespace tadaima
 
         std::vector<Lesson> ApplicationDatabase::getAllLessons() const
         {
+            tools::TraceScope trace("ApplicationDatabase::getAllLessons", "database");
             std::vector<Lesson> lessons;
             const char* sql = "SELECT id, main_name, sub_name, group_name FROM lessons;";
             sqlite3_stmt* stmt;
@@ -576,6 +1066,7 @@ namespace tadaima
 
         void ApplicationDatabase::saveSettings(const ApplicationSettings& settings)
         {
+            tools::TraceScope trace("ApplicationDatabase::saveSettings", "database");
             m_logger.log("Database: Saving application settings.", tools::LogLevel::INFO);
 
             const char* sql = "REPLACE INTO settings (key, value) VALUES (?, ?);";
@@ -608,6 +1099,7 @@ namespace tadaima
 
         ApplicationSettings ApplicationDatabase::loadSettings()
         {
+            tools::TraceScope trace("ApplicationDatabase::loadSettings", "database");
             ApplicationSettings settings;
             const char* sql = "SELECT value FROM settings WHERE key = ?;";
             sqlite3_stmt* stmt;
@@ -645,8 +1137,39 @@ namespace tadaima
             return settings;
         }
 
+        bool ApplicationDatabase::beginTransaction()
+        {
+            char* errMsg = nullptr;
+            if( sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, &errMsg) != SQLITE_OK )
+            {
+                m_logger.log("Database: Cannot start a transaction: " + std::string(errMsg ? errMsg : ""), tools::LogLevel::PROBLEM);
+                sqlite3_free(errMsg);
+                return false;
+            }
+            return true;
+        }
+
+        bool ApplicationDatabase::commitTransaction()
+        {
+            char* errMsg = nullptr;
+            if( sqlite3_exec(db, "COMMIT;", 0, 0, &errMsg) != SQLITE_OK )
+            {
+                m_logger.log("Database: Cannot commit the transaction: " + std::string(errMsg ? errMsg : ""), tools::LogLevel::PROBLEM);
+                sqlite3_free(errMsg);
+                rollbackTransaction();
+                return false;
+            }
+            return true;
+        }
+
+        void ApplicationDatabase::rollbackTransaction()
+        {
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, 0);
+        }
+
         void ApplicationDatabase::addConjugation(int wordId, ConjugationType type, const std::string& conjugatedWord)
         {
+            tools::TraceScope trace("ApplicationDatabase::addConjugation", "database");
             const char* sql = "INSERT INTO conjugations (word_id, type, conjugated_word) VALUES (?, ?, ?);";
             sqlite3_stmt* stmt;
 
@@ -662,7 +1185,7 @@ namespace tadaima
                 }
                 else
                 {
-                    m_logger.log("Database: Added conjugation for word ID " + std::to_string(wordId) + " (" + std::to_string(type) + ": " + conjugatedWord + ")", tools::LogLevel::INFO);
+                    m_logger.verbose("Database: Added conjugation for word ID {} ({}: {})", wordId, static_cast<int>(type), conjugatedWord);
                 }
 
                 sqlite3_finalize(stmt);
@@ -84,7 +84,7 @@ namespace tadaima
             void updateLesson(int lessonId, const std::string& newGroupName, const std::string& newMainName, const std::string& newSubName) override;
 
             /**
-             * @brief Updates an existing word's details in the database.
+             * @brief Updates an existing word's details in the database, replacing its tags and conjugations.
              * @param wordId The ID of the word to update.
              * @param updatedWord The updated word object containing new data.
              */
@@ -97,11 +97,59 @@ namespace tadaima
             void deleteLesson(int lessonId) override;
 
             /**
-             * @brief Deletes a word from the database.
+             * @brief Deletes a word, its tags and its conjugations from the database.
              * @param wordId The ID of the word to delete.
              */
             void deleteWord(int wordId) override;
 
+            /**
+             * @brief Finds the oldest lesson with the given names.
+             * @return The ID of the lesson, or -1 if there is none.
+             */
+            int findLesson(const std::string& groupName, const std::string& mainName, const std::string& subName) const override;
+
+            /**
+             * @brief Finds lessons that have the same names.
+             * @return The IDs of each set of duplicates, in ascending order.
+             */
+            std::vector<std::vector<int>> findDuplicateLessons() const override;
+
+            /**
+             * @brief Finds words of the same lesson with the same fingerprint.
+             * @return The IDs of each set of duplicates in ascending order, by lesson ID.
+             */
+            std::map<int, std::vector<std::vector<int>>> findDuplicateWords() const override;
+
+            /**
+             * @brief Moves all words of a lesson to another lesson.
+             * @param fromLessonId The lesson that loses its words.
+             * @param toLessonId The lesson that receives them.
+             */
+            void moveWords(int fromLessonId, int toLessonId) override;
+
+            /**
+             * @brief Returns the version of the database, raised by the change triggers.
+             */
+            int64_t getVersion() const override;
+
+            /**
+             * @brief Collects the tombstones, lessons and words with a version after the given one.
+             * @param version The version of the last sync, -1 for the whole database.
+             * @return The changes.
+             */
+            LessonChanges getChangesSince(int64_t version) const override;
+
+            /**
+             * @brief Returns the version of the last delta export, -1 if there was none.
+             */
+            int64_t getExportedVersion() const override;
+
+            /**
+             * @brief Records the version of a delta export.
+             * @param version The exported version.
+             */
+            void setExportedVersion(int64_t version) override;
+
             /**
              * @brief Retrieves the names of all lessons in the database.
              * @return A vector of strings containing the names of all lessons.
@@ -133,8 +181,59 @@ namespace tadaima
              */
             ApplicationSettings loadSettings();
 
+            /**
+             * @brief Starts a transaction.
+             * @return True if the transaction was started.
+             */
+            bool beginTransaction() override;
+
+            /**
+             * @brief Commits the current transaction.
+             * @return True if the changes were written.
+             */
+            bool commitTransaction() override;
+
+            /**
+             * @brief Rolls back the current transaction.
+             */
+            void rollbackTransaction() override;
+
         private:
 
+            /**
+             * @brief Computes the fingerprint of words stored before the fingerprint column existed.
+             * @return True if all fingerprints were stored.
+             */
+            bool backfillFingerprints();
+
+            /**
+             * @brief Creates the version columns, the tombstones table and the triggers that track changes.
+             * @return True if change tracking is set up.
+             */
+            bool initChangeTracking();
+
+            /**
+             * @brief Reads the words of a lesson written after a version.
+             * @param lessonId The ID of the lesson.
+             * @param version The version, -1 for all words.
+             * @return The words with their tags and conjugations.
+             */
+            std::vector<Word> selectWords(int lessonId, int64_t version) const;
+
+            /**
+             * @brief Deletes the tags and conjugations of a word.
+             * @param wordId The ID of the word.
+             */
+            void deleteWordDetails(int wordId);
+
+            /**
+             * @brief Runs a query of (id, key...) rows ordered by key and groups the ids by key.
+             * @param sql The query.
+             * @param keyColumns The number of key columns after the id.
+             * @return Each key with its ids.
+             */
+            std::vector<std::pair<std::vector<std::string>, std::vector<int>>> selectGroups(const char* sql, int keyColumns) const;
+
             /**
              * @brief Adds a conjugation entry to the database for a specific word.
              * @param wordId The ID of the word to which the conjugation belongs.
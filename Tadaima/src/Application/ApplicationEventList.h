@@ -12,7 +12,8 @@ namespace tadaima
             OnLessonUpdate,
             OnLessonDelete,
             OnLessonEdited,
-            OnSettingsChanged
+            OnSettingsChanged,
+            OnLessonsImported
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,556 @@
+#include "DatabaseMerger.h"
+#include "ApplicationDatabase.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <tuple>
+
+namespace tadaima
+{
+    namespace application
+    {
+        namespace
+        {
+            // What happens to a word of the other database, stored in word_map.action.
+            constexpr int WORD_MATCHED = 0;  // Same word in both databases, compared by updateWords().
+            constexpr int WORD_COPIED = 1;   // Added or replaced, its tags and conjugations are copied.
+            constexpr int WORD_SKIPPED = 2;  // Deleted here, or a duplicate of a word already copied.
+
+            // The tags and conjugations of a word as one comparable text, independent of their order, and the whole word as one.
+#define TAGS_OF(schema, word) "(SELECT group_concat(tag, char(31)) FROM (SELECT tag FROM " schema ".tags WHERE word_id = " word " ORDER BY tag))"
+#define CONJUGATIONS_OF(schema, word) "(SELECT group_concat(type || char(30) || conjugated_word, char(31)) FROM " \
+                "(SELECT type, conjugated_word FROM " schema ".conjugations WHERE word_id = " word " ORDER BY type, conjugated_word))"
+#define SIGNATURE_OF(schema, word) "(IFNULL(" word ".kana, '') || char(29) || IFNULL(" word ".kanji, '') || char(29) || IFNULL(" word ".translation, '') " \
+                "|| char(29) || IFNULL(" word ".romaji, '') || char(29) || IFNULL(" word ".example_sentence, '') " \
+                "|| char(29) || IFNULL(" TAGS_OF(schema, word ".id") ", '') || char(29) || IFNULL(" CONJUGATIONS_OF(schema, word ".id") ", ''))"
+
+            class Connection
+            {
+            public:
+                explicit Connection(const std::string& path)
+                {
+                    if( sqlite3_open_v2(path.c_str(), &m_db, SQLITE_OPEN_READWRITE, nullptr) != SQLITE_OK )
+                    {
+                        const std::string message = m_db ? sqlite3_errmsg(m_db) : "out of memory";
+                        sqlite3_close(m_db);
+                        throw std::runtime_error("Cannot open the database: " + message);
+                    }
+                    sqlite3_busy_timeout(m_db, 2000);
+                }
+
+                ~Connection()
+                {
+                    sqlite3_close(m_db);
+                }
+
+                Connection(const Connection&) = delete;
+                Connection& operator=(const Connection&) = delete;
+
+                void exec(const char* sql)
+                {
+                    char* errMsg = nullptr;
+                    if( sqlite3_exec(m_db, sql, 0, 0, &errMsg) != SQLITE_OK )
+                    {
+                        const std::string message = errMsg ? errMsg : sqlite3_errmsg(m_db);
+                        sqlite3_free(errMsg);
+                        throw std::runtime_error("Cannot merge the databases: " + message);
+                    }
+                }
+
+                int64_t lastInsertId() const { return sqlite3_last_insert_rowid(m_db); }
+                int changes() const { return sqlite3_changes(m_db); }
+                sqlite3* handle() const { return m_db; }
+
+            private:
+                sqlite3* m_db = nullptr;
+            };
+
+            class Statement
+            {
+            public:
+                Statement(Connection& connection, const char* sql)
+                    : m_db(connection.handle())
+                {
+                    if( sqlite3_prepare_v2(m_db, sql, -1, &m_stmt, nullptr) != SQLITE_OK )
+                        throw std::runtime_error("Cannot merge the databases: " + std::string(sqlite3_errmsg(m_db)));
+                }
+
+                ~Statement()
+                {
+                    sqlite3_finalize(m_stmt);
+                }
+
+                Statement(const Statement&) = delete;
+                Statement& operator=(const Statement&) = delete;
+
+                Statement& bind(int index, int64_t value)
+                {
+                    sqlite3_bind_int64(m_stmt, index, value);
+                    return *this;
+                }
+
+                Statement& bind(int index, const std::string& value)
+                {
+                    sqlite3_bind_text(m_stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+                    return *this;
+                }
+
+                // Steps to the next row, false when there is none; the statement is reset for the next bindings then.
+                bool step()
+                {
+                    const int rc = sqlite3_step(m_stmt);
+                    if( rc == SQLITE_ROW )
+                        return true;
+                    sqlite3_reset(m_stmt);
+                    if( rc != SQLITE_DONE )
+                        throw std::runtime_error("Cannot merge the databases: " + std::string(sqlite3_errmsg(m_db)));
+                    return false;
+                }
+
+                void run()
+                {
+                    while( step() )
+                    {
+                    }
+                }
+
+                bool isNull(int column) const { return sqlite3_column_type(m_stmt, column) == SQLITE_NULL; }
+                int64_t integer(int column) const { return sqlite3_column_int64(m_stmt, column); }
+
+                std::string text(int column) const
+                {
+                    const unsigned char* text = sqlite3_column_text(m_stmt, column);
+                    return text ? std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(m_stmt, column)) : std::string();
+                }
+
+            private:
+                sqlite3* m_db;
+                sqlite3_stmt* m_stmt = nullptr;
+            };
+
+            std::string lessonName(const std::string& groupName, const std::string& mainName, const std::string& subName)
+            {
+                return groupName + " / " + mainName + " / " + subName;
+            }
+
+            // Merges the attached database "other" into "main" of one connection, step by step.
+            class Merge
+            {
+            public:
+                explicit Merge(Connection& connection)
+                    : m_connection(connection)
+                {
+                }
+
+                DatabaseMerger::Report run()
+                {
+                    {
+                        Statement version(m_connection, "SELECT version FROM main.sync_state;");
+                        m_startVersion = version.step() ? version.integer(0) : 0;
+                    }
+
+                    mapLessons();
+                    applyLessonDeletions();
+                    applyWordDeletions();
+                    addLessons();
+                    mapWords();
+                    addWords();
+                    updateWords();
+                    copyWordDetails();
+                    copyTombstones();
+                    return m_report;
+                }
+
+            private:
+                // Pairs each lesson of the other database with the oldest lesson of the same names here.
+                void mapLessons()
+                {
+                    m_connection.exec(
+                        "CREATE TEMP TABLE lesson_map ("
+                        "their_id INTEGER PRIMARY KEY, our_id INTEGER, group_name TEXT NOT NULL, main_name TEXT NOT NULL, sub_name TEXT NOT NULL);"
+                        "INSERT INTO lesson_map "
+                        "SELECT t.id, (SELECT MIN(o.id) FROM main.lessons o "
+                        "WHERE o.main_name = t.main_name AND o.sub_name = t.sub_name AND IFNULL(o.group_name, '') = IFNULL(t.group_name, '')), "
+                        "IFNULL(t.group_name, ''), t.main_name, t.sub_name FROM other.lessons t;"
+                        "CREATE INDEX temp.idx_lesson_map_names ON lesson_map(main_name, sub_name);");
+                }
+
+                // Deletes the lessons deleted in the other database, unless they changed here after the deletion.
+                void applyLessonDeletions()
+                {
+                    Statement select(m_connection,
+                        "SELECT t.group_name, t.main_name, t.sub_name, MAX(t.modified_at), o.id, "
+                        "MAX(o.modified_at, IFNULL((SELECT MAX(w.modified_at) FROM main.words w WHERE w.lesson_id = o.id), 0)) "
+                        "FROM other.tombstones t JOIN main.lessons o "
+                        "ON o.main_name = t.main_name AND o.sub_name = t.sub_name AND IFNULL(o.group_name, '') = t.group_name "
+                        "WHERE t.fingerprint IS NULL AND NOT EXISTS (SELECT 1 FROM lesson_map m "
+                        "WHERE m.main_name = t.main_name AND m.sub_name = t.sub_name AND m.group_name = t.group_name) "
+                        "GROUP BY o.id;");
+
+                    std::vector<int64_t> deleted;
+                    while( select.step() )
+                    {
+                        if( select.integer(3) >= select.integer(5) )
+                            deleted.push_back(select.integer(4));
+                        else
+                            m_report.conflicts.push_back({ DatabaseMerger::Conflict::Kind::DeletedThere, lessonName(select.text(0), select.text(1), select.text(2)), "", false });
+                    }
+
+                    Statement deleteTags(m_connection, "DELETE FROM main.tags WHERE word_id IN (SELECT id FROM main.words WHERE lesson_id = ?);");
+                    Statement deleteConjugations(m_connection, "DELETE FROM main.conjugations WHERE word_id IN (SELECT id FROM main.words WHERE lesson_id = ?);");
+                    Statement deleteWords(m_connection, "DELETE FROM main.words WHERE lesson_id = ?;");
+                    Statement deleteLesson(m_connection, "DELETE FROM main.lessons WHERE id = ?;");
+                    for( int64_t id : deleted )
+                    {
+                        deleteTags.bind(1, id).run();
+                        deleteConjugations.bind(1, id).run();
+                        deleteWords.bind(1, id).run();
+                        m_report.wordsDeleted += m_connection.changes();
+                        deleteLesson.bind(1, id).run();
+                        ++m_report.lessonsDeleted;
+                    }
+                }
+
+                // Deletes the words deleted in the other database, unless they changed here after the deletion.
+                void applyWordDeletions()
+                {
+                    Statement select(m_connection,
+                        "SELECT t.group_name, t.main_name, t.sub_name, MAX(t.modified_at), w.id, w.modified_at, w.kana, w.translation "
+                        "FROM other.tombstones t "
+                        "JOIN main.lessons l ON l.main_name = t.main_name AND l.sub_name = t.sub_name AND IFNULL(l.group_name, '') = t.group_name "
+                        "JOIN main.words w ON w.lesson_id = l.id AND w.fingerprint = t.fingerprint "
+                        "WHERE t.fingerprint IS NOT NULL AND NOT EXISTS (SELECT 1 FROM lesson_map m JOIN other.words tw ON tw.lesson_id = m.their_id "
+                        "WHERE m.main_name = t.main_name AND m.sub_name = t.sub_name AND m.group_name = t.group_name AND tw.fingerprint = t.fingerprint) "
+                        "GROUP BY w.id;");
+
+                    std::vector<int64_t> deleted;
+                    while( select.step() )
+                    {
+                        if( select.integer(3) >= select.integer(5) )
+                            deleted.push_back(select.integer(4));
+                        else
+                            m_report.conflicts.push_back({ DatabaseMerger::Conflict::Kind::DeletedThere, lessonName(select.text(0), select.text(1), select.text(2)),
+                                select.text(6) + " (" + select.text(7) + ")", false });
+                    }
+
+                    Statement deleteTags(m_connection, "DELETE FROM main.tags WHERE word_id = ?;");
+                    Statement deleteConjugations(m_connection, "DELETE FROM main.conjugations WHERE word_id = ?;");
+                    Statement deleteWord(m_connection, "DELETE FROM main.words WHERE id = ?;");
+                    for( int64_t id : deleted )
+                    {
+                        deleteTags.bind(1, id).run();
+                        deleteConjugations.bind(1, id).run();
+                        deleteWord.bind(1, id).run();
+                        ++m_report.wordsDeleted;
+                    }
+                }
+
+                // Adds the lessons missing here, unless they were deleted here after their last change there.
+                void addLessons()
+                {
+                    Statement select(m_connection,
+                        "SELECT m.their_id, l.group_name, l.main_name, l.sub_name, l.modified_at, "
+                        "MAX(l.modified_at, IFNULL((SELECT MAX(w.modified_at) FROM other.words w WHERE w.lesson_id = l.id), 0)), "
+                        "(SELECT MAX(o.modified_at) FROM main.tombstones o "
+                        "WHERE o.fingerprint IS NULL AND o.main_name = m.main_name AND o.sub_name = m.sub_name AND o.group_name = m.group_name) "
+                        "FROM lesson_map m JOIN other.lessons l ON l.id = m.their_id WHERE m.our_id IS NULL ORDER BY m.their_id;");
+
+                    struct Missing
+                    {
+                        int64_t theirId;
+                        std::string groupName, mainName, subName;
+                        int64_t modifiedAt;
+                        bool deletedHere;
+                        bool deletionWins;
+                    };
+                    std::vector<Missing> missing;
+                    while( select.step() )
+                    {
+                        const bool deletedHere = !select.isNull(6);
+                        missing.push_back({ select.integer(0), select.text(1), select.text(2), select.text(3), select.integer(4),
+                            deletedHere, deletedHere && select.integer(6) >= select.integer(5) });
+                    }
+
+                    Statement insert(m_connection, "INSERT INTO main.lessons (main_name, sub_name, group_name) VALUES (?, ?, ?);");
+                    Statement stamp(m_connection, "UPDATE main.lessons SET modified_at = ? WHERE id = ?;");
+                    Statement pruneTombstone(m_connection,
+                        "DELETE FROM main.tombstones WHERE fingerprint IS NULL AND main_name = ? AND sub_name = ? AND group_name = ?;");
+                    Statement map(m_connection, "UPDATE lesson_map SET our_id = ? WHERE their_id = ?;");
+
+                    // Duplicate lessons of the other database become one lesson here.
+                    std::map<std::tuple<std::string, std::string, std::string>, int64_t> added;
+                    for( const Missing& lesson : missing )
+                    {
+                        const auto key = std::make_tuple(lesson.groupName, lesson.mainName, lesson.subName);
+                        auto it = added.find(key);
+                        if( it == added.end() )
+                        {
+                            if( lesson.deletionWins )
+                                continue;
+
+                            insert.bind(1, lesson.mainName).bind(2, lesson.subName).bind(3, lesson.groupName).run();
+                            it = added.emplace(key, m_connection.lastInsertId()).first;
+                            stamp.bind(1, lesson.modifiedAt).bind(2, it->second).run();
+                            ++m_report.lessonsAdded;
+
+                            if( lesson.deletedHere )
+                            {
+                                pruneTombstone.bind(1, lesson.mainName).bind(2, lesson.subName).bind(3, lesson.groupName).run();
+                                m_report.conflicts.push_back({ DatabaseMerger::Conflict::Kind::DeletedHere,
+                                    lessonName(lesson.groupName, lesson.mainName, lesson.subName), "", true });
+                            }
+                        }
+                        map.bind(1, it->second).bind(2, lesson.theirId).run();
+                    }
+                }
+
+                // Pairs each word of a lesson kept here with the oldest word of the same fingerprint in that lesson.
+                void mapWords()
+                {
+                    m_connection.exec(
+                        "CREATE TEMP TABLE word_map ("
+                        "their_id INTEGER PRIMARY KEY, our_id INTEGER, our_lesson_id INTEGER NOT NULL, action INTEGER NOT NULL DEFAULT 0);"
+                        "INSERT INTO word_map (their_id, our_id, our_lesson_id) "
+                        "SELECT t.id, (SELECT MIN(o.id) FROM main.words o WHERE o.lesson_id = m.our_id AND o.fingerprint = t.fingerprint), m.our_id "
+                        "FROM other.words t JOIN lesson_map m ON m.their_id = t.lesson_id WHERE m.our_id IS NOT NULL;");
+                }
+
+                // Adds the words missing here, unless they were deleted here after their last change there.
+                void addWords()
+                {
+                    Statement select(m_connection,
+                        "SELECT wm.their_id, wm.our_lesson_id, t.kana, t.kanji, t.translation, t.romaji, t.example_sentence, t.fingerprint, t.modified_at, "
+                        "(SELECT MAX(o.modified_at) FROM main.lessons l JOIN main.tombstones o "
+                        "ON o.main_name = l.main_name AND o.sub_name = l.sub_name AND o.fingerprint = t.fingerprint AND o.group_name = IFNULL(l.group_name, '') "
+                        "WHERE l.id = wm.our_lesson_id), "
+                        "l.group_name, l.main_name, l.sub_name "
+                        "FROM word_map wm JOIN other.words t ON t.id = wm.their_id JOIN main.lessons l ON l.id = wm.our_lesson_id "
+                        "WHERE wm.our_id IS NULL ORDER BY wm.their_id;");
+
+                    struct Missing
+                    {
+                        int64_t theirId;
+                        int64_t lessonId;
+                        std::string kana, kanji, translation, romaji, example;
+                        int64_t fingerprint;
+                        bool deletedHere;
+                        bool deletionWins;
+                        std::string lesson;
+                    };
+                    std::vector<Missing> missing;
+                    while( select.step() )
+                    {
+                        const bool deletedHere = !select.isNull(9);
+                        missing.push_back({ select.integer(0), select.integer(1), select.text(2), select.text(3), select.text(4), select.text(5), select.text(6),
+                            select.integer(7), deletedHere, deletedHere && select.integer(9) >= select.integer(8),
+                            deletedHere ? lessonName(select.text(10), select.text(11), select.text(12)) : std::string() });
+                    }
+
+                    Statement insert(m_connection,
+                        "INSERT INTO main.words (lesson_id, kana, kanji, translation, romaji, example_sentence, fingerprint) VALUES (?, ?, ?, ?, ?, ?, ?);");
+                    Statement map(m_connection, "UPDATE word_map SET our_id = ?, action = ? WHERE their_id = ?;");
+
+                    // Duplicate words of the other database become one word here.
+                    std::map<std::pair<int64_t, int64_t>, int64_t> added;
+                    for( const Missing& word : missing )
+                    {
+                        const auto key = std::make_pair(word.lessonId, word.fingerprint);
+                        if( auto it = added.find(key); it != added.end() )
+                        {
+                            map.bind(1, it->second).bind(2, WORD_SKIPPED).bind(3, word.theirId).run();
+                            continue;
+                        }
+                        if( word.deletionWins )
+                        {
+                            map.bind(1, -1).bind(2, WORD_SKIPPED).bind(3, word.theirId).run();
+                            continue;
+                        }
+
+                        insert.bind(1, word.lessonId).bind(2, word.kana).bind(3, word.kanji).bind(4, word.translation)
+                            .bind(5, word.romaji).bind(6, word.example).bind(7, word.fingerprint).run();
+                        const int64_t id = m_connection.lastInsertId();
+                        added.emplace(key, id);
+                        map.bind(1, id).bind(2, WORD_COPIED).bind(3, word.theirId).run();
+                        ++m_report.wordsAdded;
+
+                        if( word.deletedHere )
+                            m_report.conflicts.push_back({ DatabaseMerger::Conflict::Kind::DeletedHere, word.lesson, word.kana + " (" + word.translation + ")", true });
+                    }
+                }
+
+                // Replaces the words that differ by the other version when it is newer.
+                void updateWords()
+                {
+                    Statement select(m_connection,
+                        "SELECT * FROM (SELECT wm.their_id, wm.our_id, t.modified_at, o.modified_at, l.group_name, l.main_name, l.sub_name, "
+                        "o.kana, o.translation, " SIGNATURE_OF("other", "t") " AS theirs, " SIGNATURE_OF("main", "o") " AS ours "
+                        "FROM word_map wm JOIN other.words t ON t.id = wm.their_id JOIN main.words o ON o.id = wm.our_id JOIN main.lessons l ON l.id = o.lesson_id "
+                        "WHERE wm.action = 0) WHERE theirs IS NOT ours ORDER BY 1;");
+
+                    struct Differing
+                    {
+                        int64_t theirId;
+                        int64_t ourId;
+                        bool theirsWins;
+                        DatabaseMerger::Conflict conflict;
+                    };
+                    std::vector<Differing> differing;
+                    while( select.step() )
+                    {
+                        // Equal times are settled by the content, so both directions of a sync agree.
+                        const bool theirsWins = select.integer(2) > select.integer(3) || (select.integer(2) == select.integer(3) && select.text(9) > select.text(10));
+                        differing.push_back({ select.integer(0), select.integer(1), theirsWins, { DatabaseMerger::Conflict::Kind::Edited,
+                            lessonName(select.text(4), select.text(5), select.text(6)), select.text(7) + " (" + select.text(8) + ")", theirsWins } });
+                    }
+
+                    Statement update(m_connection,
+                        "UPDATE main.words AS o SET kana = t.kana, kanji = t.kanji, translation = t.translation, romaji = t.romaji, "
+                        "example_sentence = t.example_sentence, fingerprint = t.fingerprint FROM other.words AS t WHERE t.id = ?1 AND o.id = ?2;");
+                    Statement deleteTags(m_connection, "DELETE FROM main.tags WHERE word_id = ?;");
+                    Statement deleteConjugations(m_connection, "DELETE FROM main.conjugations WHERE word_id = ?;");
+                    Statement copy(m_connection, "UPDATE word_map SET action = ? WHERE their_id = ?;");
+
+                    // Duplicates of the other database may differ from the same word here, the first one wins.
+                    std::set<int64_t> updated;
+                    for( const Differing& word : differing )
+                    {
+                        if( updated.count(word.ourId) )
+                            continue;
+
+                        m_report.conflicts.push_back(word.conflict);
+                        if( !word.theirsWins )
+                            continue;
+
+                        update.bind(1, word.theirId).bind(2, word.ourId).run();
+                        deleteTags.bind(1, word.ourId).run();
+                        deleteConjugations.bind(1, word.ourId).run();
+                        copy.bind(1, WORD_COPIED).bind(2, word.theirId).run();
+                        updated.insert(word.ourId);
+                        ++m_report.wordsUpdated;
+                    }
+                }
+
+                // Copies the tags and conjugations of the added and replaced words, then gives them their times of the other database.
+                void copyWordDetails()
+                {
+                    m_connection.exec(
+                        "INSERT INTO main.tags (word_id, tag) "
+                        "SELECT wm.our_id, t.tag FROM word_map wm JOIN other.tags t ON t.word_id = wm.their_id WHERE wm.action = 1 ORDER BY t.id;"
+                        "INSERT INTO main.conjugations (word_id, type, conjugated_word) "
+                        "SELECT wm.our_id, t.type, t.conjugated_word FROM word_map wm JOIN other.conjugations t ON t.word_id = wm.their_id WHERE wm.action = 1 ORDER BY t.id;"
+                        "UPDATE main.words AS o SET modified_at = t.modified_at "
+                        "FROM word_map wm JOIN other.words t ON t.id = wm.their_id WHERE wm.action = 1 AND o.id = wm.our_id;");
+                }
+
+                // Gives the deletions made by the merge the times of the other database and records its other deletions, so
+                // they reach the databases this one is merged into later.
+                void copyTombstones()
+                {
+                    Statement stamp(m_connection,
+                        "UPDATE main.tombstones AS o SET modified_at = t.modified_at FROM other.tombstones t "
+                        "WHERE o.version > ? AND t.main_name = o.main_name AND t.sub_name = o.sub_name AND t.group_name = o.group_name "
+                        "AND t.fingerprint IS o.fingerprint;");
+                    stamp.bind(1, m_startVersion).run();
+
+                    m_connection.exec(
+                        "INSERT INTO main.tombstones (group_name, main_name, sub_name, fingerprint, version, modified_at) "
+                        "SELECT t.group_name, t.main_name, t.sub_name, t.fingerprint, (SELECT version + 1 FROM main.sync_state), MAX(t.modified_at) "
+                        "FROM other.tombstones t "
+                        "WHERE NOT EXISTS (SELECT 1 FROM main.tombstones o "
+                        "WHERE o.main_name = t.main_name AND o.sub_name = t.sub_name AND o.group_name = t.group_name AND o.fingerprint IS t.fingerprint) "
+                        "AND NOT EXISTS (SELECT 1 FROM main.lessons l "
+                        "WHERE l.main_name = t.main_name AND l.sub_name = t.sub_name AND IFNULL(l.group_name, '') = t.group_name "
+                        "AND (t.fingerprint IS NULL OR EXISTS (SELECT 1 FROM main.words w WHERE w.lesson_id = l.id AND w.fingerprint = t.fingerprint))) "
+                        "GROUP BY t.group_name, t.main_name, t.sub_name, t.fingerprint;");
+                    m_report.tombstonesCopied = m_connection.changes();
+                    if( m_report.tombstonesCopied )
+                        m_connection.exec("UPDATE main.sync_state SET version = version + 1;");
+                }
+
+                Connection& m_connection;
+                int64_t m_startVersion = 0;
+                DatabaseMerger::Report m_report;
+            };
+
+#undef TAGS_OF
+#undef CONJUGATIONS_OF
+#undef SIGNATURE_OF
+        }
+
+        std::string DatabaseMerger::Conflict::toString() const
+        {
+            std::string text = word.empty() ? "Lesson " + lesson : "Word " + word + " in " + lesson;
+            switch( kind )
+            {
+                case Kind::Edited:
+                    text += " was changed in both databases";
+                    break;
+                case Kind::DeletedThere:
+                    text += " was deleted in the other database";
+                    break;
+                case Kind::DeletedHere:
+                    text += " was deleted in this database";
+                    break;
+            }
+            return text + (theirsWon ? ", the other version was taken." : ", this version was kept.");
+        }
+
+        std::string DatabaseMerger::Report::toString() const
+        {
+            std::string text = std::to_string(lessonsAdded) + " lessons added, " + std::to_string(lessonsDeleted) + " deleted, "
+                + std::to_string(wordsAdded) + " words added, " + std::to_string(wordsUpdated) + " updated, "
+                + std::to_string(wordsDeleted) + " deleted, " + std::to_string(conflicts.size()) + " conflicts";
+            if( tombstonesCopied )
+                text += ", " + std::to_string(tombstonesCopied) + " deletions recorded";
+            return text;
+        }
+
+        DatabaseMerger::DatabaseMerger(tools::Logger& logger)
+            : m_logger(logger)
+        {
+        }
+
+        DatabaseMerger::Report DatabaseMerger::merge(const std::string& databasePath, const std::string& otherPath)
+        {
+            for( const std::string& path : { databasePath, otherPath } )
+            {
+                if( !std::filesystem::is_regular_file(path) )
+                    throw std::runtime_error("Cannot find the database " + path + ".");
+            }
+            if( std::filesystem::equivalent(databasePath, otherPath) )
+                throw std::runtime_error("Cannot merge a database into itself.");
+
+            {
+                // Opening both through ApplicationDatabase brings their schemas and change tracking up to date.
+                ApplicationDatabase database(databasePath, m_logger);
+                ApplicationDatabase other(otherPath, m_logger);
+            }
+
+            Connection connection(databasePath);
+            Statement attach(connection, "ATTACH DATABASE ? AS other;");
+            attach.bind(1, otherPath).run();
+
+            connection.exec("BEGIN IMMEDIATE;");
+            try
+            {
+                Report report = Merge(connection).run();
+                connection.exec("COMMIT;");
+                return report;
+            }
+            catch( ... )
+            {
+                sqlite3_exec(connection.handle(), "ROLLBACK;", 0, 0, 0);
+                throw;
+            }
+        }
+
+        std::pair<DatabaseMerger::Report, DatabaseMerger::Report> DatabaseMerger::sync(const std::string& firstPath, const std::string& secondPath)
+        {
+            Report first = merge(firstPath, secondPath);
+            Report second = merge(secondPath, firstPath);
+            return { std::move(first), std::move(second) };
+        }
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file DatabaseMerger.h
+ * @brief Defines the DatabaseMerger class, which reconciles two lesson database files.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tools { class Logger; }
+
+namespace tadaima
+{
+    namespace application
+    {
+        /**
+         * @class DatabaseMerger
+         * @brief Merges the lessons of one Tadaima database file into another.
+         *
+         * The other file is attached to the connection of the target, so the whole merge is a few set-based
+         * statements in one transaction: it either applies completely or not at all. Lessons are matched by
+         * their names and words by their lesson and WordFingerprint, since IDs differ between databases.
+         *
+         * Conflicts are resolved by last writer wins, using the modification times the change tracking of
+         * ApplicationDatabase stores for lessons, words and tombstones:
+         *  - a word that differs on both sides takes the newer version;
+         *  - a deletion wins over the lesson or word it names unless that was changed after the deletion.
+         * Every conflict is listed in the report. Merging A into B and then B into A (see sync()) leaves
+         * both files with the same lessons.
+         */
+        class DatabaseMerger
+        {
+        public:
+
+            /**
+             * @brief A lesson or word changed differently in both databases.
+             */
+            struct Conflict
+            {
+                /**
+                 * @brief What the databases disagree on.
+                 */
+                enum class Kind
+                {
+                    Edited,       ///< The word differs in both databases.
+                    DeletedThere, ///< The lesson or word was deleted in the other database and kept here.
+                    DeletedHere   ///< The lesson or word was deleted here and kept in the other database.
+                };
+
+                Kind kind = Kind::Edited;
+                std::string lesson;     ///< The names of the lesson, as "group / main / sub".
+                std::string word;       ///< The kana and translation of the word, empty for a whole lesson.
+                bool theirsWon = false; ///< True if the version of the other database was taken.
+
+                /**
+                 * @brief Describes the conflict in one line for the log.
+                 */
+                std::string toString() const;
+            };
+
+            /**
+             * @brief What a merge changed in the target database.
+             */
+            struct Report
+            {
+                int64_t lessonsAdded = 0;
+                int64_t lessonsDeleted = 0;
+                int64_t wordsAdded = 0;
+                int64_t wordsUpdated = 0;
+                int64_t wordsDeleted = 0;
+                int64_t tombstonesCopied = 0; ///< Deletions recorded so they reach the databases merged later.
+                std::vector<Conflict> conflicts;
+
+                /**
+                 * @brief Describes the counts in one line for the log.
+                 */
+                std::string toString() const;
+            };
+
+            /**
+             * @brief Creates a merger.
+             * @param logger The logger of the databases opened by the merge.
+             */
+            explicit DatabaseMerger(tools::Logger& logger);
+
+            /**
+             * @brief Merges the lessons of another database file into a database file.
+             * @param databasePath The database to change.
+             * @param otherPath The database to read, it is not changed apart from a schema upgrade.
+             * @return What changed in the database.
+             * @throws std::runtime_error if a file is missing, both paths name the same file or the merge fails;
+             *         the database is unchanged then.
+             */
+            Report merge(const std::string& databasePath, const std::string& otherPath);
+
+            /**
+             * @brief Merges two database files both ways, so they end up with the same lessons.
+             * @return What changed in the first and in the second database.
+             * @throws std::runtime_error as merge().
+             */
+            std::pair<Report, Report> sync(const std::string& firstPath, const std::string& secondPath);
+
+        private:
+            tools::Logger& m_logger;
+        };
+    }
+}
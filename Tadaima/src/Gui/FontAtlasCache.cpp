@@ -0,0 +1,348 @@
+#include "FontAtlasCache.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "Tools/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr char MAGIC[8] = { 'T', 'D', 'F', 'A', 'T', 'L', 'A', 'S' };
+    constexpr uint32_t VERSION = 1;
+    constexpr const char* EXTENSION = ".atlas";
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t fonts;
+        uint64_t key;
+        int32_t width;
+        int32_t height;
+        uint32_t customRects;
+        uint32_t reserved;
+    };
+
+    struct RectPosition
+    {
+        uint16_t x;
+        uint16_t y;
+    };
+
+    struct FontHeader
+    {
+        float ascent;
+        float descent;
+        int32_t metricsTotalSurface;
+        uint32_t glyphs;
+    };
+
+    // FNV-1a, 64 bit.
+    void hashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for( size_t i = 0; i < size; ++i )
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+    }
+
+    template<typename T>
+    void hashValue(uint64_t& hash, const T& value)
+    {
+        hashBytes(hash, &value, sizeof(value));
+    }
+
+    uint64_t hashAtlas(const ImFontAtlas& atlas)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hashValue(hash, IMGUI_VERSION_NUM);
+        hashValue(hash, sizeof(ImFontGlyph));
+        hashValue(hash, atlas.Flags);
+        hashValue(hash, atlas.TexDesiredWidth);
+        hashValue(hash, atlas.TexGlyphPadding);
+        hashValue(hash, atlas.FontBuilderFlags);
+        hashValue(hash, atlas.Fonts.Size);
+        hashValue(hash, atlas.CustomRects.Size);
+
+        for( const ImFontConfig& config : atlas.ConfigData )
+        {
+            // The size and both ends of the font data tell font files apart without reading megabytes of kanji outlines.
+            const size_t sample = std::min<size_t>(static_cast<size_t>(config.FontDataSize), 64 * 1024);
+            const unsigned char* data = static_cast<const unsigned char*>(config.FontData);
+            hashValue(hash, config.FontDataSize);
+            hashBytes(hash, data, sample);
+            hashBytes(hash, data + config.FontDataSize - sample, sample);
+
+            hashBytes(hash, config.Name, std::strlen(config.Name));
+            hashValue(hash, config.FontNo);
+            hashValue(hash, config.SizePixels);
+            hashValue(hash, config.OversampleH);
+            hashValue(hash, config.OversampleV);
+            hashValue(hash, config.PixelSnapH);
+            hashValue(hash, config.GlyphExtraSpacing);
+            hashValue(hash, config.GlyphOffset);
+            hashValue(hash, config.GlyphMinAdvanceX);
+            hashValue(hash, config.GlyphMaxAdvanceX);
+            hashValue(hash, config.MergeMode);
+            hashValue(hash, config.FontBuilderFlags);
+            hashValue(hash, config.RasterizerMultiply);
+            hashValue(hash, config.RasterizerDensity);
+            hashValue(hash, config.EllipsisChar);
+            hashValue(hash, atlas.Fonts.find_index(config.DstFont));
+
+            // Without ranges a font gets the default ones, which never change for a given ImGui version.
+            hashValue(hash, config.GlyphRanges != nullptr);
+            for( const ImWchar* range = config.GlyphRanges; range && *range; ++range )
+                hashValue(hash, *range);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Reads the cached file front to back and tells whether it had all the bytes asked for.
+     */
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        template<typename T>
+        bool read(T& value)
+        {
+            return read(&value, sizeof(T));
+        }
+
+        bool read(void* destination, size_t size)
+        {
+            if( size > m_size - m_offset )
+                return false;
+            if( size == 0 )
+                return true;
+            std::memcpy(destination, m_data + m_offset, size);
+            m_offset += size;
+            return true;
+        }
+
+        bool atEnd() const
+        {
+            return m_offset == m_size;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset = 0;
+    };
+}
+
+namespace tadaima
+{
+    namespace gui
+    {
+        std::string FontAtlasCache::Stats::toString() const
+        {
+            return std::format("{} glyphs, {}x{} texture ({} KB as RGBA32), {} in {:.1f} ms",
+                glyphs, width, height, textureBytes / 1024, fromCache ? "loaded from the cache" : "built", milliseconds);
+        }
+
+        FontAtlasCache::FontAtlasCache(std::string directory)
+            : m_directory(std::move(directory))
+        {
+        }
+
+        FontAtlasCache::Stats FontAtlasCache::build(ImFontAtlas& atlas)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            // Glyphs of custom rectangles are added again on every build, so such atlases are never cached.
+            bool cacheable = true;
+            for( const ImFontAtlasCustomRect& rect : atlas.CustomRects )
+                cacheable &= rect.Font == nullptr;
+
+            // The key is taken before building, which rounds the font sizes and adds the rectangles of the cursors.
+            Stats stats;
+            const std::string atlasKey = key(atlas);
+            stats.fromCache = cacheable && load(atlas, atlasKey);
+            if( !stats.fromCache )
+            {
+                if( !atlas.Build() )
+                    throw std::runtime_error("FontAtlasCache: The font atlas cannot be built.");
+                if( cacheable )
+                    save(atlas, atlasKey);
+            }
+
+            stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            for( const ImFont* font : atlas.Fonts )
+                stats.glyphs += static_cast<size_t>(font->Glyphs.Size);
+            stats.width = atlas.TexWidth;
+            stats.height = atlas.TexHeight;
+            stats.textureBytes = static_cast<size_t>(atlas.TexWidth) * atlas.TexHeight * 4;
+            return stats;
+        }
+
+        std::string FontAtlasCache::key(const ImFontAtlas& atlas)
+        {
+            return std::format("{:016x}", hashAtlas(atlas));
+        }
+
+        std::string FontAtlasCache::filePath(const std::string& key) const
+        {
+            return (std::filesystem::path(m_directory) / (key + EXTENSION)).string();
+        }
+
+        bool FontAtlasCache::load(ImFontAtlas& atlas, const std::string& key) const
+        {
+            tools::MappedFile file;
+            if( !file.open(filePath(key)) )
+                return false;
+
+            // Registers the rectangles of the mouse cursors and lines, as a build would, to restore their places.
+            ImFontAtlasBuildInit(&atlas);
+
+            Reader reader(file.data(), file.size());
+            Header header{};
+            if( !reader.read(header) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+                || std::format("{:016x}", header.key) != key || header.fonts != static_cast<uint32_t>(atlas.Fonts.Size)
+                || header.customRects != static_cast<uint32_t>(atlas.CustomRects.Size)
+                || header.width <= 0 || header.height <= 0 || header.width > 16384 || header.height > 16384 )
+                return false;
+
+            std::vector<RectPosition> rectPositions(header.customRects);
+            if( !reader.read(rectPositions.data(), sizeof(RectPosition) * rectPositions.size()) )
+                return false;
+
+            std::vector<FontHeader> fonts(header.fonts);
+            std::vector<ImVector<ImFontGlyph>> glyphs(header.fonts);
+            for( uint32_t i = 0; i < header.fonts; ++i )
+            {
+                if( !reader.read(fonts[i]) || fonts[i].glyphs > 0x10000 )
+                    return false;
+                glyphs[i].resize(static_cast<int>(fonts[i].glyphs));
+                if( !reader.read(glyphs[i].Data, sizeof(ImFontGlyph) * fonts[i].glyphs) )
+                    return false;
+            }
+
+            const size_t pixelCount = static_cast<size_t>(header.width) * header.height;
+            unsigned char* pixels = static_cast<unsigned char*>(IM_ALLOC(pixelCount));
+            if( !reader.read(pixels, pixelCount) || !reader.atEnd() )
+            {
+                IM_FREE(pixels);
+                return false;
+            }
+
+            // The file is complete; the atlas is set up the way ImFontAtlasBuildWithStbTruetype leaves it.
+            atlas.TexID = ImTextureID();
+            atlas.ClearTexData();
+            atlas.TexWidth = header.width;
+            atlas.TexHeight = header.height;
+            atlas.TexUvScale = ImVec2(1.0f / header.width, 1.0f / header.height);
+            atlas.TexPixelsAlpha8 = pixels;
+
+            for( uint32_t i = 0; i < header.customRects; ++i )
+            {
+                atlas.CustomRects[i].X = rectPositions[i].x;
+                atlas.CustomRects[i].Y = rectPositions[i].y;
+            }
+
+            for( ImFontConfig& config : atlas.ConfigData )
+            {
+                const FontHeader& font = fonts[atlas.Fonts.find_index(config.DstFont)];
+                ImFontAtlasBuildSetupFont(&atlas, config.DstFont, &config, font.ascent, font.descent);
+            }
+
+            for( uint32_t i = 0; i < header.fonts; ++i )
+            {
+                ImFont* font = atlas.Fonts[static_cast<int>(i)];
+                font->Glyphs.swap(glyphs[i]);
+                font->MetricsTotalSurface = fonts[i].metricsTotalSurface;
+                font->DirtyLookupTables = true;
+            }
+
+            // Draws the cursors and lines again, sets their UVs and builds the lookup tables of the fonts.
+            ImFontAtlasBuildFinish(&atlas);
+
+            std::error_code error;
+            std::filesystem::last_write_time(filePath(key), std::filesystem::file_time_type::clock::now(), error);
+            return true;
+        }
+
+        void FontAtlasCache::save(const ImFontAtlas& atlas, const std::string& key) const
+        {
+            if( atlas.TexPixelsAlpha8 == nullptr )
+                return;
+
+            std::error_code error;
+            std::filesystem::create_directories(m_directory, error);
+
+            // Written under a temporary name, so a crash never leaves a truncated atlas behind.
+            const std::string path = filePath(key);
+            const std::string temporaryPath = path + ".tmp";
+            {
+                std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+                if( !file )
+                    return;
+
+                Header header{};
+                std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                header.version = VERSION;
+                header.fonts = static_cast<uint32_t>(atlas.Fonts.Size);
+                header.key = std::stoull(key, nullptr, 16);
+                header.width = atlas.TexWidth;
+                header.height = atlas.TexHeight;
+                header.customRects = static_cast<uint32_t>(atlas.CustomRects.Size);
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+                for( const ImFontAtlasCustomRect& rect : atlas.CustomRects )
+                {
+                    const RectPosition position{ rect.X, rect.Y };
+                    file.write(reinterpret_cast<const char*>(&position), sizeof(position));
+                }
+
+                for( const ImFont* font : atlas.Fonts )
+                {
+                    const FontHeader fontHeader{ font->Ascent, font->Descent, font->MetricsTotalSurface, static_cast<uint32_t>(font->Glyphs.Size) };
+                    file.write(reinterpret_cast<const char*>(&fontHeader), sizeof(fontHeader));
+                    file.write(reinterpret_cast<const char*>(font->Glyphs.Data), sizeof(ImFontGlyph) * font->Glyphs.Size);
+                }
+
+                file.write(reinterpret_cast<const char*>(atlas.TexPixelsAlpha8), static_cast<std::streamsize>(atlas.TexWidth) * atlas.TexHeight);
+                if( !file )
+                {
+                    file.close();
+                    std::filesystem::remove(temporaryPath, error);
+                    return;
+                }
+            }
+
+            std::filesystem::rename(temporaryPath, path, error);
+            if( error )
+                std::filesystem::remove(temporaryPath, error);
+            removeOldFiles();
+        }
+
+        void FontAtlasCache::removeOldFiles() const
+        {
+            std::error_code error;
+            std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+            for( const auto& entry : std::filesystem::directory_iterator(m_directory, error) )
+                if( entry.path().extension() == EXTENSION )
+                    files.emplace_back(entry.last_write_time(error), entry.path());
+
+            if( files.size() <= KEPT_FILES )
+                return;
+
+            std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+            for( size_t i = KEPT_FILES; i < files.size(); ++i )
+                std::filesystem::remove(files[i].second, error);
+        }
+    }
+}
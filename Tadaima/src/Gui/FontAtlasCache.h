@@ -0,0 +1,90 @@
+/**
+ * @file FontAtlasCache.h
+ * @brief Defines the FontAtlasCache class, which keeps built font atlases on disk.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct ImFontAtlas;
+
+namespace tadaima
+{
+    namespace gui
+    {
+        /**
+         * @class FontAtlasCache
+         * @brief Builds font atlases, or loads them from disk if the same atlas was built before.
+         *
+         * Rasterizing thousands of glyphs with 3x3 oversampling takes most of the startup of the GUI. A built
+         * atlas is written to a file named after a hash of everything that shapes it: the ImGui version, the font
+         * data, the sizes and rasterizer settings and the glyph ranges. An atlas with the same fonts and glyphs is
+         * then loaded from that file instead, which costs little more than copying its pixels. A changed glyph set
+         * gets a new file; only the most recent files are kept.
+         */
+        class FontAtlasCache
+        {
+        public:
+            /**
+             * @struct Stats
+             * @brief What building or loading an atlas cost.
+             */
+            struct Stats
+            {
+                bool fromCache = false;     /**< Whether the atlas was loaded from the cache. */
+                double milliseconds = 0;    /**< Time spent building or loading it. */
+                size_t glyphs = 0;          /**< Number of glyphs of all fonts. */
+                int width = 0;              /**< Width of the texture. */
+                int height = 0;             /**< Height of the texture. */
+                size_t textureBytes = 0;    /**< Size of the texture as RGBA32, the format uploaded to the GPU. */
+
+                /**
+                 * @brief Formats the statistics for the log.
+                 */
+                std::string toString() const;
+            };
+
+            static constexpr size_t KEPT_FILES = 4; ///< Number of cached atlases kept in the directory.
+
+            /**
+             * @brief Constructor.
+             * @param directory The directory of the cached atlases, created when the first one is written.
+             */
+            explicit FontAtlasCache(std::string directory);
+
+            /**
+             * @brief Builds the texture of an atlas whose fonts were added, or loads it from the cache.
+             *
+             * A freshly built atlas is written to the cache; failing to write it only costs the next startup.
+             *
+             * @param atlas The atlas, with its fonts added and not built yet.
+             * @return The statistics of the atlas.
+             * @throws std::runtime_error if the atlas cannot be built, e.g. a font file is missing.
+             */
+            Stats build(ImFontAtlas& atlas);
+
+            /**
+             * @brief Computes the cache key of an atlas from its fonts, sizes and glyph ranges.
+             * @param atlas The atlas, with its fonts added.
+             * @return The key as 16 hexadecimal digits.
+             */
+            static std::string key(const ImFontAtlas& atlas);
+
+            /**
+             * @brief Returns the file an atlas with the given key is cached in.
+             * @param key The key of the atlas.
+             */
+            std::string filePath(const std::string& key) const;
+
+        private:
+            bool load(ImFontAtlas& atlas, const std::string& key) const;
+            void save(const ImFontAtlas& atlas, const std::string& key) const;
+            void removeOldFiles() const;
+
+            std::string m_directory; /**< The directory of the cached atlases. */
+        };
+    }
+}
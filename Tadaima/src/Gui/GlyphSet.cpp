@@ -0,0 +1,150 @@
+#include "GlyphSet.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <mutex>
+
+namespace tadaima
+{
+    namespace gui
+    {
+        bool GlyphSet::addText(std::string_view utf8)
+        {
+            bool added = false;
+            const char* text = utf8.data();
+            const char* end = text + utf8.size();
+            while( text < end )
+            {
+                unsigned int codePoint = 0;
+                text += ImTextCharFromUtf8(&codePoint, text, end);
+                // Invalid sequences and characters beyond ImWchar are decoded as the replacement character.
+                if( codePoint >= 0x20 && codePoint != IM_UNICODE_CODEPOINT_INVALID )
+                    added |= add(codePoint);
+            }
+            return added;
+        }
+
+        bool GlyphSet::addCharacters(const ImWchar* text, size_t length)
+        {
+            bool added = false;
+            for( size_t index = 0; index < length; ++index )
+            {
+                if( text[index] >= 0x20 )
+                    added |= add(text[index]);
+            }
+            return added;
+        }
+
+        bool GlyphSet::addRange(ImWchar first, ImWchar last)
+        {
+            bool added = false;
+            for( uint32_t codePoint = first; codePoint <= last; ++codePoint )
+                added |= add(codePoint);
+            return added;
+        }
+
+        bool GlyphSet::addLessons(const std::vector<Lesson>& lessons)
+        {
+            bool added = false;
+            for( const Lesson& lesson : lessons )
+            {
+                added |= addText(lesson.groupName);
+                added |= addText(lesson.mainName);
+                added |= addText(lesson.subName);
+                for( const Word& word : lesson.words )
+                {
+                    added |= addText(word.kana);
+                    added |= addText(word.kanji);
+                    added |= addText(word.translation);
+                    added |= addText(word.romaji);
+                    added |= addText(word.exampleSentence);
+                    for( const std::string& tag : word.tags )
+                        added |= addText(tag);
+                    for( const std::string& conjugation : word.conjugations )
+                        added |= addText(conjugation);
+                }
+            }
+            return added;
+        }
+
+        bool GlyphSet::contains(uint32_t codePoint) const
+        {
+            return codePoint <= IM_UNICODE_CODEPOINT_MAX && codePoint < 0x10000 && (m_bits[codePoint / 64] >> (codePoint % 64) & 1) != 0;
+        }
+
+        size_t GlyphSet::size() const
+        {
+            return m_size;
+        }
+
+        const ImWchar* GlyphSet::ranges()
+        {
+            if( m_rangesOutdated )
+            {
+                m_ranges.clear();
+                for( uint32_t codePoint = 0; codePoint < 0x10000; ++codePoint )
+                {
+                    if( !contains(codePoint) )
+                        continue;
+
+                    const uint32_t first = codePoint;
+                    while( codePoint + 1 < 0x10000 && contains(codePoint + 1) )
+                        ++codePoint;
+                    m_ranges.push_back(static_cast<ImWchar>(first));
+                    m_ranges.push_back(static_cast<ImWchar>(codePoint));
+                }
+                m_ranges.push_back(0);
+                m_rangesOutdated = false;
+            }
+            return m_ranges.data();
+        }
+
+        namespace
+        {
+            std::mutex g_requestsMutex;
+            std::string g_requests; ///< Text requested by GlyphRequests::add(), separated by newlines.
+        }
+
+        void GlyphRequests::add(std::string_view utf8)
+        {
+            if( std::all_of(utf8.begin(), utf8.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; }) )
+                return;
+
+            std::lock_guard<std::mutex> lock(g_requestsMutex);
+            g_requests.append(utf8);
+            g_requests.push_back('\n');
+        }
+
+        void GlyphRequests::add(const Word& word)
+        {
+            add(word.kana);
+            add(word.kanji);
+            add(word.translation);
+            add(word.romaji);
+            add(word.exampleSentence);
+            for( const std::string& tag : word.tags )
+                add(tag);
+            for( const std::string& conjugation : word.conjugations )
+                add(conjugation);
+        }
+
+        std::string GlyphRequests::take()
+        {
+            std::lock_guard<std::mutex> lock(g_requestsMutex);
+            std::string requests;
+            requests.swap(g_requests);
+            return requests;
+        }
+
+        bool GlyphSet::add(uint32_t codePoint)
+        {
+            // ImWchar holds only the Basic Multilingual Plane in this build; other characters are never baked.
+            if( codePoint >= 0x10000 || codePoint > IM_UNICODE_CODEPOINT_MAX || contains(codePoint) )
+                return false;
+
+            m_bits[codePoint / 64] |= uint64_t(1) << (codePoint % 64);
+            ++m_size;
+            m_rangesOutdated = true;
+            return true;
+        }
+    }
+}
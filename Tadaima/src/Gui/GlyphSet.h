@@ -0,0 +1,116 @@
+/**
+ * @file GlyphSet.h
+ * @brief Defines the GlyphSet class, the characters the fonts of the GUI must contain.
+ */
+
+#pragma once
+
+#include "imgui.h"
+#include "lessons/Lesson.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tadaima
+{
+    namespace gui
+    {
+        /**
+         * @class GlyphSet
+         * @brief The code points found in the shown text, turned into the glyph ranges of a font.
+         *
+         * Baking whole Unicode blocks rasterizes tens of thousands of kanji a deck never uses. The set instead
+         * grows with the text it is given, so the atlas holds only the characters of the vocabulary and of the
+         * UI, and callers rebuild it only when add...() reports new characters.
+         */
+        class GlyphSet
+        {
+        public:
+            /**
+             * @brief Adds the characters of a text.
+             * @param utf8 The text, UTF-8 encoded.
+             * @return True if the text contained characters not in the set yet.
+             */
+            bool addText(std::string_view utf8);
+
+            /**
+             * @brief Adds decoded characters, e.g. the edit buffer of ImGui's active text field.
+             * @param text The characters.
+             * @param length The number of characters.
+             * @return True if the characters were not all in the set yet.
+             */
+            bool addCharacters(const ImWchar* text, size_t length);
+
+            /**
+             * @brief Adds all characters of a range.
+             * @param first The first code point.
+             * @param last The last code point, inclusive.
+             * @return True if the range contained characters not in the set yet.
+             */
+            bool addRange(ImWchar first, ImWchar last);
+
+            /**
+             * @brief Adds the characters of the names and words of lessons.
+             * @param lessons The lessons.
+             * @return True if the lessons contained characters not in the set yet.
+             */
+            bool addLessons(const std::vector<Lesson>& lessons);
+
+            /**
+             * @brief Checks whether a code point is in the set.
+             * @param codePoint The code point.
+             */
+            bool contains(uint32_t codePoint) const;
+
+            /**
+             * @brief Returns the number of code points in the set.
+             */
+            size_t size() const;
+
+            /**
+             * @brief Returns the set as zero-terminated glyph ranges for ImFontConfig::GlyphRanges.
+             *
+             * The pointer stays valid until the set changes; ImGui reads the ranges when the atlas is built.
+             */
+            const ImWchar* ranges();
+
+        private:
+            bool add(uint32_t codePoint);
+
+            std::vector<uint64_t> m_bits = std::vector<uint64_t>(0x10000 / 64); /**< One bit per code point of the BMP. */
+            size_t m_size = 0;                                                   /**< Number of bits set. */
+            std::vector<ImWchar> m_ranges;                                       /**< Ranges built from m_bits. */
+            bool m_rangesOutdated = true;                                        /**< Whether m_ranges misses added characters. */
+        };
+
+        /**
+         * @class GlyphRequests
+         * @brief Text shown by the widgets that did not come with a lesson package, e.g. dictionary results.
+         *
+         * Widgets add such text when they receive it; the Gui moves it into its GlyphSet before each frame, so the
+         * font gains the characters before the text has been on screen for long. Safe to call from any thread.
+         */
+        class GlyphRequests
+        {
+        public:
+            /**
+             * @brief Requests the characters of a text. Plain ASCII is ignored, it is always baked.
+             * @param utf8 The text, UTF-8 encoded.
+             */
+            static void add(std::string_view utf8);
+
+            /**
+             * @brief Requests the characters of all fields of a word.
+             * @param word The word.
+             */
+            static void add(const Word& word);
+
+            /**
+             * @brief Returns the text requested since the last call.
+             */
+            static std::string take();
+        };
+    }
+}
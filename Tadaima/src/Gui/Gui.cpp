@@ -10,17 +10,21 @@
 #include "Widgets/LessonTreeViewWidget.h"
 #include "Widgets/MenuBarWidget.h"
 #include "Widgets/MainDashboardWidget.h"
+#include "Widgets/packages/LessonDataPackage.h"
 #include "resources/IconsFontAwesome4.h"
 #include "resources/resource.h"
 #include "tools/SystemTools.h"
 #include "imgui.h"
+#include "imgui_internal.h"
 #include "imgui_impl_dx11.h"
 #include "imgui_impl_win32.h"
 #include <xutility>
 #include <format> 
+#include <filesystem>
 #include <string>
 #include <windows.h>
 #include "Tools/Logger.h"
+#include "Tools/Tracer.h"
 #include "Widgets/WidgetTypes.h"
 
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -33,6 +37,8 @@ namespace tadaima
         static float window_height = 820;
         static uint16_t g_ResizeWidth = 0;
         static uint16_t g_ResizeHeight = 0;
+        static constexpr std::chrono::milliseconds FONT_REBUILD_DELAY{ 250 };
+        static constexpr std::chrono::milliseconds FONT_REBUILD_MAX_DELAY{ 1000 };
 
         Gui::Gui(tools::Logger& logger, const config& r_config) : m_logger(logger), m_quizManager(logger), m_guiConfig(r_config)
         {
@@ -48,64 +54,113 @@ namespace tadaima
             {
                 value->setObserver(std::bind(&Gui::handleWidgetEvent, this, std::placeholders::_1));
             }
+
+            /*
+            *  Quizzes started from the lesson tree are run by the GUI itself.
+            */
+            using LessonTree = widget::LessonTreeViewWidget;
+            m_subscriptions.push_back(m_dispatcher.subscribe<widget::LessonDataPackage>(widget::Type::LessonTreeView, LessonTree::OnPlayMultipleChoiceQuiz,
+                [this](const widget::LessonDataPackage& package) { m_quizManager.startQuiz(quiz::QuizType::MultipleChoiceQuiz, package.m_lessons); }));
+            m_subscriptions.push_back(m_dispatcher.subscribe<widget::LessonDataPackage>(widget::Type::LessonTreeView, LessonTree::OnPlayVocabularyQuiz,
+                [this](const widget::LessonDataPackage& package) { m_quizManager.startQuiz(quiz::QuizType::VocabularyQuiz, package.m_lessons); }));
+            m_subscriptions.push_back(m_dispatcher.subscribe<widget::LessonDataPackage>(widget::Type::LessonTreeView, LessonTree::OnConjuactionQuiz,
+                [this](const widget::LessonDataPackage& package) { m_quizManager.startQuiz(quiz::QuizType::ConjuactionQuiz, package.m_lessons); }));
         }
 
         void Gui::initialize()
         {
             /*
-            * Initialize fonts.
+            * Initialize fonts with the characters of the UI; the characters of the lessons are added when they arrive.
             */
+            m_glyphs.addRange(0x0020, 0x007F); // Basic Latin (for general UI)
+            m_glyphs.addRange(0x3000, 0x30FF); // Japanese Punctuation, Hiragana, Katakana
+            for( const auto& [word, meaning] : widget::MainDashboardWidget::getWordsOfTheDay() )
+            {
+                m_glyphs.addText(word);
+                m_glyphs.addText(meaning);
+            }
+
+            ImGui::GetStyle().AntiAliasedFill = true;
+            ImGui::GetStyle().AntiAliasedLines = true;
+
+            buildFonts();
+            m_fontsOutdated = false;
+        }
+
+        void Gui::buildFonts()
+        {
+            tools::TraceScope trace("Gui::buildFonts", "gui");
+
             std::string pathToFont = getexepath() + "\\fonts\\NotoSansJP-Regular.ttf";
             std::string pathToIcons = getexepath() + "\\fonts\\forkawesome-webfont.ttf";
             std::string p = getexepath() +  "\\fonts\\NotoSans-Regular.ttf";
 
-            ImGuiIO& io = ImGui::GetIO();
-            io.Fonts->AddFontDefault();
-
-            // Specify the range of characters to include
-            static const ImWchar icons_ranges[] = { 0x0020, 0x007F, // Basic Latin (for general UI)
-                0x3000, 0x30FF, // Japanese Punctuation, Hiragana, Katakana
-                0x4E00, 0x9FAF, // Common Kanji
-                0,
-            };
             static const ImWchar ranges[] =
             {
                 0x0020, 0x00FF, // Basic Latin + Latin Supplement
                 0x00A0, 0x02D9, // Polish characters 
                 0,
             };
+            static const ImWchar icon_ranges[] = { ICON_MIN_FA, ICON_MAX_FA, 0 };
 
-         //   ImGuiIO& io = ImGui::GetIO();
+            ImGuiIO& io = ImGui::GetIO();
             float fontSize = 17.0f * io.FontGlobalScale; // Adjust based on your DPI scaling
             io.Fonts->Clear();
 
-            static const ImWchar icon_ranges[] = { ICON_MIN_FA, ICON_MAX_FA, 0 };
-
             // Load Japanese font
             ImFontConfig font_config;
             font_config.MergeMode = true; // Set to true if adding to existing font
-            font_config.PixelSnapH = true; // Align text to pixels
-
             font_config.OversampleH = 3; // Horizontal oversampling
             font_config.OversampleV = 3; // Vertical oversampling
             font_config.PixelSnapH = true; // Align text to pixel boundaries
 
-            io.Fonts->TexUvScale = ImVec2(1.0f, 1.0f); // Ensure UV scaling is correct
-            io.Fonts->TexUvWhitePixel = ImVec2(1.0f, 1.0f); // Ensure white pixel texture is correct
-            ImGui::GetStyle().AntiAliasedFill = true;
-            ImGui::GetStyle().AntiAliasedLines = true;
-
             io.Fonts->AddFontFromFileTTF(p.c_str(), fontSize, NULL, ranges);
-
             io.Fonts->AddFontFromFileTTF(pathToIcons.c_str(), fontSize, &font_config, icon_ranges);
-            m_fontToUse = io.Fonts->AddFontFromFileTTF(pathToFont.c_str(), fontSize, &font_config, icons_ranges);
+            // The ranges must outlive the atlas build; m_glyphs keeps them until it gains characters.
+            m_fontToUse = io.Fonts->AddFontFromFileTTF(pathToFont.c_str(), fontSize, &font_config, m_glyphs.ranges());
+
+            try
+            {
+                const FontAtlasCache::Stats stats = m_fontAtlasCache.build(*io.Fonts);
+                m_logger.info("Gui: Font atlas of {} characters: {}", m_glyphs.size(), stats.toString());
+            }
+            catch( const std::exception& exception )
+            {
+                m_logger.problem("Gui::buildFonts: Can't build the fonts. Message: {}", exception.what());
+            }
+        }
+
+        void Gui::collectGlyphs()
+        {
+            bool added = m_glyphs.addText(GlyphRequests::take());
+            if( const ImGuiInputTextState* state = ImGui::GetInputTextState(ImGui::GetActiveID()) )
+                added |= m_glyphs.addCharacters(state->TextW.Data, static_cast<size_t>(state->CurLenW));
+
+            if( added )
+                markFontsOutdated();
+        }
+
+        void Gui::markFontsOutdated()
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if( !m_fontsOutdated )
+                m_fontsOutdatedSince = now;
+            m_glyphsAddedAt = now;
+            m_fontsOutdated = true;
+        }
+
+        bool Gui::isFontRebuildDue() const
+        {
+            if( !m_fontsOutdated )
+                return false;
 
-            io.Fonts->Build();
+            const auto now = std::chrono::steady_clock::now();
+            return now - m_glyphsAddedAt >= FONT_REBUILD_DELAY || now - m_fontsOutdatedSince >= FONT_REBUILD_MAX_DELAY;
         }
 
-        void Gui::addListener(widget::Type widget, EventListener listener)
+        Gui::WidgetEventDispatcher& Gui::getDispatcher()
         {
-            dispatcher.addListener(widget, listener);
+            return m_dispatcher;
         }
 
         LRESULT WINAPI WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -142,6 +197,13 @@ namespace tadaima
                 }
 
                 m_quizManager.initialize(data);
+
+                // Lessons may bring characters the Japanese font has no glyphs for yet.
+                if( const auto* package = dynamic_cast<const widget::LessonDataPackage*>(&data) )
+                {
+                    if( m_glyphs.addLessons(package->m_lessons) )
+                        markFontsOutdated();
+                }
             }
             catch( std::exception& exception )
             {
@@ -153,6 +215,30 @@ namespace tadaima
             }
         }
 
+        void Gui::setDatabasePath(const std::string& databasePath)
+        {
+            if( auto* lessonTree = dynamic_cast<widget::LessonTreeViewWidget*>(m_widgets[widget::Type::LessonTreeView].get()) )
+                lessonTree->setDatabasePath(databasePath);
+        }
+
+        void Gui::post(GuiUpdateQueue::Update update)
+        {
+            m_updates.post(std::move(update));
+        }
+
+        void Gui::applyPostedUpdates()
+        {
+            tools::TraceScope trace("Gui::applyPostedUpdates", "gui");
+            try
+            {
+                m_updates.apply(m_guiConfig.updateBudget);
+            }
+            catch( const std::exception& exception )
+            {
+                m_logger.log(std::format("Gui::applyPostedUpdates: An update failed. Message: {}", exception.what()), tools::LogLevel::PROBLEM);
+            }
+        }
+
         int Gui::run()
         {
             bool floating = true;
@@ -198,6 +284,7 @@ namespace tadaima
             ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
             bool showDashboard = true;
             initialize();
+            tools::Tracer::instance().setThreadName("GUI");
 
             // Main loop
             bool done = false;
@@ -218,6 +305,8 @@ namespace tadaima
                 if( done )
                     break;
 
+                tools::TraceScope frameTrace("Frame", "gui");
+
                 // Handle window resize (we don't resize directly in the WM_SIZE handler)
                 if( g_ResizeWidth != 0 && g_ResizeHeight != 0 )
                 {
@@ -227,11 +316,30 @@ namespace tadaima
                     CreateRenderTarget();
                 }
 
+                // Widgets change only here, never while they are drawn.
+                tools::Tracer::count("Posted updates", static_cast<int64_t>(m_updates.pending()));
+                applyPostedUpdates();
+
+                // A rebuilt atlas needs a new texture, which NewFrame() creates once the device objects are gone.
+                collectGlyphs();
+                if( isFontRebuildDue() )
+                {
+                    ImGui_ImplDX11_InvalidateDeviceObjects();
+                    buildFonts();
+                    m_fontsOutdated = false;
+                }
+
                 // Start the Dear ImGui frame
-                ImGui_ImplDX11_NewFrame();
-                ImGui_ImplWin32_NewFrame();
+                {
+                    tools::TraceScope trace("NewFrame", "gui");
+                    ImGui_ImplDX11_NewFrame();
+                    ImGui_ImplWin32_NewFrame();
 
-                ImGui::NewFrame();
+                    ImGui::NewFrame();
+                }
+
+                if( ImGui::IsKeyPressed(ImGuiKey_F12, false) )
+                    toggleTracing();
 
                 // 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
                 if( show_demo_window )
@@ -241,6 +349,7 @@ namespace tadaima
 
                 // 2. Show a simple window that we create ourselves. We use a Begin/End pair to create a named window.
                 {
+                    tools::TraceScope trace("Draw widgets", "gui");
 
                     /*          Main menu bar           */
                     m_widgets[widget::Type::MenuBar]->draw();
@@ -279,12 +388,16 @@ namespace tadaima
                 }
 
                 // Rendering
-                ImGui::Render();
-                const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
-                g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
-                g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
-                ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+                {
+                    tools::TraceScope trace("Render", "gui");
+                    ImGui::Render();
+                    const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
+                    g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, nullptr);
+                    g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
+                    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+                }
 
+                tools::TraceScope presentTrace("Present", "gui");
                 g_pSwapChain->Present(1, 0); // Present with vsync
             }
 
@@ -354,38 +467,32 @@ namespace tadaima
             if( g_mainRenderTargetView ) { g_mainRenderTargetView->Release(); g_mainRenderTargetView = nullptr; }
         }
 
+        void Gui::toggleTracing()
+        {
+            tools::Tracer& tracer = tools::Tracer::instance();
+            if( !tools::Tracer::isEnabled() )
+            {
+                tracer.start();
+                m_logger.info("Gui: Tracing started, press F12 again to save the trace.");
+                return;
+            }
+
+            tracer.stop();
+            const std::filesystem::path path = "logs/tadaima-trace.json";
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+            if( tracer.writeJson(path) )
+                m_logger.info("Gui: Saved {} trace events to {}.", tracer.eventCount(), path.string());
+            else
+                m_logger.problem("Gui: Cannot write the trace to {}.", path.string());
+        }
+
         void Gui::handleWidgetEvent(const widget::WidgetEvent& data)
         {
+            tools::TraceScope trace("Gui::handleWidgetEvent", "events");
             try
             {
-                if( data.getEventType() == tadaima::gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnPlayMultipleChoiceQuiz )
-                {
-                    widget::LessonDataPackage* package = dynamic_cast<widget::LessonDataPackage*>(data.getEventData());
-                    if( nullptr != package )
-                    {
-                        m_quizManager.startQuiz(quiz::QuizType::MultipleChoiceQuiz, package->m_lessons);
-                    }
-                }
-                else if( data.getEventType() == tadaima::gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnPlayVocabularyQuiz )
-                {
-                    widget::LessonDataPackage* package = dynamic_cast<widget::LessonDataPackage*>(data.getEventData());
-                    if( nullptr != package )
-                    {
-                        m_quizManager.startQuiz(quiz::QuizType::VocabularyQuiz, package->m_lessons);
-                    }
-                }
-                else if( data.getEventType() == tadaima::gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnConjuactionQuiz )
-                {
-                    widget::LessonDataPackage* package = dynamic_cast<widget::LessonDataPackage*>(data.getEventData());
-                    if( nullptr != package )
-                    {
-                        m_quizManager.startQuiz(quiz::QuizType::ConjuactionQuiz, package->m_lessons);
-                    }
-                }
-                else
-                {
-                    dispatcher.emit(data.getWidget().getType(), &data);
-                }
+                m_dispatcher.emit(data.getWidget().getType(), data.getEventType(), data.getEventData());
             }
             catch( const std::exception& e )
             {
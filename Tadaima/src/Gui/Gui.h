@@ -7,10 +7,14 @@
 
 #include "Widgets/Widget.h"
 #include "Widgets/WidgetTypes.h"
-#include "Tools/EventDispatcher.h"
+#include "GuiUpdateQueue.h"
+#include "GlyphSet.h"
+#include "FontAtlasCache.h"
 #include <d3d11.h>
+#include <chrono>
 #include <memory>
 #include <map>
+#include <vector>
 #include "gui/widgets/quiz/QuizManagerWidget.h"
 
 struct ImFont;
@@ -29,12 +33,12 @@ namespace tadaima
         class Gui
         {
         public:
-            using WidgetEventDispatcher = tools::EventDispatcher<widget::Type, const widget::WidgetEvent*>;
-            using EventListener = WidgetEventDispatcher::EventHandler;
+            using WidgetEventDispatcher = widget::WidgetEventDispatcher;
 
             struct config
             {
                 bool floating = false; ///< Flag indicating whether the GUI window has a fixed size.
+                std::chrono::microseconds updateBudget{ 4000 }; ///< Time per frame for updates posted by other threads, zero for no limit.
             };
 
             /**
@@ -52,21 +56,47 @@ namespace tadaima
             void initialize();
 
             /**
-             * @brief Adds an event listener for a specific widget and action.
+             * @brief Gets the dispatcher of widget events, to subscribe to the events of a widget.
              *
-             * @param widget The widget to listen to.
-             * @param listener The event listener function.
+             * @return The dispatcher, used on the GUI thread only.
              */
-            virtual void addListener(widget::Type widget, EventListener listener);
+            WidgetEventDispatcher& getDispatcher();
 
             /**
              * @brief Initializes a widget with provided data.
              *
+             * Must run on the GUI thread; other threads post() it instead.
+             *
              * @param widget The widget to initialize.
              * @param data The data package for initialization.
              */
             virtual void initializeWidget(const tools::DataPackage& data);
 
+            /**
+             * @brief Hands the path of the lesson database to the widgets that open their own connections.
+             *
+             * Called before run(), on the thread that runs the GUI.
+             *
+             * @param databasePath The path of the application's lesson database.
+             */
+            void setDatabasePath(const std::string& databasePath);
+
+            /**
+             * @brief Queues a change of the widgets, run on the GUI thread at the start of the next frame.
+             *
+             * Safe to call from any thread, e.g. the application worker.
+             *
+             * @param update The change.
+             */
+            void post(GuiUpdateQueue::Update update);
+
+            /**
+             * @brief Runs the posted updates within the update budget of the configuration.
+             *
+             * Called by run() before each frame; the updates left over wait for the next one.
+             */
+            void applyPostedUpdates();
+
             /**
              * @brief Runs the GUI thread.
              *
@@ -81,6 +111,36 @@ namespace tadaima
              */
             void SetupImGuiStyle();
 
+            /**
+             * @brief Adds the fonts to the atlas, with the Japanese glyphs of m_glyphs, and builds it or loads it from the cache.
+             *
+             * The device objects of the renderer must be invalidated first when the atlas was built before; the
+             * backend uploads the new texture at the start of the next frame.
+             */
+            void buildFonts();
+
+            /**
+             * @brief Adds the characters of GlyphRequests and of the active text field to m_glyphs.
+             *
+             * Typed or pasted text (e.g. kanji entered through the IME) and dictionary results are not part of any
+             * lesson yet, but must render as well.
+             */
+            void collectGlyphs();
+
+            /**
+             * @brief Records that m_glyphs gained characters, so the fonts are rebuilt once the changes settle.
+             */
+            void markFontsOutdated();
+
+            /**
+             * @brief Checks whether the outdated fonts should be rebuilt in this frame.
+             *
+             * A rebuild re-rasterizes the whole atlas, so it waits until no characters were added for
+             * FONT_REBUILD_DELAY, but at most FONT_REBUILD_MAX_DELAY, and a burst of packages or keystrokes
+             * costs one rebuild.
+             */
+            bool isFontRebuildDue() const;
+
             /**
              * @brief Creates the Direct3D device.
              *
@@ -111,14 +171,26 @@ namespace tadaima
              */
             void handleWidgetEvent(const widget::WidgetEvent& data);
 
+            /**
+             * @brief Starts tracing, or stops it and writes the trace to logs/tadaima-trace.json. Bound to F12.
+             */
+            void toggleTracing();
+
             quiz::QuizManagerWidget m_quizManager;
             ID3D11Device* g_pd3dDevice = nullptr; ///< Direct3D device.
             ID3D11DeviceContext* g_pd3dDeviceContext = nullptr; ///< Direct3D device context.
             IDXGISwapChain* g_pSwapChain = nullptr; ///< Swap chain for rendering.
             ID3D11RenderTargetView* g_mainRenderTargetView = nullptr; ///< Render target view.
-            WidgetEventDispatcher dispatcher; ///< Event dispatcher for widgets.
+            WidgetEventDispatcher m_dispatcher; ///< Event dispatcher for widgets.
+            std::vector<WidgetEventDispatcher::Subscription> m_subscriptions; ///< The events handled by the GUI itself.
+            GuiUpdateQueue m_updates; ///< Widget updates posted by other threads.
             uint8_t m_widgetId = 0; ///< ID for widgets.
             ImFont* m_fontToUse = nullptr;
+            GlyphSet m_glyphs; ///< The characters baked into the Japanese font.
+            FontAtlasCache m_fontAtlasCache{ "cache/fonts" }; ///< Built font atlases kept between runs.
+            bool m_fontsOutdated = false; ///< Whether m_glyphs gained characters since the fonts were built.
+            std::chrono::steady_clock::time_point m_fontsOutdatedSince; ///< When m_glyphs first gained characters after the last build.
+            std::chrono::steady_clock::time_point m_glyphsAddedAt; ///< When m_glyphs last gained characters.
             tools::Logger& m_logger; /**< Reference to the Logger instance for logging. */
             std::map<widget::Type, std::unique_ptr<widget::Widget>> m_widgets; ///< Vector of widgets.
             config m_guiConfig; ///< Configuration for the GUI.
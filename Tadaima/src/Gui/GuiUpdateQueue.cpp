@@ -0,0 +1,47 @@
+#include "GuiUpdateQueue.h"
+
+namespace tadaima
+{
+    namespace gui
+    {
+        void GuiUpdateQueue::post(Update update)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_posted.push_back(std::move(update));
+        }
+
+        size_t GuiUpdateQueue::apply(std::chrono::microseconds budget)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            // Leftovers of the last frame go first, so the order is kept.
+            if( m_next == m_applying.size() )
+            {
+                m_applying.clear();
+                m_next = 0;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_applying.swap(m_posted);
+            }
+
+            size_t applied = 0;
+            while( m_next < m_applying.size() )
+            {
+                // Taken out first, so an update that throws is not run again and its data is freed right away.
+                Update update = std::move(m_applying[m_next]);
+                m_applying[m_next++] = nullptr;
+                ++applied;
+                update();
+
+                if( budget != std::chrono::microseconds::zero() && std::chrono::steady_clock::now() - start >= budget )
+                    break;
+            }
+            return applied;
+        }
+
+        size_t GuiUpdateQueue::pending() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_posted.size() + (m_applying.size() - m_next);
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file GuiUpdateQueue.h
+ * @brief Defines the GuiUpdateQueue class, which hands updates of the widgets from other threads to the GUI thread.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace tadaima
+{
+    namespace gui
+    {
+        /**
+         * @class GuiUpdateQueue
+         * @brief Collects widget updates posted by any thread and runs them on the GUI thread.
+         *
+         * Widgets are only touched while a frame is drawn, so updates posted by the application worker wait here
+         * until Gui applies them at the start of the next frame. Posting only appends to a vector under a short
+         * lock; the GUI thread swaps that vector with its own, so both keep their capacity and a frame takes the
+         * lock once. Updates run in the order they were posted. With a time budget, the updates left over when it
+         * runs out are applied in the next frame, before any newer ones.
+         */
+        class GuiUpdateQueue
+        {
+        public:
+            using Update = std::function<void()>; ///< A change of the widgets, run on the GUI thread.
+
+            /**
+             * @brief Queues an update. Safe to call from any thread.
+             * @param update The update.
+             */
+            void post(Update update);
+
+            /**
+             * @brief Runs the queued updates. Only the GUI thread may call it.
+             *
+             * An update that throws is dropped and the exception is passed on; the others stay queued.
+             *
+             * @param budget The time to spend, at least one update runs; zero for no limit.
+             * @return The number of updates run.
+             */
+            size_t apply(std::chrono::microseconds budget = std::chrono::microseconds::zero());
+
+            /**
+             * @brief Returns the number of updates waiting, including those left over by the budget. Only the GUI thread may call it.
+             */
+            size_t pending() const;
+
+        private:
+            mutable std::mutex m_mutex;
+            std::vector<Update> m_posted;   ///< Updates posted since the last swap, guarded by m_mutex.
+            std::vector<Update> m_applying; ///< Updates taken by the GUI thread.
+            size_t m_next = 0;              ///< The first update of m_applying not run yet.
+        };
+    }
+}
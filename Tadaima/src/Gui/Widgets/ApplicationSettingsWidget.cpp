@@ -3,8 +3,11 @@
 #include "dictionary/Conjugations.h"
 #include "ApplicationSettingsWidget.h"
 #include "packages/SettingsDataPackage.h"
+#include "dictionary/Dictionary.h"
+#include "tools/SystemTools.h"
 #include "imgui.h"
 #include "Tools/Logger.h"
+#include <filesystem>
 
 namespace tadaima
 {
@@ -12,6 +15,11 @@ namespace tadaima
     {
         namespace widget
         {
+            namespace
+            {
+                // Where the offline dictionary is built, relative to the executable.
+                constexpr const char* LOCAL_DICTIONARY_PATH = "Dictionaries/jmdict.db";
+            }
 
             ApplicationSettingsWidget::ApplicationSettingsWidget(tools::Logger& logger)
                 : Widget(Type::ApplicationSettings), m_logger(logger)
@@ -63,15 +71,15 @@ namespace tadaima
                 try
                 {
                     SettingsDataPackage package;
-                    package.set(SettingsPackageKey::Username, std::string(m_username));
-                    package.set(SettingsPackageKey::DictionaryPath, std::string(m_dictionaryPath));
-                    package.set(SettingsPackageKey::ConjugationPath, std::string(m_conjugationPath));
-                    package.set(SettingsPackageKey::QuizzesScriptsPath, std::string(m_scriptPaths));
-                    package.set(SettingsPackageKey::AskedWordType, static_cast<quiz::WordType>(m_inputOption));
-                    package.set(SettingsPackageKey::AnswerWordType, static_cast<quiz::WordType>(m_translationOption));
-                    package.set(SettingsPackageKey::ShowLogs, m_showlogs);
-                    package.set(SettingsPackageKey::TriesForQuiz, std::to_string(m_numberOfTries));
-                    package.set(SettingsPackageKey::ConjugationMask, m_conjugationBits);
+                    package.set<SettingsPackageKey::Username>(std::string(m_username));
+                    package.set<SettingsPackageKey::DictionaryPath>(std::string(m_dictionaryPath));
+                    package.set<SettingsPackageKey::ConjugationPath>(std::string(m_conjugationPath));
+                    package.set<SettingsPackageKey::QuizzesScriptsPath>(std::string(m_scriptPaths));
+                    package.set<SettingsPackageKey::AskedWordType>(static_cast<quiz::WordType>(m_inputOption));
+                    package.set<SettingsPackageKey::AnswerWordType>(static_cast<quiz::WordType>(m_translationOption));
+                    package.set<SettingsPackageKey::ShowLogs>(m_showlogs);
+                    package.set<SettingsPackageKey::TriesForQuiz>(std::to_string(m_numberOfTries));
+                    package.set<SettingsPackageKey::ConjugationMask>(m_conjugationBits);
 
                     emitEvent(WidgetEvent(*this, ApplicationSettingsWidgetEvent::OnSettingsChanged, &package));
                 }
@@ -94,11 +102,11 @@ namespace tadaima
                     {
                         m_logger.log("ApplicationSettingsWidget::initialize: Initializing.", tools::LogLevel::INFO);
 
-                        const std::string userName = package->get<std::string>(SettingsPackageKey::Username);
-                        const std::string dictionaryPath = package->get<std::string>(SettingsPackageKey::DictionaryPath);
-                        const std::string conjugationPath = package->get<std::string>(SettingsPackageKey::ConjugationPath);
-                        const std::string quizzesScripts = package->get<std::string>(SettingsPackageKey::QuizzesScriptsPath);
-                        const std::string numberOfTries = package->get<std::string>(SettingsPackageKey::TriesForQuiz);
+                        const std::string userName = package->get<SettingsPackageKey::Username>();
+                        const std::string dictionaryPath = package->get<SettingsPackageKey::DictionaryPath>();
+                        const std::string conjugationPath = package->get<SettingsPackageKey::ConjugationPath>();
+                        const std::string quizzesScripts = package->get<SettingsPackageKey::QuizzesScriptsPath>();
+                        const std::string numberOfTries = package->get<SettingsPackageKey::TriesForQuiz>();
 
                         memset(m_username, 0, sizeof(m_username));
                         memset(m_dictionaryPath, 0, sizeof(m_dictionaryPath));
@@ -108,12 +116,17 @@ namespace tadaima
                         memcpy(m_dictionaryPath, dictionaryPath.c_str(), dictionaryPath.size());
                         memcpy(m_conjugationPath, conjugationPath.c_str(), conjugationPath.size());
                         memcpy(m_scriptPaths, quizzesScripts.c_str(), quizzesScripts.size());
+                        if( !Dictionary::isLocalDictionaryPath(dictionaryPath) )
+                        {
+                            memset(m_scriptDictionaryPath, 0, sizeof(m_scriptDictionaryPath));
+                            memcpy(m_scriptDictionaryPath, dictionaryPath.c_str(), dictionaryPath.size());
+                        }
 
-                        m_inputOption = package->get<quiz::WordType>(SettingsPackageKey::AskedWordType);
-                        m_translationOption = package->get<quiz::WordType>(SettingsPackageKey::AnswerWordType);
+                        m_inputOption = package->get<SettingsPackageKey::AskedWordType>();
+                        m_translationOption = package->get<SettingsPackageKey::AnswerWordType>();
                         m_numberOfTries = std::stoi(numberOfTries);
-                        m_showlogs = package->get<bool>(SettingsPackageKey::ShowLogs);
-                        m_conjugationBits = package->get<uint16_t>(SettingsPackageKey::ConjugationMask);
+                        m_showlogs = package->get<SettingsPackageKey::ShowLogs>();
+                        m_conjugationBits = package->get<SettingsPackageKey::ConjugationMask>();
 
                         m_logger.log("ApplicationSettingsWidget: Initialized.", tools::LogLevel::INFO);
                     }
@@ -178,6 +191,12 @@ namespace tadaima
                                 ImGui::EndTabItem();
                             }
 
+                            if( ImGui::BeginTabItem("Dictionary") )
+                            {
+                                drawDictionaryTab();
+                                ImGui::EndTabItem();
+                            }
+
                             if( ImGui::BeginTabItem("Quiz Settings") )
                             {
                                 ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "General Quiz Settings");
@@ -288,6 +307,86 @@ namespace tadaima
                 }
             }
 
+            void ApplicationSettingsWidget::drawDictionaryTab()
+            {
+                ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "Dictionary Settings");
+                ImGui::Separator();
+                ImGui::Spacing();
+
+                const char* backends[] = { "Online (dictionary script)", "Offline (JMdict)" };
+                int backend = Dictionary::isLocalDictionaryPath(m_dictionaryPath) ? 1 : 0;
+                ImGui::Text("Translation backend:");
+                if( ImGui::Combo("##backend", &backend, backends, IM_ARRAYSIZE(backends)) )
+                {
+                    const std::string path = backend == 1 ? LOCAL_DICTIONARY_PATH : m_scriptDictionaryPath;
+                    if( backend == 1 && !Dictionary::isLocalDictionaryPath(m_dictionaryPath) )
+                        memcpy(m_scriptDictionaryPath, m_dictionaryPath, sizeof(m_scriptDictionaryPath));
+
+                    memset(m_dictionaryPath, 0, sizeof(m_dictionaryPath));
+                    memcpy(m_dictionaryPath, path.c_str(), std::min(path.size(), sizeof(m_dictionaryPath) - 1));
+                }
+                ShowFieldHelp("The online backend runs the dictionary script (Path to the directory in General Settings). "
+                    "The offline backend answers from a local copy of JMdict, without network or Python.");
+
+                ImGui::Spacing();
+                ImGui::Separator();
+                ImGui::Text("Build the offline dictionary");
+
+                const bool running = m_importer.isRunning();
+                ImGui::BeginDisabled(running);
+                ImGui::InputText("##JMdictFile", m_jmdictFile, IM_ARRAYSIZE(m_jmdictFile));
+                ImGui::SameLine();
+                ImGui::Text("JMdict file");
+                ShowFieldHelp("Path to JMdict_e.xml (or JMdict.xml), available from the EDRDG website.");
+
+                ImGui::InputText("##KanjidicFile", m_kanjidicFile, IM_ARRAYSIZE(m_kanjidicFile));
+                ImGui::SameLine();
+                ImGui::Text("KANJIDIC2 file");
+                ShowFieldHelp("Optional path to kanjidic2.xml, used for single kanji without a word entry.");
+
+                if( ImGui::Button("Import", ImVec2(120, 0)) )
+                    startDictionaryImport();
+                ImGui::EndDisabled();
+
+                const JMdictImporter::Progress progress = m_importer.getProgress();
+                if( running )
+                {
+                    ImGui::SameLine();
+                    if( ImGui::Button("Cancel import", ImVec2(120, 0)) )
+                        m_importer.cancel();
+
+                    const float fraction = progress.totalBytes ? static_cast<float>(progress.bytesRead) / static_cast<float>(progress.totalBytes) : 0.0f;
+                    ImGui::ProgressBar(fraction, ImVec2(-1, 0));
+                }
+                else if( progress.finished )
+                {
+                    if( progress.error.empty() )
+                        ImGui::Text("Imported %lld words and %lld kanji.", static_cast<long long>(progress.imported.entries), static_cast<long long>(progress.imported.kanji));
+                    else
+                        ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "%s", progress.error.c_str());
+                }
+            }
+
+            void ApplicationSettingsWidget::startDictionaryImport()
+            {
+                std::vector<std::string> files;
+                if( m_jmdictFile[0] )
+                    files.emplace_back(m_jmdictFile);
+                if( m_kanjidicFile[0] )
+                    files.emplace_back(m_kanjidicFile);
+                if( files.empty() )
+                    return;
+
+                const std::string relativePath = Dictionary::isLocalDictionaryPath(m_dictionaryPath) ? m_dictionaryPath : LOCAL_DICTIONARY_PATH;
+                const std::filesystem::path dbPath = std::filesystem::path(getexepath()) / relativePath;
+
+                std::error_code error;
+                std::filesystem::create_directories(dbPath.parent_path(), error);
+
+                m_logger.log("ApplicationSettingsWidget: importing the offline dictionary into " + dbPath.string() + ".", tools::LogLevel::INFO);
+                m_importer.start(files, dbPath.string());
+            }
+
             void ApplicationSettingsWidget::ShowFieldHelp(const char* desc)
             {
                 if( ImGui::IsItemHovered() )
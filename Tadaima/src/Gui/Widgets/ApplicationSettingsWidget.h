@@ -8,6 +8,7 @@
 #include "Widget.h"
 #include <string>
 #include "quiz/QuizWordType.h"
+#include "dictionary/JMdictImporter.h"
 
 namespace tools { class Logger; }
 
@@ -117,6 +118,16 @@ namespace tadaima
                  */
                 void ShowFieldHelp(const char* desc);
 
+                /**
+                 * @brief Draws the dictionary tab: the translation backend and the offline dictionary import.
+                 */
+                void drawDictionaryTab();
+
+                /**
+                 * @brief Starts importing the JMdict and KANJIDIC2 files into the offline dictionary.
+                 */
+                void startDictionaryImport();
+
                 tools::Logger& m_logger; /**< Reference to the Logger instance for logging. */
                 char m_dictionaryPath[50] = ""; /**< Path to the dictionary used by the application. */
                 char m_conjugationPath[50] = ""; /**< Path to the conjugation used by the application. */
@@ -127,6 +138,10 @@ namespace tadaima
                 int m_numberOfTries = 1; /**< The number of tries allowed for answering a quiz question. */
                 bool m_showlogs = false; /**< Flag indicating whether logs should be displayed. */
                 uint16_t m_conjugationBits = 0; // 16 bits for up to 16 conjugation types
+                char m_scriptDictionaryPath[50] = ""; /**< Script path restored when switching back from the offline dictionary. */
+                char m_jmdictFile[260] = ""; /**< JMdict XML file to import. */
+                char m_kanjidicFile[260] = ""; /**< KANJIDIC2 XML file to import. */
+                JMdictImporter m_importer; /**< Imports the offline dictionary in the background. */
             };
         }
     }
@@ -1,6 +1,8 @@
 #include "ConjugationSettingsWidget.h"
 #include "imgui.h"
 #include "Tools/Logger.h"
+#include "Gui/GlyphSet.h"
+#include <cstring>
 
 namespace tadaima
 {
@@ -17,6 +19,11 @@ namespace tadaima
 
             }
 
+            ConjugationSettingsWidget::~ConjugationSettingsWidget()
+            {
+                m_autofillToken.cancel();
+            }
+
             void ConjugationSettingsWidget::start()
             {
                 ImGui::OpenPopup("Conjugations Modal");
@@ -39,6 +46,32 @@ namespace tadaima
                 }
             }
 
+            void ConjugationSettingsWidget::collectConjugations()
+            {
+                if( !m_pendingConjugations.valid() || m_pendingConjugations.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+                    return;
+
+                try
+                {
+                    auto conjugations = m_pendingConjugations.get();
+                    for( const auto& conjugation : conjugations )
+                        GlyphRequests::add(conjugation);
+
+                    // Update buffers with fetched conjugations
+                    for( int i = 0; i < CONJUGATION_COUNT; ++i )
+                    {
+                        std::strncpy(m_conjugationBuffers[i].data(), conjugations[i].c_str(), m_conjugationBuffers[i].size() - 1);
+                        m_conjugationBuffers[i][m_conjugationBuffers[i].size() - 1] = '\0';
+                    }
+
+                    m_logger.log("Conjugations autofilled successfully.", tools::LogLevel::INFO);
+                }
+                catch( const std::exception& e )
+                {
+                    m_logger.log(std::string("Error while autofilling conjugations: ") + e.what(), tools::LogLevel::PROBLEM);
+                }
+            }
+
             void ConjugationSettingsWidget::draw()
             {
                 ImGui::SetNextWindowSize(ImVec2(600, 400), ImGuiCond_Always);
@@ -55,29 +88,21 @@ namespace tadaima
                     ImGui::Separator();
                     ImGui::Spacing();
 
-                    // Autofill button
-                    if( ImGui::Button("Autofill Conjugations") )
+                    // Autofill button, the conjugation script runs in the background
+                    if( m_pendingConjugations.valid() )
+                    {
+                        if( ImGui::Button("Cancel Autofill") )
+                            m_autofillToken.cancel();
+                    }
+                    else if( ImGui::Button("Autofill Conjugations") )
                     {
                         m_logger.log("Autofilling conjugations for word: " + std::string(m_conjugationWord), tools::LogLevel::INFO);
 
-                        try
-                        {
-                            auto conjugations = mr_Dictionary.getConjugations(std::string(mp_Word->romaji));
-
-                            // Update buffers with fetched conjugations
-                            for( int i = 0; i < CONJUGATION_COUNT; ++i )
-                            {
-                                std::strncpy(m_conjugationBuffers[i].data(), conjugations[i].c_str(), m_conjugationBuffers[i].size() - 1);
-                                m_conjugationBuffers[i][m_conjugationBuffers[i].size() - 1] = '\0';
-                            }
-
-                            m_logger.log("Conjugations autofilled successfully.", tools::LogLevel::INFO);
-                        }
-                        catch( const std::exception& e )
-                        {
-                            m_logger.log(std::string("Error while autofilling conjugations: ") + e.what(), tools::LogLevel::PROBLEM);
-                        }
+                        const std::string romaji = mp_Word->romaji;
+                        m_autofillToken.reset();
+                        m_pendingConjugations = std::async(std::launch::async, [this, romaji]() { return mr_Dictionary.getConjugations(romaji, &m_autofillToken); });
                     }
+                    collectConjugations();
 
                     ImGui::Spacing();
 
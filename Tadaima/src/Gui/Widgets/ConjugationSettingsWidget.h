@@ -11,6 +11,7 @@
 
 #include <string>
 #include <array>
+#include <future>
 #include "dictionary/Conjugations.h"
 #include "Widget.h"
 #include "dictionary/Dictionary.h"
@@ -49,6 +50,11 @@ namespace tadaima
                  */
                 ConjugationSettingsWidget(tadaima::Dictionary& r_Dictionary, tools::Logger& logger, bool& conjugationJustSaved);
 
+                /**
+                 * @brief Cancels a running autofill, so destroying the widget does not wait for the script.
+                 */
+                ~ConjugationSettingsWidget();
+
                 /**
                  * @brief Starts the conjugation settings widget.
                  *
@@ -93,12 +99,19 @@ namespace tadaima
                  */
                 void clearConjugationBuffers(std::array<std::array<char, 128>, CONJUGATION_COUNT>& buffers);
 
+                /**
+                 * @brief Fills the conjugation buffers once the background autofill has finished, called every frame.
+                 */
+                void collectConjugations();
+
                 bool& m_conjugationJustSaved;
                 std::array<std::array<char, 128>, CONJUGATION_COUNT> m_conjugationBuffers; ///< Buffers for storing conjugation forms.
                 char m_conjugationWord[50] = ""; ///< Buffer for the word in romaji format.
                 tools::Logger& m_logger; ///< Reference to the logger for tracking operations.
                 tadaima::Dictionary& mr_Dictionary; ///< Reference to the dictionary for managing words.
                 tadaima::Word* mp_Word; ///< Pointer to the word being edited.
+                tools::CancellationToken m_autofillToken; ///< Cancels the autofill lookup only, declared before the future that uses it.
+                std::future<std::array<std::string, CONJUGATION_COUNT>> m_pendingConjugations; ///< Autofill running off the render thread.
             };
         }
     }
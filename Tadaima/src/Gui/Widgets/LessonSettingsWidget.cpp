@@ -7,6 +7,7 @@
 #include <sstream>
 #include <stdexcept>
 #include "packages/SettingsDataPackage.h"
+#include "Gui/GlyphSet.h"
 #include "Tools/Logger.h"
 
 namespace tadaima
@@ -15,9 +16,25 @@ namespace tadaima
     {
         namespace widget
         {
+            namespace
+            {
+                // Grows the std::string behind an InputText, so pasted text of any length fits.
+                int resizeStringCallback(ImGuiInputTextCallbackData* data)
+                {
+                    if( data->EventFlag == ImGuiInputTextFlags_CallbackResize )
+                    {
+                        std::string* text = static_cast<std::string*>(data->UserData);
+                        text->resize(static_cast<size_t>(data->BufTextLen));
+                        data->Buf = text->data();
+                    }
+                    return 0;
+                }
+            }
+
             LessonSettingsWidget::LessonSettingsWidget(tools::Logger& logger)
                 : m_logger(logger), m_selectedWordIndex(-1), m_isEditing(false),
-                m_ConjugationSettingsWidget(m_dictionary, logger, m_conjugationJustSaved)
+                m_ConjugationSettingsWidget(m_dictionary, logger, m_conjugationJustSaved),
+                m_batchTranslator([this](const std::string& input) { return m_dictionary.getTranslation(input, &m_batchToken); })
             {
                 m_logger.log("Initializing LessonSettingsWidget", tools::LogLevel::INFO);
                 std::memset(m_mainNameBuffer, 0, sizeof(m_mainNameBuffer));
@@ -32,6 +49,26 @@ namespace tadaima
                 m_ConjugationSettingsWidget.clear();
             }
 
+            void LessonSettingsWidget::setDatabasePath(const std::string& databasePath)
+            {
+                auto cache = std::make_shared<TranslationCache>(databasePath);
+                if( cache->isOpen() )
+                {
+                    m_dictionary.setCache(cache);
+                }
+                else
+                {
+                    m_logger.log("Translation cache is not available, every lookup will run the dictionary script.", tools::LogLevel::WARNING);
+                }
+            }
+
+            LessonSettingsWidget::~LessonSettingsWidget()
+            {
+                m_batchTranslator.cancel();
+                m_batchToken.cancel();
+                m_translationToken.cancel();
+            }
+
             void LessonSettingsWidget::draw(bool* p_open)
             {
                 if( *p_open )
@@ -82,30 +119,32 @@ namespace tadaima
 
                     ImGui::Spacing();
 
-                    // Button to translate using the dictionary
-                    if( ImGui::Button("Translate") )
+                    // Button to translate using the dictionary, the lookup runs in the background
+                    if( m_pendingTranslation.valid() )
                     {
-                        m_logger.log("Translating word: " + std::string(m_translationBuffer), tools::LogLevel::INFO);
-                        try
-                        {
-                            Word translatedWord = m_dictionary.getTranslation(m_translationBuffer);
-                            std::strncpy(m_translationBuffer, translatedWord.translation.c_str(), sizeof(m_translationBuffer));
-                            std::strncpy(m_romajiBuffer, translatedWord.romaji.c_str(), sizeof(m_romajiBuffer));
-                            std::strncpy(m_kanaBuffer, translatedWord.kana.c_str(), sizeof(m_kanaBuffer));
-                            std::strncpy(m_kanjiBuffer, translatedWord.kanji.c_str(), sizeof(m_kanjiBuffer)); // Set the kanji
-                            std::strncpy(m_exampleSentenceBuffer, translatedWord.exampleSentence.c_str(), sizeof(m_exampleSentenceBuffer)); // Set the kanji
-                            m_logger.log("Translated: ");
-                            m_logger.log(" ->: " + translatedWord.translation);
-                            m_logger.log(" ->: " + translatedWord.romaji);
-                            m_logger.log(" ->: " + translatedWord.kana);
-                            m_logger.log(" ->: " + translatedWord.kanji);
-                            m_logger.log(" ->: " + translatedWord.exampleSentence);
-                        }
-                        catch( const std::exception& e )
+                        if( ImGui::Button("Cancel##Translate") )
                         {
-                            m_logger.log(std::string("Translation error: ") + e.what(), tools::LogLevel::PROBLEM);
+                            m_logger.log("Cancelling the translation.", tools::LogLevel::INFO);
+                            m_translationToken.cancel();
                         }
                     }
+                    else if( ImGui::Button("Translate") )
+                    {
+                        const std::string input(m_translationBuffer);
+                        m_logger.log("Translating word: " + input, tools::LogLevel::INFO);
+                        m_translationToken.reset();
+                        m_pendingTranslation = std::async(std::launch::async, [this, input]() { return m_dictionary.getTranslation(input, &m_translationToken); });
+                    }
+
+                    if( ImGui::IsItemHovered() )
+                    {
+                        const auto statistics = m_dictionary.getCacheStatistics();
+                        ImGui::SetTooltip("Cache: %llu hits, %llu misses, %llu expired (%.0f%% hit ratio)",
+                                          static_cast<unsigned long long>(statistics.hits),
+                                          static_cast<unsigned long long>(statistics.misses),
+                                          static_cast<unsigned long long>(statistics.expired),
+                                          statistics.hitRatio() * 100.0);
+                    }
 
                     ImGui::SameLine();
 
@@ -116,7 +155,17 @@ namespace tadaima
                         m_ConjugationSettingsWidget.start();
                     }
 
+                    ImGui::SameLine();
+
+                    if( ImGui::Button("Translate List") )
+                    {
+                        ImGui::OpenPopup("Translate Word List");
+                    }
+
                     m_ConjugationSettingsWidget.draw();
+                    drawWordListPopup();
+                    collectBatchResults();
+                    collectTranslation();
   
                     ImGui::Spacing();
 
@@ -378,14 +427,124 @@ namespace tadaima
                 m_selectedWordIndex = -1; // Reset selection
             }
 
+            void LessonSettingsWidget::drawWordListPopup()
+            {
+                ImGui::SetNextWindowSize(ImVec2(450, 400), ImGuiCond_Appearing);
+                if( ImGui::BeginPopupModal("Translate Word List", nullptr, ImGuiWindowFlags_NoResize) )
+                {
+                    ImGui::TextWrapped("Paste one word per line (commas also separate words). Translated words are added to the lesson as they arrive.");
+                    ImGui::InputTextMultiline("##WordList", m_wordList.data(), m_wordList.capacity() + 1, ImVec2(-1, 150), ImGuiInputTextFlags_CallbackResize,
+                        resizeStringCallback, &m_wordList);
+
+                    const auto progress = m_batchTranslator.getProgress();
+                    if( m_batchTranslator.isRunning() )
+                    {
+                        const float fraction = progress.total ? static_cast<float>(progress.completed) / static_cast<float>(progress.total) : 1.0f;
+                        const std::string overlay = std::to_string(progress.completed) + " / " + std::to_string(progress.total);
+                        ImGui::ProgressBar(fraction, ImVec2(-1, 0), overlay.c_str());
+
+                        if( ImGui::Button("Cancel", ImVec2(120, 0)) )
+                        {
+                            m_logger.log("Cancelling word list translation", tools::LogLevel::INFO);
+                            m_batchTranslator.cancel();
+                            m_batchToken.cancel();
+                        }
+                    }
+                    else
+                    {
+                        if( ImGui::Button("Translate All", ImVec2(120, 0)) )
+                        {
+                            auto words = BatchTranslator::splitList(m_wordList);
+                            m_logger.log("Translating word list of " + std::to_string(words.size()) + " words", tools::LogLevel::INFO);
+                            m_batchErrors.clear();
+                            m_batchToken.reset();
+                            m_batchTranslator.start(words);
+                        }
+
+                        ImGui::SameLine();
+                        if( ImGui::Button("Close", ImVec2(120, 0)) )
+                        {
+                            ImGui::CloseCurrentPopup();
+                        }
+
+                        if( progress.total > 0 )
+                        {
+                            ImGui::Text("Translated %zu of %zu words, %zu duplicates skipped.", progress.completed - progress.failed, progress.total, progress.duplicates);
+                        }
+                    }
+
+                    if( !m_batchErrors.empty() )
+                    {
+                        ImGui::Spacing();
+                        ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "Not translated:");
+                        ImGui::BeginChild("BatchErrors", ImVec2(0, 0), true);
+                        for( const auto& error : m_batchErrors )
+                        {
+                            ImGui::TextWrapped("%s", error.c_str());
+                        }
+                        ImGui::EndChild();
+                    }
+
+                    ImGui::EndPopup();
+                }
+            }
+
+            void LessonSettingsWidget::collectBatchResults()
+            {
+                for( auto& item : m_batchTranslator.takeResults() )
+                {
+                    if( item.succeeded() && !item.word.kana.empty() )
+                    {
+                        GlyphRequests::add(item.word);
+                        m_newLesson.groupName = std::string(m_groupNameBuffer);
+                        m_newLesson.mainName = std::string(m_mainNameBuffer);
+                        m_newLesson.subName = std::string(m_subNameBuffer);
+                        m_newLesson.words.push_back(std::move(item.word));
+                    }
+                    else
+                    {
+                        const std::string reason = item.succeeded() ? "No kana found." : item.error;
+                        m_logger.log("Translation error for " + item.input + ": " + reason, tools::LogLevel::WARNING);
+                        m_batchErrors.push_back(item.input + ": " + reason);
+                    }
+                }
+            }
+
+            void LessonSettingsWidget::collectTranslation()
+            {
+                if( !m_pendingTranslation.valid() || m_pendingTranslation.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+                    return;
+
+                try
+                {
+                    Word translatedWord = m_pendingTranslation.get();
+                    GlyphRequests::add(translatedWord);
+                    std::strncpy(m_translationBuffer, translatedWord.translation.c_str(), sizeof(m_translationBuffer));
+                    std::strncpy(m_romajiBuffer, translatedWord.romaji.c_str(), sizeof(m_romajiBuffer));
+                    std::strncpy(m_kanaBuffer, translatedWord.kana.c_str(), sizeof(m_kanaBuffer));
+                    std::strncpy(m_kanjiBuffer, translatedWord.kanji.c_str(), sizeof(m_kanjiBuffer)); // Set the kanji
+                    std::strncpy(m_exampleSentenceBuffer, translatedWord.exampleSentence.c_str(), sizeof(m_exampleSentenceBuffer)); // Set the kanji
+                    m_logger.log("Translated: ");
+                    m_logger.log(" ->: " + translatedWord.translation);
+                    m_logger.log(" ->: " + translatedWord.romaji);
+                    m_logger.log(" ->: " + translatedWord.kana);
+                    m_logger.log(" ->: " + translatedWord.kanji);
+                    m_logger.log(" ->: " + translatedWord.exampleSentence);
+                }
+                catch( const std::exception& e )
+                {
+                    m_logger.log(std::string("Translation error: ") + e.what(), tools::LogLevel::PROBLEM);
+                }
+            }
+
             void LessonSettingsWidget::initialize(const tools::DataPackage& r_package)
             {
                 m_logger.log("Initializing LessonSettingsWidget with data package", tools::LogLevel::INFO);
                 const SettingsDataPackage* package = dynamic_cast<const SettingsDataPackage*>(&r_package);
                 if( package )
                 {
-                    const std::string dictionaryPath = package->get<std::string>(SettingsPackageKey::DictionaryPath);
-                    const std::string conjugationPath = package->get<std::string>(SettingsPackageKey::ConjugationPath);
+                    const std::string dictionaryPath = package->get<SettingsPackageKey::DictionaryPath>();
+                    const std::string conjugationPath = package->get<SettingsPackageKey::ConjugationPath>();
                     m_dictionary.setPathForTranslator(dictionaryPath);
                     m_dictionary.setPathForConjugationTranslator(conjugationPath);
                     m_logger.log("Dictionary path set to: " + dictionaryPath, tools::LogLevel::INFO);
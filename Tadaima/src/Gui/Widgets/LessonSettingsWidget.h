@@ -10,6 +10,10 @@
 #include "Lessons/Lesson.h"
 #include "dictionary/Conjugations.h"
 #include "dictionary/Dictionary.h"
+#include "dictionary/BatchTranslator.h"
+#include <future>
+#include <string>
+#include <vector>
 
 namespace tools { class Logger; }
 
@@ -42,6 +46,11 @@ namespace tadaima
                  */
                 LessonSettingsWidget(tools::Logger& logger);
 
+                /**
+                 * @brief Cancels this widget's lookups so the background threads finish before the dictionary goes away.
+                 */
+                ~LessonSettingsWidget();
+
                 /**
                  * @brief Draws the lesson settings widget.
                  *
@@ -70,6 +79,15 @@ namespace tadaima
                  */
                 void initialize(const tools::DataPackage& r_package) override;
 
+                /**
+                 * @brief Opens the translation cache in the lesson database.
+                 *
+                 * Without it every lookup runs the dictionary script. Called before the first frame.
+                 *
+                 * @param databasePath The path of the application's lesson database.
+                 */
+                void setDatabasePath(const std::string& databasePath);
+
                 /**
                  * @brief Clears the widget's fields and resets its state.
                  *
@@ -86,6 +104,21 @@ namespace tadaima
                  */
                 void createAWordFromFields();
 
+                /**
+                 * @brief Draws the "Translate List" popup where a pasted word list is translated in the background.
+                 */
+                void drawWordListPopup();
+
+                /**
+                 * @brief Moves finished batch translations into the lesson, called every frame.
+                 */
+                void collectBatchResults();
+
+                /**
+                 * @brief Fills the word fields once the background translation has finished, called every frame.
+                 */
+                void collectTranslation();
+
                 bool m_conjugationJustSaved = false;
                 bool m_isEditing = false; ///< Flag indicating whether the widget is in edit mode.
                 char m_mainNameBuffer[50] = ""; ///< Buffer for the lesson main name.
@@ -97,6 +130,8 @@ namespace tadaima
                 char m_romajiBuffer[50] = ""; ///< Buffer for word romaji.
                 char m_exampleSentenceBuffer[300] = ""; ///< Buffer for example sentence.
                 char m_tagBuffer[100] = ""; ///< Buffer for word tags.
+                std::string m_wordList; ///< The pasted word list, grown by the InputText as needed.
+                std::vector<std::string> m_batchErrors; ///< Words of the last batch that could not be translated.
 
                 Word m_newWord; ///< Temporary storage for a newly created word.
                 int m_selectedWordIndex = -1; ///< Index of the selected word in the list.
@@ -105,6 +140,10 @@ namespace tadaima
                 tools::Logger& m_logger; ///< Reference to the logger for operation tracking.
                 Lesson* m_lesson; ///< Pointer to the current lesson being edited.
                 ConjugationSettingsWidget m_ConjugationSettingsWidget; ///< Widget for conjugation settings.
+                tools::CancellationToken m_batchToken; ///< Cancels the lookups of the word list translation only.
+                tools::CancellationToken m_translationToken; ///< Cancels the lookup of the Translate button only.
+                BatchTranslator m_batchTranslator; ///< Translates pasted word lists, declared after m_dictionary and m_batchToken which it uses.
+                std::future<Word> m_pendingTranslation; ///< Translation started by the Translate button, runs off the render thread.
             };
         }
     }
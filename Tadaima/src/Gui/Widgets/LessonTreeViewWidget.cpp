@@ -9,8 +9,12 @@
 #include "ImGuiFileDialog.h"
 #include "Tools/pugixml.hpp"
 #include "Tools/Logger.h"
+#include "Tools/Tracer.h"
 #include "LessonTreeViewWidget/LessonUtils.h"
-#include "LessonTreeViewWidget/LessonFileIO.h"
+#include "Application/ApplicationDatabase.h"
+#include "Application/DatabaseMerger.h"
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <unordered_set>
 
@@ -33,19 +37,15 @@ namespace tadaima
 
             void LessonTreeViewWidget::initialize(const tools::DataPackage& r_package)
             {
+                tools::TraceScope trace("LessonTreeViewWidget::initialize", "gui");
                 m_logger.log("Initializing LessonTreeViewWidget.");
                 const LessonDataPackage* package = dynamic_cast<const LessonDataPackage*>(&r_package);
                 if( package )
                 {
-                    m_cashedLessons.clear();
-                    std::map<std::string, LessonGroup> lessonMap;
-
-                    for( const auto& lesson : package->m_lessons )
-                        lessonMap[lesson.groupName].groupName = lesson.groupName,
-                        lessonMap[lesson.groupName].subLessons[lesson.mainName].push_back(lesson);
-
-                    for( const auto& pair : lessonMap )
-                        m_cashedLessons.push_back(pair.second);
+                    // Only the lessons that changed are touched; the expansion and selection of the others stay.
+                    m_lessons.assign(package->m_lessons);
+                    std::erase_if(m_selectedLessons, [this](int id) { return m_lessons.findLesson(id) == LessonTreeModel::INVALID_NODE; });
+                    std::erase_if(m_selectedWords, [this](int id) { return m_lessons.findWord(id) == LessonTreeModel::INVALID_NODE; });
                 }
 
                 m_lessonSettingsWidget.initialize(r_package);
@@ -56,13 +56,7 @@ namespace tadaima
             {
                 m_logger.log("Copying words to a new lesson.");
                 Lesson newLesson;
-
-                for( const auto& lessonGroup : m_cashedLessons )
-                    for( const auto& subLessons : lessonGroup.subLessons )
-                        for( const auto& lesson : subLessons.second )
-                            for( const auto& word : lesson.words )
-                                if( wordIds.count(word.id) )
-                                    newLesson.words.push_back(word);
+                newLesson.words = m_lessons.findWords(wordIds);
                 return newLesson;
             }
 
@@ -80,27 +74,16 @@ namespace tadaima
 
             Lesson LessonTreeViewWidget::findLessonWithId(int id) const
             {
-                for( const auto& group : m_cashedLessons )
-                    for( const auto& [_, lessons] : group.subLessons )
-                        for( const auto& lesson : lessons )
-                            if( lesson.id == id )
-                                return lesson;
-                return Lesson();
+                return m_lessons.lesson(m_lessons.findLesson(id));
             }
 
             LessonDataPackage LessonTreeViewWidget::createLessonDataPackageFromSelectedNodes(const std::unordered_set<int>& selectedNodeIds)
             {
                 m_logger.log("Creating LessonDataPackage from selected nodes.");
-                std::unordered_map<int, Lesson> allLessonsById;
-                for( const auto& cachedLessonGroup : m_cashedLessons )
-                    for( const auto& [mainName, groupedLessons] : cachedLessonGroup.subLessons )
-                        for( const auto& groupedLesson : groupedLessons )
-                            allLessonsById[groupedLesson.id] = groupedLesson;
-
                 std::vector<Lesson> selectedLessons;
                 for( int nodeId : selectedNodeIds )
-                    if( auto it = allLessonsById.find(nodeId); it != allLessonsById.end() )
-                        selectedLessons.push_back(it->second);
+                    if( const LessonTreeModel::NodeId node = m_lessons.findLesson(nodeId); node != LessonTreeModel::INVALID_NODE )
+                        selectedLessons.push_back(m_lessons.lesson(node));
 
                 return createLessonDataPackageFromLessons(selectedLessons);
             }
@@ -140,12 +123,57 @@ namespace tadaima
                 }
 
                 ImGui::SameLine();
-                if( ImGui::Button(ICON_FA_UPLOAD " Import") )
+                // The lesson database is only known once the application has handed its path over, see setDatabasePath().
+                ImGui::BeginDisabled(m_databasePath.empty() || m_lessonImporter.isRunning() || m_pendingSync.valid() || m_pendingMerge.valid() || m_pendingChangesExport.valid());
+                const bool importClicked = ImGui::Button(ICON_FA_UPLOAD " Import");
+                ImGui::SameLine();
+                ImGui::Checkbox("Preview only", &m_lessonImportDryRun);
+                ImGui::SameLine();
+                const bool mergeClicked = ImGui::Button(ICON_FA_COMPRESS " Merge duplicates");
+                ImGui::SameLine();
+                const bool exportChangesClicked = ImGui::Button(ICON_FA_EXCHANGE " Export changes");
+                ImGui::SameLine();
+                const bool syncClicked = ImGui::Button(ICON_FA_REFRESH " Sync with...");
+                ImGui::EndDisabled();
+                if( syncClicked )
+                {
+                    m_logger.log("Sync button clicked.");
+                    IGFD::FileDialogConfig config;
+                    ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_Always);
+                    ImGuiFileDialog::Instance()->OpenDialog("SyncDatabaseDlgKey", "Sync With Database", ".db", config);
+                }
+
+                if( ImGuiFileDialog::Instance()->Display("SyncDatabaseDlgKey") )
+                {
+                    if( ImGuiFileDialog::Instance()->IsOk() )
+                        syncLessonDatabase(ImGuiFileDialog::Instance()->GetFilePathName());
+                    ImGuiFileDialog::Instance()->Close();
+                }
+                if( exportChangesClicked )
+                {
+                    m_logger.log("Export changes button clicked.");
+                    IGFD::FileDialogConfig config;
+                    ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_Always);
+                    ImGuiFileDialog::Instance()->OpenDialog("SaveChangesDlgKey", "Export Changes", ".xml", config);
+                }
+
+                if( ImGuiFileDialog::Instance()->Display("SaveChangesDlgKey") )
+                {
+                    if( ImGuiFileDialog::Instance()->IsOk() )
+                        exportLessonChanges(ImGuiFileDialog::Instance()->GetFilePathName());
+                    ImGuiFileDialog::Instance()->Close();
+                }
+                if( mergeClicked )
+                {
+                    m_logger.log("Merge duplicates button clicked.");
+                    mergeDuplicateLessons();
+                }
+                if( importClicked )
                 {
                     m_logger.log("Import button clicked.");
                     IGFD::FileDialogConfig config;
                     ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_Always);
-                    ImGuiFileDialog::Instance()->OpenDialog("ChooseFileDlgKey", "Choose File", ".xml", config);
+                    ImGuiFileDialog::Instance()->OpenDialog("ChooseFileDlgKey", "Choose File", ".xml,.tdpack,.csv,.tsv,.anki2", config);
                 }
 
                 if( ImGuiFileDialog::Instance()->Display("ChooseFileDlgKey") )
@@ -154,18 +182,180 @@ namespace tadaima
                     {
                         std::string filePath = ImGuiFileDialog::Instance()->GetFilePathName();
                         m_logger.log("File selected: " + filePath);
-                        auto lessons = LessonFileIO::importLessons(filePath, m_logger);
-                        auto package = createLessonDataPackageFromLessons(lessons);
-                        emitEvent(WidgetEvent(*this, LessonTreeViewWidgetEvent::OnLessonCreated, &package));
-                        m_logger.log("New lesson imported.");
+                        startLessonImport(filePath);
                     }
                     ImGuiFileDialog::Instance()->Close();
                 }
 
+                drawImportProgress();
+                drawSyncProgress();
+                drawMergeProgress();
+                drawChangesExportProgress();
+
                 ImGui::PopStyleColor(3);
                 ImGui::PopStyleVar();
             }
 
+            void LessonTreeViewWidget::setDatabasePath(const std::string& databasePath)
+            {
+                m_databasePath = databasePath;
+                m_lessonSettingsWidget.setDatabasePath(databasePath);
+            }
+
+            void LessonTreeViewWidget::startLessonImport(const std::string& filePath)
+            {
+                // The importer writes through its own connection, opened on the import thread, so neither
+                // the application thread nor the render thread waits for it.
+                const auto openDatabase = [path = m_databasePath, &logger = m_logger]()
+                    {
+                        return std::make_shared<application::ApplicationDatabase>(path, logger);
+                    };
+                if( m_lessonImporter.start(filePath, openDatabase, m_lessonImportDryRun) )
+                    m_lessonImportReported = false;
+            }
+
+            void LessonTreeViewWidget::exportLessonChanges(const std::string& filePath)
+            {
+                // Reading the changes and writing the file both wait for disk, so they run off the render thread like full exports do.
+                m_changesPath = filePath;
+                m_pendingChangesExport = std::async(std::launch::async, [&logger = m_logger, databasePath = m_databasePath, filePath]()
+                    {
+                        application::ApplicationDatabase database(databasePath, logger);
+                        LessonChanges changes = database.getChangesSince(database.getExportedVersion());
+                        LessonExporter::exportChangesFile(filePath, changes);
+                        database.setExportedVersion(changes.version);
+                        return changes;
+                    });
+            }
+
+            void LessonTreeViewWidget::drawChangesExportProgress()
+            {
+                if( !m_pendingChangesExport.valid() )
+                    return;
+
+                if( m_pendingChangesExport.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+                {
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted("Exporting changes...");
+                    return;
+                }
+
+                try
+                {
+                    const LessonChanges changes = m_pendingChangesExport.get();
+                    m_logger.log("Exported the changes since version " + std::to_string(changes.sinceVersion) + " to " + m_changesPath + ": "
+                        + std::to_string(changes.lessons.size()) + " lessons, " + std::to_string(changes.tombstones.size()) + " deletions.", tools::LogLevel::INFO);
+                }
+                catch( const std::exception& e )
+                {
+                    m_logger.log(std::string("Exporting changes failed: ") + e.what(), tools::LogLevel::PROBLEM);
+                }
+            }
+
+            void LessonTreeViewWidget::syncLessonDatabase(const std::string& filePath)
+            {
+                // Both merges read and write whole databases, so they run off the render thread like imports do.
+                m_syncPath = filePath;
+                m_pendingSync = std::async(std::launch::async, [&logger = m_logger, databasePath = m_databasePath, filePath]()
+                    {
+                        application::DatabaseMerger merger(logger);
+                        return merger.sync(databasePath, filePath);
+                    });
+            }
+
+            void LessonTreeViewWidget::drawSyncProgress()
+            {
+                if( !m_pendingSync.valid() )
+                    return;
+
+                if( m_pendingSync.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+                {
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted("Syncing...");
+                    return;
+                }
+
+                try
+                {
+                    const auto [here, there] = m_pendingSync.get();
+                    m_logger.log("Synced with " + m_syncPath + ". Here: " + here.toString() + ". There: " + there.toString() + ".", tools::LogLevel::INFO);
+
+                    // The second direction only meets the conflicts of the first again, from the other side.
+                    for( const auto& conflict : here.conflicts )
+                        m_logger.log("Sync conflict: " + conflict.toString(), tools::LogLevel::WARNING);
+                    emitEvent(WidgetEvent(*this, LessonTreeViewWidgetEvent::OnLessonsImported, nullptr));
+                }
+                catch( const std::exception& e )
+                {
+                    m_logger.log(std::string("Syncing lessons failed: ") + e.what(), tools::LogLevel::PROBLEM);
+                }
+            }
+
+            void LessonTreeViewWidget::mergeDuplicateLessons()
+            {
+                // Merging compares every word of the database, so it runs off the render thread like syncs do.
+                m_mergeDryRun = m_lessonImportDryRun;
+                m_pendingMerge = std::async(std::launch::async, [&logger = m_logger, databasePath = m_databasePath, dryRun = m_mergeDryRun]()
+                    {
+                        application::ApplicationDatabase database(databasePath, logger);
+                        return LessonUpserter::mergeDuplicates(database, dryRun);
+                    });
+            }
+
+            void LessonTreeViewWidget::drawMergeProgress()
+            {
+                if( !m_pendingMerge.valid() )
+                    return;
+
+                if( m_pendingMerge.wait_for(std::chrono::seconds(0)) != std::future_status::ready )
+                {
+                    ImGui::SameLine();
+                    ImGui::TextUnformatted("Merging...");
+                    return;
+                }
+
+                try
+                {
+                    const LessonUpserter::Report report = m_pendingMerge.get();
+                    m_logger.log(std::string(m_mergeDryRun ? "Duplicates found: " : "Duplicates merged: ") + report.toString() + ".", tools::LogLevel::INFO);
+                    if( !m_mergeDryRun )
+                        emitEvent(WidgetEvent(*this, LessonTreeViewWidgetEvent::OnLessonsImported, nullptr));
+                }
+                catch( const std::exception& e )
+                {
+                    m_logger.log(std::string("Merging duplicates failed: ") + e.what(), tools::LogLevel::PROBLEM);
+                }
+            }
+
+            void LessonTreeViewWidget::drawImportProgress()
+            {
+                const LessonImporter::Progress progress = m_lessonImporter.getProgress();
+                if( m_lessonImporter.isRunning() )
+                {
+                    ImGui::SameLine();
+                    if( ImGui::Button(ICON_FA_TIMES " Cancel import") )
+                        m_lessonImporter.cancel();
+
+                    const float fraction = progress.totalBytes ? static_cast<float>(progress.bytesRead) / static_cast<float>(progress.totalBytes) : 0.0f;
+                    ImGui::ProgressBar(fraction, ImVec2(-1, 0));
+                    return;
+                }
+
+                if( !m_lessonImportReported && progress.finished )
+                {
+                    m_lessonImportReported = true;
+                    if( progress.error.empty() )
+                    {
+                        m_logger.log(std::string(m_lessonImportDryRun ? "Import preview of " : "Imported ") + std::to_string(progress.imported.lessons) + " lessons with "
+                            + std::to_string(progress.imported.words) + " words: " + progress.report.toString() + ".", tools::LogLevel::INFO);
+                    }
+                    else
+                        m_logger.log("Lesson import failed: " + progress.error, tools::LogLevel::PROBLEM);
+
+                    emitEvent(WidgetEvent(*this, LessonTreeViewWidgetEvent::OnLessonsImported, nullptr));
+                }
+            }
+
             void LessonTreeViewWidget::draw(bool* p_open)
             {
                 if( !ImGui::Begin("Lessons Overview", p_open, ImGuiWindowFlags_NoDecoration) )
@@ -181,6 +371,7 @@ namespace tadaima
                 ShowDeletePopup();
                 showMoveWordsToLessonPopup();
                 handleExportLessons();
+                drawExportProgress();
 
                 ImGui::End();
             }
@@ -191,81 +382,104 @@ namespace tadaima
 
             void LessonTreeViewWidget::drawLessonsTree()
             {
-                for( size_t g = 0; g < m_cashedLessons.size(); ++g )
-                {
-                    const auto& group = m_cashedLessons[g];
-                    ImGui::PushID((int)g);
+                tools::TraceScope trace("LessonTreeViewWidget::drawLessonsTree", "gui");
+                const std::vector<LessonTreeRow>& rows = m_treeRows.update(m_lessons);
 
-                    if( ImGui::TreeNode(group.groupName.c_str()) )
+                // Only the rows on screen are submitted; expanding or collapsing takes effect from the next frame.
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(rows.size()));
+                while( clipper.Step() )
+                {
+                    for( int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i )
                     {
-                        for( const auto& [mainName, lessons] : group.subLessons )
+                        const LessonTreeRow& row = rows[i];
+                        const float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+                        if( indent > 0 )
+                            ImGui::Indent(indent);
+
+                        switch( row.kind )
                         {
-                            ImGui::PushID(mainName.c_str());
-                            bool mainOpen = ImGui::TreeNode(mainName.c_str());
+                            case LessonTreeRow::Kind::Group:
+                            case LessonTreeRow::Kind::Chapter:
+                                drawNodeRow(row);
+                                break;
+                            case LessonTreeRow::Kind::Lesson:
+                                drawLessonRow(row);
+                                break;
+                            case LessonTreeRow::Kind::Word:
+                                drawWordRow(row);
+                                break;
+                        }
 
-                            // Context menu for Chapter (mainName)
-                            if( ImGui::IsItemHovered() && ImGui::IsMouseReleased(ImGuiMouseButton_Right) )
-                                ImGui::OpenPopup(("ChapterContextMenu" + mainName).c_str());
+                        if( indent > 0 )
+                            ImGui::Unindent(indent);
+                    }
+                }
+            }
 
-                            if( ImGui::BeginPopup(("ChapterContextMenu" + mainName).c_str()) )
-                            {
-                                // --- Play Group ---
-                                if( ImGui::BeginMenu("Play group") )
-                                {
-                                    struct PlayOption
-                                    {
-                                        const char* label;
-                                        LessonTreeViewWidgetEvent event;
-                                        const char* icon;
-                                    } playOptions[] = {
-                                        { "Vocabulary Quiz",      LessonTreeViewWidgetEvent::OnPlayVocabularyQuiz,      ICON_FA_QUESTION },
-                                        { "Multiple Choice Quiz", LessonTreeViewWidgetEvent::OnPlayMultipleChoiceQuiz,  ICON_FA_LIST },
-                                        { "Conjugation Quiz",     LessonTreeViewWidgetEvent::OnConjuactionQuiz,         ICON_FA_MAGIC }
-                                    };
-
-                                    for( const auto& opt : playOptions )
-                                    {
-                                        std::string itemLabel = std::string(opt.icon) + " " + opt.label;
-                                        if( ImGui::MenuItem(itemLabel.c_str()) )
-                                        {
-                                            std::vector<Lesson> lessonsToPlay(lessons.begin(), lessons.end());
-                                            auto pkg = createLessonDataPackageFromLessons(lessonsToPlay);
-                                            emitEvent(WidgetEvent(*this, opt.event, &pkg));
-                                        }
-                                    }
-                                    ImGui::EndMenu();
-                                }
+            void LessonTreeViewWidget::drawNodeRow(const LessonTreeRow& row)
+            {
+                ImGui::SetNextItemOpen(row.open);
+                const bool open = ImGui::TreeNodeEx(row.key.c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen, "%s", row.label.c_str());
+                if( open != row.open )
+                    m_lessons.setOpen(row.node, open);
 
-                                // --- Remove Group ---
-                                if( ImGui::MenuItem(ICON_FA_TRASH "  Remove group") )
-                                {
-                                    m_pendingAction.type = LessonActionState::Type::Delete;
-                                    m_pendingAction.editable.groupName = group.groupName;
-                                    m_pendingAction.editable.mainName = mainName;
-                                    m_pendingAction.editable.subName = "";
-                                }
+                if( row.kind == LessonTreeRow::Kind::Chapter )
+                {
+                    ImGui::PushID(row.key.c_str());
+                    if( ImGui::IsItemHovered() && ImGui::IsMouseReleased(ImGuiMouseButton_Right) )
+                        ImGui::OpenPopup("ChapterContextMenu");
 
-                                ImGui::EndPopup();
-                            }
+                    if( ImGui::BeginPopup("ChapterContextMenu") )
+                    {
+                        showChapterContextMenu(row);
+                        ImGui::EndPopup();
+                    }
+                    ImGui::PopID();
+                }
+            }
 
-                            if( mainOpen )
-                            {
-                                for( size_t lessonIndex = 0; lessonIndex < lessons.size(); ++lessonIndex )
-                                    drawLessonRow(lessons[lessonIndex], lessons, (int)lessonIndex);
-                                ImGui::TreePop();
-                            }
-                            ImGui::PopID();
+            void LessonTreeViewWidget::showChapterContextMenu(const LessonTreeRow& row)
+            {
+                // --- Play Group ---
+                if( ImGui::BeginMenu("Play group") )
+                {
+                    struct PlayOption
+                    {
+                        const char* label;
+                        LessonTreeViewWidgetEvent event;
+                    } playOptions[] = {
+                        { ICON_FA_QUESTION " Vocabulary Quiz",      LessonTreeViewWidgetEvent::OnPlayVocabularyQuiz },
+                        { ICON_FA_LIST     " Multiple Choice Quiz", LessonTreeViewWidgetEvent::OnPlayMultipleChoiceQuiz },
+                        { ICON_FA_MAGIC    " Conjugation Quiz",     LessonTreeViewWidgetEvent::OnConjuactionQuiz }
+                    };
+
+                    for( const auto& opt : playOptions )
+                    {
+                        if( ImGui::MenuItem(opt.label) )
+                        {
+                            auto pkg = createLessonDataPackageFromLessons(m_lessons.lessons(row.node));
+                            emitEvent(WidgetEvent(*this, opt.event, &pkg));
                         }
-                        ImGui::TreePop();
                     }
-                    ImGui::PopID();
+                    ImGui::EndMenu();
+                }
+
+                // --- Remove Group ---
+                if( ImGui::MenuItem(ICON_FA_TRASH "  Remove group") )
+                {
+                    m_pendingAction.type = LessonActionState::Type::Delete;
+                    m_pendingAction.editable.groupName = m_lessons.find(row.treeNode->parent)->name;
+                    m_pendingAction.editable.mainName = row.treeNode->name;
+                    m_pendingAction.editable.subName = "";
                 }
             }
 
-            void LessonTreeViewWidget::drawLessonRow(const Lesson& lesson, const std::vector<Lesson>& lessonsInSubgroup, int lessonIdx)
+            void LessonTreeViewWidget::drawLessonRow(const LessonTreeRow& row)
             {
-                bool isLessonSelected = m_selectedLessons.count(lesson.id) > 0;
-                ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanFullWidth;
+                const LessonTreeModel::Node& lesson = *row.treeNode;
+                bool isLessonSelected = m_selectedLessons.count(lesson.lessonId) > 0;
+                ImGuiTreeNodeFlags node_flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
                 if( isLessonSelected )
                 {
                     ImVec4 selectedBgColor = ImVec4(0.16f, 0.60f, 0.85f, 1.0f);   // bright blue
@@ -276,7 +490,10 @@ namespace tadaima
                     node_flags |= ImGuiTreeNodeFlags_Selected;
                 }
 
-                bool isNodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)lesson.id, node_flags, "%s", lesson.subName.c_str());
+                ImGui::SetNextItemOpen(row.open);
+                bool isNodeOpen = ImGui::TreeNodeEx((void*)(intptr_t)lesson.lessonId, node_flags, "%s", row.label.c_str());
+                if( isNodeOpen != row.open )
+                    m_lessons.setOpen(row.node, isNodeOpen);
 
                 if( ImGui::IsItemClicked() )
                 {
@@ -286,21 +503,18 @@ namespace tadaima
                     if( ctrl )
                     {
                         if( isLessonSelected )
-                            m_selectedLessons.erase(lesson.id);
+                            m_selectedLessons.erase(lesson.lessonId);
                         else
-                            m_selectedLessons.insert(lesson.id);
-                        m_lastSelectedLessonId = lesson.id;
+                            m_selectedLessons.insert(lesson.lessonId);
+                        m_lastSelectedLessonId = lesson.lessonId;
                     }
                     else if( shift && m_lastSelectedLessonId != -1 )
                     {
-                        int lastIdx = -1;
-                        for( size_t i = 0; i < lessonsInSubgroup.size(); ++i )
-                            if( lessonsInSubgroup[i].id == m_lastSelectedLessonId )
-                                lastIdx = (int)i;
-                        if( lastIdx != -1 )
-                            setLessonRangeSelection(lessonsInSubgroup, lastIdx, lessonIdx, true);
+                        const LessonTreeModel::Node* last = m_lessons.find(m_lessons.findLesson(m_lastSelectedLessonId));
+                        if( last && last->parent == lesson.parent )
+                            setLessonRangeSelection(lesson.parent, m_lastSelectedLessonId, lesson.lessonId, true);
 
-                        m_lastSelectedLessonId = lesson.id;
+                        m_lastSelectedLessonId = lesson.lessonId;
                     }
                     else
                     {
@@ -313,28 +527,22 @@ namespace tadaima
                     ImGui::PopStyleColor(3);
                 }
 
-                // Context menu and children drawing, as before:
-                if( ImGui::BeginPopupContextItem(("LessonContextMenu" + std::to_string(lesson.id)).c_str()) )
+                if( ImGui::BeginPopupContextItem() )
                 {
-                    showLessonContextMenu(lesson);
+                    showLessonContextMenu(m_lessons.lesson(row.node));
                     ImGui::EndPopup();
                 }
-
-                if( isNodeOpen )
-                {
-                    for( size_t wi = 0; wi < lesson.words.size(); ++wi )
-                        drawWordRow(lesson.words[wi], lesson);
-                    ImGui::TreePop();
-                }
             }
 
-            void LessonTreeViewWidget::drawWordRow(const Word& word, const Lesson& lesson)
+            void LessonTreeViewWidget::drawWordRow(const LessonTreeRow& row)
             {
+                const Word& word = *row.word;
+                const std::vector<Word>& words = row.treeNode->words;
                 bool isSelected = m_selectedWords.count(word.id) > 0;
                 if( isSelected )
                     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1, 0.2f, 0.2f, 1));
 
-                if( ImGui::Selectable((word.translation + " - " + word.kana).c_str(), isSelected) )
+                if( ImGui::Selectable(row.label.c_str(), isSelected) )
                 {
                     const bool ctrl = ImGui::GetIO().KeyCtrl;
                     const bool shift = ImGui::GetIO().KeyShift;
@@ -349,9 +557,9 @@ namespace tadaima
                     }
                     else if( shift && m_lastSelectedWordId != -1 )
                     {
-                        auto it1 = std::find_if(lesson.words.begin(), lesson.words.end(), [&](const Word& w) { return w.id == m_lastSelectedWordId; });
-                        auto it2 = std::find_if(lesson.words.begin(), lesson.words.end(), [&](const Word& w) { return w.id == word.id; });
-                        if( it1 != lesson.words.end() && it2 != lesson.words.end() )
+                        auto it1 = std::find_if(words.begin(), words.end(), [&](const Word& w) { return w.id == m_lastSelectedWordId; });
+                        auto it2 = std::find_if(words.begin(), words.end(), [&](const Word& w) { return w.id == word.id; });
+                        if( it1 != words.end() && it2 != words.end() )
                         {
                             if( it1 > it2 ) std::swap(it1, it2);
                             for( auto it = it1; it <= it2; ++it )
@@ -368,9 +576,9 @@ namespace tadaima
                 if( isSelected )
                     ImGui::PopStyleColor();
 
-                if( ImGui::BeginPopupContextItem(("WordContextMenu" + std::to_string(word.id)).c_str()) )
+                if( ImGui::BeginPopupContextItem() )
                 {
-                    showSelectedWordsContextMenu(lesson);
+                    showSelectedWordsContextMenu(m_lessons.lesson(row.node));
                 }
             }
 
@@ -452,7 +660,7 @@ namespace tadaima
                         if( ImGui::MenuItem(opt.label) )
                         {
                             // Package only selected words
-                            auto lessonPackage = LessonUtils::copyWordsToNewLesson(m_selectedWords, m_cashedLessons);
+                            auto lessonPackage = LessonUtils::copyWordsToNewLesson(m_selectedWords, m_lessons);
                             auto package = createLessonDataPackageFromLesson(lessonPackage);
                             emitEvent(WidgetEvent(*this, opt.event, &package));
                         }
@@ -574,6 +782,8 @@ namespace tadaima
                         {
                             LessonDataPackage updatedPackage = createLessonDataPackageFromLesson(m_pendingAction.editable);
                             emitEvent(WidgetEvent(*this, LessonTreeViewWidgetEvent::OnLessonRename, &updatedPackage));
+                            // The lesson keeps its node, so it stays expanded and selected under its new names.
+                            m_lessons.insert(m_pendingAction.editable);
                             m_logger.log("Lesson renamed: " + std::string(m_GroupNameBuf) + " - " + std::string(m_MainNameBuf) + " - " + std::string(m_SubNameBuf));
                         }
                         ImGui::CloseCurrentPopup();
@@ -628,17 +838,8 @@ namespace tadaima
                     popupName = "Delete Chapter";
                     deleteTargetText = m_pendingAction.editable.groupName + " / " + m_pendingAction.editable.mainName;
                     // Collect all lessons in this chapter
-                    for( const auto& lessonGroup : m_cashedLessons )
-                    {
-                        if( lessonGroup.groupName == m_pendingAction.editable.groupName )
-                        {
-                            auto it = lessonGroup.subLessons.find(m_pendingAction.editable.mainName);
-                            if( it != lessonGroup.subLessons.end() )
-                                for( const auto& lesson : it->second )
-                                    toDelete.push_back(lesson);
-                            break;
-                        }
-                    }
+                    const LessonTreeModel::NodeId group = m_lessons.findChild(LessonTreeModel::ROOT, m_pendingAction.editable.groupName);
+                    toDelete = m_lessons.lessons(m_lessons.findChild(group, m_pendingAction.editable.mainName));
                 }
                 else
                 {
@@ -669,30 +870,9 @@ namespace tadaima
 
                     if( ImGui::Button("Delete", ImVec2(120, 0)) )
                     {
-                        // Remove from cache!
+                        // Remove from the tree; chapters and groups left empty go with them.
                         for( const auto& lesson : toDelete )
-                        {
-                            for( auto& lessonGroup : m_cashedLessons )
-                            {
-                                for( auto it = lessonGroup.subLessons.begin(); it != lessonGroup.subLessons.end(); ++it )
-                                {
-                                    auto& lessons = it->second;
-                                    auto oldSz = lessons.size();
-                                    lessons.erase(
-                                        std::remove_if(lessons.begin(), lessons.end(),
-                                            [&](const Lesson& l) { return l.id == lesson.id; }),
-                                        lessons.end());
-                                    // If this sublesson (chapter) is now empty, remove it
-                                    if( lessons.empty() )
-                                    {
-                                        lessonGroup.subLessons.erase(it);
-                                        break;
-                                    }
-                                    if( oldSz != lessons.size() )
-                                        break; // Already erased from this group
-                                }
-                            }
-                        }
+                            m_lessons.remove(m_lessons.findLesson(lesson.id));
 
                         // Prepare and emit event
                         if( !toDelete.empty() )
@@ -751,65 +931,40 @@ namespace tadaima
                         std::string mainName(m_MainNameBuf);
                         std::string subName(m_SubNameBuf);
 
-                        std::unordered_set<int> movedWordIds(m_selectedWords.begin(), m_selectedWords.end());
-                        std::vector<Word> wordsToMove;
-
                         // 1. Collect the Word objects to move
-                        for( const auto& group : m_cashedLessons )
-                            for( const auto& [main, lessons] : group.subLessons )
-                                for( const auto& lesson : lessons )
-                                    for( const auto& w : lesson.words )
-                                        if( movedWordIds.count(w.id) )
-                                            wordsToMove.push_back(w);
+                        const std::vector<Word> wordsToMove = m_lessons.findWords(m_selectedWords);
 
                         // 2. Remove words from their original lessons (track changed lessons)
-                        std::vector<Lesson> updatedLessons;
-                        Lesson* destinationLesson = nullptr;
-
-                        for( auto& group : m_cashedLessons )
+                        std::map<LessonTreeModel::NodeId, Lesson> changedLessons;
+                        for( const auto& w : wordsToMove )
                         {
-                            for( auto& [main, lessons] : group.subLessons )
-                            {
-                                for( auto& lesson : lessons )
-                                {
-                                    size_t oldSz = lesson.words.size();
-                                    lesson.words.erase(
-                                        std::remove_if(lesson.words.begin(), lesson.words.end(),
-                                            [&](const Word& w) { return movedWordIds.count(w.id); }),
-                                        lesson.words.end());
-
-                                    if( lesson.words.size() != oldSz )
-                                        updatedLessons.push_back(lesson);
-
-                                    // Look for destination lesson pointer
-                                    if( !destinationLesson
-                                        && lesson.groupName == groupName
-                                        && lesson.mainName == mainName
-                                        && lesson.subName == subName )
-                                    {
-                                        destinationLesson = &lesson;
-                                    }
-                                }
-                            }
+                            const LessonTreeModel::NodeId node = m_lessons.findWord(w.id);
+                            auto [it, added] = changedLessons.try_emplace(node);
+                            if( added )
+                                it->second = m_lessons.lesson(node);
+                            std::erase_if(it->second.words, [&](const Word& ww) { return ww.id == w.id; });
                         }
 
                         // 3. If destination lesson exists, add words (avoid dups); else create new
-                        if( destinationLesson )
+                        std::vector<Lesson> updatedLessons;
+                        const LessonTreeModel::NodeId destination = m_lessons.findLesson(groupName, mainName, subName);
+                        if( destination != LessonTreeModel::INVALID_NODE )
                         {
+                            auto [it, added] = changedLessons.try_emplace(destination);
+                            if( added )
+                                it->second = m_lessons.lesson(destination);
+                            Lesson& destinationLesson = it->second;
                             for( const auto& w : wordsToMove )
                             {
-                                auto already = std::find_if(destinationLesson->words.begin(), destinationLesson->words.end(),
+                                auto already = std::find_if(destinationLesson.words.begin(), destinationLesson.words.end(),
                                     [&](const Word& ww) { return ww == w; });
-                                if( already == destinationLesson->words.end() )
+                                if( already == destinationLesson.words.end() )
                                 {
                                     Word wCopy = w;
                                     wCopy.id = 0; // Reset ID for new context, if needed
-                                    destinationLesson->words.push_back(wCopy);
+                                    destinationLesson.words.push_back(wCopy);
                                 }
                             }
-                            // If not already in updatedLessons, add
-                            if( std::none_of(updatedLessons.begin(), updatedLessons.end(), [&](const Lesson& l) { return l.id == destinationLesson->id; }) )
-                                updatedLessons.push_back(*destinationLesson);
                         }
                         else
                         {
@@ -824,7 +979,13 @@ namespace tadaima
                                 newLesson.words.push_back(wCopy);
                             }
                             updatedLessons.push_back(newLesson);
-                            // You may want to add newLesson to m_cashedLessons as well, if you manage cache here
+                            // The new lesson joins the tree with its ID, when the application sends the lessons again.
+                        }
+
+                        for( const auto& [node, lesson] : changedLessons )
+                        {
+                            m_lessons.insert(lesson);
+                            updatedLessons.push_back(lesson);
                         }
 
                         // 4. Emit and cleanup
@@ -866,7 +1027,7 @@ namespace tadaima
                 {
                     IGFD::FileDialogConfig config;
                     ImGui::SetNextWindowSize(ImVec2(500, 400), ImGuiCond_Always);
-                    ImGuiFileDialog::Instance()->OpenDialog("SaveLessonDlgKey", "Export Lessons", ".xml", config);
+                    ImGuiFileDialog::Instance()->OpenDialog("SaveLessonDlgKey", "Export Lessons", ".xml,.tdpack", config);
                     initialize = true;
                 }
 
@@ -879,8 +1040,9 @@ namespace tadaima
                             selected.push_back(findLessonWithId(id));
 
                         std::string filePath = ImGuiFileDialog::Instance()->GetFilePathName();
-                        LessonFileIO::exportLessons(filePath, selected, m_logger);
-                        m_logger.log("Lessons exported to: " + filePath);
+                        m_logger.log("Exporting lessons to file: " + filePath);
+                        if( m_lessonExporter.start(filePath, std::move(selected)) )
+                            m_lessonExportReported = false;
                     }
 
                     initialize = false;
@@ -889,11 +1051,34 @@ namespace tadaima
                 }
             }
 
+            void LessonTreeViewWidget::drawExportProgress()
+            {
+                const LessonExporter::Progress progress = m_lessonExporter.getProgress();
+                if( m_lessonExporter.isRunning() )
+                {
+                    const float fraction = progress.totalWords ? static_cast<float>(progress.wordsWritten) / static_cast<float>(progress.totalWords) : 0.0f;
+                    ImGui::ProgressBar(fraction, ImVec2(-100, 0), "Exporting...");
+                    ImGui::SameLine();
+                    if( ImGui::Button("Cancel##Export") )
+                        m_lessonExporter.cancel();
+                    return;
+                }
+
+                if( !m_lessonExportReported && progress.finished )
+                {
+                    m_lessonExportReported = true;
+                    if( progress.error.empty() )
+                        m_logger.log("Lessons exported: " + std::to_string(progress.wordsWritten) + " words.", tools::LogLevel::INFO);
+                    else
+                        m_logger.log("Lesson export failed: " + progress.error, tools::LogLevel::PROBLEM);
+                }
+            }
+
             // -----------------------------------------------------------------------------
             // SECTION: Selection & Utility Functions
             // -----------------------------------------------------------------------------
 
-            void LessonTreeViewWidget::setLessonWordsSelection(const Lesson& lesson, bool select)
+            void LessonTreeViewWidget::setLessonWordsSelection(const LessonTreeModel::Node& lesson, bool select)
             {
                 for( const auto& w : lesson.words )
                 {
@@ -903,18 +1088,30 @@ namespace tadaima
                         m_selectedWords.erase(w.id);
                 }
             }
-            void LessonTreeViewWidget::setLessonRangeSelection(const std::vector<Lesson>& lessonsInSubgroup, int fromIdx, int toIdx, bool select)
+            void LessonTreeViewWidget::setLessonRangeSelection(LessonTreeModel::NodeId chapter, int fromLessonId, int toLessonId, bool select)
             {
-                int from = std::min(fromIdx, toIdx);
-                int to = std::max(fromIdx, toIdx);
-                for( int i = from; i <= to; ++i )
+                const LessonTreeModel::Node* node = m_lessons.find(chapter);
+                if( !node )
+                    return;
+
+                // The children are in display order; the range runs from whichever end comes first.
+                bool inRange = false;
+                for( const auto& [key, child] : node->children )
                 {
-                    int lid = lessonsInSubgroup[i].id;
+                    const LessonTreeModel::Node& lesson = *m_lessons.find(child);
+                    const bool isEnd = lesson.lessonId == fromLessonId || lesson.lessonId == toLessonId;
+                    if( !inRange && !isEnd )
+                        continue;
+
                     if( select )
-                        m_selectedLessons.insert(lid);
+                        m_selectedLessons.insert(lesson.lessonId);
                     else
-                        m_selectedLessons.erase(lid);
-                    setLessonWordsSelection(lessonsInSubgroup[i], select);
+                        m_selectedLessons.erase(lesson.lessonId);
+                    setLessonWordsSelection(lesson, select);
+
+                    if( isEnd && (inRange || fromLessonId == toLessonId) )
+                        break;
+                    inRange = true;
                 }
             }
 
@@ -2,11 +2,15 @@
 
 #include "Widget.h"
 #include "lessons/Lesson.h"
+#include "lessons/LessonExporter.h"
+#include "lessons/LessonImporter.h"
 #include "LessonSettingsWidget.h"
 #include "packages/LessonDataPackage.h"
+#include "LessonTreeViewWidget/LessonTreeModel.h"
+#include "LessonTreeViewWidget/LessonTreeRows.h"
+#include "Application/DatabaseMerger.h"
+#include <future>
 #include <unordered_set>
-#include <deque>
-#include <map>
 
 namespace tools { class Logger; }
 
@@ -56,7 +60,8 @@ namespace tadaima
                     OnPlayMultipleChoiceQuiz,    /**< Triggered for multiple-choice quiz. */
                     OnPlayVocabularyQuiz,        /**< Triggered for vocabulary quiz. */
                     OnConjuactionQuiz,           /**< Triggered for conjugation quiz. */
-                    OnQuizSelect                 /**< Triggered when a quiz is selected. */
+                    OnQuizSelect,                /**< Triggered when a quiz is selected. */
+                    OnLessonsImported            /**< Triggered when a lesson file import has finished. */
                 };
 
                 /**
@@ -71,6 +76,12 @@ namespace tadaima
                  */
                 void initialize(const tools::DataPackage& r_package) override;
 
+                /**
+                 * @brief Sets the lesson database that imports, exports, merges and syncs open; they stay disabled until then.
+                 * @param databasePath The path of the application's lesson database.
+                 */
+                void setDatabasePath(const std::string& databasePath);
+
                 /**
                  * @brief Draws the main widget window.
                  * @param p_open Pointer to a boolean indicating whether the window is open.
@@ -83,24 +94,76 @@ namespace tadaima
                 void drawTopButtons();
 
                 /**
-                 * @brief Draws the lesson tree hierarchy.
+                 * @brief Starts importing a lesson file in the background.
+                 * @param filePath The lesson XML file.
+                 */
+                void startLessonImport(const std::string& filePath);
+
+                /**
+                 * @brief Starts writing the changes of the lesson database since the last delta export to a file in the background.
+                 * @param filePath The delta file.
+                 */
+                void exportLessonChanges(const std::string& filePath);
+
+                /**
+                 * @brief Shows that a delta export is running, and logs what it wrote once it has finished.
+                 */
+                void drawChangesExportProgress();
+
+                /**
+                 * @brief Starts merging the lesson database with another database file both ways in the background.
+                 * @param filePath The other lesson database, e.g. a copy from another computer.
+                 */
+                void syncLessonDatabase(const std::string& filePath);
+
+                /**
+                 * @brief Shows that a sync is running, and logs its report and conflicts once it has finished.
+                 */
+                void drawSyncProgress();
+
+                /**
+                 * @brief Starts merging duplicate lessons and words of the lesson database in the background (only counts them in preview mode).
+                 */
+                void mergeDuplicateLessons();
+
+                /**
+                 * @brief Shows that a merge of duplicates is running, and logs its report once it has finished.
+                 */
+                void drawMergeProgress();
+
+                /**
+                 * @brief Draws the progress of a running lesson import and reports its end.
+                 */
+                void drawImportProgress();
+
+                /**
+                 * @brief Draws the rows of the lesson tree that are on screen.
                  */
                 void drawLessonsTree();
 
                 /**
-                 * @brief Draws a single lesson row and handles its selection.
-                 * @param lesson The lesson to draw.
-                 * @param lessonsInSubgroup Reference to the vector of lessons in the current subgroup.
-                 * @param lessonIdx Index of this lesson within lessonsInSubgroup.
+                 * @brief Draws a group or chapter row and handles its expansion.
+                 * @param row The row to draw.
+                 */
+                void drawNodeRow(const LessonTreeRow& row);
+
+                /**
+                 * @brief Shows the context menu for a chapter.
+                 * @param row The row of the chapter.
+                 */
+                void showChapterContextMenu(const LessonTreeRow& row);
+
+                /**
+                 * @brief Draws a single lesson row and handles its selection and expansion.
+                 * @param row The row of the lesson.
                  */
-                void drawLessonRow(const Lesson& lesson, const std::vector<Lesson>& lessonsInSubgroup, int lessonIdx);
+                void drawLessonRow(const LessonTreeRow& row);
 
                 /**
-                 * @brief Draws a word row for a given lesson.
-                 * @param word The word to draw.
-                 * @param lesson The lesson containing the word.
+                 * @brief Draws a word row and handles its selection.
+                 * @param row The row of the word.
                  */
-                void drawWordRow(const Word& word, const Lesson& lesson);
+                void drawWordRow(const LessonTreeRow& row);
 
                 /**
                  * @brief Shows the context menu for a lesson.
@@ -110,7 +173,7 @@ namespace tadaima
 
                 /**
                  * @brief Shows the context menu for selected words in a lesson.
-                 * @param lesson The lesson containing the selected words.
+                 * @param lesson The lesson containing the word the menu was opened on.
                  */
                 void showSelectedWordsContextMenu(const Lesson& lesson);
 
@@ -131,19 +194,19 @@ namespace tadaima
 
                 /**
                  * @brief Sets all words in the lesson as selected or unselected.
-                 * @param lesson The lesson whose words to update.
+                 * @param lesson The node of the lesson whose words to update.
                  * @param select True to select, false to unselect.
                  */
-                void setLessonWordsSelection(const Lesson& lesson, bool select);
+                void setLessonWordsSelection(const LessonTreeModel::Node& lesson, bool select);
 
                 /**
-                 * @brief Selects or unselects a range of lessons in the current subgroup.
-                 * @param lessonsInSubgroup The vector of lessons.
-                 * @param fromIdx Index to start selection (inclusive).
-                 * @param toIdx Index to end selection (inclusive).
+                 * @brief Selects or unselects a range of lessons of a chapter.
+                 * @param chapter The node of the chapter.
+                 * @param fromLessonId ID of the lesson to start selection at (inclusive).
+                 * @param toLessonId ID of the lesson to end selection at (inclusive).
                  * @param select True to select, false to unselect.
                  */
-                void setLessonRangeSelection(const std::vector<Lesson>& lessonsInSubgroup, int fromIdx, int toIdx, bool select);
+                void setLessonRangeSelection(LessonTreeModel::NodeId chapter, int fromLessonId, int toLessonId, bool select);
 
                 /**
                  * @brief Handles editing a lesson.
@@ -155,6 +218,11 @@ namespace tadaima
                  */
                 void handleExportLessons();
 
+                /**
+                 * @brief Draws the progress of a running lesson export and logs its end.
+                 */
+                void drawExportProgress();
+
                 /**
                  * @brief Creates a new lesson from a set of word IDs.
                  * @param wordIds The set of word IDs to copy.
@@ -190,25 +258,25 @@ namespace tadaima
                  */
                 Lesson findLessonWithId(int id) const;
 
-                /**
-                 * @struct LessonGroup
-                 * @brief Represents a group of lessons organized by group name.
-                 */
-                struct LessonGroup
-                {
-                    std::string groupName;  /**< Name of the lesson group. */
-                    std::map<std::string, std::vector<Lesson>> subLessons; /**< Map: mainName -> list of lessons. */
-                };
-
-                std::deque<LessonGroup> m_cashedLessons;     /**< Cached groups of lessons. */
+                LessonTreeModel m_lessons;                   /**< The lessons, with the expansion state of the tree. */
+                LessonTreeRows m_treeRows;                   /**< The visible rows of m_lessons. */
                 LessonSettingsWidget m_lessonSettingsWidget; /**< Widget for lesson editing. */
                 tools::Logger& m_logger;                     /**< Logger reference. */
+                std::string m_databasePath;                  /**< The lesson database, see setDatabasePath(). */
+                LessonImporter m_lessonImporter;             /**< Background import of lesson files. */
+                bool m_lessonImportReported = true;          /**< Whether the end of the last import was reported. */
+                bool m_lessonImportDryRun = false;           /**< Whether imports and merges only report their changes. */
+                LessonExporter m_lessonExporter;             /**< Background export of lesson files. */
+                bool m_lessonExportReported = true;          /**< Whether the end of the last export was reported. */
+                std::future<std::pair<application::DatabaseMerger::Report, application::DatabaseMerger::Report>> m_pendingSync; /**< Running sync, see syncLessonDatabase(). */
+                std::string m_syncPath;                      /**< The database file of the running sync. */
+                std::future<LessonUpserter::Report> m_pendingMerge; /**< Running merge of duplicates, see mergeDuplicateLessons(). */
+                bool m_mergeDryRun = false;                  /**< Whether the running merge only counts the duplicates. */
+                std::future<LessonChanges> m_pendingChangesExport; /**< Running delta export, see exportLessonChanges(). */
+                std::string m_changesPath;                   /**< The delta file of the running export. */
 
                 int m_lastSelectedWordId = -1;               /**< Last selected word ID (for range selection). */
                 int m_lastSelectedLessonId = -1;             /**< Last selected lesson ID (for range selection). */
-                int m_changedLessonGroupIndex = -1;          /**< Index of changed lesson group. */
-                int m_changedLessonSubGroupIndex = -1;       /**< Index of changed lesson subgroup. */
-                int m_changedLessonIndex = -1;               /**< Index of changed lesson. */
 
                 std::unordered_set<int> m_lessonsToExport;   /**< Set of lessons marked for export. */
                 std::unordered_set<int> m_selectedWords;     /**< Currently selected word IDs. */
@@ -1,6 +1,8 @@
 #include "LessonFileIO.h"
-#include "Tools/pugixml.hpp"
 #include "Tools/Logger.h"
+#include "lessons/LessonExporter.h"
+#include "lessons/LessonImporter.h"
+#include <fstream>
 #include <unordered_set>
 
 namespace tadaima::gui::widget
@@ -8,49 +10,33 @@ namespace tadaima::gui::widget
     std::vector<Lesson> LessonFileIO::importLessons(const std::string& filePath, tools::Logger& logger)
     {
         logger.log("Parsing and importing lessons from file: " + filePath);
-        pugi::xml_document doc;
-        pugi::xml_parse_result result = doc.load_file(filePath.c_str());
         std::vector<Lesson> parsedLessons;
 
-        if( !result )
+        std::ifstream input(filePath, std::ios::binary);
+        if( !input )
         {
             logger.log("Error: Could not load XML file!");
             return parsedLessons;
         }
 
-        for( pugi::xml_node lessonNode : doc.child("lessons").children("lesson") )
+        try
         {
-            Lesson lesson;
-            lesson.groupName = lessonNode.attribute("groupName").as_string();
-            lesson.mainName = lessonNode.attribute("mainName").as_string();
-            lesson.subName = lessonNode.attribute("subName").as_string();
-
-            for( pugi::xml_node wordNode : lessonNode.children("word") )
-            {
-                Word word;
-                word.translation = wordNode.attribute("translation").as_string();
-                word.romaji = wordNode.attribute("romaji").as_string();
-                word.kana = wordNode.attribute("kana").as_string();
-                word.kanji = wordNode.attribute("kanji").as_string();
-                word.exampleSentence = wordNode.attribute("example").as_string();
-
-                // tags
-                for( pugi::xml_node tagNode : wordNode.children("tag") )
-                {
-                    word.tags.push_back(tagNode.attribute("name").as_string());
-                }
-
-                // conjugations (optional, in case you export them)
-                int conjIdx = 0;
-                for( pugi::xml_node conjNode : wordNode.children("conjugation") )
+            LessonImporter::importStream(input, [&parsedLessons](const LessonImporter::Batch& batch)
                 {
-                    if( conjIdx < (int)word.conjugations.size() )
-                        word.conjugations[conjIdx++] = conjNode.attribute("value").as_string();
-                }
-
-                lesson.words.push_back(word);
-            }
-            parsedLessons.push_back(lesson);
+                    auto lesson = batch.lessons.begin();
+                    if( batch.continuesLesson && !parsedLessons.empty() )
+                    {
+                        auto& words = parsedLessons.back().words;
+                        words.insert(words.end(), lesson->words.begin(), lesson->words.end());
+                        ++lesson;
+                    }
+                    parsedLessons.insert(parsedLessons.end(), lesson, batch.lessons.end());
+                });
+        }
+        catch( const std::exception& e )
+        {
+            logger.log(std::string("Error: Could not load XML file! ") + e.what());
+            return {};
         }
 
         logger.log("Lessons imported from file.");
@@ -61,51 +47,14 @@ namespace tadaima::gui::widget
     {
         logger.log("Exporting lessons to file: " + filePath);
 
-        pugi::xml_document doc;
-        pugi::xml_node root = doc.append_child("lessons");
-
-        for( const auto& lesson : lessons )
-        {
-            pugi::xml_node lessonNode = root.append_child("lesson");
-            lessonNode.append_attribute("groupName") = lesson.groupName.c_str();
-            lessonNode.append_attribute("mainName") = lesson.mainName.c_str();
-            lessonNode.append_attribute("subName") = lesson.subName.c_str();
-
-            for( const auto& word : lesson.words )
-            {
-                pugi::xml_node wordNode = lessonNode.append_child("word");
-                wordNode.append_attribute("translation") = word.translation.c_str();
-                wordNode.append_attribute("romaji") = word.romaji.c_str();
-                wordNode.append_attribute("kana") = word.kana.c_str();
-                wordNode.append_attribute("kanji") = word.kanji.c_str();
-                wordNode.append_attribute("example") = word.exampleSentence.c_str();
-
-                for( const auto& tag : word.tags )
-                {
-                    pugi::xml_node tagNode = wordNode.append_child("tag");
-                    tagNode.append_attribute("name") = tag.c_str();
-                }
-
-                // Export conjugations
-                for( size_t i = 0; i < word.conjugations.size(); ++i )
-                {
-                    if( !word.conjugations[i].empty() )
-                    {
-                        pugi::xml_node conjNode = wordNode.append_child("conjugation");
-                        conjNode.append_attribute("index") = static_cast<int>(i);
-                        conjNode.text() = word.conjugations[i].c_str();
-                    }
-                }
-            }
-        }
-
-        if( !doc.save_file(filePath.c_str()) )
+        try
         {
-            logger.log("Error: Could not save XML file!", tools::LogLevel::PROBLEM);
+            LessonExporter::exportFile(filePath, lessons);
+            logger.log("Lessons successfully exported to file: " + filePath, tools::LogLevel::INFO);
         }
-        else
+        catch( const std::exception& e )
         {
-            logger.log("Lessons successfully exported to file: " + filePath, tools::LogLevel::INFO);
+            logger.log(std::string("Error: Could not save XML file! ") + e.what(), tools::LogLevel::PROBLEM);
         }
     }
 
@@ -7,7 +7,7 @@ namespace tadaima::gui::widget
 {
     struct LessonFileIO
     {
-        // Import lessons from XML file
+        // Import lessons from XML file into memory; large files should go through LessonImporter instead
         static std::vector<Lesson> importLessons(const std::string& filePath, tools::Logger& logger);
 
         // Export lessons to XML file
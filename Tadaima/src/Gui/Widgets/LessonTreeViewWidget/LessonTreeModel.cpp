@@ -0,0 +1,327 @@
+#include "LessonTreeModel.h"
+#include <algorithm>
+
+namespace tadaima::gui::widget
+{
+    namespace
+    {
+        bool sameWords(const std::vector<Word>& a, const std::vector<Word>& b)
+        {
+            // Word::operator== ignores the IDs, which the word index depends on.
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Word& x, const Word& y) { return x.id == y.id && x == y; });
+        }
+    }
+
+    LessonTreeModel::LessonTreeModel()
+    {
+        Node& root = m_nodes[ROOT];
+        root.id = ROOT;
+        root.kind = Kind::Root;
+        root.open = true;
+        m_dirtyNodes.push_back(ROOT);
+    }
+
+    void LessonTreeModel::assign(const std::vector<Lesson>& lessons)
+    {
+        std::unordered_set<NodeId> kept;
+        kept.reserve(lessons.size());
+        for( const Lesson& lesson : lessons )
+            kept.insert(insert(lesson));
+
+        std::vector<NodeId> removed;
+        for( const auto& [id, node] : m_nodes )
+            if( node.kind == Kind::Lesson && !kept.count(id) )
+                removed.push_back(id);
+        for( NodeId node : removed )
+            remove(node);
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::insert(const Lesson& lesson)
+    {
+        const NodeId group = findOrAddChild(ROOT, Kind::Group, lesson.groupName);
+        const NodeId chapter = findOrAddChild(group, Kind::Chapter, lesson.mainName);
+
+        // Lessons not saved yet have no ID; they are known only by their names.
+        NodeId id = INVALID_NODE;
+        if( lesson.id != 0 )
+            id = findLesson(lesson.id);
+        else if( const auto it = m_nodes.at(chapter).children.find(ChildKey{ lesson.subName, 0 }); it != m_nodes.at(chapter).children.end() )
+            id = it->second;
+
+        if( id == INVALID_NODE )
+        {
+            id = addChild(chapter, Kind::Lesson, lesson.subName, lesson.id);
+            if( lesson.id != 0 )
+                m_lessonNodes[lesson.id] = id;
+        }
+        else
+        {
+            rename(id, lesson.subName);
+            move(id, chapter);
+        }
+
+        setWords(m_nodes.at(id), lesson.words);
+        return id;
+    }
+
+    bool LessonTreeModel::rename(NodeId id, const std::string& name)
+    {
+        Node* node = findNode(id);
+        if( !node || node->kind == Kind::Root )
+            return false;
+        if( node->name == name )
+            return true;
+
+        Node& parent = m_nodes.at(node->parent);
+        ChildKey key = keyOf(*node);
+        key.name = name;
+        if( !parent.children.emplace(key, id).second )
+            return false;
+
+        parent.children.erase(keyOf(*node));
+        node->name = name;
+        markDirty(id);
+        return true;
+    }
+
+    bool LessonTreeModel::move(NodeId id, NodeId parentId)
+    {
+        Node* node = findNode(id);
+        Node* parent = findNode(parentId);
+        if( !node || !parent || node->kind == Kind::Root || static_cast<int>(parent->kind) + 1 != static_cast<int>(node->kind) )
+            return false;
+        if( node->parent == parentId )
+            return true;
+        if( !parent->children.emplace(keyOf(*node), id).second )
+            return false;
+
+        const NodeId oldParent = node->parent;
+        m_nodes.at(oldParent).children.erase(keyOf(*node));
+        markDirty(oldParent);
+        node->parent = parentId;
+        markDirty(id);
+        markDirty(parentId);
+        removeIfEmpty(oldParent);
+        return true;
+    }
+
+    bool LessonTreeModel::remove(NodeId id)
+    {
+        Node* node = findNode(id);
+        if( !node || node->kind == Kind::Root )
+            return false;
+
+        const NodeId parent = node->parent;
+        m_nodes.at(parent).children.erase(keyOf(*node));
+        removeSubtree(id);
+        markDirty(parent);
+        removeIfEmpty(parent);
+        return true;
+    }
+
+    const LessonTreeModel::Node* LessonTreeModel::find(NodeId id) const
+    {
+        const auto it = m_nodes.find(id);
+        return it != m_nodes.end() ? &it->second : nullptr;
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::findChild(NodeId parentId, const std::string& name) const
+    {
+        const Node* parent = find(parentId);
+        if( !parent )
+            return INVALID_NODE;
+
+        // Groups and chapters have lesson ID 0; lessons of the same sub name follow in the order of their IDs.
+        const auto it = parent->children.lower_bound(ChildKey{ name, std::numeric_limits<int>::min() });
+        return it != parent->children.end() && it->first.name == name ? it->second : INVALID_NODE;
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::findLesson(int lessonId) const
+    {
+        const auto it = m_lessonNodes.find(lessonId);
+        return it != m_lessonNodes.end() ? it->second : INVALID_NODE;
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::findLesson(const std::string& groupName, const std::string& mainName, const std::string& subName) const
+    {
+        return findChild(findChild(findChild(ROOT, groupName), mainName), subName);
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::findWord(int wordId) const
+    {
+        const auto it = m_wordLessons.find(wordId);
+        return it != m_wordLessons.end() ? it->second : INVALID_NODE;
+    }
+
+    std::vector<Word> LessonTreeModel::findWords(const std::unordered_set<int>& wordIds) const
+    {
+        std::vector<Word> words;
+        for( int wordId : wordIds )
+        {
+            const Node* lesson = find(findWord(wordId));
+            if( !lesson )
+                continue;
+
+            const auto it = std::find_if(lesson->words.begin(), lesson->words.end(), [wordId](const Word& word) { return word.id == wordId; });
+            if( it != lesson->words.end() )
+                words.push_back(*it);
+        }
+        std::sort(words.begin(), words.end(), [](const Word& a, const Word& b) { return a.id < b.id; });
+        return words;
+    }
+
+    Lesson LessonTreeModel::lesson(NodeId id) const
+    {
+        const Node* node = find(id);
+        if( !node || node->kind != Kind::Lesson )
+            return Lesson();
+
+        const Node& chapter = m_nodes.at(node->parent);
+        Lesson lesson;
+        lesson.id = node->lessonId;
+        lesson.groupName = m_nodes.at(chapter.parent).name;
+        lesson.mainName = chapter.name;
+        lesson.subName = node->name;
+        lesson.words = node->words;
+        return lesson;
+    }
+
+    std::vector<Lesson> LessonTreeModel::lessons(NodeId id) const
+    {
+        std::vector<Lesson> result;
+        const Node* node = find(id);
+        if( !node )
+            return result;
+
+        if( node->kind == Kind::Lesson )
+        {
+            result.push_back(lesson(id));
+            return result;
+        }
+
+        for( const auto& [key, child] : node->children )
+        {
+            std::vector<Lesson> below = lessons(child);
+            result.insert(result.end(), std::make_move_iterator(below.begin()), std::make_move_iterator(below.end()));
+        }
+        return result;
+    }
+
+    size_t LessonTreeModel::lessonCount() const
+    {
+        size_t count = 0;
+        for( const auto& [id, node] : m_nodes )
+            if( node.kind == Kind::Lesson )
+                ++count;
+        return count;
+    }
+
+    void LessonTreeModel::setOpen(NodeId id, bool open)
+    {
+        Node* node = findNode(id);
+        if( node && node->open != open )
+        {
+            node->open = open;
+            markDirty(id);
+        }
+    }
+
+    bool LessonTreeModel::isOpen(NodeId id) const
+    {
+        const Node* node = find(id);
+        return node && node->open;
+    }
+
+    bool LessonTreeModel::isDirty(NodeId id) const
+    {
+        const Node* node = find(id);
+        return node && node->dirty;
+    }
+
+    void LessonTreeModel::clearDirty()
+    {
+        for( NodeId id : m_dirtyNodes )
+            if( Node* node = findNode(id) )
+                node->dirty = false;
+        m_dirtyNodes.clear();
+    }
+
+    LessonTreeModel::Node* LessonTreeModel::findNode(NodeId id)
+    {
+        const auto it = m_nodes.find(id);
+        return it != m_nodes.end() ? &it->second : nullptr;
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::addChild(NodeId parent, Kind kind, const std::string& name, int lessonId)
+    {
+        const NodeId id = m_nextId++;
+        Node& node = m_nodes[id];
+        node.id = id;
+        node.kind = kind;
+        node.parent = parent;
+        node.name = name;
+        node.lessonId = lessonId;
+        m_nodes.at(parent).children.emplace(keyOf(node), id);
+        m_dirtyNodes.push_back(id);
+        markDirty(parent);
+        return id;
+    }
+
+    LessonTreeModel::NodeId LessonTreeModel::findOrAddChild(NodeId parent, Kind kind, const std::string& name)
+    {
+        const Node& node = m_nodes.at(parent);
+        const auto it = node.children.find(ChildKey{ name, 0 });
+        return it != node.children.end() ? it->second : addChild(parent, kind, name, 0);
+    }
+
+    void LessonTreeModel::removeSubtree(NodeId id)
+    {
+        Node& node = m_nodes.at(id);
+        for( const auto& [key, child] : node.children )
+            removeSubtree(child);
+
+        if( node.kind == Kind::Lesson )
+        {
+            setWords(node, {});
+            m_lessonNodes.erase(node.lessonId);
+        }
+        m_nodes.erase(id);
+    }
+
+    void LessonTreeModel::removeIfEmpty(NodeId id)
+    {
+        const Node& node = m_nodes.at(id);
+        if( node.kind != Kind::Root && node.kind != Kind::Lesson && node.children.empty() )
+            remove(id);
+    }
+
+    void LessonTreeModel::setWords(Node& node, const std::vector<Word>& words)
+    {
+        if( sameWords(node.words, words) )
+            return;
+
+        for( const Word& word : node.words )
+            if( const auto it = m_wordLessons.find(word.id); it != m_wordLessons.end() && it->second == node.id )
+                m_wordLessons.erase(it);
+        node.words = words;
+        for( const Word& word : node.words )
+            if( word.id > 0 )
+                m_wordLessons[word.id] = node.id;
+        markDirty(node.id);
+    }
+
+    void LessonTreeModel::markDirty(NodeId id)
+    {
+        // Ancestors of a dirty node are dirty already, so the walk stops at the first one.
+        for( Node* node = findNode(id); node && !node->dirty; node = findNode(node->parent) )
+        {
+            node->dirty = true;
+            m_dirtyNodes.push_back(node->id);
+        }
+    }
+
+    LessonTreeModel::ChildKey LessonTreeModel::keyOf(const Node& node)
+    {
+        return ChildKey{ node.name, node.kind == Kind::Lesson ? node.lessonId : 0 };
+    }
+}
@@ -0,0 +1,224 @@
+/**
+ * @file LessonTreeModel.h
+ * @brief Defines the in-memory tree of lesson groups, chapters and lessons shown by the lesson tree view.
+ */
+
+#pragma once
+
+#include "lessons/Lesson.h"
+#include <compare>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tadaima::gui::widget
+{
+    /**
+     * @class LessonTreeModel
+     * @brief The lessons as a tree of groups, chapters and lessons, changed in place instead of being rebuilt.
+     *
+     * Every node has an id that stays the same for as long as the node exists: groups and chapters are found by
+     * name and lessons by their database ID, so reloading the lessons, renaming or moving a lesson keeps its node,
+     * and with it the expansion state. Children are kept sorted in a map, groups and chapters by name and lessons by
+     * sub name and ID as the database lists them, so inserting, renaming, moving and deleting a node costs
+     * O(log n). A group or chapter exists only as long as it holds lessons.
+     *
+     * Each change marks the node and its ancestors dirty; the view rebuilds its rows while the root is dirty and
+     * clears the flags once it caught up.
+     */
+    class LessonTreeModel
+    {
+    public:
+        using NodeId = uint32_t;
+
+        static constexpr NodeId ROOT = 0;                                              ///< The node holding the groups.
+        static constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();     ///< Returned when no node matches.
+
+        /**
+         * @enum Kind
+         * @brief The level of the tree a node belongs to.
+         */
+        enum class Kind : uint8_t
+        {
+            Root, Group, Chapter, Lesson
+        };
+
+        /**
+         * @struct ChildKey
+         * @brief The position of a node among its siblings: the name, and the lesson ID for lessons.
+         */
+        struct ChildKey
+        {
+            std::string name;   /**< The name of a group or chapter, the sub name of a lesson. */
+            int lessonId = 0;   /**< The ID of a lesson, 0 for groups and chapters. */
+
+            auto operator<=>(const ChildKey&) const = default;
+        };
+
+        /**
+         * @struct Node
+         * @brief A group, chapter or lesson of the tree.
+         *
+         * References to a node stay valid until it is removed.
+         */
+        struct Node
+        {
+            NodeId id = INVALID_NODE;                   /**< The stable ID of the node. */
+            Kind kind = Kind::Root;                     /**< The level of the node. */
+            NodeId parent = INVALID_NODE;               /**< The parent, INVALID_NODE for the root. */
+            std::string name;                           /**< The group name, main name or sub name. */
+            int lessonId = 0;                           /**< The database ID of a lesson. */
+            std::vector<Word> words;                    /**< The words of a lesson. */
+            std::map<ChildKey, NodeId> children;        /**< The children, in display order. */
+            bool open = false;                          /**< Whether the node is expanded in the view. */
+            bool dirty = true;                          /**< Whether the node or anything below it changed. */
+        };
+
+        /**
+         * @brief Constructor, creates the empty root.
+         */
+        LessonTreeModel();
+
+        /**
+         * @brief Makes the tree hold exactly the given lessons, changing only what differs.
+         *
+         * Nodes of lessons that are still there keep their ids and state; unchanged lessons are not marked dirty.
+         *
+         * @param lessons All lessons, e.g. the lessons sent by the application.
+         */
+        void assign(const std::vector<Lesson>& lessons);
+
+        /**
+         * @brief Inserts a lesson, or updates the lesson with the same ID and moves it if its names changed.
+         * @param lesson The lesson; its group and main names select the group and chapter, created if needed.
+         * @return The node of the lesson.
+         */
+        NodeId insert(const Lesson& lesson);
+
+        /**
+         * @brief Renames a node. The lessons below a renamed group or chapter take its name.
+         * @param node The group, chapter or lesson.
+         * @param name The new name.
+         * @return False if there is no such node or a sibling group or chapter has that name already.
+         */
+        bool rename(NodeId node, const std::string& name);
+
+        /**
+         * @brief Moves a chapter to another group or a lesson to another chapter.
+         * @param node The chapter or lesson.
+         * @param parent The new group or chapter, one level above the node.
+         * @return False if the levels do not fit or the group has a chapter of the same name already.
+         */
+        bool move(NodeId node, NodeId parent);
+
+        /**
+         * @brief Removes a node with everything below it, and the groups and chapters left empty.
+         * @param node The group, chapter or lesson.
+         * @return False if there is no such node or it is the root.
+         */
+        bool remove(NodeId node);
+
+        /**
+         * @brief Finds a node.
+         * @param node The ID of the node.
+         * @return The node, or nullptr if it does not exist.
+         */
+        const Node* find(NodeId node) const;
+
+        /**
+         * @brief Finds a child by name, e.g. a group of the root; for lessons the first one with that sub name.
+         * @param parent The parent node.
+         * @param name The name of the child.
+         * @return The child, or INVALID_NODE.
+         */
+        NodeId findChild(NodeId parent, const std::string& name) const;
+
+        /**
+         * @brief Finds the node of a lesson by its database ID.
+         * @param lessonId The ID of the lesson.
+         * @return The node, or INVALID_NODE.
+         */
+        NodeId findLesson(int lessonId) const;
+
+        /**
+         * @brief Finds the node of a lesson by its names.
+         * @return The node, or INVALID_NODE.
+         */
+        NodeId findLesson(const std::string& groupName, const std::string& mainName, const std::string& subName) const;
+
+        /**
+         * @brief Finds the lesson that holds a word.
+         * @param wordId The ID of the word.
+         * @return The node of the lesson, or INVALID_NODE.
+         */
+        NodeId findWord(int wordId) const;
+
+        /**
+         * @brief Copies the words with the given IDs, ordered by ID.
+         * @param wordIds The IDs of the words.
+         */
+        std::vector<Word> findWords(const std::unordered_set<int>& wordIds) const;
+
+        /**
+         * @brief Builds the lesson of a lesson node, with the names of its group and chapter.
+         * @param node The lesson node.
+         * @return The lesson, or an empty lesson if the node is not a lesson.
+         */
+        Lesson lesson(NodeId node) const;
+
+        /**
+         * @brief Builds all lessons below a node, in display order.
+         * @param node Any node; ROOT for all lessons.
+         */
+        std::vector<Lesson> lessons(NodeId node) const;
+
+        /**
+         * @brief Gets the number of lessons.
+         */
+        size_t lessonCount() const;
+
+        /**
+         * @brief Expands or collapses a node; a change marks it dirty.
+         * @param node The node.
+         * @param open True to expand it.
+         */
+        void setOpen(NodeId node, bool open);
+
+        /**
+         * @brief Checks whether a node is expanded.
+         * @param node The node.
+         */
+        bool isOpen(NodeId node) const;
+
+        /**
+         * @brief Checks whether a node or anything below it changed since the flags were cleared.
+         * @param node The node; ROOT for the whole tree.
+         */
+        bool isDirty(NodeId node) const;
+
+        /**
+         * @brief Clears the dirty flags, at the cost of the number of nodes marked since the last call.
+         */
+        void clearDirty();
+
+    private:
+        Node* findNode(NodeId node);
+        NodeId addChild(NodeId parent, Kind kind, const std::string& name, int lessonId);
+        NodeId findOrAddChild(NodeId parent, Kind kind, const std::string& name);
+        void removeSubtree(NodeId node);
+        void removeIfEmpty(NodeId node);
+        void setWords(Node& node, const std::vector<Word>& words);
+        void markDirty(NodeId node);
+        static ChildKey keyOf(const Node& node);
+
+        std::unordered_map<NodeId, Node> m_nodes;           /**< All nodes by ID. */
+        std::unordered_map<int, NodeId> m_lessonNodes;      /**< Lesson ID -> lesson node. */
+        std::unordered_map<int, NodeId> m_wordLessons;      /**< Word ID -> lesson node. */
+        std::vector<NodeId> m_dirtyNodes;                   /**< The nodes marked dirty since the last clearDirty(). */
+        NodeId m_nextId = ROOT + 1;                         /**< The ID of the next node; IDs are never reused. */
+    };
+}
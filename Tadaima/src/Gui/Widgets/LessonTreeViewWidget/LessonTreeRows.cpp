@@ -0,0 +1,56 @@
+#include "LessonTreeRows.h"
+
+namespace tadaima::gui::widget
+{
+    const std::vector<LessonTreeRow>& LessonTreeRows::update(LessonTreeModel& model)
+    {
+        if( model.isDirty(LessonTreeModel::ROOT) )
+        {
+            m_rows.clear();
+            addRows(model, *model.find(LessonTreeModel::ROOT), 0);
+            model.clearDirty();
+        }
+        return m_rows;
+    }
+
+    void LessonTreeRows::addRows(const LessonTreeModel& model, const LessonTreeModel::Node& parent, int depth)
+    {
+        for( const auto& [childKey, id] : parent.children )
+        {
+            const LessonTreeModel::Node& node = *model.find(id);
+
+            LessonTreeRow row;
+            row.kind = node.kind == LessonTreeModel::Kind::Group ? LessonTreeRow::Kind::Group
+                : node.kind == LessonTreeModel::Kind::Chapter ? LessonTreeRow::Kind::Chapter : LessonTreeRow::Kind::Lesson;
+            row.depth = depth;
+            row.open = node.open;
+            row.node = id;
+            row.treeNode = &node;
+            row.key = "n\x1f" + std::to_string(id);
+            row.label = node.name;
+            m_rows.push_back(std::move(row));
+            if( !node.open )
+                continue;
+
+            if( node.kind != LessonTreeModel::Kind::Lesson )
+            {
+                addRows(model, node, depth + 1);
+                continue;
+            }
+
+            for( const Word& word : node.words )
+            {
+                LessonTreeRow wordRow;
+                wordRow.kind = LessonTreeRow::Kind::Word;
+                wordRow.depth = depth + 1;
+                wordRow.node = id;
+                wordRow.treeNode = &node;
+                wordRow.word = &word;
+                wordRow.key = "w\x1f" + std::to_string(word.id);
+                // The hidden "##" part keeps equal words of different lessons apart.
+                wordRow.label = word.translation + " - " + word.kana + "##" + wordRow.key;
+                m_rows.push_back(std::move(wordRow));
+            }
+        }
+    }
+}
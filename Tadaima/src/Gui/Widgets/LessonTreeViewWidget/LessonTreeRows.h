@@ -0,0 +1,64 @@
+/**
+ * @file LessonTreeRows.h
+ * @brief Defines the flattened rows of the lesson tree, drawn a screenful at a time.
+ */
+
+#pragma once
+
+#include "LessonTreeModel.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tadaima::gui::widget
+{
+    /**
+     * @struct LessonTreeRow
+     * @brief One visible row of the lesson tree, with everything its drawing needs.
+     *
+     * The pointers refer to the nodes of the model the rows were built from and stay valid until it changes.
+     */
+    struct LessonTreeRow
+    {
+        /**
+         * @enum Kind
+         * @brief The level of the tree a row belongs to.
+         */
+        enum class Kind : uint8_t
+        {
+            Group, Chapter, Lesson, Word
+        };
+
+        Kind kind = Kind::Group;                                        /**< The level of the row. */
+        int depth = 0;                                                  /**< The indentation level, 0 for groups. */
+        bool open = false;                                              /**< Whether the node is expanded. */
+        LessonTreeModel::NodeId node = LessonTreeModel::INVALID_NODE;   /**< The node of the row, the lesson of a word row. */
+        const LessonTreeModel::Node* treeNode = nullptr;                /**< The node itself. */
+        const Word* word = nullptr;                                     /**< The word of a word row. */
+        std::string key;                                                /**< Stable identifier of the row, also its ImGui ID. */
+        std::string label;                                              /**< The text shown, formatted once. */
+    };
+
+    /**
+     * @class LessonTreeRows
+     * @brief The rows of the lesson tree that are visible with the expansion state of the model.
+     *
+     * The rows are rebuilt only while the model is dirty, so a frame only reads the rows on screen and its cost
+     * does not depend on the size of the decks.
+     */
+    class LessonTreeRows
+    {
+    public:
+        /**
+         * @brief Rebuilds the rows if the model changed since the last build, and clears its dirty flags.
+         * @param model The lessons, they must outlive the rows.
+         * @return The visible rows, top to bottom.
+         */
+        const std::vector<LessonTreeRow>& update(LessonTreeModel& model);
+
+    private:
+        void addRows(const LessonTreeModel& model, const LessonTreeModel::Node& node, int depth);
+
+        std::vector<LessonTreeRow> m_rows;          /**< The visible rows. */
+    };
+}
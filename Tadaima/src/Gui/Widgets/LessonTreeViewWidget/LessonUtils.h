@@ -1,7 +1,6 @@
 #pragma once
-#include <deque>
 #include <unordered_set>
-#include "../LessonTreeViewWidget.h"
+#include "LessonTreeModel.h"
 
 namespace tadaima::gui::widget
 {
@@ -10,10 +9,10 @@ namespace tadaima::gui::widget
     {
     public:
 
-        static Lesson copyWordsToNewLesson(const std::unordered_set<int>& wordIds, const std::deque<LessonTreeViewWidget::LessonGroup>& cachedLessons);
+        static Lesson copyWordsToNewLesson(const std::unordered_set<int>& wordIds, const LessonTreeModel& lessons);
 
-        static Lesson findLessonWithId(int id, const std::deque<LessonTreeViewWidget::LessonGroup>& cachedLessons);
+        static Lesson findLessonWithId(int id, const LessonTreeModel& lessons);
 
         // ... more helpers as needed
     };
-}
\ No newline at end of file
+}
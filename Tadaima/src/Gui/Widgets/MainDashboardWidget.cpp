@@ -1,6 +1,5 @@
 ﻿#include "MainDashboardWidget.h"
 #include "imgui.h"
-#include "gui.h"
 #include "packages/SettingsDataPackage.h"
 #include <random>
 #include <format>
@@ -14,13 +13,7 @@ namespace tadaima
             // Utility function to get a random word of the day
             std::pair<std::string, std::string> getRandomWordOfTheDay()
             {
-                std::vector<std::pair<std::string, std::string>> words = {
-                    {"茶", "Tea (ちゃ)"},
-                    {"本", "Book (ほん)"},
-                    {"猫", "Cat (ねこ)"},
-                    {"犬", "Dog (いぬ)"},
-                    {"花", "Flower (はな)"}
-                };
+                const auto& words = MainDashboardWidget::getWordsOfTheDay();
 
                 std::random_device rd;
                 std::mt19937 gen(rd());
@@ -29,12 +22,24 @@ namespace tadaima
                 return words[dist(gen)];
             }
 
+            const std::vector<std::pair<std::string, std::string>>& MainDashboardWidget::getWordsOfTheDay()
+            {
+                static const std::vector<std::pair<std::string, std::string>> words = {
+                    {"茶", "Tea (ちゃ)"},
+                    {"本", "Book (ほん)"},
+                    {"猫", "Cat (ねこ)"},
+                    {"犬", "Dog (いぬ)"},
+                    {"花", "Flower (はな)"}
+                };
+                return words;
+            }
+
             void MainDashboardWidget::initialize(const tools::DataPackage& r_package)
             {
                 const SettingsDataPackage* package = dynamic_cast<const SettingsDataPackage*>(&r_package);
                 if( package )
                 {
-                    m_username = package->get<std::string>(SettingsPackageKey::Username);
+                    m_username = package->get<SettingsPackageKey::Username>();
                 }
 
                 // Initialize dynamic content
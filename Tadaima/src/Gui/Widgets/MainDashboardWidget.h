@@ -7,6 +7,8 @@
 #include "Widget.h"
 #include <string>
 #include <array>
+#include <utility>
+#include <vector>
 
 namespace tadaima
 {
@@ -34,6 +36,13 @@ namespace tadaima
                  */
                 void draw(bool* p_open) override;
 
+                /**
+                 * @brief Gets the words the dashboard picks the word of the day from.
+                 *
+                 * @return The words with their meanings; the GUI bakes their glyphs into the font.
+                 */
+                static const std::vector<std::pair<std::string, std::string>>& getWordsOfTheDay();
+
             private:
                 std::string m_username = "Gakusei-dono";
                 float m_progress = 0.0f;
@@ -58,10 +58,10 @@ namespace tadaima
                     {
                         m_logger.log("QuizManager::initialize.", tools::LogLevel::INFO);
 
-                        m_answerWordType = package->get<tadaima::quiz::WordType>(widget::SettingsPackageKey::AnswerWordType);
-                        m_askedWordType = package->get<tadaima::quiz::WordType>(widget::SettingsPackageKey::AskedWordType);
-                        m_triesForAWord = static_cast<uint8_t>(std::stoi(package->get<std::string>(widget::SettingsPackageKey::TriesForQuiz)));
-                        m_conjugationMask = package->get < uint16_t>(widget::SettingsPackageKey::ConjugationMask);
+                        m_answerWordType = package->get<widget::SettingsPackageKey::AnswerWordType>();
+                        m_askedWordType = package->get<widget::SettingsPackageKey::AskedWordType>();
+                        m_triesForAWord = static_cast<uint8_t>(std::stoi(package->get<widget::SettingsPackageKey::TriesForQuiz>()));
+                        m_conjugationMask = package->get<widget::SettingsPackageKey::ConjugationMask>();
                     }
                 }
                 catch( std::exception& exception )
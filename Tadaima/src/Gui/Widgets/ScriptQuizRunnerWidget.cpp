@@ -34,7 +34,7 @@ namespace tadaima
                     if( package )
                     {
                         m_logger.log("ScriptQuizRunnerWidget::initialize: Initializing.", tools::LogLevel::INFO);
-                        auto scriptPaths = package->get<std::string>(SettingsPackageKey::QuizzesScriptsPath);
+                        auto scriptPaths = package->get<SettingsPackageKey::QuizzesScriptsPath>();
 
                         std::filesystem::path exePath(getexepath());
                         std::filesystem::path script(scriptPaths);
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Tools/DataPackage.h"
+#include "Tools/TypedEventDispatcher.h"
 #include "WidgetTypes.h"
 #include <string>
 #include <functional>
@@ -79,6 +80,13 @@ namespace tadaima
                 tools::DataPackage* m_eventData = nullptr; ///< The data associated with the event.
             };
 
+            static constexpr size_t MAX_EVENTS_PER_WIDGET = 16; ///< The events a widget type may define, see WidgetEventDispatcher.
+
+            /**
+             * @brief Dispatches widget events by the type of the emitting widget and the event type.
+             */
+            using WidgetEventDispatcher = tools::TypedEventDispatcher<Type, WidgetEvent::EventType, tools::DataPackage, Type::Npc + 1, MAX_EVENTS_PER_WIDGET>;
+
             /**
              * @brief Base class for widgets.
              *
@@ -26,13 +26,19 @@ namespace tadaima
             class LessonDataPackage : public tools::DataPackage
             {
             public:
+                static constexpr Identifier PACKAGE_ID = PackageType::Lessons; ///< The identifier of every LessonDataPackage.
 
-                LessonDataPackage(const std::vector<Lesson>& lessons) : DataPackage(PackageType::Lessons), m_lessons(lessons)
+                LessonDataPackage(const std::vector<Lesson>& lessons) : DataPackage(PACKAGE_ID), m_lessons(lessons)
                 {
 
                 }
 
-                LessonDataPackage(const Lesson& lesson) : DataPackage(PackageType::Lessons)
+                LessonDataPackage(std::vector<Lesson>&& lessons) : DataPackage(PACKAGE_ID), m_lessons(std::move(lessons))
+                {
+
+                }
+
+                LessonDataPackage(const Lesson& lesson) : DataPackage(PACKAGE_ID)
                 {
                     m_lessons.push_back(lesson);
                 }
@@ -22,9 +22,9 @@ namespace tadaima
                 LessonTreeView = 1,         ///< ID for the lesson tree view widget.
                 Dashboard = 2,              ///< ID for the main dashboard widget.
                 VocabularySettings = 3,     ///< ID for the vocabulary settings widget.*/
-                Lessons = 0,
-                Settings = 1,    ///< ID for the application settings widget.
-                None = 2
+                None = 0,        ///< No type, the identifier of packages built without one (tools::DataPackage::NO_TYPE).
+                Lessons = 1,     ///< ID for the lesson packages.
+                Settings = 2     ///< ID for the application settings widget.
             };
 
         }
@@ -39,14 +39,24 @@ namespace tadaima
             /**
              * @brief Represents a package containing settings data.
              */
-            class SettingsDataPackage : public tools::ComplexDataPackage<SettingsPackageKey, bool, uint16_t, std::string, tadaima::quiz::WordType>
+            class SettingsDataPackage : public tools::KeyedDataPackage<SettingsPackageKey,
+                tools::PackageField<SettingsPackageKey::Username, std::string>,
+                tools::PackageField<SettingsPackageKey::DictionaryPath, std::string>,
+                tools::PackageField<SettingsPackageKey::ConjugationPath, std::string>,
+                tools::PackageField<SettingsPackageKey::QuizzesScriptsPath, std::string>,
+                tools::PackageField<SettingsPackageKey::TriesForQuiz, std::string>,
+                tools::PackageField<SettingsPackageKey::AskedWordType, tadaima::quiz::WordType>,
+                tools::PackageField<SettingsPackageKey::AnswerWordType, tadaima::quiz::WordType>,
+                tools::PackageField<SettingsPackageKey::ShowLogs, bool>,
+                tools::PackageField<SettingsPackageKey::ConjugationMask, uint16_t>>
             {
             public:
+                static constexpr Identifier PACKAGE_ID = PackageType::Settings; ///< The identifier of every SettingsDataPackage.
 
                 /**
                  * @brief Constructs a SettingsDataPackage object.
                  */
-                SettingsDataPackage() : ComplexDataPackage(PackageType::Settings) {}
+                SettingsDataPackage() : KeyedDataPackage(PACKAGE_ID) {}
             };
 
         }
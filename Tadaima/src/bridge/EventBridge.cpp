@@ -2,6 +2,7 @@
 #include "application/Application.h"
 #include "Gui/Gui.h"
 #include <stdexcept>
+#include "Tools/Tracer.h"
 #include "widgets/packages/LessonDataPackage.h"
 #include "Widgets/LessonTreeViewWidget.h"
 #include "widgets/packages/SettingsDataPackage.h"
@@ -14,142 +15,99 @@ namespace tadaima
         m_app = &app;
         m_gui = &gui;
 
-        m_gui->addListener(gui::widget::Type::LessonTreeView, std::bind(&EventBridge::handleEvent, this, std::placeholders::_1));
-        m_gui->addListener(gui::widget::Type::ApplicationSettings, std::bind(&EventBridge::handleEvent, this, std::placeholders::_1));
+        // The widgets open their own connections for imports and syncs, to the database the application uses.
+        m_gui->setDatabasePath(m_app->getDatabasePath());
+
+        using LessonTree = gui::widget::LessonTreeViewWidget;
+        using LessonPackage = gui::widget::LessonDataPackage;
+        using SettingsPackage = gui::widget::SettingsDataPackage;
+        gui::widget::WidgetEventDispatcher& dispatcher = m_gui->getDispatcher();
+
+        m_subscriptions.clear();
+        m_subscriptions.push_back(dispatcher.subscribe<LessonPackage>(gui::widget::Type::LessonTreeView, LessonTree::OnLessonCreated,
+            [this](const LessonPackage& package) { onLessonCreated(package); }));
+        m_subscriptions.push_back(dispatcher.subscribe<LessonPackage>(gui::widget::Type::LessonTreeView, LessonTree::OnLessonRename,
+            [this](const LessonPackage& package) { onLessonRename(package); }));
+        m_subscriptions.push_back(dispatcher.subscribe<LessonPackage>(gui::widget::Type::LessonTreeView, LessonTree::OnLessonDelete,
+            [this](const LessonPackage& package) { onLessonRemove(package); }));
+        m_subscriptions.push_back(dispatcher.subscribe<LessonPackage>(gui::widget::Type::LessonTreeView, LessonTree::OnLessonEdited,
+            [this](const LessonPackage& package) { onLessonEdited(package); }));
+        m_subscriptions.push_back(dispatcher.subscribe(gui::widget::Type::LessonTreeView, LessonTree::OnLessonsImported,
+            [this]() { m_app->setEvent(application::ApplicationEvent::OnLessonsImported); }));
+        m_subscriptions.push_back(dispatcher.subscribe<SettingsPackage>(gui::widget::Type::ApplicationSettings, gui::widget::ApplicationSettingsWidget::OnSettingsChanged,
+            [this](const SettingsPackage& package) { onSettingsChanged(package); }));
     }
 
-    void EventBridge::initializeGui(const std::vector<Lesson>& lessons)
+    void EventBridge::initializeGui(std::vector<Lesson> lessons)
     {
-        gui::widget::LessonDataPackage lessonsPackage(lessons);
-        m_gui->initializeWidget(lessonsPackage);
+        tools::TraceScope trace("EventBridge::initializeGui", "events");
+        // Called by the application worker, the widgets take the lessons on the GUI thread.
+        m_gui->post([target = m_gui, package = gui::widget::LessonDataPackage(std::move(lessons))]()
+            {
+                target->initializeWidget(package);
+            });
     }
 
     void EventBridge::initializeSettings(const application::ApplicationSettings& settings)
     {
+        tools::TraceScope trace("EventBridge::initializeSettings", "events");
         gui::widget::SettingsDataPackage package;
 
-        package.set(gui::widget::SettingsPackageKey::Username, settings.userName);
-        package.set(gui::widget::SettingsPackageKey::DictionaryPath, settings.dictionaryPath);
-        package.set(gui::widget::SettingsPackageKey::ConjugationPath, settings.conjugationPath);
-        package.set(gui::widget::SettingsPackageKey::QuizzesScriptsPath, settings.quizzesPaths);
-        package.set(gui::widget::SettingsPackageKey::AskedWordType, stringToWordType(settings.inputWord));
-        package.set(gui::widget::SettingsPackageKey::AnswerWordType, stringToWordType(settings.translatedWord));
-        package.set(gui::widget::SettingsPackageKey::ShowLogs, settings.showLogs);
-        package.set(gui::widget::SettingsPackageKey::TriesForQuiz, settings.maxTriesForQuiz);
-        package.set(gui::widget::SettingsPackageKey::ConjugationMask, settings.conjugationMask);
-
-        m_gui->initializeWidget(package);
-    }
-
-    void EventBridge::handleEvent(const gui::widget::WidgetEvent* data)
-    {
-        if( data == nullptr )
-        {
-            throw std::invalid_argument("Invalid argument in handleEvent: data pointer is null");
-        }
-
-        if( gui::widget::Type::LessonTreeView == data->getWidget().getType() )
-        {
-            switch( data->getEventType() )
-            {
-                case gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnLessonCreated:
-                {
-                    onLessonCreated(data->getEventData());
-                    break;
-                }
-                case gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnLessonRename:
-                {
-                    onLessonRename(data->getEventData());
-                    break;
-                }
-
-                case gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnLessonDelete:
-                {
-                    onLessonRemove(data->getEventData());
-                    break;
-                }
-
-                case gui::widget::LessonTreeViewWidget::LessonTreeViewWidgetEvent::OnLessonEdited:
-                {
-                    onLessonEdited(data->getEventData());
-                    break;
-                }
-
-                default:
-                    throw std::invalid_argument("Unhandled event type in handleEvent.");
-            }
-        }
-
-        if( gui::widget::Type::ApplicationSettings == data->getWidget().getType() )
-        {
-            switch( data->getEventType() )
+        package.set<gui::widget::SettingsPackageKey::Username>(settings.userName);
+        package.set<gui::widget::SettingsPackageKey::DictionaryPath>(settings.dictionaryPath);
+        package.set<gui::widget::SettingsPackageKey::ConjugationPath>(settings.conjugationPath);
+        package.set<gui::widget::SettingsPackageKey::QuizzesScriptsPath>(settings.quizzesPaths);
+        package.set<gui::widget::SettingsPackageKey::AskedWordType>(stringToWordType(settings.inputWord));
+        package.set<gui::widget::SettingsPackageKey::AnswerWordType>(stringToWordType(settings.translatedWord));
+        package.set<gui::widget::SettingsPackageKey::ShowLogs>(settings.showLogs);
+        package.set<gui::widget::SettingsPackageKey::TriesForQuiz>(settings.maxTriesForQuiz);
+        package.set<gui::widget::SettingsPackageKey::ConjugationMask>(settings.conjugationMask);
+
+        m_gui->post([target = m_gui, package = std::move(package)]()
             {
-                case gui::widget::ApplicationSettingsWidget::ApplicationSettingsWidgetEvent::OnSettingsChanged:
-                {
-                    onSettingsChanged(data->getEventData());
-                    break;
-                }
-
-                default:
-                    throw std::invalid_argument("Unhandled event type in handleEvent.");
-            }
-        }
+                target->initializeWidget(package);
+            });
     }
 
-    void EventBridge::onLessonCreated(const tools::DataPackage* dataPackage)
+    void EventBridge::onLessonCreated(const gui::widget::LessonDataPackage& package)
     {
-        const gui::widget::LessonDataPackage* package = dynamic_cast<const gui::widget::LessonDataPackage*>(dataPackage);
-        if( nullptr != package )
-        {
-            m_app->setEvent(application::ApplicationEvent::OnLessonCreated, package->m_lessons);
-        }
+        tools::TraceScope trace("EventBridge::onLessonCreated", "events");
+        m_app->setEvent(application::ApplicationEvent::OnLessonCreated, package.m_lessons);
     }
 
-    void EventBridge::onLessonRename(const tools::DataPackage* dataPackage)
+    void EventBridge::onLessonRename(const gui::widget::LessonDataPackage& package)
     {
-        const gui::widget::LessonDataPackage* package = dynamic_cast<const gui::widget::LessonDataPackage*>(dataPackage);
-        if( nullptr != package )
-        {
-            m_app->setEvent(application::ApplicationEvent::OnLessonUpdate, package->m_lessons);
-        }
+        tools::TraceScope trace("EventBridge::onLessonRename", "events");
+        m_app->setEvent(application::ApplicationEvent::OnLessonUpdate, package.m_lessons);
     }
 
-    void EventBridge::onLessonRemove(const tools::DataPackage* dataPackage)
+    void EventBridge::onLessonRemove(const gui::widget::LessonDataPackage& package)
     {
-        const gui::widget::LessonDataPackage* package = dynamic_cast<const gui::widget::LessonDataPackage*>(dataPackage);
-        if( nullptr != package )
-        {
-            m_app->setEvent(application::ApplicationEvent::OnLessonDelete, package->m_lessons);
-        }
+        tools::TraceScope trace("EventBridge::onLessonRemove", "events");
+        m_app->setEvent(application::ApplicationEvent::OnLessonDelete, package.m_lessons);
     }
 
-    void EventBridge::onLessonEdited(const tools::DataPackage* dataPackage)
+    void EventBridge::onLessonEdited(const gui::widget::LessonDataPackage& package)
     {
-        const gui::widget::LessonDataPackage* package = dynamic_cast<const gui::widget::LessonDataPackage*>(dataPackage);
-        if( nullptr != package )
-        {
-            m_app->setEvent(application::ApplicationEvent::OnLessonEdited, package->m_lessons);
-        }
+        tools::TraceScope trace("EventBridge::onLessonEdited", "events");
+        m_app->setEvent(application::ApplicationEvent::OnLessonEdited, package.m_lessons);
     }
 
-    void EventBridge::onSettingsChanged(const tools::DataPackage* dataPackage)
+    void EventBridge::onSettingsChanged(const gui::widget::SettingsDataPackage& package)
     {
-        const gui::widget::SettingsDataPackage* package = dynamic_cast<const gui::widget::SettingsDataPackage*>(dataPackage);
-        if( nullptr != package )
-        {
-            application::ApplicationSettings settings;
-            settings.userName = package->get<std::string>(gui::widget::SettingsPackageKey::Username);
-            settings.dictionaryPath = package->get<std::string>(gui::widget::SettingsPackageKey::DictionaryPath);
-            settings.conjugationPath = package->get<std::string>(gui::widget::SettingsPackageKey::ConjugationPath);
-            settings.quizzesPaths = package->get<std::string>(gui::widget::SettingsPackageKey::QuizzesScriptsPath);
-            settings.inputWord = wordTypeToString(package->get<tadaima::quiz::WordType>(gui::widget::SettingsPackageKey::AskedWordType));
-            settings.translatedWord = wordTypeToString(package->get<tadaima::quiz::WordType>(gui::widget::SettingsPackageKey::AnswerWordType));
-            settings.showLogs = package->get<bool>(gui::widget::SettingsPackageKey::ShowLogs);
-            settings.maxTriesForQuiz = package->get<std::string>(gui::widget::SettingsPackageKey::TriesForQuiz);
-            settings.conjugationMask = package->get<uint16_t>(gui::widget::SettingsPackageKey::ConjugationMask);
-
-            m_app->setEvent(application::ApplicationEvent::OnSettingsChanged, settings);
-        }
+        tools::TraceScope trace("EventBridge::onSettingsChanged", "events");
+        application::ApplicationSettings settings;
+        settings.userName = package.get<gui::widget::SettingsPackageKey::Username>();
+        settings.dictionaryPath = package.get<gui::widget::SettingsPackageKey::DictionaryPath>();
+        settings.conjugationPath = package.get<gui::widget::SettingsPackageKey::ConjugationPath>();
+        settings.quizzesPaths = package.get<gui::widget::SettingsPackageKey::QuizzesScriptsPath>();
+        settings.inputWord = wordTypeToString(package.get<gui::widget::SettingsPackageKey::AskedWordType>());
+        settings.translatedWord = wordTypeToString(package.get<gui::widget::SettingsPackageKey::AnswerWordType>());
+        settings.showLogs = package.get<gui::widget::SettingsPackageKey::ShowLogs>();
+        settings.maxTriesForQuiz = package.get<gui::widget::SettingsPackageKey::TriesForQuiz>();
+        settings.conjugationMask = package.get<gui::widget::SettingsPackageKey::ConjugationMask>();
+
+        m_app->setEvent(application::ApplicationEvent::OnSettingsChanged, settings);
     }
 
     tadaima::quiz::WordType EventBridge::stringToWordType(const std::string& str)
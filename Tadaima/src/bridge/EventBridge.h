@@ -16,7 +16,7 @@
 
 namespace tadaima
 {
-    namespace gui { class Gui; }
+    namespace gui { class Gui; namespace widget { class LessonDataPackage; class SettingsDataPackage; } }
     namespace application { class Application; struct ApplicationSettings; }
 
     /**
@@ -30,6 +30,9 @@ namespace tadaima
     public:
         /**
          * @brief Initializes the EventBridge with the application and GUI instances.
+         *
+         * Subscribes to the widget events handled by the application; the subscriptions end with the bridge.
+         *
          * @param app Reference to the Application instance.
          * @param gui Reference to the GUI instance.
          */
@@ -38,26 +41,20 @@ namespace tadaima
         /**
          * @brief Initializes the GUI with a list of lessons.
          *
-         * This method sets up the GUI components with the provided lessons data.
+         * This method posts the lessons to the GUI, which sets up its components at the start of the next frame.
          *
          * @param lessons Vector containing the lessons to initialize in the GUI.
          */
-        void initializeGui(const std::vector<Lesson>& lessons);
+        void initializeGui(std::vector<Lesson> lessons);
 
         /**
          * @brief Initializes the GUI with application settings.
-         * @param settings The application settings to initialize in the GUI.
-         */
-        void initializeSettings(const application::ApplicationSettings& settings);
-
-        /**
-         * @brief Handles an event from the GUI.
          *
-         * This method processes events that originate from the GUI widgets.
+         * Like initializeGui(), the settings reach the widgets at the start of the next frame.
          *
-         * @param data Pointer to the WidgetEvent data.
+         * @param settings The application settings to initialize in the GUI.
          */
-        void handleEvent(const gui::widget::WidgetEvent* data);
+        void initializeSettings(const application::ApplicationSettings& settings);
 
     protected:
 
@@ -67,50 +64,51 @@ namespace tadaima
 
         application::Application* m_app = nullptr; /**< Pointer to the Application instance. */
         gui::Gui* m_gui = nullptr; /**< Pointer to the GUI instance. */
+        std::vector<gui::widget::WidgetEventDispatcher::Subscription> m_subscriptions; /**< The GUI events forwarded to the application. */
 
         /**
          * @brief Handles the creation of a new lesson.
          *
          * This method processes the data package when a new lesson is created in the GUI.
          *
-         * @param dataPackage The data package containing the new lesson information.
+         * @param package The data package containing the new lesson information.
          */
-        void onLessonCreated(const tools::DataPackage* dataPackage);
+        void onLessonCreated(const gui::widget::LessonDataPackage& package);
 
         /**
          * @brief Handles the renaming of a lesson.
          *
          * This method processes the data package when a lesson is renamed in the GUI.
          *
-         * @param dataPackage The data package containing the renamed lesson information.
+         * @param package The data package containing the renamed lesson information.
          */
-        void onLessonRename(const tools::DataPackage* dataPackage);
+        void onLessonRename(const gui::widget::LessonDataPackage& package);
 
         /**
          * @brief Handles the deletion of a lesson.
          *
          * This method processes the data package when a lesson is removed in the GUI.
          *
-         * @param dataPackage The data package containing the deleted lesson information.
+         * @param package The data package containing the deleted lesson information.
          */
-        void onLessonRemove(const tools::DataPackage* dataPackage);
+        void onLessonRemove(const gui::widget::LessonDataPackage& package);
 
         /**
          * @brief Handles the edition of a lesson.
          *
          * This method processes the data package when a lesson is edited in the GUI.
          *
-         * @param dataPackage The data package containing the edited lesson information.
+         * @param package The data package containing the edited lesson information.
          */
-        void onLessonEdited(const tools::DataPackage* dataPackage);
+        void onLessonEdited(const gui::widget::LessonDataPackage& package);
 
         /**
          * @brief Handles the change of application settings.
          *
          * This method processes the data package when application settings are changed in the GUI.
          *
-         * @param dataPackage The data package containing the changed settings information.
+         * @param package The data package containing the changed settings information.
          */
-        void onSettingsChanged(const tools::DataPackage* dataPackage);
+        void onSettingsChanged(const gui::widget::SettingsDataPackage& package);
     };
 }
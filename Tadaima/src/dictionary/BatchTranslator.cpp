@@ -0,0 +1,167 @@
+#include "BatchTranslator.h"
+#include "TranslationCache.h"
+#include <algorithm>
+#include <exception>
+#include <unordered_set>
+
+namespace tadaima
+{
+    BatchTranslator::BatchTranslator(TranslateFunction translate, size_t maxParallel)
+        : m_translate(std::move(translate)), m_maxParallel(std::max<size_t>(1, maxParallel))
+    {
+    }
+
+    BatchTranslator::~BatchTranslator()
+    {
+        cancel();
+        wait();
+    }
+
+    bool BatchTranslator::start(const std::vector<std::string>& inputs, ItemCallback onItem)
+    {
+        if( isRunning() )
+            return false;
+        wait();
+
+        m_inputs.clear();
+        Progress progress;
+        std::unordered_set<std::string> seen;
+        for( const auto& input : inputs )
+        {
+            std::string key = TranslationCache::normalizeInput(input);
+            if( key.empty() )
+                continue;
+            if( !seen.insert(key).second )
+            {
+                ++progress.duplicates;
+                continue;
+            }
+            m_inputs.push_back(input);
+        }
+        progress.total = m_inputs.size();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress = progress;
+            m_finished.clear();
+        }
+
+        m_onItem = std::move(onItem);
+        m_next = 0;
+        m_cancelled = false;
+
+        const size_t threads = std::min(m_maxParallel, m_inputs.size());
+        m_active = threads;
+        for( size_t index = 0; index < threads; ++index )
+        {
+            m_threads.emplace_back(&BatchTranslator::work, this);
+        }
+        return true;
+    }
+
+    std::vector<BatchTranslator::Item> BatchTranslator::takeResults()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<Item> results;
+        results.swap(m_finished);
+        return results;
+    }
+
+    BatchTranslator::Progress BatchTranslator::getProgress() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_progress;
+    }
+
+    bool BatchTranslator::isRunning() const
+    {
+        return m_active > 0;
+    }
+
+    void BatchTranslator::cancel()
+    {
+        m_cancelled = true;
+    }
+
+    void BatchTranslator::wait()
+    {
+        for( auto& thread : m_threads )
+        {
+            if( thread.joinable() )
+                thread.join();
+        }
+        m_threads.clear();
+    }
+
+    void BatchTranslator::work()
+    {
+        while( !m_cancelled )
+        {
+            const size_t index = m_next++;
+            if( index >= m_inputs.size() )
+                break;
+
+            Item item;
+            item.index = index;
+            item.input = m_inputs[index];
+            try
+            {
+                item.word = m_translate(item.input);
+                if( item.word.translation.empty() )
+                    item.error = "No translation found.";
+            }
+            catch( const std::exception& e )
+            {
+                item.error = e.what();
+            }
+            finish(std::move(item));
+        }
+        --m_active;
+    }
+
+    void BatchTranslator::finish(Item item)
+    {
+        if( m_onItem )
+            m_onItem(item);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_progress.completed;
+        if( !item.succeeded() )
+            ++m_progress.failed;
+        m_finished.push_back(std::move(item));
+    }
+
+    std::vector<std::string> BatchTranslator::splitList(const std::string& text)
+    {
+        std::vector<std::string> words;
+        std::string current;
+
+        auto flush = [&words, &current]()
+            {
+                const size_t first = current.find_first_not_of(" \r");
+                if( first != std::string::npos )
+                {
+                    const size_t last = current.find_last_not_of(" \r");
+                    words.push_back(current.substr(first, last - first + 1));
+                }
+                current.clear();
+            };
+
+        // The Japanese comma separates words as well.
+        std::string normalized = text;
+        for( size_t position = normalized.find("\xE3\x80\x81"); position != std::string::npos; position = normalized.find("\xE3\x80\x81", position) )
+        {
+            normalized.replace(position, 3, ",");
+        }
+
+        for( char c : normalized )
+        {
+            if( c == '\n' || c == ',' || c == ';' || c == '\t' )
+                flush();
+            else
+                current += c;
+        }
+        flush();
+        return words;
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * @file BatchTranslator.h
+ * @brief Defines the BatchTranslator class, which translates a list of words with bounded parallelism.
+ */
+
+#pragma once
+
+#include "Word.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tadaima
+{
+    /**
+     * @class BatchTranslator
+     * @brief Runs many translations in the background and streams the results back as they complete.
+     *
+     * Inputs are deduplicated (after TranslationCache::normalizeInput) so each distinct word is translated
+     * once. At most `maxParallel` translations run at the same time. The owner polls takeResults() every
+     * frame, or registers a callback that is invoked on the worker threads.
+     */
+    class BatchTranslator
+    {
+    public:
+
+        static constexpr size_t DEFAULT_PARALLELISM = 4;
+
+        /**
+         * @brief Outcome of one input.
+         */
+        struct Item
+        {
+            size_t index = 0;    ///< Position of the input in the deduplicated list.
+            std::string input;   ///< The input as it was given.
+            Word word;           ///< The translation, valid when succeeded() is true.
+            std::string error;   ///< Why the translation failed, empty on success.
+
+            bool succeeded() const
+            {
+                return error.empty();
+            }
+        };
+
+        /**
+         * @brief Progress of the current batch.
+         */
+        struct Progress
+        {
+            size_t total = 0;       ///< Number of distinct inputs.
+            size_t completed = 0;   ///< Inputs that finished, successfully or not.
+            size_t failed = 0;      ///< Inputs that finished with an error.
+            size_t duplicates = 0;  ///< Inputs skipped because they repeat an earlier one.
+        };
+
+        using TranslateFunction = std::function<Word(const std::string&)>;
+        using ItemCallback = std::function<void(const Item&)>;
+
+        /**
+         * @brief Constructs the translator.
+         * @param translate Translates one word, may throw std::exception. Called from several threads at once.
+         * @param maxParallel Maximum number of translations running at the same time.
+         */
+        explicit BatchTranslator(TranslateFunction translate, size_t maxParallel = DEFAULT_PARALLELISM);
+
+        /**
+         * @brief Cancels the batch and waits for the running translations.
+         */
+        ~BatchTranslator();
+
+        BatchTranslator(const BatchTranslator&) = delete;
+        BatchTranslator& operator=(const BatchTranslator&) = delete;
+
+        /**
+         * @brief Starts translating a list of words.
+         * @param inputs The words to translate, empty entries are ignored.
+         * @param onItem Optional callback invoked on a worker thread for every finished item.
+         * @return False if a batch is still running.
+         */
+        bool start(const std::vector<std::string>& inputs, ItemCallback onItem = nullptr);
+
+        /**
+         * @brief Returns the items finished since the last call, in completion order.
+         */
+        std::vector<Item> takeResults();
+
+        /**
+         * @brief Returns the progress of the current (or last) batch.
+         */
+        Progress getProgress() const;
+
+        /**
+         * @brief Checks whether translations are still running.
+         */
+        bool isRunning() const;
+
+        /**
+         * @brief Stops handing out new inputs. Translations already running are finished.
+         */
+        void cancel();
+
+        /**
+         * @brief Waits until the batch has finished or was cancelled.
+         */
+        void wait();
+
+        /**
+         * @brief Splits pasted text into words: one per line, commas (also 、), semicolons and tabs also separate.
+         * @param text The pasted text.
+         * @return The trimmed, non-empty words in order.
+         */
+        static std::vector<std::string> splitList(const std::string& text);
+
+    private:
+
+        void work();
+        void finish(Item item);
+
+        TranslateFunction m_translate;
+        const size_t m_maxParallel;
+
+        std::vector<std::string> m_inputs;
+        ItemCallback m_onItem;
+        std::atomic<size_t> m_next{ 0 };
+        std::atomic<size_t> m_active{ 0 };
+        std::atomic<bool> m_cancelled{ false };
+
+        mutable std::mutex m_mutex;
+        Progress m_progress;
+        std::vector<Item> m_finished;
+        std::vector<std::thread> m_threads;
+    };
+}
@@ -2,21 +2,23 @@
 
 #include "Word.h"
 #include "Conjugations.h"
+#include "TranslationCache.h"
+#include "DictionaryWorker.h"
+#include "LocalDictionary.h"
 #include "tools/pugixml.hpp"
 #include "tools/SystemTools.h"
+#include "Tools/ProcessExecutor.h"
+#include "Tools/CancellationToken.h"
 #include <string>
 #include <array>
 #include <memory>
 #include <stdexcept>
-#include <cstdio>
 #include <filesystem>
 #include <future>
 #include <chrono>
-
-#ifdef _WIN32
-#define popen _popen
-#define pclose _pclose
-#endif
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace tadaima
 {
@@ -26,6 +28,8 @@ namespace tadaima
      *
      * The `Dictionary` class handles communication with external Python scripts for translations and conjugations.
      * It also parses the XML responses and converts them into appropriate data structures.
+     * When the translation path names a dictionary database (`.db`, built by JMdictImporter), translations
+     * are answered by a LocalDictionary instead and no script is started.
      */
     class Dictionary
     {
@@ -37,7 +41,17 @@ namespace tadaima
          */
         void setPathForTranslator(const std::string& scriptPath)
         {
+            std::lock_guard<std::mutex> lock(m_pathMutex);
+            if( scriptPath == m_translationScriptPath )
+                return;
+
             m_translationScriptPath = scriptPath;
+            m_localDictionary.reset();
+            if( isLocalDictionaryPath(scriptPath) )
+            {
+                std::filesystem::path exePath(getexepath());
+                m_localDictionary = std::make_shared<LocalDictionary>((exePath / scriptPath).string());
+            }
         }
 
         /**
@@ -46,108 +60,242 @@ namespace tadaima
          */
         void setPathForConjugationTranslator(const std::string& scriptPath)
         {
+            std::lock_guard<std::mutex> lock(m_pathMutex);
             m_conjugationScriptPath = scriptPath;
         }
 
+        /**
+         * @brief Sets the cache consulted before any script is started.
+         * @param cache The cache to use, or nullptr to always run the scripts.
+         */
+        void setCache(std::shared_ptr<TranslationCache> cache)
+        {
+            m_cache = std::move(cache);
+        }
+
+        /**
+         * @brief Returns the usage counters of the cache, or empty counters when no cache is set.
+         */
+        TranslationCache::Statistics getCacheStatistics() const
+        {
+            return m_cache ? m_cache->getStatistics() : TranslationCache::Statistics{};
+        }
+
+        /**
+         * @brief Enables or disables keeping the scripts resident as workers.
+         * @param enabled When false, every lookup starts a new Python process.
+         */
+        void setWorkerModeEnabled(bool enabled)
+        {
+            translator.setWorkerModeEnabled(enabled);
+        }
+
         /**
          * @brief Translates a given word into multiple formats (kanji, kana, romaji, etc.).
          * @param wordToTranslate The word to translate.
+         * @param token Optional token of the caller; cancelling it kills the script or fails the worker request,
+         *        so this call returns with a std::runtime_error right away. Lookups of other callers keep running.
          * @return A `Word` object containing the translated forms and additional information.
-         * @throws std::runtime_error if translation or XML parsing fails.
+         * @throws std::runtime_error if translation or XML parsing fails, or the lookup was cancelled.
          */
-        Word getTranslation(const std::string& wordToTranslate)
+        Word getTranslation(const std::string& wordToTranslate, tools::CancellationToken* token = nullptr)
         {
-            translator.setPathForTranslator(m_translationScriptPath);
-            std::string xmlStr = translator.translate(wordToTranslate);
-            return parseTranslationXml(xmlStr);
+            // Lookups run on background threads while the settings may change the paths.
+            std::string scriptPath;
+            std::shared_ptr<LocalDictionary> localDictionary;
+            {
+                std::lock_guard<std::mutex> lock(m_pathMutex);
+                scriptPath = m_translationScriptPath;
+                localDictionary = m_localDictionary;
+            }
+
+            if( localDictionary )
+            {
+                if( !localDictionary->isOpen() )
+                    throw std::runtime_error("Cannot open the dictionary " + scriptPath + ".");
+                return localDictionary->lookup(wordToTranslate).value_or(Word());
+            }
+
+            const std::string script = cacheKey(scriptPath);
+            if( m_cache )
+            {
+                if( auto cached = m_cache->findTranslation(script, wordToTranslate) )
+                    return *cached;
+            }
+
+            std::string xmlStr = translator.translate(scriptPath, wordToTranslate, token);
+            Word word = parseTranslationXml(xmlStr);
+
+            // Only cache real answers, an empty result usually means the script or the network failed.
+            if( m_cache && !word.translation.empty() )
+                m_cache->storeTranslation(script, wordToTranslate, word);
+
+            return word;
         }
 
         /**
           * @brief Retrieves conjugations for a given word.
           * @param wordToConjugate The word to conjugate.
+          * @param token Optional token of the caller, see getTranslation().
           * @return An array of strings representing the conjugations for each `ConjugationType`.
-          * @throws std::runtime_error if conjugation or XML parsing fails.
+          * @throws std::runtime_error if conjugation or XML parsing fails, or the lookup was cancelled.
           */
-        std::array<std::string, CONJUGATION_COUNT> getConjugations(const std::string& wordToConjugate)
+        std::array<std::string, CONJUGATION_COUNT> getConjugations(const std::string& wordToConjugate, tools::CancellationToken* token = nullptr)
         {
-            translator.setPathForTranslator(m_conjugationScriptPath);
-            std::string xmlStr = translator.translate(wordToConjugate);
-            return parseConjugationsXml(xmlStr);
+            std::string scriptPath;
+            {
+                std::lock_guard<std::mutex> lock(m_pathMutex);
+                scriptPath = m_conjugationScriptPath;
+            }
+
+            const std::string script = cacheKey(scriptPath);
+            if( m_cache )
+            {
+                if( auto cached = m_cache->findConjugations(script, wordToConjugate) )
+                    return *cached;
+            }
+
+            std::string xmlStr = translator.translate(scriptPath, wordToConjugate, token);
+            auto conjugations = parseConjugationsXml(xmlStr);
+
+            if( m_cache && !conjugations[0].empty() )
+                m_cache->storeConjugations(script, wordToConjugate, conjugations);
+
+            return conjugations;
+        }
+
+        /**
+         * @brief Checks whether a translation path names a local dictionary database instead of a script.
+         * @param path The configured translation path.
+         * @return True for `.db` files.
+         */
+        static bool isLocalDictionaryPath(const std::string& path)
+        {
+            return std::filesystem::path(path).extension() == ".db";
         }
 
     private:
 
+        /**
+         * @brief Builds the cache key of a script, so entries survive moving the scripts folder.
+         * @param scriptPath The configured script path.
+         * @return The file name of the script.
+         */
+        static std::string cacheKey(const std::string& scriptPath)
+        {
+            return std::filesystem::path(scriptPath).filename().string();
+        }
+
         /**
          * @class PythonTranslator
          * @brief Handles communication with Python scripts for translations and conjugations.
+         *
+         * Each script is started once with `--worker` and kept resident (see DictionaryWorker), which saves
+         * the interpreter start-up, the imports and the HTTP session set-up on every lookup. Scripts that do
+         * not answer with the worker banner are run once per lookup instead.
          */
         class PythonTranslator
         {
         public:
 
             /**
-             * @brief Sets the file path for the translation script.
-             * @param scriptPath The file path to the Python script.
+             * @brief Enables or disables the resident worker mode.
+             * @param enabled When false, every lookup starts a new Python process.
              */
-            void setPathForTranslator(const std::string& scriptPath)
+            void setWorkerModeEnabled(bool enabled)
             {
-                std::filesystem::path exePath(getexepath());
-                std::filesystem::path script(scriptPath);
-                m_translationScriptPath = ((exePath) / scriptPath).string();
+                m_workerModeEnabled = enabled;
             }
 
             /**
              * @brief Executes the translation or conjugation script with the given input.
+             * @param scriptPath The script path, relative to the executable.
              * @param input The word to translate or conjugate.
+             * @param token Optional token of the caller, cancelling it aborts this lookup only.
              * @return The script output as a string.
-             * @throws std::runtime_error if the script execution fails.
+             * @throws std::runtime_error if the script execution fails or is cancelled.
              */
-            std::string translate(const std::string& input)
+            std::string translate(const std::string& scriptPath, const std::string& input, tools::CancellationToken* token)
             {
-                if( !m_translationScriptPath.empty() )
+                if( scriptPath.empty() )
+                    return "";
+                if( token && token->isCancelled() )
+                    throw std::runtime_error("The request was cancelled.");
+
+                std::filesystem::path exePath(getexepath());
+                const std::string fullPath = (exePath / scriptPath).string();
+
+                if( m_workerModeEnabled )
                 {
-                    std::string command = "python " + m_translationScriptPath + " " + input;
-                    return exec(command.c_str());
+                    if( auto worker = getWorker(fullPath) )
+                        return worker->request(input, std::chrono::seconds(TIMEOUT_SECONDS), token);
                 }
-                return "";
+
+                return exec({ "python", fullPath, input }, token, TIMEOUT_SECONDS);
             }
 
         private:
 
+            static constexpr int TIMEOUT_SECONDS = 10;
+
             /**
-             * @brief Executes a shell command and captures its output.
-             * @param cmd The command to execute.
-             * @param timeoutSeconds The timeout for the command in seconds.
-             * @return The output of the command as a string.
-             * @throws std::runtime_error if the command fails or times out.
+             * @brief Returns the resident worker of a script, starting it on first use.
+             * @param fullPath The absolute script path.
+             * @return The worker, or nullptr if the script cannot run as a worker.
+             *
+             * The worker is registered first and started without holding m_workersMutex, so waiting for the
+             * banner does not block lookups of other scripts. Concurrent callers of the same script wait in
+             * DictionaryWorker::start() for the same banner.
              */
-            std::string exec(const char* cmd, int timeoutSeconds = 10)
+            std::shared_ptr<DictionaryWorker> getWorker(const std::string& fullPath)
             {
-                auto future = std::async(std::launch::async, [cmd]()
+                std::shared_ptr<DictionaryWorker> worker;
+                {
+                    std::lock_guard<std::mutex> lock(m_workersMutex);
+                    auto& registered = m_workers[fullPath];
+                    if( !registered )
                     {
-                        std::array<char, 5000> buffer;
-                        std::string result;
-                        std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd, "r"), pclose);
-                        if( !pipe )
-                            throw std::runtime_error("popen() failed!");
-                        while( fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr )
-                        {
-                            result += buffer.data();
-                        }
-                        int returnCode = pclose(pipe.release());
-                        if( returnCode != 0 )
-                            throw std::runtime_error("Command failed with code " + std::to_string(returnCode));
-                        return result;
-                    });
-
-                if( future.wait_for(std::chrono::seconds(timeoutSeconds)) == std::future_status::timeout )
-                    throw std::runtime_error("Command timed out!");
-
-                return future.get();
+                        registered = std::make_shared<DictionaryWorker>([fullPath]()
+                            {
+                                return ProcessWorkerChannel::spawn({ "python", fullPath, "--worker" });
+                            });
+                    }
+                    worker = registered;
+                }
+
+                if( !worker->start(std::chrono::seconds(TIMEOUT_SECONDS)) )
+                    return nullptr;
+                return worker;
+            }
+
+            /**
+             * @brief Runs a script once and captures its output.
+             * @param arguments The program followed by its arguments.
+             * @param token Optional token, cancelling it kills the script.
+             * @param timeoutSeconds The script is killed when it runs longer.
+             * @return The output of the script as a string.
+             * @throws std::runtime_error if the script fails, times out or is cancelled.
+             */
+            std::string exec(const std::vector<std::string>& arguments, tools::CancellationToken* token, int timeoutSeconds = 10)
+            {
+                auto task = m_executor.run(arguments, std::chrono::seconds(timeoutSeconds));
+
+                uint64_t subscription = 0;
+                if( token )
+                    subscription = token->subscribe([task]() { task->cancel(); });
+                tools::ProcessExecutor::Result result = task->wait();
+                if( token )
+                    token->unsubscribe(subscription);
+
+                if( result.status != tools::ProcessExecutor::Status::Completed )
+                    throw std::runtime_error(result.error);
+                return result.output;
             }
 
-            std::string m_translationScriptPath;
-            std::string m_conjugationScriptPath;
+            bool m_workerModeEnabled = true;
+            tools::ProcessExecutor m_executor;
+            std::mutex m_workersMutex;
+            std::map<std::string, std::shared_ptr<DictionaryWorker>> m_workers;
         };
 
         /**
@@ -203,6 +351,9 @@ namespace tadaima
         }
 
         PythonTranslator translator;
+        std::shared_ptr<TranslationCache> m_cache;
+        std::shared_ptr<LocalDictionary> m_localDictionary;
+        std::mutex m_pathMutex; ///< Guards the paths and m_localDictionary.
         std::string m_translationScriptPath;
         std::string m_conjugationScriptPath;
     };
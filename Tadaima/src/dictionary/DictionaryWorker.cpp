@@ -0,0 +1,418 @@
+#include "DictionaryWorker.h"
+#include "Tools/ChildProcess.h"
+#include "Tools/CancellationToken.h"
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+namespace tadaima
+{
+    ProcessWorkerChannel::ProcessWorkerChannel()
+        : m_process(std::make_unique<tools::ChildProcess>())
+    {
+    }
+
+    ProcessWorkerChannel::~ProcessWorkerChannel() = default;
+
+    std::unique_ptr<WorkerChannel> ProcessWorkerChannel::spawn(const std::vector<std::string>& arguments)
+    {
+        std::unique_ptr<ProcessWorkerChannel> channel(new ProcessWorkerChannel());
+        if( !channel->m_process->start(arguments) )
+            return nullptr;
+        return channel;
+    }
+
+    bool ProcessWorkerChannel::write(const std::string& data)
+    {
+        return m_process->write(data);
+    }
+
+    int ProcessWorkerChannel::read(char* buffer, size_t size)
+    {
+        return m_process->read(buffer, size);
+    }
+
+    void ProcessWorkerChannel::close()
+    {
+        std::lock_guard<std::mutex> lock(m_closeMutex);
+        if( m_closed )
+            return;
+        m_closed = true;
+        m_process->closeInput();
+        m_process->terminate();
+    }
+
+    DictionaryWorker::DictionaryWorker(ChannelFactory factory, int maxRestarts)
+        : m_factory(std::move(factory)), m_maxRestarts(maxRestarts)
+    {
+    }
+
+    DictionaryWorker::~DictionaryWorker()
+    {
+        stop();
+    }
+
+    bool DictionaryWorker::start(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if( m_state == State::Idle )
+        {
+            m_state = State::Starting;
+            m_reader = std::thread(&DictionaryWorker::run, this);
+        }
+
+        bool settled = m_stateChanged.wait_for(lock, timeout, [this] { return m_state != State::Starting; });
+        if( !settled )
+        {
+            // Most likely a script without worker support that is busy with "--worker" as its input.
+            lock.unlock();
+            stop();
+            return false;
+        }
+        return m_state == State::Ready;
+    }
+
+    void DictionaryWorker::stop()
+    {
+        // Several callers of start() may time out together, only one of them may join the reader.
+        std::lock_guard<std::mutex> stopLock(m_stopMutex);
+
+        std::shared_ptr<WorkerChannel> channel;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            channel = m_channel;
+        }
+
+        if( channel )
+            channel->close();
+
+        if( m_reader.joinable() && m_reader.get_id() != std::this_thread::get_id() )
+            m_reader.join();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_state = State::Failed;
+        }
+        m_stateChanged.notify_all();
+        failPending("Dictionary worker was stopped.", 0);
+    }
+
+    std::future<std::string> DictionaryWorker::submit(const std::string& input)
+    {
+        std::future<std::string> future;
+        enqueue(input, future);
+        return future;
+    }
+
+    std::string DictionaryWorker::request(const std::string& input, std::chrono::milliseconds timeout, tools::CancellationToken* token)
+    {
+        std::future<std::string> future;
+        uint64_t id = enqueue(input, future);
+
+        uint64_t subscription = 0;
+        if( token )
+            subscription = token->subscribe([this, id]() { fail(id, "The request was cancelled."); });
+
+        const bool timedOut = future.wait_for(timeout) == std::future_status::timeout;
+        if( token )
+            token->unsubscribe(subscription);
+
+        if( timedOut )
+        {
+            cancel(id);
+            killHungWorker();
+            throw std::runtime_error("Dictionary worker timed out!");
+        }
+        return future.get();
+    }
+
+    void DictionaryWorker::fail(uint64_t id, const std::string& reason)
+    {
+        std::promise<std::string> promise;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_pending.find(id);
+            if( it == m_pending.end() )
+                return;
+            promise = std::move(it->second.promise);
+            m_pending.erase(it);
+        }
+        promise.set_exception(std::make_exception_ptr(std::runtime_error(reason)));
+    }
+
+    void DictionaryWorker::killHungWorker()
+    {
+        std::shared_ptr<WorkerChannel> channel;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            channel = m_channel;
+        }
+
+        // The worker handles requests one by one, so a hung lookup holds up everything queued behind it.
+        // Closing the channel kills the process tree, the reader then starts a new worker and resends the
+        // other pending requests like after a crash.
+        if( channel )
+            channel->close();
+    }
+
+    void DictionaryWorker::cancelAll()
+    {
+        failPending("The request was cancelled.", 0);
+    }
+
+    DictionaryWorker::State DictionaryWorker::getState() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_state;
+    }
+
+    int DictionaryWorker::getRestartCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_restartCount;
+    }
+
+    uint64_t DictionaryWorker::enqueue(const std::string& input, std::future<std::string>& future)
+    {
+        std::shared_ptr<WorkerChannel> channel;
+        uint64_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            id = m_nextId++;
+            PendingRequest& pending = m_pending[id];
+            pending.input = input;
+            future = pending.promise.get_future();
+
+            if( m_state == State::Failed )
+            {
+                pending.promise.set_exception(std::make_exception_ptr(std::runtime_error("Dictionary worker is not available.")));
+                m_pending.erase(id);
+                return id;
+            }
+
+            // While the worker is (re)starting the request waits in m_pending and is sent by sendPending().
+            if( m_state == State::Ready && m_channel )
+            {
+                pending.attempts = 1;
+                channel = m_channel;
+            }
+        }
+
+        // A failed write means the worker died, the reader notices and resends after the restart.
+        if( channel )
+            channel->write(formatRequest(id, input));
+
+        return id;
+    }
+
+    void DictionaryWorker::cancel(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.erase(id);
+    }
+
+    void DictionaryWorker::run()
+    {
+        int consecutiveCrashes = 0;
+        bool everReady = false;
+
+        while( true )
+        {
+            std::shared_ptr<WorkerChannel> channel(m_factory());
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if( m_stopping || !channel )
+                {
+                    if( channel )
+                        channel->close();
+                    m_state = State::Failed;
+                    break;
+                }
+                m_channel = channel;
+            }
+
+            m_readBuffer.clear();
+            bool ready = readBanner(*channel);
+            if( ready )
+            {
+                // The waiting requests are taken in the same lock that publishes Ready: the ones enqueued after it
+                // are written by enqueue() itself, so no request is sent twice to this worker.
+                std::string requests;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_state = State::Ready;
+                    requests = takePendingRequests();
+                }
+                everReady = true;
+                m_stateChanged.notify_all();
+
+                if( !requests.empty() )
+                    channel->write(requests);
+                if( readReplies(*channel) > 0 )
+                    consecutiveCrashes = 0;
+            }
+
+            channel->close();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_channel.reset();
+                if( m_stopping )
+                {
+                    m_state = State::Failed;
+                    break;
+                }
+            }
+
+            // A worker that never said hello does not speak the protocol, do not retry.
+            if( !everReady || ++consecutiveCrashes > m_maxRestarts )
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_state = State::Failed;
+                break;
+            }
+
+            failPending("Dictionary worker crashed while handling the request.", 2);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_state = State::Starting;
+                ++m_restartCount;
+            }
+        }
+
+        m_stateChanged.notify_all();
+        failPending("Dictionary worker is not available.", 0);
+    }
+
+    bool DictionaryWorker::readBanner(WorkerChannel& channel)
+    {
+        std::string line;
+        while( readLine(channel, line) )
+        {
+            if( line == PROTOCOL_BANNER )
+                return true;
+        }
+        return false;
+    }
+
+    int DictionaryWorker::readReplies(WorkerChannel& channel)
+    {
+        int answered = 0;
+        std::string header;
+        while( readLine(channel, header) )
+        {
+            std::istringstream stream(header);
+            uint64_t id = 0;
+            std::string status;
+            size_t length = 0;
+            if( !(stream >> id >> status >> length) )
+                return answered; // Not our protocol anymore, treat it like a crash.
+
+            std::string payload;
+            if( !readExactly(channel, length, payload) )
+                return answered;
+
+            ++answered;
+
+            std::promise<std::string> promise;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_pending.find(id);
+                if( it == m_pending.end() )
+                    continue; // Timed out or answered twice.
+                promise = std::move(it->second.promise);
+                m_pending.erase(it);
+            }
+
+            if( status == "OK" )
+                promise.set_value(std::move(payload));
+            else
+                promise.set_exception(std::make_exception_ptr(std::runtime_error(payload)));
+        }
+        return answered;
+    }
+
+    bool DictionaryWorker::readLine(WorkerChannel& channel, std::string& line)
+    {
+        std::array<char, 4096> buffer;
+        size_t end;
+        while( (end = m_readBuffer.find('\n')) == std::string::npos )
+        {
+            int count = channel.read(buffer.data(), buffer.size());
+            if( count <= 0 )
+                return false;
+            m_readBuffer.append(buffer.data(), count);
+        }
+
+        line.assign(m_readBuffer, 0, end);
+        m_readBuffer.erase(0, end + 1);
+        if( !line.empty() && line.back() == '\r' )
+            line.pop_back();
+        return true;
+    }
+
+    bool DictionaryWorker::readExactly(WorkerChannel& channel, size_t length, std::string& data)
+    {
+        std::array<char, 4096> buffer;
+        while( m_readBuffer.size() < length )
+        {
+            int count = channel.read(buffer.data(), buffer.size());
+            if( count <= 0 )
+                return false;
+            m_readBuffer.append(buffer.data(), count);
+        }
+
+        data.assign(m_readBuffer, 0, length);
+        m_readBuffer.erase(0, length);
+        return true;
+    }
+
+    std::string DictionaryWorker::takePendingRequests()
+    {
+        // Called with m_mutex locked.
+        std::string requests;
+        for( auto& [id, pending] : m_pending )
+        {
+            ++pending.attempts;
+            requests += formatRequest(id, pending.input);
+        }
+        return requests;
+    }
+
+    void DictionaryWorker::failPending(const std::string& reason, int minimumAttempts)
+    {
+        std::vector<std::promise<std::string>> failed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for( auto it = m_pending.begin(); it != m_pending.end(); )
+            {
+                if( it->second.attempts >= minimumAttempts )
+                {
+                    failed.push_back(std::move(it->second.promise));
+                    it = m_pending.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        for( auto& promise : failed )
+        {
+            promise.set_exception(std::make_exception_ptr(std::runtime_error(reason)));
+        }
+    }
+
+    std::string DictionaryWorker::formatRequest(uint64_t id, const std::string& input)
+    {
+        std::string request = std::to_string(id) + '\t' + input + '\n';
+        // The input must stay on one line and must not contain the field separator.
+        for( size_t index = request.find('\t') + 1; index + 1 < request.size(); ++index )
+        {
+            if( request[index] == '\n' || request[index] == '\r' || request[index] == '\t' )
+                request[index] = ' ';
+        }
+        return request;
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @file DictionaryWorker.h
+ * @brief Defines the DictionaryWorker class, which keeps a dictionary script resident and multiplexes requests over it.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tools { class ChildProcess; class CancellationToken; }
+
+namespace tadaima
+{
+    /**
+     * @class WorkerChannel
+     * @brief Byte stream to a worker: requests are written to it and framed replies are read from it.
+     */
+    class WorkerChannel
+    {
+    public:
+        virtual ~WorkerChannel() = default;
+
+        /**
+         * @brief Writes bytes to the worker.
+         * @return False if the worker is gone.
+         */
+        virtual bool write(const std::string& data) = 0;
+
+        /**
+         * @brief Blocks until bytes from the worker are available.
+         * @return The number of bytes read, 0 when the worker closed the stream, -1 on error.
+         */
+        virtual int read(char* buffer, size_t size) = 0;
+
+        /**
+         * @brief Shuts the worker down. A blocked read returns afterwards.
+         *
+         * Called by the reader thread and by DictionaryWorker::stop(), so it must be safe to call
+         * more than once and from several threads.
+         */
+        virtual void close() = 0;
+    };
+
+    /**
+     * @class ProcessWorkerChannel
+     * @brief WorkerChannel backed by a child process (the dictionary script started with `--worker`).
+     */
+    class ProcessWorkerChannel : public WorkerChannel
+    {
+    public:
+        /**
+         * @brief Starts the process.
+         * @param arguments The program followed by its arguments.
+         * @return The channel, or nullptr if the process could not be started.
+         */
+        static std::unique_ptr<WorkerChannel> spawn(const std::vector<std::string>& arguments);
+
+        ~ProcessWorkerChannel() override;
+
+        bool write(const std::string& data) override;
+        int read(char* buffer, size_t size) override;
+        void close() override;
+
+    private:
+        ProcessWorkerChannel();
+
+        std::unique_ptr<tools::ChildProcess> m_process;
+        std::mutex m_closeMutex;
+        bool m_closed = false;
+    };
+
+    /**
+     * @class DictionaryWorker
+     * @brief Keeps one worker running and routes requests to it.
+     *
+     * Protocol (UTF-8, one worker per script):
+     * - on start-up the worker writes the banner line `TADAIMA-WORKER 1`,
+     * - a request is one line `<id>\t<input>\n`,
+     * - a reply is a header line `<id> <OK|ERR> <length>\n` followed by exactly `<length>` bytes of payload.
+     *
+     * Any number of requests may be in flight, replies are matched by id and may arrive in any order.
+     * When the worker dies, it is started again and the unanswered requests are sent to the new one;
+     * a request that was already sent twice fails instead, so one bad input cannot crash-loop the worker.
+     */
+    class DictionaryWorker
+    {
+    public:
+        using ChannelFactory = std::function<std::unique_ptr<WorkerChannel>()>;
+
+        static constexpr const char* PROTOCOL_BANNER = "TADAIMA-WORKER 1";
+
+        /**
+         * @brief State of the worker.
+         */
+        enum class State
+        {
+            Idle,       ///< Not started yet.
+            Starting,   ///< Waiting for the banner.
+            Ready,      ///< Accepting requests.
+            Failed      ///< Could not be started, did not speak the protocol or crashed too often.
+        };
+
+        /**
+         * @brief Constructs the worker without starting it.
+         * @param factory Creates a new channel, called on start and on every restart.
+         * @param maxRestarts Number of consecutive crashes tolerated before the worker gives up.
+         */
+        explicit DictionaryWorker(ChannelFactory factory, int maxRestarts = 3);
+
+        /**
+         * @brief Stops the worker and fails all outstanding requests.
+         */
+        ~DictionaryWorker();
+
+        DictionaryWorker(const DictionaryWorker&) = delete;
+        DictionaryWorker& operator=(const DictionaryWorker&) = delete;
+
+        /**
+         * @brief Starts the worker and waits for its banner. May be called from several threads at once.
+         * @param timeout How long to wait for the banner.
+         * @return True if the worker is ready.
+         */
+        bool start(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief Stops the worker and fails all outstanding requests.
+         */
+        void stop();
+
+        /**
+         * @brief Sends a request.
+         * @param input The word to translate or conjugate.
+         * @return Future holding the reply payload, or a std::runtime_error.
+         */
+        std::future<std::string> submit(const std::string& input);
+
+        /**
+         * @brief Sends a request and waits for its reply.
+         * @param input The word to translate or conjugate.
+         * @param timeout How long to wait for the reply.
+         * @param token Optional token, cancelling it fails this request and leaves the others alone.
+         * @return The reply payload.
+         * @throws std::runtime_error on an error reply, a timeout, a cancellation or if the worker is not available.
+         *
+         * On a timeout the worker is killed and restarted, counting as a crash.
+         */
+        std::string request(const std::string& input, std::chrono::milliseconds timeout, tools::CancellationToken* token = nullptr);
+
+        /**
+         * @brief Fails all outstanding requests with "cancelled". The worker keeps running, late replies are dropped.
+         */
+        void cancelAll();
+
+        /**
+         * @brief Returns the current state.
+         */
+        State getState() const;
+
+        /**
+         * @brief Returns how often the worker was restarted after a crash.
+         */
+        int getRestartCount() const;
+
+    private:
+
+        struct PendingRequest
+        {
+            std::string input;
+            std::promise<std::string> promise;
+            int attempts = 0;
+        };
+
+        uint64_t enqueue(const std::string& input, std::future<std::string>& future);
+        void cancel(uint64_t id);
+        void fail(uint64_t id, const std::string& reason);
+        void killHungWorker();
+        void run();
+        bool readBanner(WorkerChannel& channel);
+        int readReplies(WorkerChannel& channel);
+        bool readLine(WorkerChannel& channel, std::string& line);
+        bool readExactly(WorkerChannel& channel, size_t length, std::string& data);
+        std::string takePendingRequests();
+        void failPending(const std::string& reason, int minimumAttempts);
+        static std::string formatRequest(uint64_t id, const std::string& input);
+
+        ChannelFactory m_factory;
+        const int m_maxRestarts;
+
+        mutable std::mutex m_mutex;
+        std::mutex m_stopMutex; ///< Serializes stop(), which joins m_reader.
+        std::condition_variable m_stateChanged;
+        State m_state = State::Idle;
+        bool m_stopping = false;
+        int m_restartCount = 0;
+        std::shared_ptr<WorkerChannel> m_channel;
+        std::map<uint64_t, PendingRequest> m_pending;
+        uint64_t m_nextId = 1;
+
+        std::string m_readBuffer; ///< Bytes received but not consumed yet, only touched by the reader thread.
+        std::thread m_reader;
+    };
+}
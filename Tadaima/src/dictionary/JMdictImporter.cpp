@@ -0,0 +1,333 @@
+#include "JMdictImporter.h"
+#include "LocalDictionary.h"
+#include "Tools/XmlPullParser.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace tadaima
+{
+    namespace
+    {
+        using tools::XmlPullParser;
+        using Event = XmlPullParser::Event;
+
+        // How many records are parsed between two progress reports.
+        constexpr int PROGRESS_INTERVAL = 256;
+
+        bool isEnglish(const XmlPullParser& parser, const char* languageAttribute)
+        {
+            const std::string* language = parser.findAttribute(languageAttribute);
+            return !language || *language == "eng" || *language == "en";
+        }
+
+        void appendListItem(std::string& list, const std::string& item)
+        {
+            if( !list.empty() )
+                list += ", ";
+            list += item;
+        }
+
+        int toNumber(const std::string& text)
+        {
+            try
+            {
+                return std::stoi(text);
+            }
+            catch( const std::exception& )
+            {
+                return 0;
+            }
+        }
+
+        [[noreturn]] void throwParseError(const XmlPullParser& parser)
+        {
+            throw std::runtime_error("Malformed dictionary file: " + parser.getError());
+        }
+
+        // Parses one <entry>; the parser stands on its start tag and ends on its end tag.
+        LocalDictionary::Record readEntry(XmlPullParser& parser)
+        {
+            LocalDictionary::Record record;
+            std::vector<std::string> previousPartsOfSpeech;
+            LocalDictionary::Sense* sense = nullptr;
+            const int depth = parser.getDepth();
+
+            while( true )
+            {
+                Event event = parser.next();
+                if( event == Event::Error || event == Event::EndDocument )
+                    throwParseError(parser);
+                if( event == Event::EndElement && parser.getDepth() < depth )
+                    break;
+                if( event == Event::EndElement && parser.getName() == "sense" && sense )
+                {
+                    // JMdict lists the part of speech once for consecutive senses that share it.
+                    if( sense->partsOfSpeech.empty() )
+                        sense->partsOfSpeech = previousPartsOfSpeech;
+                    else
+                        previousPartsOfSpeech = sense->partsOfSpeech;
+                    sense = nullptr;
+                }
+                if( event != Event::StartElement )
+                    continue;
+
+                const std::string& name = parser.getName();
+                if( name == "ent_seq" )
+                    record.sequence = toNumber(parser.readElementText());
+                else if( name == "keb" )
+                    record.kanji.push_back(parser.readElementText());
+                else if( name == "reb" )
+                    record.readings.push_back(parser.readElementText());
+                else if( name == "ke_pri" || name == "re_pri" )
+                {
+                    record.common = true;
+                    parser.skipElement();
+                }
+                else if( name == "sense" )
+                {
+                    record.senses.emplace_back();
+                    sense = &record.senses.back();
+                }
+                else if( name == "pos" && sense )
+                    sense->partsOfSpeech.push_back(parser.readElementText());
+                else if( name == "gloss" && sense )
+                {
+                    const bool english = isEnglish(parser, "xml:lang");
+                    std::string gloss = parser.readElementText();
+                    if( english && !gloss.empty() )
+                        sense->glosses.push_back(std::move(gloss));
+                }
+                else if( name != "k_ele" && name != "r_ele" )
+                    parser.skipElement();
+            }
+
+            // Senses that only have glosses in other languages are dropped.
+            record.senses.erase(std::remove_if(record.senses.begin(), record.senses.end(),
+                [](const LocalDictionary::Sense& candidate) { return candidate.glosses.empty(); }), record.senses.end());
+            return record;
+        }
+
+        // Parses one KANJIDIC2 <character>; the parser stands on its start tag and ends on its end tag.
+        LocalDictionary::Kanji readCharacter(XmlPullParser& parser)
+        {
+            LocalDictionary::Kanji kanji;
+            const int depth = parser.getDepth();
+
+            while( true )
+            {
+                Event event = parser.next();
+                if( event == Event::Error || event == Event::EndDocument )
+                    throwParseError(parser);
+                if( event == Event::EndElement && parser.getDepth() < depth )
+                    break;
+                if( event != Event::StartElement )
+                    continue;
+
+                const std::string& name = parser.getName();
+                if( name == "literal" )
+                    kanji.literal = parser.readElementText();
+                else if( name == "grade" )
+                    kanji.grade = toNumber(parser.readElementText());
+                else if( name == "jlpt" )
+                    kanji.jlpt = toNumber(parser.readElementText());
+                else if( name == "reading" )
+                {
+                    const std::string type = parser.getAttribute("r_type");
+                    const std::string reading = parser.readElementText();
+                    if( type == "ja_on" )
+                        appendListItem(kanji.onyomi, reading);
+                    else if( type == "ja_kun" )
+                        appendListItem(kanji.kunyomi, reading);
+                }
+                else if( name == "meaning" )
+                {
+                    const bool english = isEnglish(parser, "m_lang");
+                    const std::string meaning = parser.readElementText();
+                    if( english )
+                        appendListItem(kanji.meanings, meaning);
+                }
+                else if( name != "misc" && name != "reading_meaning" && name != "rmgroup" )
+                    parser.skipElement();
+            }
+            return kanji;
+        }
+    }
+
+    JMdictImporter::~JMdictImporter()
+    {
+        cancel();
+        wait();
+    }
+
+    bool JMdictImporter::start(const std::vector<std::string>& files, const std::string& dbPath)
+    {
+        if( isRunning() )
+            return false;
+        wait();
+
+        Progress progress;
+        for( const auto& file : files )
+        {
+            std::error_code error;
+            const auto size = std::filesystem::file_size(file, error);
+            if( !error )
+                progress.totalBytes += size;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress = progress;
+        }
+
+        m_cancelled = false;
+        m_running = true;
+        m_thread = std::thread(&JMdictImporter::run, this, files, dbPath);
+        return true;
+    }
+
+    JMdictImporter::Progress JMdictImporter::getProgress() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_progress;
+    }
+
+    bool JMdictImporter::isRunning() const
+    {
+        return m_running;
+    }
+
+    void JMdictImporter::cancel()
+    {
+        m_cancelled = true;
+    }
+
+    void JMdictImporter::wait()
+    {
+        if( m_thread.joinable() )
+            m_thread.join();
+    }
+
+    void JMdictImporter::run(std::vector<std::string> files, std::string dbPath)
+    {
+        std::string error;
+        try
+        {
+            LocalDictionary dictionary(dbPath);
+            if( !dictionary.isOpen() )
+                throw std::runtime_error("Cannot open the dictionary database " + dbPath + ".");
+
+            uint64_t finishedBytes = 0;
+            for( const auto& file : files )
+            {
+                std::ifstream input(file, std::ios::binary);
+                if( !input )
+                    throw std::runtime_error("Cannot open " + file + ".");
+
+                Result result = importStream(input, dictionary, [this, finishedBytes](uint64_t bytesRead)
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_progress.bytesRead = finishedBytes + bytesRead;
+                        return !m_cancelled.load();
+                    });
+
+                std::error_code sizeError;
+                const auto size = std::filesystem::file_size(file, sizeError);
+                finishedBytes += sizeError ? 0 : size;
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_progress.bytesRead = finishedBytes;
+                m_progress.imported.entries += result.entries;
+                m_progress.imported.kanji += result.kanji;
+            }
+        }
+        catch( const std::exception& e )
+        {
+            error = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress.finished = true;
+            m_progress.error = error;
+        }
+        m_running = false;
+    }
+
+    JMdictImporter::Result JMdictImporter::importStream(std::istream& input, LocalDictionary& dictionary, ProgressCallback progress)
+    {
+        XmlPullParser parser(input);
+
+        Event event = parser.next();
+        while( event == Event::Text )
+        {
+            event = parser.next();
+        }
+        if( event == Event::Error )
+            throwParseError(parser);
+
+        const bool isJMdict = event == Event::StartElement && parser.getName() == "JMdict";
+        const bool isKanjidic = event == Event::StartElement && parser.getName() == "kanjidic2";
+        if( !isJMdict && !isKanjidic )
+            throw std::runtime_error("Not a JMdict or KANJIDIC2 file.");
+
+        if( !dictionary.beginImport() )
+            throw std::runtime_error("Cannot write to the dictionary database.");
+
+        Result result;
+        try
+        {
+            if( isJMdict )
+                dictionary.clearEntries();
+            else
+                dictionary.clearKanji();
+
+            const char* recordName = isJMdict ? "entry" : "character";
+            int sinceReport = 0;
+
+            while( (event = parser.next()) != Event::EndDocument )
+            {
+                if( event == Event::Error )
+                    throwParseError(parser);
+                if( event != Event::StartElement )
+                    continue;
+                if( parser.getName() != recordName )
+                {
+                    parser.skipElement();
+                    continue;
+                }
+
+                if( isJMdict )
+                {
+                    if( dictionary.addEntry(readEntry(parser)) )
+                        ++result.entries;
+                }
+                else
+                {
+                    if( dictionary.addKanji(readCharacter(parser)) )
+                        ++result.kanji;
+                }
+
+                if( progress && ++sinceReport == PROGRESS_INTERVAL )
+                {
+                    sinceReport = 0;
+                    if( !progress(parser.getBytesRead()) )
+                        throw std::runtime_error("The import was cancelled.");
+                }
+            }
+
+            if( progress && !progress(parser.getBytesRead()) )
+                throw std::runtime_error("The import was cancelled.");
+        }
+        catch( ... )
+        {
+            dictionary.rollbackImport();
+            throw;
+        }
+
+        if( !dictionary.commitImport() )
+            throw std::runtime_error("Cannot write to the dictionary database.");
+        return result;
+    }
+}
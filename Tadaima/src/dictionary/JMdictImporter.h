@@ -0,0 +1,117 @@
+/**
+ * @file JMdictImporter.h
+ * @brief Defines the JMdictImporter class, which builds a LocalDictionary from the JMdict and KANJIDIC2 XML files.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tadaima
+{
+    class LocalDictionary;
+
+    /**
+     * @class JMdictImporter
+     * @brief Streams JMdict (JMdict_e) and KANJIDIC2 files into a LocalDictionary.
+     *
+     * The files are read with tools::XmlPullParser, so the ~100 MB JMdict file is never held in memory.
+     * Only English glosses are imported. The kind of file is recognized by its root element. Each file is
+     * imported in one transaction: a failed or cancelled import leaves the previous dictionary untouched.
+     */
+    class JMdictImporter
+    {
+    public:
+
+        /**
+         * @brief Number of records written by an import.
+         */
+        struct Result
+        {
+            int64_t entries = 0;  ///< Word entries (JMdict).
+            int64_t kanji = 0;    ///< Characters (KANJIDIC2).
+        };
+
+        /**
+         * @brief Progress of a background import.
+         */
+        struct Progress
+        {
+            uint64_t bytesRead = 0;   ///< Bytes of all files parsed so far.
+            uint64_t totalBytes = 0;  ///< Size of all files.
+            Result imported;          ///< Records written by the files finished so far.
+            bool finished = false;    ///< True once the import ended, successfully or not.
+            std::string error;        ///< Why the import failed, empty on success.
+        };
+
+        /**
+         * @brief Called regularly with the number of bytes parsed; returning false cancels the import.
+         */
+        using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+        JMdictImporter() = default;
+
+        /**
+         * @brief Cancels a running import and waits for it.
+         */
+        ~JMdictImporter();
+
+        JMdictImporter(const JMdictImporter&) = delete;
+        JMdictImporter& operator=(const JMdictImporter&) = delete;
+
+        /**
+         * @brief Imports files on a background thread.
+         * @param files JMdict and/or KANJIDIC2 files, in any order.
+         * @param dbPath The dictionary database to write.
+         * @return False if an import is still running.
+         */
+        bool start(const std::vector<std::string>& files, const std::string& dbPath);
+
+        /**
+         * @brief Returns the progress of the current (or last) import.
+         */
+        Progress getProgress() const;
+
+        /**
+         * @brief Checks whether an import is running.
+         */
+        bool isRunning() const;
+
+        /**
+         * @brief Requests the running import to stop, its transaction is rolled back.
+         */
+        void cancel();
+
+        /**
+         * @brief Waits until the import has finished.
+         */
+        void wait();
+
+        /**
+         * @brief Imports one JMdict or KANJIDIC2 document.
+         * @param input The XML document.
+         * @param dictionary The dictionary to write; its entries (or kanji) are replaced.
+         * @param progress Optional progress callback.
+         * @return The number of imported records.
+         * @throws std::runtime_error if the document is malformed, not a dictionary, cannot be written or the import was cancelled.
+         */
+        static Result importStream(std::istream& input, LocalDictionary& dictionary, ProgressCallback progress = nullptr);
+
+    private:
+
+        void run(std::vector<std::string> files, std::string dbPath);
+
+        std::atomic<bool> m_running{ false };
+        std::atomic<bool> m_cancelled{ false };
+        mutable std::mutex m_mutex;
+        Progress m_progress;
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,436 @@
+#include "LocalDictionary.h"
+#include "TranslationCache.h"
+#include "Transliterator.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <algorithm>
+#include <unordered_set>
+
+namespace tadaima
+{
+    namespace
+    {
+        // Lower ranks win. Common words always come before uncommon ones, then spellings and
+        // readings before romaji, then English glosses in the order JMdict lists them.
+        constexpr int UNCOMMON_RANK = 100;
+        constexpr int ROMAJI_RANK = 10;
+        constexpr int GLOSS_RANK = 20;
+        constexpr int MAX_GLOSS_RANK = 99;
+
+        std::string columnText(sqlite3_stmt* stmt, int column)
+        {
+            const unsigned char* text = sqlite3_column_text(stmt, column);
+            return text ? reinterpret_cast<const char*>(text) : "";
+        }
+
+        std::string join(const std::vector<std::string>& parts, const char* separator)
+        {
+            std::string joined;
+            for( const auto& part : parts )
+            {
+                if( !joined.empty() )
+                    joined += separator;
+                joined += part;
+            }
+            return joined;
+        }
+
+        std::string firstOf(const std::string& list)
+        {
+            return list.substr(0, list.find(", "));
+        }
+    }
+
+    LocalDictionary::LocalDictionary(const std::string& dbPath)
+        : m_db(nullptr)
+    {
+        if( sqlite3_open(dbPath.c_str(), &m_db) != SQLITE_OK || !initTables() )
+        {
+            sqlite3_close(m_db);
+            m_db = nullptr;
+        }
+    }
+
+    LocalDictionary::~LocalDictionary()
+    {
+        if( m_db )
+        {
+            finalizeStatements();
+            sqlite3_close(m_db);
+        }
+    }
+
+    bool LocalDictionary::isOpen() const
+    {
+        return m_db != nullptr;
+    }
+
+    bool LocalDictionary::initTables()
+    {
+        // An import on another connection holds the write lock while it runs, wait for the commit instead of failing.
+        sqlite3_busy_timeout(m_db, 2000);
+
+        const char* createEntriesTable =
+            "CREATE TABLE IF NOT EXISTS entries ("
+            "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+            "sequence INTEGER, "
+            "kanji TEXT, "
+            "reading TEXT NOT NULL, "
+            "romaji TEXT, "
+            "gloss TEXT, "
+            "senses TEXT, "
+            "pos TEXT, "
+            "common INTEGER NOT NULL DEFAULT 0);";
+
+        const char* createFormsTable =
+            "CREATE TABLE IF NOT EXISTS forms ("
+            "form TEXT NOT NULL, "
+            "entry_id INTEGER NOT NULL, "
+            "rank INTEGER NOT NULL);";
+
+        const char* createFormsIndex =
+            "CREATE INDEX IF NOT EXISTS forms_by_form ON forms(form, rank);";
+
+        const char* createKanjiTable =
+            "CREATE TABLE IF NOT EXISTS kanji ("
+            "literal TEXT PRIMARY KEY, "
+            "onyomi TEXT, "
+            "kunyomi TEXT, "
+            "meanings TEXT, "
+            "grade INTEGER, "
+            "jlpt INTEGER);";
+
+        return execute(createEntriesTable) && execute(createFormsTable) && execute(createFormsIndex) && execute(createKanjiTable);
+    }
+
+    bool LocalDictionary::execute(const char* sql)
+    {
+        return sqlite3_exec(m_db, sql, 0, 0, nullptr) == SQLITE_OK;
+    }
+
+    sqlite3_stmt* LocalDictionary::prepare(sqlite3_stmt*& statement, const char* sql)
+    {
+        if( !statement && sqlite3_prepare_v2(m_db, sql, -1, &statement, nullptr) != SQLITE_OK )
+        {
+            sqlite3_finalize(statement);
+            statement = nullptr;
+            return nullptr;
+        }
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        return statement;
+    }
+
+    void LocalDictionary::finalizeStatements()
+    {
+        for( sqlite3_stmt** statement : { &m_findEntries, &m_findKanji, &m_insertEntry, &m_insertForm, &m_insertKanji } )
+        {
+            sqlite3_finalize(*statement);
+            *statement = nullptr;
+        }
+    }
+
+    std::optional<Word> LocalDictionary::lookup(const std::string& query)
+    {
+        auto entries = findEntries(query, 1);
+        if( !entries.empty() )
+        {
+            const Entry& entry = entries.front();
+            Word word;
+            word.kanji = entry.kanji;
+            word.kana = entry.reading;
+            word.romaji = entry.romaji;
+            word.translation = entry.gloss;
+            return word;
+        }
+
+        // A single kanji without a word entry of its own, answer with its readings and meanings.
+        if( auto kanji = findKanji(normalizeForm(query)) )
+        {
+            Word word;
+            word.kanji = kanji->literal;
+            std::string reading = firstOf(kanji->kunyomi.empty() ? kanji->onyomi : kanji->kunyomi);
+            reading.erase(std::remove_if(reading.begin(), reading.end(), [](char c) { return c == '.' || c == '-'; }), reading.end());
+            word.kana = reading;
+            word.romaji = Transliterator::toRomaji(reading);
+            word.translation = kanji->meanings;
+            return word;
+        }
+        return std::nullopt;
+    }
+
+    std::vector<LocalDictionary::Entry> LocalDictionary::findEntries(const std::string& query, int limit)
+    {
+        std::vector<Entry> entries;
+        const std::string form = normalizeForm(query);
+        if( form.empty() )
+            return entries;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return entries;
+
+        const char* sql =
+            "SELECT e.kanji, e.reading, e.romaji, e.gloss, e.senses, e.pos, e.common "
+            "FROM forms f JOIN entries e ON e.id = f.entry_id "
+            "WHERE f.form = ? ORDER BY f.rank, e.id LIMIT ?;";
+
+        sqlite3_stmt* stmt = prepare(m_findEntries, sql);
+        if( !stmt )
+            return entries;
+
+        sqlite3_bind_text(stmt, 1, form.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 2, limit);
+
+        while( sqlite3_step(stmt) == SQLITE_ROW )
+        {
+            Entry entry;
+            entry.kanji = columnText(stmt, 0);
+            entry.reading = columnText(stmt, 1);
+            entry.romaji = columnText(stmt, 2);
+            entry.gloss = columnText(stmt, 3);
+            entry.senses = columnText(stmt, 4);
+            entry.partOfSpeech = columnText(stmt, 5);
+            entry.common = sqlite3_column_int(stmt, 6) != 0;
+            entries.push_back(std::move(entry));
+        }
+        sqlite3_reset(stmt);
+        return entries;
+    }
+
+    std::optional<LocalDictionary::Kanji> LocalDictionary::findKanji(const std::string& literal)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db || literal.empty() )
+            return std::nullopt;
+
+        sqlite3_stmt* stmt = prepare(m_findKanji, "SELECT literal, onyomi, kunyomi, meanings, grade, jlpt FROM kanji WHERE literal = ?;");
+        if( !stmt )
+            return std::nullopt;
+
+        sqlite3_bind_text(stmt, 1, literal.c_str(), -1, SQLITE_TRANSIENT);
+
+        std::optional<Kanji> kanji;
+        if( sqlite3_step(stmt) == SQLITE_ROW )
+        {
+            kanji = Kanji{};
+            kanji->literal = columnText(stmt, 0);
+            kanji->onyomi = columnText(stmt, 1);
+            kanji->kunyomi = columnText(stmt, 2);
+            kanji->meanings = columnText(stmt, 3);
+            kanji->grade = sqlite3_column_int(stmt, 4);
+            kanji->jlpt = sqlite3_column_int(stmt, 5);
+        }
+        sqlite3_reset(stmt);
+        return kanji;
+    }
+
+    int64_t LocalDictionary::getEntryCount()
+    {
+        return count("SELECT COUNT(*) FROM entries;");
+    }
+
+    int64_t LocalDictionary::getKanjiCount()
+    {
+        return count("SELECT COUNT(*) FROM kanji;");
+    }
+
+    int64_t LocalDictionary::count(const char* sql)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return 0;
+
+        sqlite3_stmt* stmt = nullptr;
+        if( sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK )
+            return 0;
+
+        int64_t result = 0;
+        if( sqlite3_step(stmt) == SQLITE_ROW )
+            result = sqlite3_column_int64(stmt, 0);
+        sqlite3_finalize(stmt);
+        return result;
+    }
+
+    bool LocalDictionary::beginImport()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return false;
+
+        // The dictionary can always be imported again, so durability is traded for speed here.
+        execute("PRAGMA synchronous = OFF;");
+        if( !execute("BEGIN TRANSACTION;") )
+            return false;
+
+        // Filling an unindexed table and indexing it once is much faster than updating the index per row.
+        return execute("DROP INDEX IF EXISTS forms_by_form;");
+    }
+
+    void LocalDictionary::clearEntries()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( m_db )
+        {
+            execute("DELETE FROM forms;");
+            execute("DELETE FROM entries;");
+        }
+    }
+
+    void LocalDictionary::clearKanji()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( m_db )
+            execute("DELETE FROM kanji;");
+    }
+
+    bool LocalDictionary::addEntry(const Record& record)
+    {
+        if( record.readings.empty() || record.senses.empty() || record.senses.front().glosses.empty() )
+            return false;
+
+        std::vector<std::string> senses;
+        for( const auto& sense : record.senses )
+        {
+            senses.push_back(join(sense.glosses, "; "));
+        }
+
+        const std::string kanji = record.kanji.empty() ? "" : record.kanji.front();
+        const std::string romaji = Transliterator::toRomaji(record.readings.front());
+        const std::string gloss = senses.front();
+        const std::string allSenses = join(senses, " / ");
+        const std::string partOfSpeech = join(record.senses.front().partsOfSpeech, "; ");
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return false;
+
+        const char* insertEntry =
+            "INSERT INTO entries (sequence, kanji, reading, romaji, gloss, senses, pos, common) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+
+        sqlite3_stmt* stmt = prepare(m_insertEntry, insertEntry);
+        if( !stmt )
+            return false;
+
+        sqlite3_bind_int64(stmt, 1, record.sequence);
+        sqlite3_bind_text(stmt, 2, kanji.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, record.readings.front().c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, romaji.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 5, gloss.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 6, allSenses.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 7, partOfSpeech.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 8, record.common ? 1 : 0);
+
+        const bool inserted = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+        if( !inserted )
+            return false;
+
+        const sqlite3_int64 entryId = sqlite3_last_insert_rowid(m_db);
+        const int base = record.common ? 0 : UNCOMMON_RANK;
+
+        std::unordered_set<std::string> seen;
+        auto addForm = [this, entryId, &seen](const std::string& text, int rank)
+            {
+                std::string form = normalizeForm(text);
+                if( form.empty() || !seen.insert(form).second )
+                    return true;
+
+                sqlite3_stmt* insertForm = prepare(m_insertForm, "INSERT INTO forms (form, entry_id, rank) VALUES (?, ?, ?);");
+                if( !insertForm )
+                    return false;
+                sqlite3_bind_text(insertForm, 1, form.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_int64(insertForm, 2, entryId);
+                sqlite3_bind_int(insertForm, 3, rank);
+                const bool done = sqlite3_step(insertForm) == SQLITE_DONE;
+                sqlite3_reset(insertForm);
+                return done;
+            };
+
+        bool ok = true;
+        for( size_t index = 0; index < record.kanji.size(); ++index )
+        {
+            ok &= addForm(record.kanji[index], base + static_cast<int>(std::min<size_t>(index, ROMAJI_RANK - 1)));
+        }
+        for( size_t index = 0; index < record.readings.size(); ++index )
+        {
+            ok &= addForm(record.readings[index], base + static_cast<int>(std::min<size_t>(index, ROMAJI_RANK - 1)));
+        }
+        ok &= addForm(romaji, base + ROMAJI_RANK);
+
+        int order = 0;
+        for( const auto& sense : record.senses )
+        {
+            for( const auto& text : sense.glosses )
+            {
+                const int rank = base + std::min(GLOSS_RANK + order++, MAX_GLOSS_RANK);
+                ok &= addForm(text, rank);
+
+                // "to eat" is also found as "eat", "cat (esp. the domestic cat)" also as "cat".
+                if( text.compare(0, 3, "to ") == 0 )
+                    ok &= addForm(text.substr(3), rank);
+                const size_t parenthesis = text.find(" (");
+                if( parenthesis != std::string::npos )
+                    ok &= addForm(text.substr(0, parenthesis), rank);
+            }
+        }
+        return ok;
+    }
+
+    bool LocalDictionary::addKanji(const Kanji& kanji)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db || kanji.literal.empty() )
+            return false;
+
+        const char* insertKanji =
+            "INSERT OR REPLACE INTO kanji (literal, onyomi, kunyomi, meanings, grade, jlpt) "
+            "VALUES (?, ?, ?, ?, ?, ?);";
+
+        sqlite3_stmt* stmt = prepare(m_insertKanji, insertKanji);
+        if( !stmt )
+            return false;
+
+        sqlite3_bind_text(stmt, 1, kanji.literal.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, kanji.onyomi.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, kanji.kunyomi.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, kanji.meanings.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 5, kanji.grade);
+        sqlite3_bind_int(stmt, 6, kanji.jlpt);
+
+        const bool inserted = sqlite3_step(stmt) == SQLITE_DONE;
+        sqlite3_reset(stmt);
+        return inserted;
+    }
+
+    bool LocalDictionary::commitImport()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return false;
+
+        if( !execute("CREATE INDEX IF NOT EXISTS forms_by_form ON forms(form, rank);") || !execute("COMMIT;") )
+        {
+            execute("ROLLBACK;");
+            execute("PRAGMA synchronous = FULL;");
+            return false;
+        }
+        execute("PRAGMA synchronous = FULL;");
+        return true;
+    }
+
+    void LocalDictionary::rollbackImport()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( m_db )
+        {
+            execute("ROLLBACK;");
+            execute("PRAGMA synchronous = FULL;");
+        }
+    }
+
+    std::string LocalDictionary::normalizeForm(const std::string& form)
+    {
+        return TranslationCache::normalizeInput(form);
+    }
+}
@@ -0,0 +1,192 @@
+/**
+ * @file LocalDictionary.h
+ * @brief Defines the LocalDictionary class, an indexed offline dictionary stored in SQLite.
+ */
+
+#pragma once
+
+#include "Word.h"
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace tadaima
+{
+    /**
+     * @class LocalDictionary
+     * @brief Answers lookups from a dictionary database built by JMdictImporter, without any subprocess or network.
+     *
+     * Every entry is indexed by all of its kanji spellings, readings, the romaji of its first reading and
+     * its English glosses, so a lookup is a single indexed query. Common words (those with a priority
+     * marker in JMdict) are preferred when several entries share a form. The `kanji` table holds the
+     * KANJIDIC2 characters and answers single-kanji lookups that have no word entry.
+     */
+    class LocalDictionary
+    {
+    public:
+
+        /**
+         * @brief One sense of a JMdict entry.
+         */
+        struct Sense
+        {
+            std::vector<std::string> glosses;        ///< English glosses.
+            std::vector<std::string> partsOfSpeech;  ///< Part-of-speech descriptions.
+        };
+
+        /**
+         * @brief A JMdict entry as it is imported.
+         */
+        struct Record
+        {
+            int64_t sequence = 0;                ///< The JMdict sequence number.
+            std::vector<std::string> kanji;      ///< Kanji spellings, most common first.
+            std::vector<std::string> readings;   ///< Kana readings, most common first.
+            std::vector<Sense> senses;           ///< The senses with English glosses.
+            bool common = false;                 ///< True if any spelling or reading has a priority marker.
+        };
+
+        /**
+         * @brief A dictionary entry as it is returned by a lookup.
+         */
+        struct Entry
+        {
+            std::string kanji;         ///< The first kanji spelling, empty for kana-only words.
+            std::string reading;       ///< The first reading.
+            std::string romaji;        ///< The romaji of the first reading.
+            std::string gloss;         ///< The glosses of the first sense.
+            std::string senses;        ///< The glosses of all senses, separated by " / ".
+            std::string partOfSpeech;  ///< The parts of speech of the first sense.
+            bool common = false;       ///< True for common words.
+        };
+
+        /**
+         * @brief A KANJIDIC2 character.
+         */
+        struct Kanji
+        {
+            std::string literal;   ///< The character.
+            std::string onyomi;    ///< On readings (katakana), separated by ", ".
+            std::string kunyomi;   ///< Kun readings (hiragana), separated by ", ".
+            std::string meanings;  ///< English meanings, separated by ", ".
+            int grade = 0;         ///< School grade, 0 if unknown.
+            int jlpt = 0;          ///< Former JLPT level, 0 if unknown.
+        };
+
+        /**
+         * @brief Opens (or creates) the dictionary database.
+         * @param dbPath The file path to the SQLite database.
+         */
+        explicit LocalDictionary(const std::string& dbPath);
+
+        /**
+         * @brief Closes the database connection.
+         */
+        ~LocalDictionary();
+
+        LocalDictionary(const LocalDictionary&) = delete;
+        LocalDictionary& operator=(const LocalDictionary&) = delete;
+
+        /**
+         * @brief Checks whether the database was opened and its tables are available.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Translates a word given in kanji, kana, romaji or English.
+         * @param query The word to look up.
+         * @return The best matching word, or std::nullopt if the dictionary does not know it.
+         */
+        std::optional<Word> lookup(const std::string& query);
+
+        /**
+         * @brief Returns the entries matching a word, best match first.
+         * @param query The word to look up.
+         * @param limit Maximum number of entries.
+         */
+        std::vector<Entry> findEntries(const std::string& query, int limit = 10);
+
+        /**
+         * @brief Looks up a single kanji.
+         * @param literal The character.
+         */
+        std::optional<Kanji> findKanji(const std::string& literal);
+
+        /**
+         * @brief Returns the number of word entries.
+         */
+        int64_t getEntryCount();
+
+        /**
+         * @brief Returns the number of kanji.
+         */
+        int64_t getKanjiCount();
+
+        /**
+         * @brief Starts a bulk import. Everything up to commitImport() runs in one transaction.
+         * @return False if the database is not open or a transaction could not be started.
+         */
+        bool beginImport();
+
+        /**
+         * @brief Removes all word entries, used before a JMdict file is imported again.
+         */
+        void clearEntries();
+
+        /**
+         * @brief Removes all kanji, used before a KANJIDIC2 file is imported again.
+         */
+        void clearKanji();
+
+        /**
+         * @brief Adds a word entry during an import.
+         * @param record The entry; records without readings or glosses are ignored.
+         * @return False if the entry could not be written.
+         */
+        bool addEntry(const Record& record);
+
+        /**
+         * @brief Adds or replaces a kanji during an import.
+         * @return False if the kanji could not be written.
+         */
+        bool addKanji(const Kanji& kanji);
+
+        /**
+         * @brief Rebuilds the lookup index and commits the import.
+         * @return False if the commit failed, the previous content is kept then.
+         */
+        bool commitImport();
+
+        /**
+         * @brief Discards everything written since beginImport().
+         */
+        void rollbackImport();
+
+        /**
+         * @brief Normalizes a lookup form: trims, collapses whitespace and lowercases ASCII letters.
+         */
+        static std::string normalizeForm(const std::string& form);
+
+    private:
+
+        bool initTables();
+        bool execute(const char* sql);
+        sqlite3_stmt* prepare(sqlite3_stmt*& statement, const char* sql);
+        int64_t count(const char* sql);
+        void finalizeStatements();
+
+        sqlite3* m_db;
+        std::mutex m_mutex; ///< Serializes access to the connection, lookups come from several threads.
+
+        sqlite3_stmt* m_findEntries = nullptr;
+        sqlite3_stmt* m_findKanji = nullptr;
+        sqlite3_stmt* m_insertEntry = nullptr;
+        sqlite3_stmt* m_insertForm = nullptr;
+        sqlite3_stmt* m_insertKanji = nullptr;
+    };
+}
@@ -0,0 +1,291 @@
+#include "TranslationCache.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <cctype>
+
+namespace tadaima
+{
+    namespace
+    {
+        constexpr char CONJUGATION_SEPARATOR = '\x1f';
+
+        enum Column
+        {
+            Kana = 0,
+            Kanji,
+            Translation,
+            Romaji,
+            Example,
+            ConjugationList
+        };
+
+        std::string columnText(sqlite3_stmt* stmt, int column)
+        {
+            const unsigned char* text = sqlite3_column_text(stmt, column);
+            return text ? reinterpret_cast<const char*>(text) : "";
+        }
+    }
+
+    TranslationCache::TranslationCache(const std::string& dbPath, std::chrono::seconds timeToLive)
+        : m_db(nullptr), m_timeToLive(timeToLive)
+    {
+        if( sqlite3_open(dbPath.c_str(), &m_db) != SQLITE_OK || !initTable() )
+        {
+            sqlite3_close(m_db);
+            m_db = nullptr;
+        }
+    }
+
+    TranslationCache::~TranslationCache()
+    {
+        if( m_db )
+        {
+            sqlite3_close(m_db);
+        }
+    }
+
+    bool TranslationCache::isOpen() const
+    {
+        return m_db != nullptr;
+    }
+
+    bool TranslationCache::initTable()
+    {
+        // The application database may hold a write lock while we read, wait for it instead of failing.
+        sqlite3_busy_timeout(m_db, 2000);
+
+        const char* createCacheTable =
+            "CREATE TABLE IF NOT EXISTS translation_cache ("
+            "script TEXT NOT NULL, "
+            "input TEXT NOT NULL, "
+            "kind INTEGER NOT NULL, "
+            "kana TEXT, "
+            "kanji TEXT, "
+            "translation TEXT, "
+            "romaji TEXT, "
+            "example_sentence TEXT, "
+            "conjugations TEXT, "
+            "created_at INTEGER NOT NULL, "
+            "PRIMARY KEY(script, input, kind));";
+
+        return sqlite3_exec(m_db, createCacheTable, 0, 0, nullptr) == SQLITE_OK;
+    }
+
+    std::optional<Word> TranslationCache::findTranslation(const std::string& script, const std::string& input)
+    {
+        std::array<std::string, 6> columns;
+        if( !findEntry(EntryKind::Translation, script, input, columns) )
+            return std::nullopt;
+
+        Word word;
+        word.kana = columns[Kana];
+        word.kanji = columns[Kanji];
+        word.translation = columns[Translation];
+        word.romaji = columns[Romaji];
+        word.exampleSentence = columns[Example];
+        return word;
+    }
+
+    void TranslationCache::storeTranslation(const std::string& script, const std::string& input, const Word& word)
+    {
+        std::array<std::string, 6> columns;
+        columns[Kana] = word.kana;
+        columns[Kanji] = word.kanji;
+        columns[Translation] = word.translation;
+        columns[Romaji] = word.romaji;
+        columns[Example] = word.exampleSentence;
+        storeEntry(EntryKind::Translation, script, input, columns);
+    }
+
+    std::optional<std::array<std::string, CONJUGATION_COUNT>> TranslationCache::findConjugations(const std::string& script, const std::string& input)
+    {
+        std::array<std::string, 6> columns;
+        if( !findEntry(EntryKind::Conjugation, script, input, columns) )
+            return std::nullopt;
+
+        std::array<std::string, CONJUGATION_COUNT> conjugations;
+        const std::string& joined = columns[ConjugationList];
+        size_t start = 0;
+        for( int index = 0; index < CONJUGATION_COUNT; ++index )
+        {
+            size_t end = joined.find(CONJUGATION_SEPARATOR, start);
+            if( end == std::string::npos )
+            {
+                conjugations[index] = joined.substr(start);
+                break;
+            }
+            conjugations[index] = joined.substr(start, end - start);
+            start = end + 1;
+        }
+        return conjugations;
+    }
+
+    void TranslationCache::storeConjugations(const std::string& script, const std::string& input, const std::array<std::string, CONJUGATION_COUNT>& conjugations)
+    {
+        std::array<std::string, 6> columns;
+        for( int index = 0; index < CONJUGATION_COUNT; ++index )
+        {
+            if( index > 0 )
+                columns[ConjugationList] += CONJUGATION_SEPARATOR;
+            columns[ConjugationList] += conjugations[index];
+        }
+        storeEntry(EntryKind::Conjugation, script, input, columns);
+    }
+
+    bool TranslationCache::findEntry(EntryKind kind, const std::string& script, const std::string& input, std::array<std::string, 6>& columns)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+        {
+            ++m_misses;
+            return false;
+        }
+
+        const char* sql =
+            "SELECT kana, kanji, translation, romaji, example_sentence, conjugations, created_at "
+            "FROM translation_cache WHERE script = ? AND input = ? AND kind = ?;";
+
+        sqlite3_stmt* stmt = nullptr;
+        if( sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK )
+        {
+            ++m_misses;
+            return false;
+        }
+
+        const std::string key = normalizeInput(input);
+        sqlite3_bind_text(stmt, 1, script.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, static_cast<int>(kind));
+
+        bool found = false;
+        if( sqlite3_step(stmt) == SQLITE_ROW )
+        {
+            const int64_t createdAt = sqlite3_column_int64(stmt, 6);
+            if( now() - createdAt > m_timeToLive.count() )
+            {
+                ++m_expired;
+            }
+            else
+            {
+                for( int column = 0; column < 6; ++column )
+                {
+                    columns[column] = columnText(stmt, column);
+                }
+                found = true;
+                ++m_hits;
+            }
+        }
+        else
+        {
+            ++m_misses;
+        }
+
+        sqlite3_finalize(stmt);
+        return found;
+    }
+
+    void TranslationCache::storeEntry(EntryKind kind, const std::string& script, const std::string& input, const std::array<std::string, 6>& columns)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return;
+
+        const char* sql =
+            "INSERT OR REPLACE INTO translation_cache "
+            "(script, input, kind, kana, kanji, translation, romaji, example_sentence, conjugations, created_at) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+
+        sqlite3_stmt* stmt = nullptr;
+        if( sqlite3_prepare_v2(m_db, sql, -1, &stmt, nullptr) != SQLITE_OK )
+            return;
+
+        const std::string key = normalizeInput(input);
+        sqlite3_bind_text(stmt, 1, script.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, key.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, static_cast<int>(kind));
+        for( int column = 0; column < 6; ++column )
+        {
+            sqlite3_bind_text(stmt, 4 + column, columns[column].c_str(), -1, SQLITE_TRANSIENT);
+        }
+        sqlite3_bind_int64(stmt, 10, now());
+
+        if( sqlite3_step(stmt) == SQLITE_DONE )
+        {
+            ++m_stores;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    void TranslationCache::setTimeToLive(std::chrono::seconds timeToLive)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timeToLive = timeToLive;
+    }
+
+    int TranslationCache::purgeExpired()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( !m_db )
+            return 0;
+
+        sqlite3_stmt* stmt = nullptr;
+        if( sqlite3_prepare_v2(m_db, "DELETE FROM translation_cache WHERE created_at < ?;", -1, &stmt, nullptr) != SQLITE_OK )
+            return 0;
+
+        sqlite3_bind_int64(stmt, 1, now() - m_timeToLive.count());
+        int removed = 0;
+        if( sqlite3_step(stmt) == SQLITE_DONE )
+        {
+            removed = sqlite3_changes(m_db);
+        }
+        sqlite3_finalize(stmt);
+        return removed;
+    }
+
+    void TranslationCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if( m_db )
+        {
+            sqlite3_exec(m_db, "DELETE FROM translation_cache;", 0, 0, nullptr);
+        }
+    }
+
+    TranslationCache::Statistics TranslationCache::getStatistics() const
+    {
+        Statistics statistics;
+        statistics.hits = m_hits.load();
+        statistics.misses = m_misses.load();
+        statistics.expired = m_expired.load();
+        statistics.stores = m_stores.load();
+        return statistics;
+    }
+
+    std::string TranslationCache::normalizeInput(const std::string& input)
+    {
+        std::string normalized;
+        normalized.reserve(input.size());
+
+        bool pendingSpace = false;
+        for( char c : input )
+        {
+            const unsigned char uc = static_cast<unsigned char>(c);
+            if( uc < 0x80 && std::isspace(uc) )
+            {
+                pendingSpace = !normalized.empty();
+                continue;
+            }
+            if( pendingSpace )
+            {
+                normalized += ' ';
+                pendingSpace = false;
+            }
+            normalized += (uc < 0x80) ? static_cast<char>(std::tolower(uc)) : c;
+        }
+        return normalized;
+    }
+
+    int64_t TranslationCache::now() const
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+}
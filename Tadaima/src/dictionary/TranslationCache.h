@@ -0,0 +1,164 @@
+/**
+ * @file TranslationCache.h
+ * @brief Defines the TranslationCache class, a persistent SQLite-backed cache for dictionary script results.
+ */
+
+#pragma once
+
+#include "Word.h"
+#include "Conjugations.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+struct sqlite3;
+
+namespace tadaima
+{
+    /**
+     * @class TranslationCache
+     * @brief Stores results of the translation and conjugation scripts so repeated lookups skip the subprocess.
+     *
+     * Entries are keyed by the script name and the normalized input word and live in the
+     * `translation_cache` table of the given database. Entries older than the time-to-live are
+     * treated as misses and overwritten on the next store. Any database failure degrades to a miss,
+     * so the dictionary keeps working without a cache.
+     */
+    class TranslationCache
+    {
+    public:
+
+        /**
+         * @brief Default lifetime of a cache entry (30 days).
+         */
+        static constexpr std::chrono::seconds DEFAULT_TIME_TO_LIVE = std::chrono::hours(24 * 30);
+
+        /**
+         * @brief Counters describing how the cache has been used since it was opened.
+         */
+        struct Statistics
+        {
+            uint64_t hits = 0;      ///< Lookups answered from the cache.
+            uint64_t misses = 0;    ///< Lookups that found no entry.
+            uint64_t expired = 0;   ///< Lookups that found an entry older than the time-to-live.
+            uint64_t stores = 0;    ///< Entries written to the cache.
+
+            /**
+             * @brief Returns the ratio of hits to all lookups, or 0 when nothing was looked up yet.
+             */
+            double hitRatio() const
+            {
+                const uint64_t lookups = hits + misses + expired;
+                return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+            }
+        };
+
+        /**
+         * @brief Opens (or creates) the cache table in the given database.
+         * @param dbPath The file path to the SQLite database.
+         * @param timeToLive How long an entry stays valid.
+         */
+        explicit TranslationCache(const std::string& dbPath, std::chrono::seconds timeToLive = DEFAULT_TIME_TO_LIVE);
+
+        /**
+         * @brief Closes the database connection.
+         */
+        ~TranslationCache();
+
+        TranslationCache(const TranslationCache&) = delete;
+        TranslationCache& operator=(const TranslationCache&) = delete;
+
+        /**
+         * @brief Checks whether the database was opened and the cache table is available.
+         * @return True if the cache can be used.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Looks up a cached translation.
+         * @param script The script that produced the entry (e.g. "Tangorin.py").
+         * @param input The word that was translated.
+         * @return The cached word, or std::nullopt on a miss.
+         */
+        std::optional<Word> findTranslation(const std::string& script, const std::string& input);
+
+        /**
+         * @brief Stores a translation result.
+         * @param script The script that produced the result.
+         * @param input The word that was translated.
+         * @param word The parsed translation.
+         */
+        void storeTranslation(const std::string& script, const std::string& input, const Word& word);
+
+        /**
+         * @brief Looks up cached conjugations.
+         * @param script The script that produced the entry.
+         * @param input The word that was conjugated.
+         * @return The cached conjugations, or std::nullopt on a miss.
+         */
+        std::optional<std::array<std::string, CONJUGATION_COUNT>> findConjugations(const std::string& script, const std::string& input);
+
+        /**
+         * @brief Stores a conjugation result.
+         * @param script The script that produced the result.
+         * @param input The word that was conjugated.
+         * @param conjugations The parsed conjugations.
+         */
+        void storeConjugations(const std::string& script, const std::string& input, const std::array<std::string, CONJUGATION_COUNT>& conjugations);
+
+        /**
+         * @brief Sets how long an entry stays valid.
+         * @param timeToLive The new lifetime; applies to existing entries too.
+         */
+        void setTimeToLive(std::chrono::seconds timeToLive);
+
+        /**
+         * @brief Removes all entries older than the time-to-live.
+         * @return The number of removed entries.
+         */
+        int purgeExpired();
+
+        /**
+         * @brief Removes all entries.
+         */
+        void clear();
+
+        /**
+         * @brief Returns a snapshot of the usage counters.
+         */
+        Statistics getStatistics() const;
+
+        /**
+         * @brief Normalizes a lookup key: trims and collapses ASCII whitespace and lowercases ASCII letters.
+         * @param input The raw input word.
+         * @return The normalized key. Non-ASCII (e.g. kana) bytes are kept as they are.
+         */
+        static std::string normalizeInput(const std::string& input);
+
+    private:
+
+        enum class EntryKind : int
+        {
+            Translation = 0,
+            Conjugation = 1
+        };
+
+        bool initTable();
+        bool findEntry(EntryKind kind, const std::string& script, const std::string& input, std::array<std::string, 6>& columns);
+        void storeEntry(EntryKind kind, const std::string& script, const std::string& input, const std::array<std::string, 6>& columns);
+        int64_t now() const;
+
+        sqlite3* m_db; ///< Own connection to the database, independent of ApplicationDatabase.
+        mutable std::mutex m_mutex; ///< Serializes access to the connection.
+        std::chrono::seconds m_timeToLive;
+
+        std::atomic<uint64_t> m_hits{ 0 };
+        std::atomic<uint64_t> m_misses{ 0 };
+        std::atomic<uint64_t> m_expired{ 0 };
+        std::atomic<uint64_t> m_stores{ 0 };
+    };
+}
@@ -0,0 +1,165 @@
+#include "Transliterator.h"
+#include <cstdint>
+#include <vector>
+
+namespace tadaima
+{
+    namespace
+    {
+        constexpr uint32_t HIRAGANA_FIRST = 0x3041; // ぁ
+        constexpr uint32_t HIRAGANA_LAST = 0x3096;  // ゖ
+        constexpr uint32_t KATAKANA_FIRST = 0x30A1; // ァ
+        constexpr uint32_t KATAKANA_LAST = 0x30F6;  // ヶ
+        constexpr uint32_t KATAKANA_OFFSET = KATAKANA_FIRST - HIRAGANA_FIRST;
+        constexpr uint32_t SMALL_TSU = 0x3063;      // っ
+        constexpr uint32_t LONG_VOWEL_MARK = 0x30FC; // ー
+        constexpr uint32_t SYLLABIC_N = 0x3093;     // ん
+
+        // Romaji of U+3041 (ぁ) to U+3096 (ゖ), in code point order. っ is handled separately.
+        const char* const HIRAGANA_ROMAJI[] = {
+            "a", "a", "i", "i", "u", "u", "e", "e", "o", "o",
+            "ka", "ga", "ki", "gi", "ku", "gu", "ke", "ge", "ko", "go",
+            "sa", "za", "shi", "ji", "su", "zu", "se", "ze", "so", "zo",
+            "ta", "da", "chi", "ji", "", "tsu", "zu", "te", "de", "to", "do",
+            "na", "ni", "nu", "ne", "no",
+            "ha", "ba", "pa", "hi", "bi", "pi", "fu", "bu", "pu", "he", "be", "pe", "ho", "bo", "po",
+            "ma", "mi", "mu", "me", "mo",
+            "ya", "ya", "yu", "yu", "yo", "yo",
+            "ra", "ri", "ru", "re", "ro",
+            "wa", "wa", "i", "e", "o", "n", "vu", "ka", "ke"
+        };
+
+        // Katakana-only syllables after ヶ: ヷ ヸ ヹ ヺ.
+        const char* const KATAKANA_V_ROMAJI[] = { "va", "vi", "ve", "vo" };
+
+        struct Syllable
+        {
+            std::string text;
+            bool kana = false;
+            bool syllabicN = false;
+        };
+
+        bool isVowel(char c)
+        {
+            return c == 'a' || c == 'i' || c == 'u' || c == 'e' || c == 'o';
+        }
+
+        bool endsWith(const std::string& text, const char* suffix)
+        {
+            const std::string tail(suffix);
+            return text.size() >= tail.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+        }
+
+        // Decodes one UTF-8 sequence. Invalid bytes are returned as they are, one at a time.
+        uint32_t decodeUtf8(const std::string& text, size_t& position, size_t& length)
+        {
+            const unsigned char lead = static_cast<unsigned char>(text[position]);
+            length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+            if( position + length > text.size() )
+                length = 1;
+            if( length == 1 )
+                return lead;
+
+            uint32_t codePoint = lead & (0xFF >> (length + 1));
+            for( size_t index = 1; index < length; ++index )
+            {
+                codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[position + index]) & 0x3F);
+            }
+            return codePoint;
+        }
+    }
+
+    std::string Transliterator::toRomaji(const std::string& kana)
+    {
+        std::vector<Syllable> syllables;
+        bool doubleNext = false;
+
+        for( size_t position = 0; position < kana.size(); )
+        {
+            size_t length = 1;
+            uint32_t codePoint = decodeUtf8(kana, position, length);
+            const std::string original = kana.substr(position, length);
+            position += length;
+
+            if( codePoint >= KATAKANA_FIRST && codePoint <= KATAKANA_LAST )
+                codePoint -= KATAKANA_OFFSET;
+
+            Syllable* previous = !syllables.empty() && syllables.back().kana ? &syllables.back() : nullptr;
+
+            if( codePoint == SMALL_TSU )
+            {
+                doubleNext = true;
+                continue;
+            }
+
+            if( codePoint == LONG_VOWEL_MARK )
+            {
+                if( previous && !previous->text.empty() && isVowel(previous->text.back()) )
+                    syllables.push_back({ std::string(1, previous->text.back()), true });
+                continue;
+            }
+
+            // Contracted sounds: き + ゃ → kya, し + ゃ → sha.
+            if( (codePoint == 0x3083 || codePoint == 0x3085 || codePoint == 0x3087) && previous
+                && previous->text.size() >= 2 && previous->text.back() == 'i' )
+            {
+                const char vowel = codePoint == 0x3083 ? 'a' : codePoint == 0x3085 ? 'u' : 'o';
+                previous->text.pop_back();
+                if( !endsWith(previous->text, "sh") && !endsWith(previous->text, "ch") && !endsWith(previous->text, "j") )
+                    previous->text += 'y';
+                previous->text += vowel;
+                continue;
+            }
+
+            // Small vowels of loan words: フ + ァ → fa, テ + ィ → ti, ウ + ィ → wi.
+            if( (codePoint == 0x3041 || codePoint == 0x3043 || codePoint == 0x3045 || codePoint == 0x3047 || codePoint == 0x3049)
+                && previous && !previous->syllabicN && !previous->text.empty() && isVowel(previous->text.back())
+                && (previous->text.size() >= 2 || previous->text == "u") )
+            {
+                const char vowel = HIRAGANA_ROMAJI[codePoint - HIRAGANA_FIRST][0];
+                if( previous->text == "u" )
+                    previous->text = "w";
+                else
+                    previous->text.pop_back();
+                previous->text += vowel;
+                continue;
+            }
+
+            Syllable syllable;
+            if( codePoint >= HIRAGANA_FIRST && codePoint <= HIRAGANA_LAST )
+            {
+                syllable.text = HIRAGANA_ROMAJI[codePoint - HIRAGANA_FIRST];
+                syllable.kana = true;
+                syllable.syllabicN = codePoint == SYLLABIC_N;
+            }
+            else if( codePoint >= 0x30F7 && codePoint <= 0x30FA )
+            {
+                syllable.text = KATAKANA_V_ROMAJI[codePoint - 0x30F7];
+                syllable.kana = true;
+            }
+            else
+            {
+                syllable.text = original;
+            }
+
+            if( doubleNext && syllable.kana && !syllable.syllabicN && !isVowel(syllable.text[0]) )
+                syllable.text.insert(0, 1, syllable.text.compare(0, 2, "ch") == 0 ? 't' : syllable.text[0]);
+            doubleNext = false;
+
+            syllables.push_back(std::move(syllable));
+        }
+
+        std::string romaji;
+        for( size_t index = 0; index < syllables.size(); ++index )
+        {
+            romaji += syllables[index].text;
+            if( syllables[index].syllabicN && index + 1 < syllables.size() && syllables[index + 1].kana )
+            {
+                const char next = syllables[index + 1].text[0];
+                if( isVowel(next) || next == 'y' )
+                    romaji += '\'';
+            }
+        }
+        return romaji;
+    }
+}
@@ -0,0 +1,32 @@
+/**
+ * @file Transliterator.h
+ * @brief Defines the Transliterator class, which converts kana to romaji without any script.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace tadaima
+{
+    /**
+     * @class Transliterator
+     * @brief Converts hiragana and katakana to Hepburn romaji.
+     *
+     * Handles the contracted sounds (きゃ → kya, しゃ → sha), the small vowels of loan words
+     * (ファ → fa, ティ → ti), the small tsu (がっこう → gakkou, まっちゃ → matcha), the long vowel
+     * mark (ラーメン → raamen) and an apostrophe after ん before a vowel or y (きんえん → kin'en).
+     * Long vowels are not merged and characters that are not kana are copied unchanged.
+     */
+    class Transliterator
+    {
+    public:
+
+        /**
+         * @brief Converts kana to romaji.
+         * @param kana UTF-8 text, typically a reading from the dictionary.
+         * @return The romanized text in lower case.
+         */
+        static std::string toRomaji(const std::string& kana);
+    };
+}
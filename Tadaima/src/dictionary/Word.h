@@ -67,6 +67,35 @@ namespace tadaima
         {
         }
 
+        /**
+         * @brief Copy assignment operator.
+         *
+         * Copies the properties of another `Word` instance.
+         *
+         * @param other The `Word` instance to copy from.
+         * @return A reference to this word.
+         */
+        Word& operator=(const Word& other) = default;
+
+        /**
+         * @brief Move constructor.
+         *
+         * Takes over the strings of another `Word` instance instead of copying them.
+         *
+         * @param other The `Word` instance to move from.
+         */
+        Word(Word&& other) noexcept = default;
+
+        /**
+         * @brief Move assignment operator.
+         *
+         * Takes over the strings of another `Word` instance instead of copying them.
+         *
+         * @param other The `Word` instance to move from.
+         * @return A reference to this word.
+         */
+        Word& operator=(Word&& other) noexcept = default;
+
         /**
          * @brief Equality operator.
          *
@@ -0,0 +1,285 @@
+#include "AnkiImporter.h"
+#include "Dictionary/Transliterator.h"
+#include "Tools/Database.h"
+#include <Libraries/SQLite3/sqlite3.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace tadaima
+{
+    namespace
+    {
+        // How many notes are read between two progress reports.
+        constexpr int PROGRESS_INTERVAL = 256;
+
+        // Anki separates the fields of a note with the unit separator.
+        constexpr char FIELD_SEPARATOR = '\x1f';
+
+        // The ideographic tilde Anki decks put in front of suffixes (～さん).
+        const std::string WAVE_DASH = "\xEF\xBD\x9E";
+
+        class Collection
+        {
+        public:
+            explicit Collection(const std::string& path)
+            {
+                if( sqlite3_open_v2(path.c_str(), &m_db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK )
+                {
+                    const std::string message = m_db ? sqlite3_errmsg(m_db) : "out of memory";
+                    sqlite3_close(m_db);
+                    throw std::runtime_error("Cannot open the Anki collection: " + message);
+                }
+            }
+
+            ~Collection()
+            {
+                sqlite3_finalize(m_stmt);
+                sqlite3_close(m_db);
+            }
+
+            Collection(const Collection&) = delete;
+            Collection& operator=(const Collection&) = delete;
+
+            int64_t countNotes()
+            {
+                prepare("SELECT COUNT(*) FROM notes;");
+                const int64_t count = sqlite3_step(m_stmt) == SQLITE_ROW ? sqlite3_column_int64(m_stmt, 0) : 0;
+                sqlite3_finalize(m_stmt);
+                m_stmt = nullptr;
+                return count;
+            }
+
+            void selectNotes()
+            {
+                prepare("SELECT flds, tags FROM notes ORDER BY id;");
+            }
+
+            // Steps to the next note, false after the last one.
+            bool next()
+            {
+                const int rc = sqlite3_step(m_stmt);
+                if( rc != SQLITE_ROW && rc != SQLITE_DONE )
+                    throw std::runtime_error("Cannot read the Anki collection: " + std::string(sqlite3_errmsg(m_db)));
+                return rc == SQLITE_ROW;
+            }
+
+            std::string column(int index) const
+            {
+                const unsigned char* text = sqlite3_column_text(m_stmt, index);
+                return text ? std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(m_stmt, index)) : std::string();
+            }
+
+        private:
+            void prepare(const char* sql)
+            {
+                sqlite3_finalize(m_stmt);
+                m_stmt = nullptr;
+                if( sqlite3_prepare_v2(m_db, sql, -1, &m_stmt, nullptr) != SQLITE_OK )
+                    throw std::runtime_error("Not an Anki collection: " + std::string(sqlite3_errmsg(m_db)));
+            }
+
+            sqlite3* m_db = nullptr;
+            sqlite3_stmt* m_stmt = nullptr;
+        };
+
+        std::vector<std::string> splitFields(const std::string& fields)
+        {
+            std::vector<std::string> result;
+            size_t start = 0;
+            while( true )
+            {
+                const size_t end = fields.find(FIELD_SEPARATOR, start);
+                result.push_back(fields.substr(start, end - start));
+                if( end == std::string::npos )
+                    break;
+                start = end + 1;
+            }
+            return result;
+        }
+
+        std::string field(const std::vector<std::string>& fields, int index)
+        {
+            return index >= 0 && static_cast<size_t>(index) < fields.size() ? AnkiImporter::fieldText(fields[index]) : std::string();
+        }
+
+        std::string trim(const std::string& text, const char* characters)
+        {
+            const size_t first = text.find_first_not_of(characters);
+            if( first == std::string::npos )
+                return {};
+            return text.substr(first, text.find_last_not_of(characters) - first + 1);
+        }
+
+        // Decks often list alternatives ("いく; ゆく"), only the first one is kept.
+        std::string firstAlternative(const std::string& text)
+        {
+            return text.substr(0, text.find(';'));
+        }
+
+        std::string cleanKana(std::string kana)
+        {
+            kana = trim(firstAlternative(kana), " ~");
+            while( kana.compare(0, WAVE_DASH.size(), WAVE_DASH) == 0 )
+                kana = trim(kana.substr(WAVE_DASH.size()), " ~");
+            return kana;
+        }
+
+        std::string cleanTranslation(const std::string& translation)
+        {
+            return trim(firstAlternative(translation), " .;");
+        }
+
+        std::vector<std::string> splitTags(const std::string& tags)
+        {
+            std::vector<std::string> result;
+            std::istringstream stream(tags);
+            std::string tag;
+            while( stream >> tag )
+                result.push_back(tag);
+            return result;
+        }
+
+        Word makeWord(const std::vector<std::string>& fields, const std::string& tags, const AnkiImporter::FieldMapping& mapping)
+        {
+            Word word;
+            word.kana = cleanKana(field(fields, mapping.kana));
+            word.kanji = field(fields, mapping.kanji);
+            word.translation = cleanTranslation(field(fields, mapping.translation));
+            word.romaji = field(fields, mapping.romaji);
+            word.exampleSentence = field(fields, mapping.exampleSentence);
+            if( word.romaji.empty() )
+                word.romaji = Transliterator::toRomaji(word.kana);
+            if( mapping.importTags )
+                word.tags = splitTags(tags);
+            return word;
+        }
+    }
+
+    AnkiImporter::Result AnkiImporter::importCollection(const std::string& collectionPath, Database& database, const Options& options,
+        ProgressCallback progress)
+    {
+        Collection collection(collectionPath);
+        const int64_t totalNotes = collection.countNotes();
+        collection.selectNotes();
+
+        if( !options.dryRun && !database.beginTransaction() )
+            throw std::runtime_error("Cannot write to the lesson database.");
+
+        Result result;
+        try
+        {
+            LessonUpserter upserter(database, options.dryRun);
+            Lesson lesson;
+            lesson.groupName = options.groupName;
+            lesson.mainName = options.mainName.empty() ? lessonNameFor(collectionPath) : options.mainName;
+            lesson.subName = options.subName;
+
+            // Words are upserted a few at a time as they are read, the notes are never all held in memory.
+            upserter.upsert(lesson);
+
+            int64_t notesRead = 0;
+            while( collection.next() )
+            {
+                const Word word = makeWord(splitFields(collection.column(0)), collection.column(1), options.fields);
+                if( word.kana.empty() && word.translation.empty() )
+                    ++result.skipped;
+                else
+                {
+                    lesson.words.push_back(word);
+                    ++result.words;
+                }
+
+                if( ++notesRead % PROGRESS_INTERVAL == 0 )
+                {
+                    upserter.upsert(lesson);
+                    lesson.words.clear();
+                    if( progress && !progress(notesRead, totalNotes) )
+                        throw std::runtime_error("The import was cancelled.");
+                }
+            }
+
+            upserter.upsert(lesson);
+            result.report = upserter.getReport();
+            if( progress && !progress(notesRead, totalNotes) )
+                throw std::runtime_error("The import was cancelled.");
+        }
+        catch( ... )
+        {
+            if( !options.dryRun )
+                database.rollbackTransaction();
+            throw;
+        }
+
+        if( !options.dryRun && !database.commitTransaction() )
+            throw std::runtime_error("Cannot write to the lesson database.");
+        return result;
+    }
+
+    std::string AnkiImporter::lessonNameFor(const std::string& collectionPath)
+    {
+        const std::filesystem::path path(collectionPath);
+        const std::string stem = path.stem().string();
+        if( stem == "collection" && path.parent_path().has_filename() )
+            return path.parent_path().filename().string();
+        return stem;
+    }
+
+    bool AnkiImporter::isCollectionPath(const std::string& path)
+    {
+        const std::string extension = std::filesystem::path(path).extension().string();
+        return extension.size() == std::strlen(FILE_EXTENSION)
+            && std::equal(extension.begin(), extension.end(), FILE_EXTENSION, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    }
+
+    std::string AnkiImporter::fieldText(const std::string& html)
+    {
+        static const std::pair<const char*, const char*> entities[] = {
+            { "&nbsp;", " " }, { "&amp;", "&" }, { "&lt;", "<" }, { "&gt;", ">" }, { "&quot;", "\"" }, { "&#39;", "'" }
+        };
+
+        std::string text;
+        text.reserve(html.size());
+        for( size_t i = 0; i < html.size(); ++i )
+        {
+            if( html[i] == '<' )
+            {
+                const size_t end = html.find('>', i);
+                if( end == std::string::npos )
+                    break;
+
+                // Line breaks and blocks separate words, other markup does not.
+                const std::string tag = html.substr(i + 1, std::min<size_t>(end - i - 1, 4));
+                if( tag.compare(0, 2, "br") == 0 || tag.compare(0, 3, "div") == 0 || tag.compare(0, 4, "/div") == 0 )
+                    text += ' ';
+                i = end;
+                continue;
+            }
+
+            if( html[i] == '&' )
+            {
+                bool decoded = false;
+                for( const auto& [entity, replacement] : entities )
+                {
+                    if( html.compare(i, std::strlen(entity), entity) == 0 )
+                    {
+                        text += replacement;
+                        i += std::strlen(entity) - 1;
+                        decoded = true;
+                        break;
+                    }
+                }
+                if( decoded )
+                    continue;
+            }
+
+            text += html[i];
+        }
+
+        return trim(text, " \t\r\n");
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file AnkiImporter.h
+ * @brief Defines the AnkiImporter class, which imports the notes of an Anki collection as a lesson.
+ */
+
+#pragma once
+
+#include "LessonUpserter.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace tadaima
+{
+    class Database;
+
+    /**
+     * @class AnkiImporter
+     * @brief Reads an extracted Anki collection (collection.anki2) and writes its notes as one lesson.
+     *
+     * The collection is opened read-only through its own SQLite connection. Each note becomes a word:
+     * the note fields are assigned to the word columns by a FieldMapping, HTML markup is removed and a
+     * missing romaji column is filled in with Transliterator. Anki tags become word tags. The notes are
+     * merged into an existing lesson of the same name by LessonUpserter, so importing a deck again only
+     * adds its new notes. The lesson is written in one transaction, so a failed import leaves the lesson
+     * database unchanged.
+     */
+    class AnkiImporter
+    {
+    public:
+
+        /**
+         * @brief Extension of Anki collection files.
+         */
+        static constexpr const char* FILE_EXTENSION = ".anki2";
+
+        /**
+         * @brief Which note field (by its position in the note type) fills which word column, -1 for none.
+         *
+         * The defaults match the common "Japanese, English" vocabulary decks.
+         */
+        struct FieldMapping
+        {
+            int kana = 0;
+            int translation = 1;
+            int kanji = -1;
+            int romaji = -1;            ///< Transliterated from the kana when unmapped or empty.
+            int exampleSentence = -1;
+            bool importTags = true;     ///< Copy the Anki tags of each note.
+        };
+
+        /**
+         * @brief What to import and where the lesson goes.
+         */
+        struct Options
+        {
+            FieldMapping fields;
+            std::string groupName = "Anki";
+            std::string mainName;               ///< Empty to name the lesson after the collection (see lessonNameFor()).
+            std::string subName = "vocabulary";
+            bool dryRun = false;                ///< Only report what the import would change.
+        };
+
+        /**
+         * @brief Number of notes imported and skipped.
+         */
+        struct Result
+        {
+            int64_t words = 0;
+            int64_t skipped = 0;  ///< Notes without kana and translation.
+            LessonUpserter::Report report;  ///< Added, updated and unchanged words.
+        };
+
+        /**
+         * @brief Called regularly with the number of notes read so far and the number of notes; returning false cancels the import.
+         */
+        using ProgressCallback = std::function<bool(int64_t notesRead, int64_t totalNotes)>;
+
+        /**
+         * @brief Imports a collection as one lesson.
+         * @param collectionPath The extracted collection.anki2 file.
+         * @param database The lesson database to write.
+         * @param options The field mapping and lesson names.
+         * @param progress Optional progress callback.
+         * @return The number of imported and skipped notes.
+         * @throws std::runtime_error if the collection cannot be read, the lesson cannot be written or the import was cancelled.
+         */
+        static Result importCollection(const std::string& collectionPath, Database& database, const Options& options,
+            ProgressCallback progress = nullptr);
+
+        /**
+         * @brief Names a lesson after a collection file: its file name, or its folder for the usual collection.anki2.
+         */
+        static std::string lessonNameFor(const std::string& collectionPath);
+
+        /**
+         * @brief Checks whether a path names an Anki collection (by its extension).
+         */
+        static bool isCollectionPath(const std::string& path);
+
+        /**
+         * @brief Turns the HTML of a note field into plain text.
+         *
+         * Tags are removed, line breaks become spaces, the common entities are decoded and the
+         * whitespace around the text is trimmed.
+         */
+        static std::string fieldText(const std::string& html);
+    };
+}
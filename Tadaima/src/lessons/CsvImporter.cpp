@@ -0,0 +1,345 @@
+#include "CsvImporter.h"
+#include "Dictionary/Transliterator.h"
+#include "Tools/MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace tadaima
+{
+    namespace
+    {
+        using Column = CsvImporter::Column;
+
+        const std::string_view BYTE_ORDER_MARK = "\xEF\xBB\xBF";
+
+        struct Row
+        {
+            std::string groupName;
+            std::string mainName;
+            std::string subName;
+            Word word;
+        };
+
+        std::string toLower(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return text;
+        }
+
+        std::string trim(std::string_view text)
+        {
+            const size_t first = text.find_first_not_of(" \t");
+            if( first == std::string_view::npos )
+                return {};
+            return std::string(text.substr(first, text.find_last_not_of(" \t") - first + 1));
+        }
+
+        void splitTags(const std::string& text, std::vector<std::string>& tags)
+        {
+            size_t start = 0;
+            while( start < text.size() )
+            {
+                size_t end = text.find_first_of(" ;", start);
+                if( end == std::string::npos )
+                    end = text.size();
+                if( end > start )
+                    tags.push_back(text.substr(start, end - start));
+                start = end + 1;
+            }
+        }
+
+        // Cuts text into pieces of about chunkSize bytes that end after a line break outside quotes.
+        std::vector<size_t> findChunkEnds(std::string_view text, size_t chunkSize)
+        {
+            std::vector<size_t> ends;
+            bool quoted = false;
+            size_t position = 0;
+            while( position < text.size() )
+            {
+                const size_t target = std::min(text.size(), position + std::max<size_t>(chunkSize, 1));
+                if( std::count(text.begin() + position, text.begin() + target, '"') % 2 )
+                    quoted = !quoted;
+                position = target;
+
+                while( position < text.size() )
+                {
+                    const char c = text[position++];
+                    if( c == '"' )
+                        quoted = !quoted;
+                    else if( c == '\n' && !quoted )
+                        break;
+                }
+                ends.push_back(position);
+            }
+            return ends;
+        }
+
+        std::vector<Row> parseChunk(std::string_view text, char delimiter, const std::vector<Column>& columns, const CsvImporter::Options& options,
+            const std::string& mainName)
+        {
+            std::vector<Row> rows;
+            std::vector<std::string> fields;
+            while( CsvImporter::readRecord(text, delimiter, fields) )
+            {
+                Row row;
+                row.groupName = options.groupName;
+                row.mainName = mainName;
+                row.subName = options.subName;
+
+                Word& word = row.word;
+                const size_t count = std::min(fields.size(), columns.size());
+                for( size_t i = 0; i < count; ++i )
+                {
+                    std::string& field = fields[i];
+                    switch( columns[i] )
+                    {
+                        case Column::Kana: word.kana = std::move(field); break;
+                        case Column::Kanji: word.kanji = std::move(field); break;
+                        case Column::Translation: word.translation = std::move(field); break;
+                        case Column::Romaji: word.romaji = std::move(field); break;
+                        case Column::Example: word.exampleSentence = std::move(field); break;
+                        case Column::Tags: splitTags(field, word.tags); break;
+                        case Column::Group: if( !field.empty() ) row.groupName = std::move(field); break;
+                        case Column::Lesson: if( !field.empty() ) row.mainName = std::move(field); break;
+                        case Column::SubLesson: if( !field.empty() ) row.subName = std::move(field); break;
+                        case Column::Ignore: break;
+                    }
+                }
+
+                // Blank lines and rows of empty cells.
+                if( word.kana.empty() && word.kanji.empty() && word.translation.empty() )
+                    continue;
+
+                if( word.romaji.empty() )
+                    word.romaji = Transliterator::toRomaji(word.kana);
+                rows.push_back(std::move(row));
+            }
+            return rows;
+        }
+    }
+
+    LessonImporter::Result CsvImporter::importFile(const std::string& filePath, const Options& options,
+        const LessonImporter::BatchCallback& onBatch, LessonImporter::ProgressCallback progress, size_t batchSize)
+    {
+        LessonImporter::Result result;
+        std::error_code error;
+        if( std::filesystem::file_size(filePath, error) == 0 && !error )
+            return result;
+
+        tools::MappedFile file;
+        if( !file.open(filePath) )
+            throw std::runtime_error("Cannot open " + filePath + ".");
+
+        std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+        if( text.substr(0, BYTE_ORDER_MARK.size()) == BYTE_ORDER_MARK )
+            text.remove_prefix(BYTE_ORDER_MARK.size());
+
+        std::vector<Column> columns = options.columns;
+        if( options.hasHeader )
+        {
+            std::vector<std::string> header;
+            readRecord(text, options.delimiter, header);
+            if( columns.empty() )
+            {
+                for( const auto& name : header )
+                    columns.push_back(columnFromName(name));
+            }
+        }
+
+        const bool mapped = std::any_of(columns.begin(), columns.end(), [](Column column)
+            {
+                return column == Column::Kana || column == Column::Kanji || column == Column::Translation;
+            });
+        if( !mapped )
+            throw std::runtime_error("No kana, kanji or translation column in " + filePath + ".");
+
+        const std::string mainName = options.mainName.empty() ? std::filesystem::path(filePath).stem().string() : options.mainName;
+        const size_t offset = file.size() - text.size();
+        const std::vector<size_t> ends = findChunkEnds(text, options.chunkSize);
+        const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+        batchSize = std::max<size_t>(batchSize, 1);
+        LessonImporter::Batch batch;
+        size_t items = 0;
+        uint64_t bytesRead = offset;
+        Row previous;
+        bool hasPrevious = false;
+
+        const auto handOver = [&]()
+            {
+                if( !batch.lessons.empty() )
+                    onBatch(batch);
+                batch.lessons.clear();
+                batch.continuesLesson = false;
+                items = 0;
+
+                if( progress && !progress(bytesRead) )
+                    throw std::runtime_error("The import was cancelled.");
+            };
+
+        for( size_t window = 0; window < ends.size(); window += threads )
+        {
+            // Parse a window of chunks in parallel, then hand their rows over in file order.
+            std::vector<std::future<std::vector<Row>>> parsed;
+            const size_t windowEnd = std::min(ends.size(), window + threads);
+            for( size_t chunk = window; chunk < windowEnd; ++chunk )
+            {
+                const size_t begin = chunk == 0 ? 0 : ends[chunk - 1];
+                parsed.push_back(std::async(std::launch::async, parseChunk, text.substr(begin, ends[chunk] - begin), options.delimiter,
+                    std::cref(columns), std::cref(options), std::cref(mainName)));
+            }
+
+            for( size_t chunk = window; chunk < windowEnd; ++chunk )
+            {
+                std::vector<Row> rows = parsed[chunk - window].get();
+                bytesRead = offset + ends[chunk];
+
+                for( auto& row : rows )
+                {
+                    const bool sameLesson = hasPrevious && row.groupName == previous.groupName && row.mainName == previous.mainName
+                        && row.subName == previous.subName;
+
+                    if( !sameLesson || items >= batchSize )
+                    {
+                        if( items >= batchSize )
+                            handOver();
+
+                        Lesson lesson;
+                        lesson.groupName = row.groupName;
+                        lesson.mainName = row.mainName;
+                        lesson.subName = row.subName;
+                        batch.lessons.push_back(std::move(lesson));
+                        if( sameLesson )
+                            batch.continuesLesson = true;
+                        else
+                        {
+                            ++items;
+                            ++result.lessons;
+                        }
+                    }
+
+                    batch.lessons.back().words.push_back(std::move(row.word));
+                    ++items;
+                    ++result.words;
+
+                    previous.groupName = std::move(row.groupName);
+                    previous.mainName = std::move(row.mainName);
+                    previous.subName = std::move(row.subName);
+                    hasPrevious = true;
+                }
+            }
+        }
+
+        handOver();
+        return result;
+    }
+
+    CsvImporter::Options CsvImporter::optionsFor(const std::string& filePath)
+    {
+        Options options;
+        if( toLower(std::filesystem::path(filePath).extension().string()) == ".tsv" )
+            options.delimiter = '\t';
+        return options;
+    }
+
+    std::vector<CsvImporter::Column> CsvImporter::parseMapping(const std::string& spec)
+    {
+        std::vector<Column> columns;
+        size_t start = 0;
+        while( start <= spec.size() )
+        {
+            size_t end = spec.find(',', start);
+            if( end == std::string::npos )
+                end = spec.size();
+            columns.push_back(columnFromName(trim(std::string_view(spec).substr(start, end - start))));
+            start = end + 1;
+        }
+        return columns;
+    }
+
+    CsvImporter::Column CsvImporter::columnFromName(const std::string& name)
+    {
+        static const std::pair<const char*, Column> names[] = {
+            { "kana", Column::Kana }, { "kanji", Column::Kanji }, { "translation", Column::Translation },
+            { "romaji", Column::Romaji }, { "example", Column::Example }, { "example sentence", Column::Example },
+            { "examplesentence", Column::Example }, { "tags", Column::Tags }, { "tag", Column::Tags },
+            { "group", Column::Group }, { "groupname", Column::Group }, { "lesson", Column::Lesson },
+            { "mainname", Column::Lesson }, { "sublesson", Column::SubLesson }, { "subname", Column::SubLesson }
+        };
+
+        const std::string key = toLower(trim(name));
+        for( const auto& [text, column] : names )
+        {
+            if( key == text )
+                return column;
+        }
+        return Column::Ignore;
+    }
+
+    bool CsvImporter::isCsvPath(const std::string& path)
+    {
+        const std::string extension = toLower(std::filesystem::path(path).extension().string());
+        return extension == ".csv" || extension == ".tsv";
+    }
+
+    bool CsvImporter::readRecord(std::string_view& text, char delimiter, std::vector<std::string>& fields)
+    {
+        fields.clear();
+        if( text.empty() )
+            return false;
+
+        const size_t size = text.size();
+        size_t i = 0;
+        std::string field;
+        while( true )
+        {
+            field.clear();
+            if( i < size && text[i] == '"' )
+            {
+                ++i;
+                while( i < size )
+                {
+                    const size_t quote = std::min(text.find('"', i), size);
+                    field.append(text.substr(i, quote - i));
+                    i = quote;
+                    if( i < size && i + 1 < size && text[i + 1] == '"' )
+                    {
+                        field += '"';
+                        i += 2;
+                    }
+                    else if( i < size )
+                    {
+                        ++i;
+                        break;
+                    }
+                }
+            }
+
+            // Unquoted text, or anything after a closing quote (kept instead of failing the row).
+            size_t end = i;
+            while( end < size && text[end] != delimiter && text[end] != '\n' && text[end] != '\r' )
+                ++end;
+            field.append(text.substr(i, end - i));
+            i = end;
+            fields.push_back(std::move(field));
+
+            if( i < size && text[i] == delimiter )
+            {
+                ++i;
+                continue;
+            }
+            if( i < size && text[i] == '\r' )
+                ++i;
+            if( i < size && text[i] == '\n' )
+                ++i;
+            break;
+        }
+
+        text.remove_prefix(i);
+        return true;
+    }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file CsvImporter.h
+ * @brief Defines the CsvImporter class, which imports vocabulary lists from CSV and TSV files.
+ */
+
+#pragma once
+
+#include "LessonImporter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tadaima
+{
+    /**
+     * @class CsvImporter
+     * @brief Parses CSV (RFC 4180) and TSV vocabulary lists on several threads and hands them over like LessonImporter.
+     *
+     * Each row becomes a word; a column mapping tells which column fills which Word field. Rows may name
+     * their lesson in group/lesson/sublesson columns, consecutive rows with the same names form one lesson.
+     * Rows without lesson columns go to the lesson named in the Options.
+     *
+     * The file is memory-mapped and cut into chunks at row boundaries. A window of chunks is parsed in
+     * parallel, then its rows are handed over in file order, so memory use stays bounded for any file size.
+     * Quoted fields may contain delimiters, doubled quotes and line breaks; a UTF-8 byte order mark is skipped.
+     */
+    class CsvImporter
+    {
+    public:
+
+        /**
+         * @brief What a column holds.
+         */
+        enum class Column
+        {
+            Ignore,
+            Kana,
+            Kanji,
+            Translation,
+            Romaji,          ///< Transliterated from the kana when empty.
+            Example,
+            Tags,            ///< Several tags are separated by spaces or semicolons.
+            Group,
+            Lesson,
+            SubLesson
+        };
+
+        /**
+         * @brief How a file is read.
+         */
+        struct Options
+        {
+            char delimiter = ',';
+            bool hasHeader = true;        ///< The first row names the columns (and is not imported).
+            std::vector<Column> columns;  ///< Empty to take the mapping from the header row.
+            std::string groupName = "Imported";
+            std::string mainName;         ///< Empty to name the lesson after the file.
+            std::string subName = "vocabulary";
+            size_t chunkSize = 4 * 1024 * 1024;  ///< Bytes parsed by one thread at a time.
+        };
+
+        /**
+         * @brief Parses a file and hands its words over in batches.
+         * @param filePath The CSV or TSV file.
+         * @param options How to read the file.
+         * @param onBatch Receives the batches in file order.
+         * @param progress Optional progress callback.
+         * @param batchSize Maximum number of lessons and words in one batch.
+         * @return The number of lessons and words.
+         * @throws std::runtime_error if the file cannot be read, no column is mapped or the import was cancelled.
+         */
+        static LessonImporter::Result importFile(const std::string& filePath, const Options& options,
+            const LessonImporter::BatchCallback& onBatch, LessonImporter::ProgressCallback progress = nullptr,
+            size_t batchSize = LessonImporter::DEFAULT_BATCH_SIZE);
+
+        /**
+         * @brief Returns the default options for a file: tab-separated for *.tsv, comma-separated otherwise.
+         */
+        static Options optionsFor(const std::string& filePath);
+
+        /**
+         * @brief Parses a column mapping such as "kana, translation, -, tags".
+         *
+         * Names are those of the header row (see columnFromName()), "-" or an unknown name skips the column.
+         */
+        static std::vector<Column> parseMapping(const std::string& spec);
+
+        /**
+         * @brief Recognizes a column name, case-insensitively. Besides the enumerator names, "example sentence",
+         *        "tag", "groupName", "mainName" and "subName" are accepted.
+         * @return Column::Ignore if the name is unknown.
+         */
+        static Column columnFromName(const std::string& name);
+
+        /**
+         * @brief Checks whether a path names a CSV or TSV file (by its extension).
+         */
+        static bool isCsvPath(const std::string& path);
+
+        /**
+         * @brief Splits one record off the front of CSV text.
+         * @param text The text, advanced past the record and its line break.
+         * @param delimiter The field delimiter.
+         * @param fields Receives the unquoted fields.
+         * @return False if the text was empty.
+         */
+        static bool readRecord(std::string_view& text, char delimiter, std::vector<std::string>& fields);
+    };
+}
@@ -0,0 +1,43 @@
+/**
+ * @file LessonChanges.h
+ * @brief Defines the LessonTombstone and LessonChanges structs describing changes of a lesson database.
+ */
+
+#pragma once
+
+#include "Lesson.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tadaima
+{
+    /**
+     * @brief Records a deleted lesson, or a deleted word of a lesson.
+     *
+     * Lessons and words are identified by content instead of by their IDs, which differ between
+     * databases: a lesson by its names, a word by its lesson and its WordFingerprint.
+     */
+    struct LessonTombstone
+    {
+        std::string groupName;  /**< The group name of the lesson. */
+        std::string mainName;   /**< The main name of the lesson. */
+        std::string subName;    /**< The sub name of the lesson. */
+        bool wholeLesson = true; /**< True if the lesson was deleted, false if only the word was. */
+        uint64_t fingerprint = 0; /**< The WordFingerprint of the deleted word. */
+        int64_t version = 0;    /**< The database version of the deletion. */
+
+        bool operator==(const LessonTombstone& other) const = default;
+    };
+
+    /**
+     * @brief The changes of a lesson database after a version (see Database::getChangesSince()).
+     */
+    struct LessonChanges
+    {
+        int64_t sinceVersion = -1; /**< The changes are those after this version, -1 for the whole database. */
+        int64_t version = 0;       /**< The database version the changes lead to. */
+        std::vector<LessonTombstone> tombstones; /**< Deletions, in the order they happened. */
+        std::vector<Lesson> lessons; /**< New or renamed lessons and lessons with changed words; only the changed words are listed. */
+    };
+}
@@ -0,0 +1,240 @@
+#include "LessonExporter.h"
+#include "LessonPack.h"
+#include "Tools/XmlWriter.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace tadaima
+{
+    namespace
+    {
+        // How many words are written between two progress reports.
+        constexpr int PROGRESS_INTERVAL = 256;
+
+        // Size of the output file buffer.
+        constexpr size_t FILE_BUFFER_SIZE = 256 * 1024;
+
+        void writeWord(tools::XmlWriter& writer, const Word& word)
+        {
+            writer.startElement("word");
+            writer.attribute("translation", word.translation);
+            writer.attribute("romaji", word.romaji);
+            writer.attribute("kana", word.kana);
+            writer.attribute("kanji", word.kanji);
+            writer.attribute("example", word.exampleSentence);
+
+            for( const auto& tag : word.tags )
+            {
+                writer.startElement("tag");
+                writer.attribute("name", tag);
+                writer.endElement();
+            }
+
+            for( size_t i = 0; i < word.conjugations.size(); ++i )
+            {
+                if( word.conjugations[i].empty() )
+                    continue;
+
+                writer.startElement("conjugation");
+                writer.attribute("index", std::to_string(i));
+                writer.attribute("value", word.conjugations[i]);
+                writer.endElement();
+            }
+
+            writer.endElement();
+        }
+
+        void writeLessons(tools::XmlWriter& writer, const std::vector<Lesson>& lessons, const LessonExporter::ProgressCallback& progress)
+        {
+            int64_t wordsWritten = 0;
+            int sinceReport = 0;
+            for( const auto& lesson : lessons )
+            {
+                writer.startElement("lesson");
+                writer.attribute("groupName", lesson.groupName);
+                writer.attribute("mainName", lesson.mainName);
+                writer.attribute("subName", lesson.subName);
+
+                for( const auto& word : lesson.words )
+                {
+                    writeWord(writer, word);
+                    ++wordsWritten;
+
+                    if( progress && ++sinceReport == PROGRESS_INTERVAL )
+                    {
+                        sinceReport = 0;
+                        if( !progress(wordsWritten) )
+                            throw std::runtime_error("The export was cancelled.");
+                    }
+                }
+                writer.endElement();
+            }
+
+            if( !writer.finish() )
+                throw std::runtime_error("Cannot write the lesson file.");
+            if( progress && !progress(wordsWritten) )
+                throw std::runtime_error("The export was cancelled.");
+        }
+
+        // Writes a file under a temporary name and renames it when complete.
+        void replaceFile(const std::string& filePath, const std::function<void(std::ostream&)>& write)
+        {
+            const std::string temporaryPath = filePath + ".part";
+            try
+            {
+                {
+                    auto buffer = std::make_unique<char[]>(FILE_BUFFER_SIZE);
+                    std::ofstream output;
+                    output.rdbuf()->pubsetbuf(buffer.get(), FILE_BUFFER_SIZE);
+                    output.open(temporaryPath, std::ios::binary | std::ios::trunc);
+                    if( !output )
+                        throw std::runtime_error("Cannot create " + filePath + ".");
+
+                    write(output);
+                }
+
+                std::error_code error;
+                std::filesystem::rename(temporaryPath, filePath, error);
+                if( error )
+                    throw std::runtime_error("Cannot replace " + filePath + ": " + error.message());
+            }
+            catch( ... )
+            {
+                std::error_code ignored;
+                std::filesystem::remove(temporaryPath, ignored);
+                throw;
+            }
+        }
+    }
+
+    LessonExporter::~LessonExporter()
+    {
+        cancel();
+        wait();
+    }
+
+    bool LessonExporter::start(const std::string& filePath, std::vector<Lesson> lessons)
+    {
+        if( isRunning() )
+            return false;
+        wait();
+
+        Progress progress;
+        for( const auto& lesson : lessons )
+        {
+            progress.totalWords += static_cast<int64_t>(lesson.words.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress = progress;
+        }
+
+        m_cancelled = false;
+        m_running = true;
+        m_thread = std::thread(&LessonExporter::run, this, filePath, std::move(lessons));
+        return true;
+    }
+
+    LessonExporter::Progress LessonExporter::getProgress() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_progress;
+    }
+
+    bool LessonExporter::isRunning() const
+    {
+        return m_running;
+    }
+
+    void LessonExporter::cancel()
+    {
+        m_cancelled = true;
+    }
+
+    void LessonExporter::wait()
+    {
+        if( m_thread.joinable() )
+            m_thread.join();
+    }
+
+    void LessonExporter::run(std::string filePath, std::vector<Lesson> lessons)
+    {
+        std::string error;
+        try
+        {
+            exportFile(filePath, lessons, [this](int64_t wordsWritten)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_progress.wordsWritten = wordsWritten;
+                    return !m_cancelled.load();
+                });
+        }
+        catch( const std::exception& e )
+        {
+            error = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress.finished = true;
+            m_progress.error = error;
+        }
+        m_running = false;
+    }
+
+    void LessonExporter::exportStream(std::ostream& output, const std::vector<Lesson>& lessons, ProgressCallback progress)
+    {
+        tools::XmlWriter writer(output);
+        writer.startElement("lessons");
+        writeLessons(writer, lessons, progress);
+    }
+
+    void LessonExporter::exportChanges(std::ostream& output, const LessonChanges& changes)
+    {
+        tools::XmlWriter writer(output);
+        writer.startElement("lessons");
+        writer.attribute("sinceVersion", std::to_string(changes.sinceVersion));
+        writer.attribute("version", std::to_string(changes.version));
+
+        for( const auto& tombstone : changes.tombstones )
+        {
+            writer.startElement("deleted");
+            writer.attribute("groupName", tombstone.groupName);
+            writer.attribute("mainName", tombstone.mainName);
+            writer.attribute("subName", tombstone.subName);
+            if( !tombstone.wholeLesson )
+                writer.attribute("fingerprint", std::to_string(tombstone.fingerprint));
+            writer.attribute("version", std::to_string(tombstone.version));
+            writer.endElement();
+        }
+
+        writeLessons(writer, changes.lessons, nullptr);
+    }
+
+    void LessonExporter::exportChangesFile(const std::string& filePath, const LessonChanges& changes)
+    {
+        replaceFile(filePath, [&changes](std::ostream& output) { exportChanges(output, changes); });
+    }
+
+    void LessonExporter::exportFile(const std::string& filePath, const std::vector<Lesson>& lessons, ProgressCallback progress)
+    {
+        if( LessonPack::isPackPath(filePath) )
+        {
+            // A pack is built in memory in one go, so progress is only reported at the end.
+            LessonPack::writeFile(filePath, lessons);
+            if( progress )
+            {
+                int64_t words = 0;
+                for( const auto& lesson : lessons )
+                    words += static_cast<int64_t>(lesson.words.size());
+                progress(words);
+            }
+            return;
+        }
+
+        replaceFile(filePath, [&lessons, &progress](std::ostream& output) { exportStream(output, lessons, progress); });
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * @file LessonExporter.h
+ * @brief Defines the LessonExporter class, which writes lessons to an XML file as it walks them.
+ */
+
+#pragma once
+
+#include "LessonChanges.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tadaima
+{
+    /**
+     * @class LessonExporter
+     * @brief Exports lessons in the format read by LessonImporter, without building a DOM.
+     *
+     * Each word is written to a buffered stream as soon as it is visited. Conjugations are stored with
+     * their index and value, so only the non-empty ones are written and the export round-trips exactly.
+     *
+     * A delta file (see exportChanges()) has the same format: its root names the versions it spans and a
+     * <deleted> element precedes the lessons for each tombstone. Readers that do not know deltas skip those
+     * elements and merge the lessons like a full export.
+     */
+    class LessonExporter
+    {
+    public:
+
+        /**
+         * @brief Progress of a background export.
+         */
+        struct Progress
+        {
+            int64_t wordsWritten = 0;  ///< Words written so far.
+            int64_t totalWords = 0;    ///< Words of all exported lessons.
+            bool finished = false;     ///< True once the export ended, successfully or not.
+            std::string error;         ///< Why the export failed, empty on success.
+        };
+
+        /**
+         * @brief Called regularly with the number of words written; returning false cancels the export.
+         */
+        using ProgressCallback = std::function<bool(int64_t wordsWritten)>;
+
+        LessonExporter() = default;
+
+        /**
+         * @brief Cancels a running export and waits for it.
+         */
+        ~LessonExporter();
+
+        LessonExporter(const LessonExporter&) = delete;
+        LessonExporter& operator=(const LessonExporter&) = delete;
+
+        /**
+         * @brief Exports lessons to a file on a background thread.
+         *
+         * The file is written under a temporary name and renamed when complete, so a failed or cancelled
+         * export never leaves a truncated file behind.
+         *
+         * @param filePath The file to write, a lesson pack if it has the LessonPack extension and XML otherwise.
+         * @param lessons The lessons, owned by the export thread until it finishes.
+         * @return False if an export is still running.
+         */
+        bool start(const std::string& filePath, std::vector<Lesson> lessons);
+
+        /**
+         * @brief Returns the progress of the current (or last) export.
+         */
+        Progress getProgress() const;
+
+        /**
+         * @brief Checks whether an export is running.
+         */
+        bool isRunning() const;
+
+        /**
+         * @brief Requests the running export to stop.
+         */
+        void cancel();
+
+        /**
+         * @brief Waits until the export has finished.
+         */
+        void wait();
+
+        /**
+         * @brief Writes lessons as an XML document.
+         * @param output The stream to write.
+         * @param lessons The lessons to export.
+         * @param progress Optional progress callback.
+         * @throws std::runtime_error if the stream fails or the export was cancelled.
+         */
+        static void exportStream(std::ostream& output, const std::vector<Lesson>& lessons, ProgressCallback progress = nullptr);
+
+        /**
+         * @brief Writes lessons to an XML file or lesson pack, see start() for how the file is replaced.
+         * @throws std::runtime_error if the file cannot be written or the export was cancelled.
+         */
+        static void exportFile(const std::string& filePath, const std::vector<Lesson>& lessons, ProgressCallback progress = nullptr);
+
+        /**
+         * @brief Writes the changes of a database as an XML delta document.
+         * @param output The stream to write.
+         * @param changes The changes, see Database::getChangesSince().
+         * @throws std::runtime_error if the stream fails.
+         */
+        static void exportChanges(std::ostream& output, const LessonChanges& changes);
+
+        /**
+         * @brief Writes the changes of a database to an XML delta file, replaced like by exportFile().
+         * @throws std::runtime_error if the file cannot be written.
+         */
+        static void exportChangesFile(const std::string& filePath, const LessonChanges& changes);
+
+    private:
+
+        void run(std::string filePath, std::vector<Lesson> lessons);
+
+        std::atomic<bool> m_running{ false };
+        std::atomic<bool> m_cancelled{ false };
+        mutable std::mutex m_mutex;
+        Progress m_progress;
+        std::thread m_thread;
+    };
+}
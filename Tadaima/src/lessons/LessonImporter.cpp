@@ -0,0 +1,478 @@
+#include "LessonImporter.h"
+#include "AnkiImporter.h"
+#include "CsvImporter.h"
+#include "LessonPack.h"
+#include "Tools/Database.h"
+#include "Tools/XmlPullParser.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace tadaima
+{
+    namespace
+    {
+        using tools::XmlPullParser;
+        using Event = XmlPullParser::Event;
+
+        [[noreturn]] void throwParseError(const XmlPullParser& parser)
+        {
+            throw std::runtime_error("Malformed lesson file: " + parser.getError());
+        }
+
+        // Returns the conjugation index stored in the file, or count if it is not a valid index.
+        size_t toIndex(const std::string& text, size_t count)
+        {
+            try
+            {
+                const int index = std::stoi(text);
+                return index >= 0 && static_cast<size_t>(index) < count ? static_cast<size_t>(index) : count;
+            }
+            catch( const std::exception& )
+            {
+                return count;
+            }
+        }
+
+        // Parses one <word>; the parser stands on its start tag and ends on its end tag.
+        Word readWord(XmlPullParser& parser)
+        {
+            Word word;
+            word.translation = parser.getAttribute("translation");
+            word.romaji = parser.getAttribute("romaji");
+            word.kana = parser.getAttribute("kana");
+            word.kanji = parser.getAttribute("kanji");
+            word.exampleSentence = parser.getAttribute("example");
+
+            size_t conjugation = 0;
+            const int depth = parser.getDepth();
+            while( true )
+            {
+                Event event = parser.next();
+                if( event == Event::Error || event == Event::EndDocument )
+                    throwParseError(parser);
+                if( event == Event::EndElement && parser.getDepth() < depth )
+                    break;
+                if( event != Event::StartElement )
+                    continue;
+
+                const std::string& name = parser.getName();
+                if( name == "tag" )
+                {
+                    word.tags.push_back(parser.getAttribute("name"));
+                    parser.skipElement();
+                }
+                else if( name == "conjugation" )
+                {
+                    const std::string* index = parser.findAttribute("index");
+                    if( index )
+                        conjugation = toIndex(*index, word.conjugations.size());
+
+                    // Files written before the value attribute existed keep the conjugation in the element text.
+                    const std::string* value = parser.findAttribute("value");
+                    std::string text = value ? *value : parser.readElementText();
+                    if( value )
+                        parser.skipElement();
+
+                    if( conjugation < word.conjugations.size() )
+                        word.conjugations[conjugation++] = std::move(text);
+                }
+                else
+                    parser.skipElement();
+            }
+            return word;
+        }
+
+        LessonTombstone makeTombstone(const XmlPullParser& parser)
+        {
+            LessonTombstone tombstone;
+            tombstone.groupName = parser.getAttribute("groupName");
+            tombstone.mainName = parser.getAttribute("mainName");
+            tombstone.subName = parser.getAttribute("subName");
+
+            try
+            {
+                const std::string* fingerprint = parser.findAttribute("fingerprint");
+                tombstone.wholeLesson = fingerprint == nullptr;
+                if( fingerprint )
+                    tombstone.fingerprint = std::stoull(*fingerprint);
+                const std::string* version = parser.findAttribute("version");
+                if( version )
+                    tombstone.version = std::stoll(*version);
+            }
+            catch( const std::exception& )
+            {
+                throw std::runtime_error("Malformed lesson file: invalid deletion of " + tombstone.mainName + ".");
+            }
+            return tombstone;
+        }
+
+        Lesson makeLesson(const XmlPullParser& parser)
+        {
+            Lesson lesson;
+            lesson.groupName = parser.getAttribute("groupName");
+            lesson.mainName = parser.getAttribute("mainName");
+            lesson.subName = parser.getAttribute("subName");
+            return lesson;
+        }
+    }
+
+    LessonImporter::~LessonImporter()
+    {
+        cancel();
+        wait();
+    }
+
+    bool LessonImporter::start(const std::string& filePath, std::shared_ptr<Database> database, bool dryRun)
+    {
+        if( !database )
+            return false;
+        return start(filePath, [database]() { return database; }, dryRun);
+    }
+
+    bool LessonImporter::start(const std::string& filePath, DatabaseFactory openDatabase, bool dryRun)
+    {
+        if( isRunning() || !openDatabase )
+            return false;
+        wait();
+
+        Progress progress;
+        std::error_code error;
+        const auto size = std::filesystem::file_size(filePath, error);
+        if( !error )
+            progress.totalBytes = size;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_progress = progress;
+        }
+
+        m_cancelled = false;
+        m_running = true;
+        m_thread = std::thread(&LessonImporter::run, this, filePath, std::move(openDatabase), dryRun);
+        return true;
+    }
+
+    LessonImporter::Progress LessonImporter::getProgress() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_progress;
+    }
+
+    bool LessonImporter::isRunning() const
+    {
+        return m_running;
+    }
+
+    void LessonImporter::cancel()
+    {
+        m_cancelled = true;
+    }
+
+    void LessonImporter::wait()
+    {
+        if( m_thread.joinable() )
+            m_thread.join();
+    }
+
+    std::string LessonImporter::importInto(const std::string& filePath, Database& database, bool dryRun)
+    {
+        std::string error;
+        LessonUpserter upserter(database, dryRun);
+        try
+        {
+            // The upserter finds the lesson a continued batch belongs to by its names.
+            const BatchCallback writeBatch = [&](const Batch& batch)
+                {
+                    if( !dryRun && !database.beginTransaction() )
+                        throw std::runtime_error("Cannot write to the lesson database.");
+
+                    Result written;
+                    try
+                    {
+                        for( const auto& tombstone : batch.tombstones )
+                            upserter.remove(tombstone);
+
+                        const auto policy = batch.delta ? LessonUpserter::Policy::Replace : LessonUpserter::Policy::Merge;
+                        for( size_t i = 0; i < batch.lessons.size(); ++i )
+                        {
+                            const Lesson& lesson = batch.lessons[i];
+                            upserter.upsert(lesson, policy);
+                            if( i > 0 || !batch.continuesLesson )
+                                ++written.lessons;
+                            written.words += static_cast<int64_t>(lesson.words.size());
+                        }
+                    }
+                    catch( ... )
+                    {
+                        if( !dryRun )
+                            database.rollbackTransaction();
+                        throw;
+                    }
+
+                    if( !dryRun && !database.commitTransaction() )
+                        throw std::runtime_error("Cannot write to the lesson database.");
+
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_progress.imported.lessons += written.lessons;
+                    m_progress.imported.words += written.words;
+                    m_progress.report = upserter.getReport();
+                };
+
+            const ProgressCallback reportProgress = [this](uint64_t bytesRead)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_progress.bytesRead = bytesRead;
+                    return !m_cancelled.load();
+                };
+
+            if( AnkiImporter::isCollectionPath(filePath) )
+            {
+                // The collection is written in one transaction that rolls itself back, no lessons are left to remove.
+                const uint64_t fileSize = std::filesystem::file_size(filePath);
+                AnkiImporter::Options options;
+                options.dryRun = dryRun;
+                const AnkiImporter::Result result = AnkiImporter::importCollection(filePath, database, options,
+                    [&](int64_t notesRead, int64_t totalNotes)
+                    {
+                        return reportProgress(totalNotes > 0 ? fileSize * static_cast<uint64_t>(notesRead) / static_cast<uint64_t>(totalNotes) : fileSize);
+                    });
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_progress.imported.lessons = 1;
+                m_progress.imported.words = result.words;
+                m_progress.report = result.report;
+            }
+            else if( CsvImporter::isCsvPath(filePath) )
+            {
+                CsvImporter::importFile(filePath, CsvImporter::optionsFor(filePath), writeBatch, reportProgress);
+            }
+            else if( LessonPack::isPackPath(filePath) )
+            {
+                LessonPack pack;
+                if( !pack.open(filePath) )
+                    throw std::runtime_error(pack.getError());
+                if( !pack.verifyChecksum() )
+                    throw std::runtime_error("The lesson pack is damaged.");
+
+                importPack(pack, writeBatch, reportProgress);
+            }
+            else
+            {
+                std::ifstream input(filePath, std::ios::binary);
+                if( !input )
+                    throw std::runtime_error("Cannot open " + filePath + ".");
+
+                importStream(input, writeBatch, reportProgress);
+            }
+        }
+        catch( const std::exception& e )
+        {
+            error = e.what();
+        }
+
+        if( !error.empty() && (!upserter.getAddedLessonIds().empty() || !upserter.getAddedWordIds().empty()) )
+        {
+            // Batches are committed one by one, a failed import must not leave half a deck behind.
+            database.beginTransaction();
+            for( int wordId : upserter.getAddedWordIds() )
+                database.deleteWord(wordId);
+            for( int lessonId : upserter.getAddedLessonIds() )
+            {
+                for( const auto& word : database.getWordsInLesson(lessonId) )
+                    database.deleteWord(word.id);
+                database.deleteLesson(lessonId);
+            }
+            database.commitTransaction();
+        }
+        return error;
+    }
+
+    void LessonImporter::run(std::string filePath, DatabaseFactory openDatabase, bool dryRun)
+    {
+        // Opening the database checks its schema, so it is done here and not on the thread that started the import.
+        std::string error;
+        std::shared_ptr<Database> database;
+        try
+        {
+            database = openDatabase();
+            if( !database )
+                error = "Cannot open the lesson database.";
+        }
+        catch( const std::exception& e )
+        {
+            error = e.what();
+        }
+
+        if( database )
+            error = importInto(filePath, *database, dryRun);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if( !error.empty() )
+            {
+                m_progress.imported = {};
+                m_progress.report = {};
+            }
+            m_progress.finished = true;
+            m_progress.error = error;
+        }
+        m_running = false;
+    }
+
+    LessonImporter::Result LessonImporter::importStream(std::istream& input, const BatchCallback& onBatch, ProgressCallback progress, size_t batchSize)
+    {
+        XmlPullParser parser(input);
+
+        Event event = parser.next();
+        while( event == Event::Text )
+        {
+            event = parser.next();
+        }
+        if( event == Event::Error )
+            throwParseError(parser);
+        if( event != Event::StartElement || parser.getName() != "lessons" )
+            throw std::runtime_error("Not a lesson file.");
+
+        batchSize = std::max<size_t>(batchSize, 1);
+        Result result;
+        Batch batch;
+        batch.delta = parser.findAttribute("sinceVersion") != nullptr;
+        size_t items = 0;
+
+        const auto handOver = [&]()
+            {
+                if( !batch.lessons.empty() || !batch.tombstones.empty() )
+                    onBatch(batch);
+                batch.lessons.clear();
+                batch.tombstones.clear();
+                batch.continuesLesson = false;
+                items = 0;
+
+                if( progress && !progress(parser.getBytesRead()) )
+                    throw std::runtime_error("The import was cancelled.");
+            };
+
+        while( (event = parser.next()) != Event::EndDocument )
+        {
+            if( event == Event::Error )
+                throwParseError(parser);
+            if( event != Event::StartElement )
+                continue;
+            if( batch.delta && parser.getName() == "deleted" )
+            {
+                batch.tombstones.push_back(makeTombstone(parser));
+                parser.skipElement();
+                if( ++items >= batchSize )
+                    handOver();
+                continue;
+            }
+            if( parser.getName() != "lesson" )
+            {
+                parser.skipElement();
+                continue;
+            }
+
+            batch.lessons.push_back(makeLesson(parser));
+            ++items;
+            ++result.lessons;
+
+            const int depth = parser.getDepth();
+            while( true )
+            {
+                event = parser.next();
+                if( event == Event::Error || event == Event::EndDocument )
+                    throwParseError(parser);
+                if( event == Event::EndElement && parser.getDepth() < depth )
+                    break;
+                if( event != Event::StartElement )
+                    continue;
+                if( parser.getName() != "word" )
+                {
+                    parser.skipElement();
+                    continue;
+                }
+
+                if( items >= batchSize )
+                {
+                    Lesson rest;
+                    rest.groupName = batch.lessons.back().groupName;
+                    rest.mainName = batch.lessons.back().mainName;
+                    rest.subName = batch.lessons.back().subName;
+                    handOver();
+                    batch.lessons.push_back(std::move(rest));
+                    batch.continuesLesson = true;
+                }
+
+                batch.lessons.back().words.push_back(readWord(parser));
+                ++items;
+                ++result.words;
+            }
+
+            if( items >= batchSize )
+                handOver();
+        }
+
+        handOver();
+        return result;
+    }
+
+    LessonImporter::Result LessonImporter::importPack(const LessonPack& pack, const BatchCallback& onBatch, ProgressCallback progress, size_t batchSize)
+    {
+        batchSize = std::max<size_t>(batchSize, 1);
+        const uint64_t fileSize = pack.getFileSize();
+        const uint64_t wordCount = std::max<uint64_t>(pack.getWordCount(), 1);
+
+        Result result;
+        Batch batch;
+        size_t items = 0;
+
+        const auto handOver = [&]()
+            {
+                if( !batch.lessons.empty() )
+                    onBatch(batch);
+                batch.lessons.clear();
+                batch.continuesLesson = false;
+                items = 0;
+
+                if( progress && !progress(fileSize * static_cast<uint64_t>(result.words) / wordCount) )
+                    throw std::runtime_error("The import was cancelled.");
+            };
+
+        for( size_t i = 0; i < pack.getLessonCount(); ++i )
+        {
+            const LessonPack::LessonRecord& record = pack.getLessonRecord(i);
+
+            Lesson lesson;
+            lesson.groupName = pack.getString(record.groupName);
+            lesson.mainName = pack.getString(record.mainName);
+            lesson.subName = pack.getString(record.subName);
+            batch.lessons.push_back(lesson);
+            ++items;
+            ++result.lessons;
+
+            // Words are read one by one instead of through getLesson(), so a big lesson is never copied whole.
+            const uint64_t end = std::min<uint64_t>(static_cast<uint64_t>(record.firstWord) + record.wordCount, pack.getWordCount());
+            for( uint64_t word = record.firstWord; word < end; ++word )
+            {
+                if( items >= batchSize )
+                {
+                    handOver();
+                    batch.lessons.push_back(lesson);
+                    batch.continuesLesson = true;
+                }
+
+                batch.lessons.back().words.push_back(pack.getWord(static_cast<size_t>(word)));
+                ++items;
+                ++result.words;
+            }
+
+            if( items >= batchSize )
+                handOver();
+        }
+
+        handOver();
+        return result;
+    }
+}
@@ -0,0 +1,189 @@
+/**
+ * @file LessonImporter.h
+ * @brief Defines the LessonImporter class, which streams lesson XML files into the database in bounded batches.
+ */
+
+#pragma once
+
+#include "Lesson.h"
+#include "LessonUpserter.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tadaima
+{
+    class Database;
+    class LessonPack;
+
+    /**
+     * @class LessonImporter
+     * @brief Imports lesson files written by LessonFileIO::exportLessons without loading them into memory.
+     *
+     * XML files are read with tools::XmlPullParser, lesson packs (see LessonPack) are read in place. Both are handed over in batches of at most a fixed number of
+     * lessons and words, so memory use does not depend on the size of the file. A lesson with more words
+     * than fit in a batch is split over several batches (see Batch::continuesLesson).
+     */
+    class LessonImporter
+    {
+    public:
+
+        /**
+         * @brief Default number of lessons and words in one batch.
+         */
+        static constexpr size_t DEFAULT_BATCH_SIZE = 512;
+
+        /**
+         * @brief Lessons parsed since the previous batch.
+         */
+        struct Batch
+        {
+            std::vector<Lesson> lessons;   ///< Lessons in file order, the last one may continue in the next batch.
+            bool continuesLesson = false;  ///< The first lesson holds further words of the last lesson of the previous batch.
+            std::vector<LessonTombstone> tombstones;  ///< Deletions of a delta file, applied before the lessons.
+            bool delta = false;            ///< From a delta file: stored words are replaced instead of merged.
+        };
+
+        /**
+         * @brief Number of lessons and words imported.
+         */
+        struct Result
+        {
+            int64_t lessons = 0;
+            int64_t words = 0;
+        };
+
+        /**
+         * @brief Progress of a background import.
+         */
+        struct Progress
+        {
+            uint64_t bytesRead = 0;   ///< Bytes of the file parsed so far.
+            uint64_t totalBytes = 0;  ///< Size of the file.
+            Result imported;          ///< Lessons and words written so far.
+            LessonUpserter::Report report;  ///< How the words were merged with the database.
+            bool finished = false;    ///< True once the import ended, successfully or not.
+            std::string error;        ///< Why the import failed, empty on success.
+        };
+
+        /**
+         * @brief Receives each batch; may throw to abort the import.
+         */
+        using BatchCallback = std::function<void(const Batch& batch)>;
+
+        /**
+         * @brief Called after each batch with the number of bytes parsed; returning false cancels the import.
+         */
+        using ProgressCallback = std::function<bool(uint64_t bytesRead)>;
+
+        /**
+         * @brief Opens the database an import writes through.
+         */
+        using DatabaseFactory = std::function<std::shared_ptr<Database>()>;
+
+        LessonImporter() = default;
+
+        /**
+         * @brief Cancels a running import and waits for it.
+         */
+        ~LessonImporter();
+
+        LessonImporter(const LessonImporter&) = delete;
+        LessonImporter& operator=(const LessonImporter&) = delete;
+
+        /**
+         * @brief Imports a lesson file into a database on a background thread.
+         *
+         * Lessons are merged into existing lessons of the same names and words matched by WordFingerprint
+         * (see LessonUpserter), so importing a file again only adds what is new. A delta file written by
+         * LessonExporter::exportChanges() also deletes what was deleted since. Each batch is written in
+         * its own transaction. If the import fails or is cancelled, the lessons and words added so far are
+         * deleted again; words updated in place keep their new values and deleted ones stay deleted.
+         *
+         * @param filePath The lesson XML file, lesson pack, CSV/TSV file or Anki collection; packs with a wrong checksum
+         *                 are rejected, the others are imported with the default CsvImporter and AnkiImporter options.
+         * @param database The database to write, used only by the import thread until it finishes.
+         * @param dryRun True to write nothing and only fill in Progress::report.
+         * @return False if an import is still running.
+         */
+        bool start(const std::string& filePath, std::shared_ptr<Database> database, bool dryRun = false);
+
+        /**
+         * @brief Like start() with a database, but opens the database on the import thread.
+         *
+         * @param filePath The file to import.
+         * @param openDatabase Opens the connection the import writes through; null or a throw fails the import.
+         * @param dryRun True to write nothing and only fill in Progress::report.
+         * @return False if an import is still running.
+         */
+        bool start(const std::string& filePath, DatabaseFactory openDatabase, bool dryRun = false);
+
+        /**
+         * @brief Returns the progress of the current (or last) import.
+         */
+        Progress getProgress() const;
+
+        /**
+         * @brief Checks whether an import is running.
+         */
+        bool isRunning() const;
+
+        /**
+         * @brief Requests the running import to stop after the current batch.
+         */
+        void cancel();
+
+        /**
+         * @brief Waits until the import has finished.
+         */
+        void wait();
+
+        /**
+         * @brief Parses a lesson document or delta and hands it over in batches.
+         *
+         * The <deleted> elements of a delta come before its lessons and are handed over as Batch::tombstones.
+         * @param input The XML document.
+         * @param onBatch Receives the batches.
+         * @param progress Optional progress callback.
+         * @param batchSize Maximum number of lessons and words in one batch.
+         * @return The number of parsed lessons and words.
+         * @throws std::runtime_error if the document is malformed, not a lesson file or the import was cancelled.
+         */
+        static Result importStream(std::istream& input, const BatchCallback& onBatch, ProgressCallback progress = nullptr,
+            size_t batchSize = DEFAULT_BATCH_SIZE);
+
+        /**
+         * @brief Hands the lessons of an open pack over in batches, like importStream().
+         * @param pack The open lesson pack.
+         * @param onBatch Receives the batches.
+         * @param progress Optional progress callback, the bytes are estimated from the words handed over.
+         * @param batchSize Maximum number of lessons and words in one batch.
+         * @return The number of lessons and words.
+         * @throws std::runtime_error if the import was cancelled.
+         */
+        static Result importPack(const LessonPack& pack, const BatchCallback& onBatch, ProgressCallback progress = nullptr,
+            size_t batchSize = DEFAULT_BATCH_SIZE);
+
+    private:
+
+        void run(std::string filePath, DatabaseFactory openDatabase, bool dryRun);
+
+        /**
+         * @brief Imports a file through an open database and removes what it added if it fails.
+         * @return The error, empty on success.
+         */
+        std::string importInto(const std::string& filePath, Database& database, bool dryRun);
+
+        std::atomic<bool> m_running{ false };
+        std::atomic<bool> m_cancelled{ false };
+        mutable std::mutex m_mutex;
+        Progress m_progress;
+        std::thread m_thread;
+    };
+}
@@ -1,5 +1,6 @@
 #include "LessonManager.h"
 #include "tools/Database.h"
+#include "Tools/Tracer.h"
 
 namespace tadaima
 {
@@ -17,6 +18,7 @@ namespace tadaima
 
     void LessonManager::editLessons(const std::vector<Lesson>& lessons)
     {
+        tools::TraceScope trace("LessonManager::editLessons", "lessons");
         // Iterate over each lesson and add it to the database
         for( const auto& lesson : lessons )
         {
@@ -49,6 +51,7 @@ namespace tadaima
 
     void LessonManager::addLessons(const std::vector<Lesson>& lessons)
     {
+        tools::TraceScope trace("LessonManager::addLessons", "lessons");
         // Iterate over each lesson and add it to the database
         for( const auto& lesson : lessons )
         {
@@ -58,6 +61,7 @@ namespace tadaima
 
     void LessonManager::renameLessons(const std::vector<Lesson>& lessons)
     {
+        tools::TraceScope trace("LessonManager::renameLessons", "lessons");
         // Iterate over each lesson and add it to the database
         for( const auto& lesson : lessons )
         {
@@ -67,6 +71,7 @@ namespace tadaima
 
     void LessonManager::removeLessons(const std::vector<Lesson>& lessons)
     {
+        tools::TraceScope trace("LessonManager::removeLessons", "lessons");
         // Iterate over each lesson and delete it from the database
         for( const auto& lesson : lessons )
         {
@@ -91,6 +96,7 @@ namespace tadaima
 
     std::vector<Lesson> LessonManager::getAllLessons() const
     {
+        tools::TraceScope trace("LessonManager::getAllLessons", "lessons");
         return m_database.getAllLessons();
     }
 
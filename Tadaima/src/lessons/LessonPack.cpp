@@ -0,0 +1,361 @@
+#include "LessonPack.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace tadaima
+{
+    static_assert(std::endian::native == std::endian::little, "Lesson packs are stored little-endian.");
+    static_assert(sizeof(LessonPack::Header) == 88, "The pack header layout must not change within a version.");
+    static_assert(sizeof(LessonPack::LessonRecord) == 32, "The lesson record layout must not change within a version.");
+    static_assert(sizeof(LessonPack::WordRecord) == 56, "The word record layout must not change within a version.");
+    static_assert(sizeof(LessonPack::ConjugationRecord) == 12, "The conjugation record layout must not change within a version.");
+
+    namespace
+    {
+        // Tables start at multiples of this, so records can be read in place.
+        constexpr size_t TABLE_ALIGNMENT = 8;
+
+        constexpr std::array<uint32_t, 256> makeCrcTable()
+        {
+            std::array<uint32_t, 256> table{};
+            for( uint32_t i = 0; i < 256; ++i )
+            {
+                uint32_t crc = i;
+                for( int bit = 0; bit < 8; ++bit )
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        constexpr std::array<uint32_t, 256> CRC_TABLE = makeCrcTable();
+
+        // CRC-32 (as in zip), continued from a previous value.
+        uint32_t crc32(uint32_t crc, const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            crc = ~crc;
+            for( size_t i = 0; i < size; ++i )
+                crc = CRC_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        bool tableFits(uint64_t offset, uint64_t count, size_t recordSize, size_t fileSize)
+        {
+            return offset % alignof(uint32_t) == 0 && offset <= fileSize && count <= (fileSize - offset) / recordSize;
+        }
+
+        uint32_t checkedCount(size_t count)
+        {
+            if( count > std::numeric_limits<uint32_t>::max() )
+                throw std::runtime_error("Too many records for a lesson pack.");
+            return static_cast<uint32_t>(count);
+        }
+
+        // Collects the strings of a pack, each distinct string is stored once.
+        class StringPool
+        {
+        public:
+            LessonPack::StringRef add(const std::string& text)
+            {
+                if( text.empty() )
+                    return {};
+
+                auto [it, inserted] = m_offsets.try_emplace(text, static_cast<uint32_t>(m_data.size()));
+                if( inserted )
+                {
+                    if( m_data.size() + text.size() + 1 > std::numeric_limits<uint32_t>::max() )
+                        throw std::runtime_error("Too much text for a lesson pack.");
+                    m_data += text;
+                    m_data += '\0';  // Lets readers hand out C strings.
+                }
+                return { it->second, static_cast<uint32_t>(text.size()) };
+            }
+
+            const std::string& data() const
+            {
+                return m_data;
+            }
+
+        private:
+            std::string m_data;
+            std::unordered_map<std::string, uint32_t> m_offsets;
+        };
+
+        template<typename Record>
+        void appendTable(std::string& body, uint64_t& offset, const std::vector<Record>& records)
+        {
+            body.append((TABLE_ALIGNMENT - (sizeof(LessonPack::Header) + body.size()) % TABLE_ALIGNMENT) % TABLE_ALIGNMENT, '\0');
+            offset = sizeof(LessonPack::Header) + body.size();
+            body.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        }
+    }
+
+    bool LessonPack::open(const std::string& path)
+    {
+        close();
+        m_error.clear();
+
+        if( !m_file.open(path) )
+            return fail("Cannot open " + path + ".");
+
+        const size_t size = m_file.size();
+        if( size < sizeof(Header) )
+            return fail("Not a lesson pack.");
+
+        const Header* header = reinterpret_cast<const Header*>(m_file.data());
+        if( std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 )
+            return fail("Not a lesson pack.");
+        if( header->version != VERSION )
+            return fail("Unsupported lesson pack version " + std::to_string(header->version) + ".");
+
+        if( header->headerSize < sizeof(Header) || header->headerSize > size
+            || !tableFits(header->lessonsOffset, header->lessonCount, sizeof(LessonRecord), size)
+            || !tableFits(header->wordsOffset, header->wordCount, sizeof(WordRecord), size)
+            || !tableFits(header->tagsOffset, header->tagCount, sizeof(StringRef), size)
+            || !tableFits(header->conjugationsOffset, header->conjugationCount, sizeof(ConjugationRecord), size)
+            || !tableFits(header->stringsOffset, header->stringsSize, 1, size) )
+        {
+            return fail("The lesson pack is damaged.");
+        }
+
+        const uint8_t* data = m_file.data();
+        m_header = header;
+        m_lessons = reinterpret_cast<const LessonRecord*>(data + header->lessonsOffset);
+        m_words = reinterpret_cast<const WordRecord*>(data + header->wordsOffset);
+        m_tags = reinterpret_cast<const StringRef*>(data + header->tagsOffset);
+        m_conjugations = reinterpret_cast<const ConjugationRecord*>(data + header->conjugationsOffset);
+        m_strings = reinterpret_cast<const char*>(data + header->stringsOffset);
+        return true;
+    }
+
+    void LessonPack::close()
+    {
+        m_file.close();
+        m_header = nullptr;
+        m_lessons = nullptr;
+        m_words = nullptr;
+        m_tags = nullptr;
+        m_conjugations = nullptr;
+        m_strings = nullptr;
+    }
+
+    bool LessonPack::isOpen() const
+    {
+        return m_header != nullptr;
+    }
+
+    const std::string& LessonPack::getError() const
+    {
+        return m_error;
+    }
+
+    size_t LessonPack::getFileSize() const
+    {
+        return isOpen() ? m_file.size() : 0;
+    }
+
+    bool LessonPack::verifyChecksum() const
+    {
+        if( !isOpen() )
+            return false;
+
+        const size_t headerSize = m_header->headerSize;
+        return crc32(0, m_file.data() + headerSize, m_file.size() - headerSize) == m_header->checksum;
+    }
+
+    size_t LessonPack::getLessonCount() const
+    {
+        return isOpen() ? m_header->lessonCount : 0;
+    }
+
+    size_t LessonPack::getWordCount() const
+    {
+        return isOpen() ? m_header->wordCount : 0;
+    }
+
+    const LessonPack::LessonRecord& LessonPack::getLessonRecord(size_t index) const
+    {
+        return m_lessons[index];
+    }
+
+    const LessonPack::WordRecord& LessonPack::getWordRecord(size_t index) const
+    {
+        return m_words[index];
+    }
+
+    std::string_view LessonPack::getString(const StringRef& ref) const
+    {
+        if( !isOpen() || ref.offset > m_header->stringsSize || ref.length > m_header->stringsSize - ref.offset )
+            return {};
+        return std::string_view(m_strings + ref.offset, ref.length);
+    }
+
+    Word LessonPack::getWord(size_t index) const
+    {
+        const WordRecord& record = getWordRecord(index);
+
+        Word word;
+        word.id = static_cast<int>(index);
+        word.kana = getString(record.kana);
+        word.kanji = getString(record.kanji);
+        word.translation = getString(record.translation);
+        word.romaji = getString(record.romaji);
+        word.exampleSentence = getString(record.exampleSentence);
+
+        // Counts are checked here rather than in open(), so opening stays independent of the pack size.
+        if( record.firstTag <= m_header->tagCount && record.tagCount <= m_header->tagCount - record.firstTag )
+        {
+            for( uint32_t i = 0; i < record.tagCount; ++i )
+                word.tags.emplace_back(getString(m_tags[record.firstTag + i]));
+        }
+
+        if( record.firstConjugation <= m_header->conjugationCount && record.conjugationCount <= m_header->conjugationCount - record.firstConjugation )
+        {
+            for( uint32_t i = 0; i < record.conjugationCount; ++i )
+            {
+                const ConjugationRecord& conjugation = m_conjugations[record.firstConjugation + i];
+                if( conjugation.type < word.conjugations.size() )
+                    word.conjugations[conjugation.type] = getString(conjugation.value);
+            }
+        }
+        return word;
+    }
+
+    Lesson LessonPack::getLesson(size_t index) const
+    {
+        const LessonRecord& record = getLessonRecord(index);
+
+        Lesson lesson;
+        lesson.id = static_cast<int>(index);
+        lesson.groupName = getString(record.groupName);
+        lesson.mainName = getString(record.mainName);
+        lesson.subName = getString(record.subName);
+
+        if( record.firstWord <= m_header->wordCount && record.wordCount <= m_header->wordCount - record.firstWord )
+        {
+            lesson.words.reserve(record.wordCount);
+            for( uint32_t i = 0; i < record.wordCount; ++i )
+                lesson.words.push_back(getWord(record.firstWord + i));
+        }
+        return lesson;
+    }
+
+    void LessonPack::write(std::ostream& output, const std::vector<Lesson>& lessons)
+    {
+        StringPool strings;
+        std::vector<LessonRecord> lessonRecords;
+        std::vector<WordRecord> wordRecords;
+        std::vector<StringRef> tagRecords;
+        std::vector<ConjugationRecord> conjugationRecords;
+
+        lessonRecords.reserve(lessons.size());
+        for( const auto& lesson : lessons )
+        {
+            LessonRecord lessonRecord{};
+            lessonRecord.groupName = strings.add(lesson.groupName);
+            lessonRecord.mainName = strings.add(lesson.mainName);
+            lessonRecord.subName = strings.add(lesson.subName);
+            lessonRecord.firstWord = checkedCount(wordRecords.size());
+            lessonRecord.wordCount = checkedCount(lesson.words.size());
+
+            for( const auto& word : lesson.words )
+            {
+                WordRecord wordRecord{};
+                wordRecord.kana = strings.add(word.kana);
+                wordRecord.kanji = strings.add(word.kanji);
+                wordRecord.translation = strings.add(word.translation);
+                wordRecord.romaji = strings.add(word.romaji);
+                wordRecord.exampleSentence = strings.add(word.exampleSentence);
+
+                wordRecord.firstTag = checkedCount(tagRecords.size());
+                for( const auto& tag : word.tags )
+                    tagRecords.push_back(strings.add(tag));
+                wordRecord.tagCount = checkedCount(tagRecords.size()) - wordRecord.firstTag;
+
+                wordRecord.firstConjugation = checkedCount(conjugationRecords.size());
+                for( size_t i = 0; i < word.conjugations.size(); ++i )
+                {
+                    if( !word.conjugations[i].empty() )
+                        conjugationRecords.push_back({ static_cast<uint32_t>(i), strings.add(word.conjugations[i]) });
+                }
+                wordRecord.conjugationCount = checkedCount(conjugationRecords.size()) - wordRecord.firstConjugation;
+
+                wordRecords.push_back(wordRecord);
+            }
+            lessonRecords.push_back(lessonRecord);
+        }
+
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.headerSize = sizeof(Header);
+        header.lessonCount = checkedCount(lessonRecords.size());
+        header.wordCount = checkedCount(wordRecords.size());
+        header.tagCount = checkedCount(tagRecords.size());
+        header.conjugationCount = checkedCount(conjugationRecords.size());
+
+        std::string body;
+        appendTable(body, header.lessonsOffset, lessonRecords);
+        appendTable(body, header.wordsOffset, wordRecords);
+        appendTable(body, header.tagsOffset, tagRecords);
+        appendTable(body, header.conjugationsOffset, conjugationRecords);
+        header.stringsOffset = sizeof(Header) + body.size();
+        header.stringsSize = strings.data().size();
+        body += strings.data();
+        header.checksum = crc32(0, body.data(), body.size());
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(body.data(), static_cast<std::streamsize>(body.size()));
+        output.flush();
+        if( !output )
+            throw std::runtime_error("Cannot write the lesson pack.");
+    }
+
+    void LessonPack::writeFile(const std::string& filePath, const std::vector<Lesson>& lessons)
+    {
+        const std::string temporaryPath = filePath + ".part";
+        try
+        {
+            {
+                std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+                if( !output )
+                    throw std::runtime_error("Cannot create " + filePath + ".");
+                write(output, lessons);
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporaryPath, filePath, error);
+            if( error )
+                throw std::runtime_error("Cannot replace " + filePath + ": " + error.message());
+        }
+        catch( ... )
+        {
+            std::error_code ignored;
+            std::filesystem::remove(temporaryPath, ignored);
+            throw;
+        }
+    }
+
+    bool LessonPack::isPackPath(const std::string& path)
+    {
+        const std::string extension = std::filesystem::path(path).extension().string();
+        return extension.size() == std::strlen(FILE_EXTENSION)
+            && std::equal(extension.begin(), extension.end(), FILE_EXTENSION, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    }
+
+    bool LessonPack::fail(const std::string& message)
+    {
+        close();
+        m_error = message;
+        return false;
+    }
+}
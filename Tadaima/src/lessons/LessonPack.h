@@ -0,0 +1,191 @@
+/**
+ * @file LessonPack.h
+ * @brief Defines the LessonPack class, a binary lesson file that is used in place through a memory mapping.
+ */
+
+#pragma once
+
+#include "Lesson.h"
+#include "Tools/MappedFile.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tadaima
+{
+    /**
+     * @class LessonPack
+     * @brief Reads and writes lesson packs (*.tdpack), the compact alternative to the XML lesson files.
+     *
+     * A pack is a header followed by tables of fixed-size records (lessons, words, tags and conjugations)
+     * and a pool of UTF-8 strings that the records point into. Opening a pack maps the file and checks
+     * the header, nothing is parsed: records are read in place, so packs can be browsed or quizzed
+     * before (or without) being imported. All numbers are little-endian. Readers reject packs with a
+     * different major version; verifyChecksum() detects damaged files.
+     */
+    class LessonPack
+    {
+    public:
+
+        static constexpr uint32_t VERSION = 1;
+        static constexpr char MAGIC[8] = { 'T', 'D', 'M', 'P', 'A', 'C', 'K', '\0' };
+        static constexpr const char* FILE_EXTENSION = ".tdpack";
+
+        /**
+         * @brief Location of a string in the string pool.
+         */
+        struct StringRef
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        /**
+         * @brief The first bytes of a pack.
+         */
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t headerSize;           ///< sizeof(Header) of the writer, newer minor versions may append fields.
+            uint32_t lessonCount;
+            uint32_t wordCount;
+            uint32_t tagCount;
+            uint32_t conjugationCount;
+            uint64_t lessonsOffset;
+            uint64_t wordsOffset;
+            uint64_t tagsOffset;
+            uint64_t conjugationsOffset;
+            uint64_t stringsOffset;
+            uint64_t stringsSize;
+            uint32_t checksum;             ///< CRC-32 of all bytes that follow the header.
+            uint32_t reserved;
+        };
+
+        struct LessonRecord
+        {
+            StringRef groupName;
+            StringRef mainName;
+            StringRef subName;
+            uint32_t firstWord;
+            uint32_t wordCount;
+        };
+
+        struct WordRecord
+        {
+            StringRef kana;
+            StringRef kanji;
+            StringRef translation;
+            StringRef romaji;
+            StringRef exampleSentence;
+            uint32_t firstTag;
+            uint32_t tagCount;
+            uint32_t firstConjugation;
+            uint32_t conjugationCount;
+        };
+
+        struct ConjugationRecord
+        {
+            uint32_t type;                 ///< The ConjugationType, i.e. the index in Word::conjugations.
+            StringRef value;
+        };
+
+        LessonPack() = default;
+
+        LessonPack(const LessonPack&) = delete;
+        LessonPack& operator=(const LessonPack&) = delete;
+
+        /**
+         * @brief Maps a pack and checks its header and table bounds.
+         * @param path The pack file.
+         * @return False if the file cannot be mapped or is not a valid pack, see getError().
+         */
+        bool open(const std::string& path);
+
+        /**
+         * @brief Unmaps the pack.
+         */
+        void close();
+
+        /**
+         * @brief Checks whether a pack is open.
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Returns why open() failed.
+         */
+        const std::string& getError() const;
+
+        /**
+         * @brief Returns the size of the pack file in bytes.
+         */
+        size_t getFileSize() const;
+
+        /**
+         * @brief Computes the checksum of the pack and compares it with the one in the header.
+         * @return True if the pack is intact.
+         */
+        bool verifyChecksum() const;
+
+        size_t getLessonCount() const;
+        size_t getWordCount() const;
+
+        /**
+         * @brief Returns a lesson record, the index must be below getLessonCount().
+         */
+        const LessonRecord& getLessonRecord(size_t index) const;
+
+        /**
+         * @brief Returns a word record, the index must be below getWordCount().
+         */
+        const WordRecord& getWordRecord(size_t index) const;
+
+        /**
+         * @brief Returns a string of the pool, empty if the reference points outside of it.
+         */
+        std::string_view getString(const StringRef& ref) const;
+
+        /**
+         * @brief Copies a word out of the pack; its id is the word's index in the pack.
+         */
+        Word getWord(size_t index) const;
+
+        /**
+         * @brief Copies a lesson and its words out of the pack; its id is the lesson's index in the pack.
+         */
+        Lesson getLesson(size_t index) const;
+
+        /**
+         * @brief Writes lessons as a pack.
+         * @throws std::runtime_error if the stream fails or the lessons exceed the limits of the format.
+         */
+        static void write(std::ostream& output, const std::vector<Lesson>& lessons);
+
+        /**
+         * @brief Writes lessons to a pack file under a temporary name and renames it when complete.
+         * @throws std::runtime_error if the file cannot be written.
+         */
+        static void writeFile(const std::string& filePath, const std::vector<Lesson>& lessons);
+
+        /**
+         * @brief Checks whether a path names a lesson pack (by its extension).
+         */
+        static bool isPackPath(const std::string& path);
+
+    private:
+
+        bool fail(const std::string& message);
+
+        tools::MappedFile m_file;
+        const Header* m_header = nullptr;
+        const LessonRecord* m_lessons = nullptr;
+        const WordRecord* m_words = nullptr;
+        const StringRef* m_tags = nullptr;
+        const ConjugationRecord* m_conjugations = nullptr;
+        const char* m_strings = nullptr;
+        std::string m_error;
+    };
+}
@@ -0,0 +1,283 @@
+#include "LessonUpserter.h"
+#include "WordFingerprint.h"
+#include "Tools/Database.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace tadaima
+{
+    namespace
+    {
+        bool isEmpty(const std::string& text)
+        {
+            return text.empty() || text == "N/A";
+        }
+
+        void addMissingTags(std::vector<std::string>& tags, const std::vector<std::string>& others)
+        {
+            for( const auto& tag : others )
+            {
+                if( std::find(tags.begin(), tags.end(), tag) == tags.end() )
+                    tags.push_back(tag);
+            }
+        }
+
+        Word replaceWord(const Word& existing, const Word& update)
+        {
+            Word replaced = update;
+            replaced.id = existing.id;
+            // The database stores a missing kanji as "N/A", which is no change.
+            if( isEmpty(replaced.kanji) && isEmpty(existing.kanji) )
+                replaced.kanji = existing.kanji;
+            return replaced;
+        }
+
+        // Unlike LessonUpserter::mergeWord(), the word keeps its fields and only takes what it lacks.
+        void fillWord(Word& word, const Word& other)
+        {
+            if( isEmpty(word.kanji) && !isEmpty(other.kanji) )
+                word.kanji = other.kanji;
+            if( word.romaji.empty() )
+                word.romaji = other.romaji;
+            if( word.exampleSentence.empty() )
+                word.exampleSentence = other.exampleSentence;
+            addMissingTags(word.tags, other.tags);
+            for( size_t i = 0; i < word.conjugations.size(); ++i )
+            {
+                if( word.conjugations[i].empty() )
+                    word.conjugations[i] = other.conjugations[i];
+            }
+        }
+    }
+
+    std::string LessonUpserter::Report::toString() const
+    {
+        std::string text = std::to_string(lessonsAdded) + " lessons added, " + std::to_string(lessonsMatched) + " matched, "
+            + std::to_string(wordsAdded) + " words added, " + std::to_string(wordsUpdated) + " updated, "
+            + std::to_string(wordsUnchanged) + " unchanged";
+        if( lessonsMerged || wordsMerged )
+            text += ", " + std::to_string(lessonsMerged) + " lessons merged, " + std::to_string(wordsMerged) + " words merged";
+        if( lessonsDeleted || wordsDeleted )
+            text += ", " + std::to_string(lessonsDeleted) + " lessons deleted, " + std::to_string(wordsDeleted) + " words deleted";
+        return text;
+    }
+
+    LessonUpserter::LessonUpserter(Database& database, bool dryRun)
+        : m_database(database), m_dryRun(dryRun)
+    {
+    }
+
+    int LessonUpserter::upsert(const Lesson& lesson, Policy policy)
+    {
+        LessonState& state = findLesson(lesson);
+
+        for( const auto& word : lesson.words )
+        {
+            const uint64_t fingerprint = WordFingerprint::of(word);
+            auto existing = state.words.find(fingerprint);
+
+            if( existing == state.words.end() )
+            {
+                ++m_report.wordsAdded;
+                Word added = word;
+                if( !m_dryRun )
+                {
+                    added.id = m_database.addWord(state.id, word);
+                    if( added.id < 0 )
+                        throw std::runtime_error("Cannot add the word " + word.kana + " to " + lesson.mainName + ".");
+                    for( const auto& tag : word.tags )
+                    {
+                        m_database.addTag(added.id, tag);
+                    }
+                    if( state.existed )
+                        m_addedWordIds.push_back(added.id);
+                }
+                state.words.emplace(fingerprint, std::move(added));
+                continue;
+            }
+
+            Word merged = policy == Policy::Replace ? replaceWord(existing->second, word) : mergeWord(existing->second, word);
+            if( merged == existing->second )
+            {
+                ++m_report.wordsUnchanged;
+                continue;
+            }
+
+            ++m_report.wordsUpdated;
+            if( !m_dryRun )
+                m_database.updateWord(existing->second.id, merged);
+            existing->second = std::move(merged);
+        }
+
+        return state.id;
+    }
+
+    void LessonUpserter::remove(const LessonTombstone& tombstone)
+    {
+        // The cached words of the lesson may be gone afterwards.
+        m_lessons.clear();
+
+        const int lessonId = m_database.findLesson(tombstone.groupName, tombstone.mainName, tombstone.subName);
+        if( lessonId < 0 )
+            return;
+
+        const std::vector<Word> words = m_database.getWordsInLesson(lessonId);
+        if( tombstone.wholeLesson )
+        {
+            ++m_report.lessonsDeleted;
+            if( m_dryRun )
+                return;
+
+            for( const auto& word : words )
+            {
+                m_database.deleteWord(word.id);
+            }
+            m_database.deleteLesson(lessonId);
+            return;
+        }
+
+        for( const auto& word : words )
+        {
+            if( WordFingerprint::of(word) != tombstone.fingerprint )
+                continue;
+
+            ++m_report.wordsDeleted;
+            if( !m_dryRun )
+                m_database.deleteWord(word.id);
+        }
+    }
+
+    const LessonUpserter::Report& LessonUpserter::getReport() const
+    {
+        return m_report;
+    }
+
+    const std::vector<int>& LessonUpserter::getAddedLessonIds() const
+    {
+        return m_addedLessonIds;
+    }
+
+    const std::vector<int>& LessonUpserter::getAddedWordIds() const
+    {
+        return m_addedWordIds;
+    }
+
+    LessonUpserter::Report LessonUpserter::mergeDuplicates(Database& database, bool dryRun)
+    {
+        Report report;
+        if( !database.beginTransaction() )
+            throw std::runtime_error("Cannot start a transaction.");
+
+        try
+        {
+            for( const auto& lessons : database.findDuplicateLessons() )
+            {
+                for( size_t i = 1; i < lessons.size(); ++i )
+                {
+                    database.moveWords(lessons[i], lessons[0]);
+                    database.deleteLesson(lessons[i]);
+                    ++report.lessonsMerged;
+                }
+            }
+
+            // Moving words may have put duplicates into the kept lessons, so words are searched afterwards.
+            for( const auto& [lessonId, duplicates] : database.findDuplicateWords() )
+            {
+                std::unordered_map<int, Word> words;
+                for( auto& word : database.getWordsInLesson(lessonId) )
+                {
+                    words.emplace(word.id, std::move(word));
+                }
+
+                for( const auto& ids : duplicates )
+                {
+                    auto kept = words.find(ids[0]);
+                    if( kept == words.end() )
+                        continue;
+
+                    Word merged = kept->second;
+                    for( size_t i = 1; i < ids.size(); ++i )
+                    {
+                        auto duplicate = words.find(ids[i]);
+                        if( duplicate != words.end() )
+                        {
+                            fillWord(merged, duplicate->second);
+                        }
+                        database.deleteWord(ids[i]);
+                        ++report.wordsMerged;
+                    }
+
+                    if( merged != kept->second )
+                        database.updateWord(merged.id, merged);
+                }
+            }
+        }
+        catch( ... )
+        {
+            database.rollbackTransaction();
+            throw;
+        }
+
+        if( dryRun )
+            database.rollbackTransaction();
+        else if( !database.commitTransaction() )
+            throw std::runtime_error("Cannot commit the merged duplicates.");
+
+        return report;
+    }
+
+    Word LessonUpserter::mergeWord(const Word& existing, const Word& update)
+    {
+        Word merged = existing;
+        if( isEmpty(merged.kanji) && !isEmpty(update.kanji) )
+            merged.kanji = update.kanji;
+        if( !update.romaji.empty() )
+            merged.romaji = update.romaji;
+        if( !update.exampleSentence.empty() )
+            merged.exampleSentence = update.exampleSentence;
+        addMissingTags(merged.tags, update.tags);
+        for( size_t i = 0; i < merged.conjugations.size(); ++i )
+        {
+            if( !update.conjugations[i].empty() )
+                merged.conjugations[i] = update.conjugations[i];
+        }
+        return merged;
+    }
+
+    LessonUpserter::LessonState& LessonUpserter::findLesson(const Lesson& lesson)
+    {
+        LessonKey key(lesson.groupName, lesson.mainName, lesson.subName);
+        auto cached = m_lessons.find(key);
+        if( cached != m_lessons.end() )
+            return cached->second;
+
+        if( !m_dryRun )
+            m_lessons.clear();
+
+        LessonState& state = m_lessons[std::move(key)];
+        state.id = m_database.findLesson(lesson.groupName, lesson.mainName, lesson.subName);
+        if( state.id >= 0 )
+        {
+            // A lesson added by this import is read back too, if its batches were not consecutive.
+            state.existed = std::find(m_addedLessonIds.begin(), m_addedLessonIds.end(), state.id) == m_addedLessonIds.end();
+            if( state.existed )
+                ++m_report.lessonsMatched;
+            for( auto& word : m_database.getWordsInLesson(state.id) )
+            {
+                const uint64_t fingerprint = WordFingerprint::of(word);
+                state.words.emplace(fingerprint, std::move(word));
+            }
+            return state;
+        }
+
+        ++m_report.lessonsAdded;
+        if( !m_dryRun )
+        {
+            state.id = m_database.addLesson(lesson.mainName, lesson.subName, lesson.groupName);
+            if( state.id < 0 )
+                throw std::runtime_error("Cannot add the lesson " + lesson.mainName + ".");
+            m_addedLessonIds.push_back(state.id);
+        }
+        return state;
+    }
+}
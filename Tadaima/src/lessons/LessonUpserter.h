@@ -0,0 +1,152 @@
+/**
+ * @file LessonUpserter.h
+ * @brief Defines the LessonUpserter class, which writes imported lessons without creating duplicates.
+ */
+
+#pragma once
+
+#include "LessonChanges.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace tadaima
+{
+    class Database;
+
+    /**
+     * @class LessonUpserter
+     * @brief Adds lessons to a database, merging them with the lessons and words already there.
+     *
+     * A lesson with the same group, main and sub name as an existing lesson is merged into it. Its words are
+     * matched by WordFingerprint: identical words are skipped, words that differ in romaji, example, tags or
+     * conjugations are updated and the others are inserted. Lessons may be passed in parts (as the batches
+     * of LessonImporter); the words of each lesson are read from the database once.
+     *
+     * A delta file (see LessonChanges) carries the current version of each changed word, so it is applied with
+     * Policy::Replace, and its tombstones with remove().
+     *
+     * In a dry run nothing is written, the report tells what an import would do.
+     */
+    class LessonUpserter
+    {
+    public:
+
+        /**
+         * @brief How a word is combined with the stored word of the same fingerprint.
+         */
+        enum class Policy
+        {
+            Merge,   ///< Non-empty fields of the imported word win and tags are united (see mergeWord()).
+            Replace  ///< The imported word replaces the stored one.
+        };
+
+        /**
+         * @brief What an import or a merge did (or would do).
+         */
+        struct Report
+        {
+            int64_t lessonsAdded = 0;
+            int64_t lessonsMatched = 0;   ///< Imported lessons merged into an existing one.
+            int64_t wordsAdded = 0;
+            int64_t wordsUpdated = 0;
+            int64_t wordsUnchanged = 0;
+            int64_t lessonsMerged = 0;    ///< Duplicate lessons removed by mergeDuplicates().
+            int64_t wordsMerged = 0;      ///< Duplicate words removed by mergeDuplicates().
+            int64_t lessonsDeleted = 0;   ///< Lessons removed by remove().
+            int64_t wordsDeleted = 0;     ///< Words removed by remove().
+
+            /**
+             * @brief Describes the report in one line for the log.
+             */
+            std::string toString() const;
+        };
+
+        /**
+         * @brief Creates an upserter.
+         * @param database The database to write; the caller owns any transaction around the writes.
+         * @param dryRun True to only count what would change.
+         */
+        explicit LessonUpserter(Database& database, bool dryRun = false);
+
+        /**
+         * @brief Adds a lesson or merges it into the existing lesson with the same names.
+         * @param lesson The lesson, its id is ignored.
+         * @param policy How words that are already stored are combined with the imported ones.
+         * @return The ID of the lesson in the database, -1 for a new lesson in a dry run.
+         * @throws std::runtime_error if the lesson or a word cannot be written.
+         */
+        int upsert(const Lesson& lesson, Policy policy = Policy::Merge);
+
+        /**
+         * @brief Deletes the lesson or word a tombstone names, if it exists.
+         * @param tombstone The deletion of a delta file.
+         */
+        void remove(const LessonTombstone& tombstone);
+
+        /**
+         * @brief Returns what the upserts did so far.
+         */
+        const Report& getReport() const;
+
+        /**
+         * @brief Returns the lessons created so far.
+         */
+        const std::vector<int>& getAddedLessonIds() const;
+
+        /**
+         * @brief Returns the words inserted so far into lessons that existed before.
+         */
+        const std::vector<int>& getAddedWordIds() const;
+
+        /**
+         * @brief Merges lessons with the same names and words with the same fingerprint in a lesson.
+         *
+         * The oldest lesson or word is kept. Words of merged lessons move to the kept lesson; the tags of merged
+         * words are added to the kept word and its empty fields are filled in from them. Everything runs in one
+         * transaction, a dry run rolls it back.
+         *
+         * @param database The database to clean up.
+         * @param dryRun True to only count the duplicates.
+         * @return The number of merged lessons and words.
+         * @throws std::runtime_error if the transaction fails.
+         */
+        static Report mergeDuplicates(Database& database, bool dryRun = false);
+
+        /**
+         * @brief Combines two versions of a word: non-empty fields of the update win and tags are united.
+         * @param existing The stored word, its id is kept.
+         * @param update The imported word.
+         */
+        static Word mergeWord(const Word& existing, const Word& update);
+
+    private:
+
+        using LessonKey = std::tuple<std::string, std::string, std::string>;
+
+        struct LessonState
+        {
+            int id = -1;
+            bool existed = false;                      ///< The lesson was in the database before the import.
+            std::unordered_map<uint64_t, Word> words;  ///< By fingerprint.
+        };
+
+        /**
+         * @brief Returns the state of the lesson with the names of the given one, adding the lesson if needed.
+         *
+         * Only the last lesson is cached outside a dry run, so memory stays bounded by the largest lesson;
+         * a lesson seen again is read back from the database. A dry run writes nothing, so it keeps them all.
+         */
+        LessonState& findLesson(const Lesson& lesson);
+
+        Database& m_database;
+        bool m_dryRun;
+        Report m_report;
+        std::map<LessonKey, LessonState> m_lessons;
+        std::vector<int> m_addedLessonIds;
+        std::vector<int> m_addedWordIds;
+    };
+}
@@ -0,0 +1,62 @@
+#include "WordFingerprint.h"
+
+namespace tadaima
+{
+    namespace
+    {
+        constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+        constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+        // U+3000, the full-width space of Japanese input methods.
+        const std::string IDEOGRAPHIC_SPACE = "\xE3\x80\x80";
+
+        uint64_t hash(uint64_t value, const std::string& text)
+        {
+            for( unsigned char c : text )
+            {
+                value ^= c;
+                value *= FNV_PRIME;
+            }
+            return value;
+        }
+    }
+
+    uint64_t WordFingerprint::of(const Word& word)
+    {
+        // The unit separator cannot occur in normalized text, so fields cannot run into each other.
+        uint64_t value = hash(FNV_OFFSET_BASIS, normalize(word.kana));
+        value = hash(value, "\x1f" + normalize(word.kanji));
+        return hash(value, "\x1f" + normalize(word.translation));
+    }
+
+    std::string WordFingerprint::normalize(const std::string& text)
+    {
+        if( text == "N/A" )
+            return {};
+
+        std::string result;
+        result.reserve(text.size());
+        bool space = false;
+        for( size_t i = 0; i < text.size(); ++i )
+        {
+            const char c = text[i];
+            if( c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\x1f' )
+            {
+                space = true;
+                continue;
+            }
+            if( text.compare(i, IDEOGRAPHIC_SPACE.size(), IDEOGRAPHIC_SPACE) == 0 )
+            {
+                space = true;
+                i += IDEOGRAPHIC_SPACE.size() - 1;
+                continue;
+            }
+
+            if( space && !result.empty() )
+                result += ' ';
+            space = false;
+            result += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+        return result;
+    }
+}
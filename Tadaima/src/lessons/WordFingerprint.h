@@ -0,0 +1,37 @@
+/**
+ * @file WordFingerprint.h
+ * @brief Defines the WordFingerprint class, which identifies words by their content.
+ */
+
+#pragma once
+
+#include "Dictionary/Word.h"
+#include <cstdint>
+#include <string>
+
+namespace tadaima
+{
+    /**
+     * @class WordFingerprint
+     * @brief Computes a 64-bit hash of the normalized kana, kanji and translation of a word.
+     *
+     * Two words with the same fingerprint are the same entry, possibly with different romaji, examples,
+     * tags or conjugations. The fingerprint is stored in the words table, so it must not change for
+     * existing words: any change to normalize() or of() needs a migration that recomputes the column.
+     */
+    class WordFingerprint
+    {
+    public:
+
+        /**
+         * @brief Computes the fingerprint of a word.
+         */
+        static uint64_t of(const Word& word);
+
+        /**
+         * @brief Trims the text, collapses runs of whitespace (including the ideographic space) to one space
+         *        and lowercases ASCII letters. The "N/A" the database stores for a missing kanji becomes empty.
+         */
+        static std::string normalize(const std::string& text);
+    };
+}
@@ -4,14 +4,20 @@
  */
 
 #include "Tools/CommandLineParser.h" 
-#include "Tools/Logger.h"
+#include "Tools/AsyncLogger.h"
+#include "Tools/RotatingFileSink.h"
 #include "Gui/Gui.h"
 #include "Application/Application.h"
 #include <iostream>
 
 int main(int argc, char* argv[])
 {
-    tools::ConsoleLogger logger;
+    // Every message also goes to a rotating file, which is all there is to inspect while the console is hidden.
+    tools::RotatingFileSink logFile("logs/tadaima.log");
+    std::ostream logFileStream(&logFile);
+
+    // Formats and prints on its own thread, so bulk imports do not wait for the console nor the file.
+    tools::AsyncLogger logger(tools::AsyncLogger::Options(), std::cout, logFileStream);
 
     try
     {
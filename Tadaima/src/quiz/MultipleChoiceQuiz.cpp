@@ -2,6 +2,7 @@
 #include <unordered_set>
 #include <stdexcept>
 #include <sstream>
+#include "Tools/Tracer.h"
 
 namespace tadaima
 {
@@ -138,6 +139,7 @@ namespace tadaima
 
             void MultipleChoiceQuiz::advance(char answer)
             {
+                tools::TraceScope trace("MultipleChoiceQuiz::advance", "quiz");
                 if( isFinished() )
                 {
                     return;
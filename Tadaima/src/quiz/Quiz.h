@@ -1,6 +1,7 @@
 #pragma once
 
 #include "QuizItem.h"
+#include "Tools/Tracer.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -75,6 +76,7 @@ namespace tadaima
              */
             bool advance(const std::string& userAnswer)
             {
+                tools::TraceScope trace("Quiz::advance", "quiz");
                 if( !m_currentItem )
                     return false;
 
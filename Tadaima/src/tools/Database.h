@@ -5,7 +5,8 @@
 
 #pragma once
 
-#include "lessons/Lesson.h"
+#include "lessons/LessonChanges.h"
+#include <map>
 #include <vector>
 #include <string>
 
@@ -72,7 +73,7 @@ namespace tadaima
         virtual void updateLesson(int lessonId, const std::string& newGroupName, const std::string& newMainName, const std::string& newSubName) = 0;
 
         /**
-         * @brief Updates an existing word in the database.
+         * @brief Updates an existing word in the database, including its tags and conjugations.
          * @param wordId The ID of the word to update.
          * @param updatedWord The updated Word object.
          */
@@ -85,11 +86,62 @@ namespace tadaima
         virtual void deleteLesson(int lessonId) = 0;
 
         /**
-         * @brief Deletes a word from the database.
+         * @brief Deletes a word, its tags and its conjugations from the database.
          * @param wordId The ID of the word to delete.
          */
         virtual void deleteWord(int wordId) = 0;
 
+        /**
+         * @brief Finds a lesson by its names.
+         * @param groupName The group name of the lesson.
+         * @param mainName The main name of the lesson.
+         * @param subName The sub name of the lesson.
+         * @return The ID of the oldest matching lesson, or -1 if there is none.
+         */
+        virtual int findLesson(const std::string& groupName, const std::string& mainName, const std::string& subName) const = 0;
+
+        /**
+         * @brief Finds lessons that have the same names.
+         * @return The IDs of each set of duplicates, in ascending order.
+         */
+        virtual std::vector<std::vector<int>> findDuplicateLessons() const = 0;
+
+        /**
+         * @brief Finds words of the same lesson with the same WordFingerprint.
+         * @return The IDs of each set of duplicates in ascending order, by lesson ID.
+         */
+        virtual std::map<int, std::vector<std::vector<int>>> findDuplicateWords() const = 0;
+
+        /**
+         * @brief Moves all words of a lesson to another lesson.
+         * @param fromLessonId The lesson that loses its words.
+         * @param toLessonId The lesson that receives them.
+         */
+        virtual void moveWords(int fromLessonId, int toLessonId) = 0;
+
+        /**
+         * @brief Returns the version of the database, raised by every change of a lesson or word.
+         */
+        virtual int64_t getVersion() const = 0;
+
+        /**
+         * @brief Collects the changes made after a version.
+         * @param version The version of the last sync, -1 for the whole database.
+         * @return The deletions and the lessons with their words written after the version.
+         */
+        virtual LessonChanges getChangesSince(int64_t version) const = 0;
+
+        /**
+         * @brief Returns the version of the last delta export, -1 if there was none.
+         */
+        virtual int64_t getExportedVersion() const = 0;
+
+        /**
+         * @brief Records the version of a delta export, the next one starts after it.
+         * @param version The LessonChanges::version that was exported.
+         */
+        virtual void setExportedVersion(int64_t version) = 0;
+
         /**
          * @brief Retrieves the names of all lessons in the database.
          * @return A vector of strings containing the names of all lessons.
@@ -120,5 +172,22 @@ namespace tadaima
          * @return An ApplicationSettings object containing the loaded settings.
          */
         virtual application::ApplicationSettings loadSettings() = 0;
+
+        /**
+         * @brief Starts a transaction, the following changes are written together by commitTransaction().
+         * @return True if the transaction was started.
+         */
+        virtual bool beginTransaction() = 0;
+
+        /**
+         * @brief Commits the transaction started by beginTransaction().
+         * @return True if the changes were written.
+         */
+        virtual bool commitTransaction() = 0;
+
+        /**
+         * @brief Discards the changes made since beginTransaction().
+         */
+        virtual void rollbackTransaction() = 0;
     };
 }